@@ -0,0 +1,21 @@
+# Generate the host-side string table for the deferred trace log.
+# Usage: cmake -DTRACE_DEF=<trace_log_fmt.def> -DTRACE_JSON=<out.json> -P trace_strings.cmake
+
+file(STRINGS "${TRACE_DEF}" trace_lines REGEX "^TRACE_FMT\\(")
+
+set(trace_entries "")
+set(trace_id 0)
+foreach(line IN LISTS trace_lines)
+    string(REGEX MATCH "^TRACE_FMT\\(([A-Za-z0-9_]+), *\"(.*)\"\\)" _ "${line}")
+    set(trace_name "${CMAKE_MATCH_1}")
+    set(trace_fmt "${CMAKE_MATCH_2}")
+    if(trace_name STREQUAL "")
+        message(FATAL_ERROR "Malformed TRACE_FMT entry: ${line}")
+    endif()
+    list(APPEND trace_entries
+         "    {\"id\": ${trace_id}, \"name\": \"${trace_name}\", \"fmt\": \"${trace_fmt}\"}")
+    math(EXPR trace_id "${trace_id} + 1")
+endforeach()
+
+list(JOIN trace_entries ",\n" trace_body)
+file(WRITE "${TRACE_JSON}" "{\n  \"version\": 1,\n  \"formats\": [\n${trace_body}\n  ]\n}\n")
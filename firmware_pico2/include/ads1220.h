@@ -15,16 +15,34 @@ typedef struct {
     uint miso_gpio;
 } ads1220_hw_t;
 
+typedef enum {
+    ADS1220_OP_NORMAL = 0,
+    ADS1220_OP_TURBO = 2,
+} ads1220_op_mode_t;
+
 typedef struct {
     uint8_t gain;
     uint16_t rate_sps;
     bool mains_reject;
     uint32_t average_window;
+    ads1220_op_mode_t op_mode;
 } ads1220_config_t;
 
+// Data rate / operating mode chosen for a measurement window by ads1220_plan().
+typedef struct {
+    uint16_t rate_sps;
+    ads1220_op_mode_t op_mode;
+    bool mains_reject;    // 50/60 Hz rejection only works at 20 SPS normal mode
+    uint16_t per_window;  // conversions guaranteed to complete inside one window
+    uint32_t noise_nV;    // expected noise of the per-window mean
+} ads1220_plan_t;
+
 void ads1220_init(const ads1220_hw_t *hw, const ads1220_config_t *config);
 void ads1220_apply_config(const ads1220_config_t *config);
 bool ads1220_read_uV(int32_t *value_uV, uint32_t timeout_ms, uint8_t *flags);
+void ads1220_plan(uint32_t window_ms, uint8_t gain, uint32_t noise_target_nV, bool want_mains, ads1220_plan_t *out);
+bool ads1220_poll(void);
+uint16_t ads1220_read_window(int32_t *value_uV, uint32_t stale_ms, uint8_t *flags);
 void ads1220_sleep(void);
 void ads1220_wake(void);
 
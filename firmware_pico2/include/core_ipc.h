@@ -0,0 +1,96 @@
+#ifndef TERPS_CORE_IPC_H
+#define TERPS_CORE_IPC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cross-core hand-off: single-producer/single-consumer rings in shared SRAM
+// plus a doorbell through the SIO mailbox FIFO. Payloads never go through the
+// FIFO; the producer publishes a slot, then pushes a one-word token
+// (channel << 16 | head index) to the consumer core. The token is only sent
+// when the ring was empty before the push, so a burst costs one doorbell. The
+// SIO FIFO IRQ on the consumer core latches the channel as pending and the
+// core sleeps in WFE until then.
+//
+// This module owns both SIO FIFOs after multicore_launch_core1(); nothing else
+// may push to or drain them (multicore_lockout is not used in this firmware).
+//
+// IPC_MODE_POLL keeps the old behaviour for comparison: no doorbells, and
+// consumers check their rings on every loop spin. Both modes record the same
+// publish-to-pop latency and traffic counters (IPC.STATUS).
+
+#define IPC_MAX_CHANNELS 8u
+
+#define TERPS_IPC_CH_FREQ 0u   // edge counter -> core1 (freq_result_t)
+#define TERPS_IPC_CH_FRAME 1u  // core1 -> core0 USB (terps_frame_t)
+
+typedef enum {
+    IPC_MODE_DOORBELL = 0,
+    IPC_MODE_POLL = 1,
+} ipc_mode_t;
+
+typedef struct {
+    uint32_t pushed;
+    uint32_t dropped;        // ring full, newest item discarded
+    uint32_t doorbells;      // FIFO tokens sent to the other core
+    uint32_t coalesced;      // pushes into a non-empty ring (no doorbell needed)
+    uint32_t fifo_full;      // doorbell skipped because the FIFO was full
+    uint32_t popped;
+    uint32_t wakeups;        // drains started by a doorbell (or by a poll in POLL mode)
+    uint32_t empty_checks;   // ring checks that found nothing: cross-core reads for no work
+    uint32_t lat_min_us;
+    uint32_t lat_max_us;
+    uint64_t lat_sum_us;
+} ipc_ring_stats_t;
+
+typedef struct {
+    uint8_t *slots;
+    uint32_t *stamps;        // publish time (time_us_32) per slot
+    uint16_t slot_size;
+    uint16_t mask;           // capacity - 1, capacity is a power of two
+    uint8_t channel;
+    uint8_t consumer_core;
+    bool draining;           // consumer side: keep popping until the ring is empty
+    volatile uint32_t head;  // written by the producer only
+    volatile uint32_t tail;  // written by the consumer only
+    ipc_ring_stats_t stats;
+} ipc_ring_t;
+
+// Call once on each core before its rings are used (installs the FIFO IRQ).
+void ipc_core_init(void);
+// `storage` holds capacity * slot_size bytes, `stamps` capacity words.
+// `capacity` is rounded down to a power of two.
+bool ipc_ring_init(ipc_ring_t *ring,
+                   void *storage,
+                   uint32_t *stamps,
+                   uint16_t slot_size,
+                   uint16_t capacity,
+                   uint8_t channel,
+                   uint8_t consumer_core);
+// Producer side. Concurrent producers must serialise externally.
+bool ipc_ring_push(ipc_ring_t *ring, const void *item);
+// Consumer side. ipc_ring_ready() is true when a doorbell arrived or a drain
+// is in progress (always true in POLL mode); pop until it returns false.
+bool ipc_ring_ready(ipc_ring_t *ring);
+bool ipc_ring_pop(ipc_ring_t *ring, void *item);
+// Sleep until a doorbell or any interrupt arrives, at most timeout_us
+// (0 = no bound). Returns immediately in POLL mode or with doorbells pending.
+void ipc_wait(uint32_t timeout_us);
+
+void ipc_set_mode(ipc_mode_t mode);
+ipc_mode_t ipc_get_mode(void);
+void ipc_ring_stats(const ipc_ring_t *ring, ipc_ring_stats_t *out);
+void ipc_ring_reset_stats(ipc_ring_t *ring);
+// Sleeps taken by ipc_wait() on a core.
+uint32_t ipc_sleeps(uint8_t core);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
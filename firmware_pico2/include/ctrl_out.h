@@ -0,0 +1,86 @@
+#ifndef TERPS_CTRL_OUT_H
+#define TERPS_CTRL_OUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hardware/spi.h"
+#include "terps_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Low-latency analog control output. core1 calls ctrl_out_update() for every
+// closed window, right after the ADC read, so no USB round trip sits in the
+// loop. The source value (window frequency, or pressure from the uploaded
+// (f-X)^i·(V-Y)^j surface) is mapped linearly from [in_lo, in_hi] onto
+// [out_min, out_max] and clamped there; out_min/out_max are fractions of full
+// scale and double as the hard output limits. Windows without a valid input
+// hold the last level, or go to fault_level when it is >= 0.
+//
+// Sinks: a PWM slice (filter it with an external RC low-pass; the new duty
+// latches at the next counter wrap, i.e. within 2^pwm_bits / clk_sys) and/or
+// an SPI DAC sharing the ADS1220 bus, written from the same core that polls the
+// ADC. `last_us`/`max_us` measure the closing edge to the completed write.
+//
+// bslfs.terps.ctrl_out.ControlOutputModel mirrors the scaling for host tests.
+#define CTRL_OUT_POLY_MAX 8u
+
+typedef struct {
+    uint32_t pwm_gpio;      // TERPS_GPIO_UNUSED = no PWM output
+    uint8_t pwm_bits;       // PWM resolution, 8..15
+    terps_out_dac_t dac;
+    uint32_t dac_cs_gpio;
+    spi_inst_t *spi;        // bus already set up by ads1220_init()
+} ctrl_out_hw_t;
+
+typedef struct {
+    terps_out_source_t source;
+    float in_lo;            // source value mapped to out_min
+    float in_hi;            // source value mapped to out_max
+    float out_min;          // fraction of full scale, 0..1
+    float out_max;
+    float fault_level;      // < 0: hold the last level on invalid windows
+} ctrl_out_scale_t;
+
+// Same layout as the host SensorPoly: K[i][j] multiplies (f-X)^i (V-Y)^j.
+typedef struct {
+    uint8_t rows;
+    uint8_t cols;
+    double x;               // Hz
+    double y;               // µV
+    double k[CTRL_OUT_POLY_MAX][CTRL_OUT_POLY_MAX];
+} ctrl_out_poly_t;
+
+typedef struct {
+    uint32_t updates;       // windows written to the output
+    uint32_t faults;        // windows without a valid input
+    uint32_t clamped;       // windows limited to out_min/out_max
+    uint32_t last_us;       // closing edge -> output written
+    uint32_t max_us;
+    uint64_t sum_us;
+    float value;            // last source value (Hz or pressure units)
+    float level;            // last level, fraction of full scale
+    uint16_t pwm_code;
+    uint16_t dac_code;
+} ctrl_out_stats_t;
+
+void ctrl_out_init(const ctrl_out_hw_t *hw, const ctrl_out_scale_t *scale);
+void ctrl_out_set_scale(const ctrl_out_scale_t *scale);
+void ctrl_out_get_scale(ctrl_out_scale_t *scale);
+// Returns false (and keeps the old surface) when the shape is out of range.
+bool ctrl_out_set_poly(const ctrl_out_poly_t *poly);
+// Rows x cols of the active surface; 0 when none was uploaded.
+uint8_t ctrl_out_poly_shape(uint8_t *cols);
+// Called by core1 once per window. `end_us` is the closing edge time.
+void ctrl_out_update(float f_hz, int32_t diode_uV, bool f_valid, bool v_valid, uint64_t end_us);
+void ctrl_out_get_stats(ctrl_out_stats_t *stats);
+void ctrl_out_reset_stats(void);
+uint32_t ctrl_out_pwm_period_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef TERPS_EDGE_CAPTURE_H
+#define TERPS_EDGE_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EDGE_CAPTURE_BYTES (96u * 1024u)
+
+typedef struct {
+    bool armed;
+    uint32_t edges;
+    uint32_t max_edges;
+    uint32_t bytes_used;
+    uint64_t first_us;
+    uint32_t tokens4;
+    uint32_t tokens8;
+    uint32_t tokens16;
+    uint32_t tokens32;
+    uint32_t overflow;
+} edge_capture_status_t;
+
+void edge_capture_init(void);
+void edge_capture_start(uint32_t max_edges);
+void edge_capture_stop(void);
+void edge_capture_push(uint64_t timestamp_us);
+void edge_capture_status(edge_capture_status_t *out);
+size_t edge_capture_read(uint32_t offset, uint8_t *dst, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
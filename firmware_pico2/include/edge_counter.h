@@ -4,13 +4,15 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#include "pico/util/queue.h"
+#include "core_ipc.h"
 #include "terps_config.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define FREQ_SLOT_NONE 0xFFFFFFFFu
+
 typedef struct {
     terps_mode_t mode;
     uint32_t pulses;
@@ -22,18 +24,58 @@ typedef struct {
     int32_t f_hz_x1e4;
     float f_hz;
     uint32_t glitch_count;
+    uint16_t duty_x1e4;
+    uint32_t slot;
     bool sync_active;
     bool timeout;
+    uint64_t ref_cycles;  // TERPS_MODE_REF: reference cycles spanned by pulses - 1 periods
 } freq_result_t;
 
+// Time-triggered acquisition: window k opens at start_us + k * period on the
+// device timer and closes when window k+1 opens. The period is period_us plus
+// period_frac/65536 µs so a host can trim it to the crystal's measured skew.
+// `slot` numbers windows from `first_slot` so several units scheduled on one
+// host grid agree on it.
+typedef struct {
+    bool active;
+    uint64_t next_us;
+    uint32_t period_us;
+    uint16_t period_frac;
+    uint32_t next_slot;
+    uint32_t late_max_us;
+    uint32_t windows;
+} freq_schedule_status_t;
+
+// Per-polarity detail of the last TERPS_MODE_DUAL window. The rise->rise and
+// fall->fall estimates agree on a healthy comparator; the duty cycle drifting
+// away from its usual value points at threshold or hysteresis problems.
+typedef struct {
+    terps_mode_t mode;
+    uint32_t rise_edges;
+    uint32_t fall_edges;
+    float f_rise_hz;
+    float f_fall_hz;
+    uint16_t duty_x1e4;
+    uint32_t glitch_count;
+} freq_edge_stats_t;
+
 void freq_counter_init(const terps_firmware_config_t *config);
 void freq_counter_start_window(terps_mode_t mode, uint32_t tau_ms);
+// GPIO IRQ enables are per core: call on core0, which owns gpio_callback,
+// before `mode` reaches freq_counter_start_window().
+void freq_counter_set_edge_irqs(terps_mode_t mode);
 void freq_counter_stop(void);
-queue_t *freq_counter_queue(void);
+// Window results for core1, published from the counter IRQ/alarm context.
+// A full ring drops the newest result (ipc_ring_stats().dropped).
+ipc_ring_t *freq_counter_ring(void);
 void freq_counter_on_sync(bool level_high);
 void freq_counter_update_timebase_ppm(float ppm_correction);
 float freq_counter_last_frequency(void);
 void freq_counter_set_min_interval(float min_interval_frac);
+void freq_counter_edge_stats(freq_edge_stats_t *out);
+bool freq_counter_schedule(uint64_t start_us, uint32_t period_us, uint16_t period_frac, uint32_t first_slot);
+void freq_counter_unschedule(void);
+void freq_counter_schedule_status(freq_schedule_status_t *out);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,83 @@
+#ifndef TERPS_FRAME_SCHEMA_H
+#define TERPS_FRAME_SCHEMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Self-describing binary records. Each packet type that carries records has a
+// descriptor table listing, per field, a stable ID, wire type, byte offset in
+// the payload, decimal scale (value = raw * 10^scale_exp) and the offset of the
+// source member in the C struct. The same table drives the encoder and the
+// `0x55 0xA6` schema packet, so adding a field is one table row: hosts decode
+// from the schema they received and skip IDs they do not know.
+//
+// Schema packet payload (little-endian):
+//   version(u8=1) | packet_type(u8) | payload_len(u8) | nfields(u8) |
+//   nfields × { id(u8) type(u8) offset(u8) scale_exp(i8) attr(u8) name_len(u8) name[name_len] }
+#define FRAME_SCHEMA_VERSION 1u
+#define FRAME_SCHEMA_MAX_TYPES 4u
+
+// Field IDs are never reused; bslfs.terps.schema maps them to Frame members.
+#define FRAME_FIELD_TS_MS 1u
+#define FRAME_FIELD_F_HZ 2u
+#define FRAME_FIELD_TAU_MS 3u
+#define FRAME_FIELD_DIODE_UV 4u
+#define FRAME_FIELD_ADC_GAIN 5u
+#define FRAME_FIELD_FLAGS 6u
+#define FRAME_FIELD_PPM_CORR 7u
+#define FRAME_FIELD_MODE 8u
+#define FRAME_FIELD_SLOT 9u
+#define FRAME_FIELD_ADC_FRESH 10u
+#define FRAME_FIELD_SEQ 11u
+
+// attr bits
+#define FRAME_ATTR_ALL_ONES_NONE 0x01u  // an all-ones raw value means "not present"
+
+typedef enum {
+    FRAME_TYPE_U8 = 1,
+    FRAME_TYPE_I8 = 2,
+    FRAME_TYPE_U16 = 3,
+    FRAME_TYPE_I16 = 4,
+    FRAME_TYPE_U32 = 5,
+    FRAME_TYPE_I32 = 6,
+    FRAME_TYPE_F32 = 7,
+} frame_field_type_t;
+
+typedef struct {
+    uint8_t id;
+    uint8_t type;          // frame_field_type_t
+    int8_t scale_exp;
+    uint8_t attr;
+    uint16_t src_offset;   // offsetof() in the source struct
+    const char *name;
+} frame_field_desc_t;
+
+typedef struct {
+    uint8_t packet_type;
+    uint8_t nfields;
+    uint8_t payload_len;   // filled in by frame_schema_register()
+    const frame_field_desc_t *fields;
+} frame_schema_t;
+
+uint8_t frame_field_size(uint8_t type);
+// Fields are laid out back to back in table order. Returns false when the
+// registry is full or the payload would not fit one packet.
+bool frame_schema_register(frame_schema_t *schema);
+const frame_schema_t *frame_schema_find(uint8_t packet_type);
+size_t frame_schema_count(void);
+const frame_schema_t *frame_schema_at(size_t index);
+// Serialise `src` (the struct the table describes) into `dst`; returns bytes written.
+size_t frame_schema_encode(const frame_schema_t *schema, const void *src, uint8_t *dst, size_t capacity);
+// Build the schema packet payload; returns bytes written or 0 if it does not fit.
+size_t frame_schema_describe(const frame_schema_t *schema, uint8_t *dst, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TERPS_HDR_HIST_H
+#define TERPS_HDR_HIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Log-linear (HDR-style) histogram over signed 32-bit integers. Magnitudes
+// below 2^P land in exact unit buckets; above that each power of two is split
+// into 2^(P-1) linear sub-buckets, so a reported quantile is within a relative
+// error of 2^-P of the true order statistic. The bucket layout is fixed, which
+// makes histograms from different windows, files or devices mergeable by
+// adding counts. bslfs.terps.hdrhist implements the same indexing.
+#define HDR_HIST_PRECISION_BITS 6u
+#define HDR_HIST_HALF (1u << (HDR_HIST_PRECISION_BITS - 1u))
+#define HDR_HIST_BUCKETS ((34u - HDR_HIST_PRECISION_BITS) * HDR_HIST_HALF)
+#define HDR_HIST_ENTRY_BYTES 6u
+#define HDR_HIST_NEGATIVE 0x8000u
+
+typedef struct {
+    uint32_t pos[HDR_HIST_BUCKETS];
+    uint32_t neg[HDR_HIST_BUCKETS];
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+} hdr_hist_t;
+
+void hdr_hist_reset(hdr_hist_t *hist);
+void hdr_hist_record(hdr_hist_t *hist, int32_t value);
+uint32_t hdr_hist_bucket(uint32_t magnitude);
+uint32_t hdr_hist_bucket_lower(uint32_t index);
+uint32_t hdr_hist_bucket_width(uint32_t index);
+int32_t hdr_hist_quantile(const hdr_hist_t *hist, float q);
+// Sparse export: one entry per non-empty bucket, u16 index (bit 15 set for
+// negative values) followed by a u32 count, little-endian. Returns bytes
+// written; stops early when `capacity` is exhausted.
+size_t hdr_hist_export(const hdr_hist_t *hist, uint8_t *dst, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TERPS_LATEST_H
+#define TERPS_LATEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "usb_cdc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Latest complete measurement, published by core1 once per window after the
+// frame is assembled, for any number of readers on either core (command
+// handlers, stats, control output) without touching the stream rings.
+//
+// Double-buffered seqlock (a "latch"): the writer bumps `seq` to odd, rewrites
+// copy 0, bumps it to even and rewrites copy 1. A reader copies entry
+// `seq & 1`, which the writer is not touching at that moment, and retries only
+// if `seq` moved meanwhile, i.e. the writer finished a half-update during the
+// copy. The writer never waits and takes no lock; a reader on the writer's own
+// core (an IRQ preempting it) never retries.
+typedef struct {
+    uint32_t windows;   // published since boot, 0 = none yet
+    uint64_t start_us;  // window edges on the device timer
+    uint64_t end_us;
+    uint32_t pulses;
+    terps_frame_t frame;
+} terps_latest_t;
+
+// Single writer (core1).
+void latest_publish(const terps_latest_t *m);
+// Wait-free for the writer, lock-free for readers; false until the first window.
+bool latest_read(terps_latest_t *out);
+// Reads that had to copy again because a publish overlapped them.
+uint32_t latest_retries(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef TERPS_REF_CLOCK_H
+#define TERPS_REF_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// External reference clock (e.g. a lab 10 MHz) counted by a PWM slice in
+// B-rising mode. The pin must be a channel B input, i.e. an odd GPIO. The
+// 16-bit hardware counter is extended to 64 bits in software: every sample
+// adds the signed difference to the previous one, and a repeating alarm
+// samples at least every quarter wrap so no wrap is missed between edges.
+//
+// TERPS_MODE_REF latches the count on each counted TERPS edge and reports
+// periods * ref_hz / ref_cycles, so the result does not depend on the Pico
+// crystal. The latch is taken in the edge IRQ, so IRQ latency jitter stays in
+// the result; only the timebase error is removed.
+
+typedef struct {
+    bool enabled;
+    uint32_t gpio;
+    uint32_t hz;
+    uint32_t slice;
+    uint64_t count;        // extended count at the last sample
+    uint32_t samples;
+    // Pico timer against the reference since init: > 0 means the crystal runs fast.
+    float xtal_ppm;
+    uint32_t span_ms;
+} ref_clock_status_t;
+
+// Returns false when the pin cannot count (not a channel B pin, hz == 0).
+bool ref_clock_init(uint32_t gpio, uint32_t hz);
+bool ref_clock_enabled(void);
+uint32_t ref_clock_slice(void);
+uint32_t ref_clock_hz(void);
+// Raw 16-bit counter; read it as close to the event as possible.
+uint16_t ref_clock_raw(void);
+// Extends a raw sample taken after (or shortly before) the previous one. Safe
+// to call inside another critical section: the ref lock is a dedicated one.
+uint64_t ref_clock_extend(uint16_t raw);
+// Frequency in 1e-4 Hz of `periods` signal periods spanning `cycles`
+// reference cycles, rounded to nearest; exact in 64-bit integers.
+int32_t ref_clock_ratio_x1e4(uint32_t periods, uint64_t cycles, uint32_t ref_hz);
+void ref_clock_status(ref_clock_status_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
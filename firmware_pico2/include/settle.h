@@ -0,0 +1,59 @@
+#ifndef TERPS_SETTLE_H
+#define TERPS_SETTLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Warm-up / step settling detector. Each valid frame adds (t, f, V) to a ring
+// of the last `window` frames; a least-squares line through each series gives
+// the drift rate and the RMS residual about that line gives the short-term
+// noise. Once both series stay inside their slope and noise limits for `hold`
+// consecutive frames the detector reports settled; it is cleared again once a
+// statistic exceeds 1.5x its limit. A pressure step shows up in the residual
+// immediately, well before it moves the fitted slope. A limit of 0 disables
+// that criterion.
+#define SETTLE_MAX_WINDOW 64u
+
+typedef struct {
+    uint16_t window;       // frames per fit, 3..SETTLE_MAX_WINDOW
+    uint16_t hold;         // consecutive passing frames before settled
+    float f_slope_hz_s;    // |df/dt| limit
+    float f_noise_hz;      // RMS residual limit for frequency
+    float v_slope_uV_s;    // |dV/dt| limit
+    float v_noise_uV;      // RMS residual limit for diode voltage
+} settle_limits_t;
+
+typedef struct {
+    settle_limits_t limits;
+    uint32_t t_ms[SETTLE_MAX_WINDOW];
+    int32_t f_x1e4[SETTLE_MAX_WINDOW];
+    int32_t v_uV[SETTLE_MAX_WINDOW];
+    uint16_t head;
+    uint16_t fill;
+    uint16_t passing;
+    bool settled;
+    // Latest fit, for status reporting.
+    float f_slope_hz_s;
+    float f_noise_hz;
+    float v_slope_uV_s;
+    float v_noise_uV;
+    uint32_t armed_ms;    // frame time of the first sample after (re-)arming
+    uint32_t settled_ms;  // time from arming to settled; 0 while unsettled
+    uint32_t transitions; // settled→unsettled drops since init
+} settle_detector_t;
+
+void settle_init(settle_detector_t *det, const settle_limits_t *limits);
+// Forget the history (after a reconfiguration or a commanded pressure step).
+void settle_reset(settle_detector_t *det);
+// Feed one frame; invalid frames (real faults only) reset the history. Returns the settled state.
+bool settle_update(settle_detector_t *det, uint32_t t_ms, int32_t f_hz_x1e4, int32_t v_uV, bool valid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -9,6 +9,8 @@
 #define TERPS_FLAG_ADC_TIMEOUT 0x02u
 #define TERPS_FLAG_PPS_LOCKED 0x04u
 #define TERPS_FLAG_ADC_SATURATED 0x08u
+#define TERPS_FLAG_SETTLED 0x10u
+#define TERPS_FLAG_SUMMARY 0x20u  // frame merges several windows (TX pacer overload)
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,8 +19,22 @@ extern "C" {
 typedef enum {
     TERPS_MODE_GATED = 0,
     TERPS_MODE_RECIP = 1,
+    TERPS_MODE_DUAL = 2,
+    TERPS_MODE_REF = 3,  // reciprocal, timed in external reference-clock cycles
 } terps_mode_t;
 
+typedef enum {
+    TERPS_OUT_OFF = 0,
+    TERPS_OUT_FREQ = 1,
+    TERPS_OUT_PRESSURE = 2,
+} terps_out_source_t;
+
+typedef enum {
+    TERPS_OUT_DAC_NONE = 0,
+    TERPS_OUT_DAC_MCP4921 = 1,  // 12-bit, SPI mode 0
+    TERPS_OUT_DAC_DAC8551 = 2,  // 16-bit, SPI mode 1
+} terps_out_dac_t;
+
 typedef struct {
     terps_mode_t mode;
     uint32_t tau_ms;
@@ -27,6 +43,8 @@ typedef struct {
     uint8_t adc_gain;
     uint16_t adc_rate_sps;
     bool adc_mains_reject;
+    bool adc_auto_rate;            // pick rate/mode per window with ads1220_plan()
+    uint32_t adc_noise_target_nV;  // 0 = lowest noise per window
     uint32_t avg_window;
     bool binary_frames;
     uint32_t queue_length;
@@ -42,6 +60,30 @@ typedef struct {
     bool debug_deglitch_stats;
     uint32_t unio_gpio;
     uint32_t unio_bitrate_bps;
+    uint32_t unio_extra_gpio_mask;  // more SCIO lines (bit n = GPIO n), read in lock-step with unio_gpio
+    uint16_t settle_window;        // frames per drift/noise fit
+    uint16_t settle_hold;          // passing frames before TERPS_FLAG_SETTLED
+    float settle_f_slope_hz_s;     // 0 disables a criterion
+    float settle_f_noise_hz;
+    float settle_v_slope_uV_s;
+    float settle_v_noise_uV;
+    terps_out_source_t out_source;  // control output, updated by core1 every window
+    uint32_t out_pwm_gpio;          // RC-filtered PWM; TERPS_GPIO_UNUSED = off
+    uint8_t out_pwm_bits;
+    terps_out_dac_t out_dac;        // SPI DAC on the ADS1220 bus
+    uint32_t out_dac_cs_gpio;
+    float out_in_lo;                // source value (Hz or pressure) at out_min
+    float out_in_hi;                // source value at out_max
+    float out_min;                  // output limits, fraction of full scale
+    float out_max;
+    float out_fault_level;          // < 0 holds the last level on invalid windows
+    uint32_t uart_tx_gpio;          // binary frames on a hardware UART; TERPS_GPIO_UNUSED = off
+    uint32_t uart_baud;
+    uint32_t uart_de_gpio;          // RS-485 driver enable; TERPS_GPIO_UNUSED = none
+    uint16_t uart_de_lead_us;       // DE high before the first start bit
+    uint16_t uart_de_tail_us;       // DE held after the last stop bit
+    uint32_t ref_clk_gpio;          // reference clock into a PWM B pin (odd GPIO); TERPS_GPIO_UNUSED = none
+    uint32_t ref_clk_hz;            // nominal reference frequency
 } terps_firmware_config_t;
 
 extern const terps_firmware_config_t terps_default_config;
@@ -0,0 +1,45 @@
+#ifndef TERPS_TRACE_LOG_H
+#define TERPS_TRACE_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_LOG_MAX_ARGS 4
+
+typedef enum {
+#define TRACE_FMT(id, fmt) id,
+#include "trace_log_fmt.def"
+#undef TRACE_FMT
+    TRACE_ID_COUNT
+} trace_id_t;
+
+typedef struct {
+    uint32_t ts_us;
+    uint16_t id;
+    uint8_t core;
+    uint8_t nargs;
+    uint32_t args[TRACE_LOG_MAX_ARGS];
+} trace_entry_t;
+
+void trace_log_init(void);
+void trace_log_write(trace_id_t id, uint8_t nargs, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+bool trace_log_pop(trace_entry_t *out);
+uint32_t trace_log_dropped(void);
+
+#define TRACE0(id) trace_log_write((id), 0, 0, 0, 0, 0)
+#define TRACE1(id, a0) trace_log_write((id), 1, (uint32_t)(a0), 0, 0, 0)
+#define TRACE2(id, a0, a1) trace_log_write((id), 2, (uint32_t)(a0), (uint32_t)(a1), 0, 0)
+#define TRACE3(id, a0, a1, a2) \
+    trace_log_write((id), 3, (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2), 0)
+#define TRACE4(id, a0, a1, a2, a3) \
+    trace_log_write((id), 4, (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
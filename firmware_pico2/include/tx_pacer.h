@@ -0,0 +1,81 @@
+#ifndef TERPS_TX_PACER_H
+#define TERPS_TX_PACER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Adaptive USB TX packing. The pacer watches the CDC TX FIFO: bytes written
+// minus bytes still queued is what the host has drained. While the FIFO stays
+// well filled, that drain rate is the host's capacity. It escalates one step
+// when the FIFO passes `high_fill` or a write stalls, and steps back after
+// `hold_ms` below `low_fill` if the lighter load is below 70 % of the last
+// measured capacity, or no capacity was measured for `probe_holds` × hold_ms.
+// A step-down that overflows again within two holds doubles `probe_holds`
+// (4 → 64), so a host that stays slow is not probed every few seconds.
+//
+//   step 0      NORMAL   one frame per write/flush
+//   step 1      BATCH    up to batch_max frames (or batch_ms) per flush
+//   step k >= 2 SUMMARY  batching + every 2^(k-1) frames merged into one
+//
+// bslfs.terps.txpace.TxPacerModel mirrors this logic for host-side tests.
+typedef enum {
+    TX_LEVEL_NORMAL = 0,
+    TX_LEVEL_BATCH = 1,
+    TX_LEVEL_SUMMARY = 2,
+} tx_level_t;
+
+typedef struct {
+    uint32_t fifo_size;   // CDC TX FIFO bytes
+    uint16_t batch_max;   // frames per flush at step >= 1
+    uint16_t batch_ms;    // oldest staged frame is flushed after this
+    uint16_t merge_max;   // largest summary factor (power of two)
+    uint16_t sample_ms;   // drain-rate sampling interval
+    uint16_t hold_ms;     // calm time before stepping back
+    float high_fill;      // FIFO fill that escalates
+    float low_fill;       // FIFO fill considered calm
+} tx_pacer_limits_t;
+
+typedef struct {
+    tx_pacer_limits_t limits;
+    uint8_t step;
+    uint8_t max_step;
+    bool started;
+    bool stall_pending;
+    uint64_t last_us;
+    uint64_t calm_since_us;
+    uint64_t capacity_at_us;
+    uint64_t down_at_us;     // last step-down, for probe back-off
+    uint8_t probe_holds;
+    uint32_t written;        // bytes handed to the FIFO (wraps)
+    uint32_t drained_prev;
+    uint32_t offered;        // NORMAL-encoding bytes offered since the last sample
+    float drain_Bps;
+    float capacity_Bps;      // drain measured while the host was the bottleneck
+    float demand_Bps;        // NORMAL-encoding bytes/s produced
+    uint32_t changes;
+    uint32_t stalls;
+    uint32_t dropped;        // frames lost to stalled writes
+} tx_pacer_t;
+
+void tx_pacer_default_limits(tx_pacer_limits_t *limits, uint32_t fifo_size);
+void tx_pacer_init(tx_pacer_t *pacer, const tx_pacer_limits_t *limits);
+// Force a step (e.g. a host command); clamps to the valid range.
+void tx_pacer_set_step(tx_pacer_t *pacer, uint8_t step);
+void tx_pacer_offer(tx_pacer_t *pacer, uint32_t normal_bytes);
+void tx_pacer_wrote(tx_pacer_t *pacer, uint32_t bytes);
+void tx_pacer_stall(tx_pacer_t *pacer, uint32_t frames_lost);
+// Returns true when the step changed; the caller announces it in-band.
+bool tx_pacer_sample(tx_pacer_t *pacer, uint64_t now_us, uint32_t fifo_free);
+tx_level_t tx_pacer_level(const tx_pacer_t *pacer);
+uint16_t tx_pacer_batch(const tx_pacer_t *pacer);
+uint16_t tx_pacer_merge(const tx_pacer_t *pacer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
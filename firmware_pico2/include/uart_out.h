@@ -0,0 +1,69 @@
+#ifndef TERPS_UART_OUT_H
+#define TERPS_UART_OUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "usb_cdc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary frame output on a hardware UART, in parallel with USB (e.g. to a PLC
+// over RS-485). core1 encodes each window's 0x55AA packet once, straight into
+// a slot of a small ring, and DMA paced by the UART TX DREQ moves the bytes;
+// the DMA-complete IRQ (also on core1) chains the next slot, so the CPU never
+// touches individual bytes. The UART stream has its own `seq`, incremented for
+// every window including dropped ones, so a receiver sees drops as gaps.
+//
+// RS-485: `de_gpio` is raised `de_lead_us` before the first start bit and kept
+// up across back-to-back packets; an alarm drops it `de_tail_us` after the
+// last stop bit (the UART BUSY flag is re-checked before release).
+//
+// Latency: the UART shifts at an exact baud rate, so the time the last stop
+// bit leaves the pin is known when DMA starts. `wire` latency = closing edge
+// -> end of the packet on the wire; `start` = closing edge -> packet queued.
+//
+// bslfs.terps.uart_out.UartOutModel mirrors the ring, DE and timing on the host.
+#define UART_OUT_SLOTS 8u
+#define UART_OUT_SLOT_BYTES 64u
+
+typedef struct {
+    uint32_t tx_gpio;       // UART TX pin (GP0/12/16/28 = uart0, GP4/8/20/24 = uart1)
+    uint32_t baud;
+    uint32_t de_gpio;       // RS-485 driver enable, TERPS_GPIO_UNUSED = none
+    uint16_t de_lead_us;
+    uint16_t de_tail_us;
+} uart_out_hw_t;
+
+typedef struct {
+    uint32_t queued;        // packets handed to the ring
+    uint32_t sent;          // packets whose DMA transfer completed
+    uint32_t bytes;
+    uint32_t dropped;       // ring full (wire slower than the window rate)
+    uint32_t encode_errors;
+    uint16_t depth_max;     // most slots in use at once
+    uint32_t de_cycles;     // DE assert/release pairs
+    uint32_t start_last_us; // closing edge -> encoded and queued
+    uint32_t start_max_us;
+    uint32_t wire_last_us;
+    uint32_t wire_max_us;
+    uint64_t wire_sum_us;
+} uart_out_stats_t;
+
+// Returns false when the pin is not a UART TX pin or no DMA channel is free.
+bool uart_out_init(const uart_out_hw_t *hw);
+bool uart_out_enabled(void);
+// Routes the DMA-complete IRQ to the calling core; call from core1_main().
+void uart_out_attach_irq(void);
+// core1, once per window. `end_us` is the closing edge time.
+bool uart_out_send_frame(const terps_frame_t *frame, uint64_t end_us);
+void uart_out_get_stats(uart_out_stats_t *stats);
+void uart_out_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
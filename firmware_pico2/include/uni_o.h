@@ -9,14 +9,33 @@
 extern "C" {
 #endif
 
+// Up to UNIO_MAX_BUSES SCIO lines (GPIO 0-31, one 11LC040 each) are driven in
+// lock-step: one timing loop toggles every line with masked SIO writes, so N
+// images load in the time of one. Bus 0 is the line given to unio_init().
+#define UNIO_MAX_BUSES 8u
+
 typedef enum {
     UNIO_STATUS_OK = 0,
     UNIO_STATUS_NO_DEVICE,
     UNIO_STATUS_IO_ERROR,
 } unio_status_t;
 
+typedef struct {
+    unio_status_t status;
+    uint8_t device_addr;  // 0xA0..0xAE when status is OK
+} unio_bus_result_t;
+
 void unio_init(uint gpio_scio, uint32_t bitrate_bps);
+// Replaces the bus list; GPIOs >= 32 or TERPS_GPIO_UNUSED entries are skipped.
+// Returns the number of buses in use.
+size_t unio_init_buses(const uint *gpios, size_t count, uint32_t bitrate_bps);
+size_t unio_bus_count(void);
+uint unio_bus_gpio(size_t bus);
 bool unio_read(uint16_t addr, uint8_t *buf, size_t len);
+// Reads [addr, addr+len) from every bus in `bus_mask` (bit i = bus i) at once.
+// bufs[i] / results[i] are indexed by bus; returns true if all succeeded.
+bool unio_read_buses(uint32_t bus_mask, uint16_t addr, uint8_t *const *bufs, size_t len,
+                     unio_bus_result_t *results);
 unio_status_t unio_last_status(void);
 uint8_t unio_last_device_address(void);
 uint32_t unio_current_bitrate(void);
@@ -2,8 +2,18 @@
 #define TERPS_USB_CDC_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "trace_log.h"
+#include "tx_pacer.h"
+
+#define TERPS_PACKET_MAGIC 0x55u
+#define TERPS_PACKET_FRAME 0xAAu
+#define TERPS_PACKET_TRACE 0xA5u
+#define TERPS_PACKET_SCHEMA 0xA6u  // frame_schema.h descriptor for one record type
+#define TERPS_PACKET_TX_STATE 0xA7u  // TX pacer step change (schema-described)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -17,6 +27,9 @@ typedef struct {
     uint8_t flags;
     int16_t ppm_corr_x1e2;
     uint8_t mode;
+    uint32_t slot;  // scheduled window index, 0xFFFFFFFF when free-running
+    uint8_t adc_fresh;  // ADS1220 conversions averaged into diode_uV (0 = reused)
+    uint16_t seq;       // per-packet counter, assigned by usb_cdc_send_frame()
     float f_hz;
     float ppm_corr;
 } terps_frame_t;
@@ -29,8 +42,26 @@ typedef enum {
 void usb_cdc_init(terps_stream_mode_t mode);
 void usb_cdc_set_mode(terps_stream_mode_t mode);
 bool usb_cdc_send_frame(const terps_frame_t *frame);
+// The 0x55AA packet usb_cdc_send_frame() emits in binary mode (frame->seq as
+// given). Reentrant; uart_out uses it from core1.
+size_t usb_cdc_encode_binary(const terps_frame_t *frame, uint8_t *dst, size_t capacity);
+bool usb_cdc_send_packet(uint8_t type, const uint8_t *payload, size_t len);
+bool usb_cdc_send_trace(const trace_entry_t *entry);
+// Emit one 0x55A6 packet per registered record type. Binary mode re-announces
+// automatically on connect and on entering binary mode; usb_cdc_request_schema()
+// queues it ahead of the next frame (e.g. after a SCHEMA reply's END).
+bool usb_cdc_send_schema(void);
+void usb_cdc_request_schema(void);
+// Frames go through the adaptive TX pacer (tx_pacer.h): batched, then merged
+// into TERPS_FLAG_SUMMARY frames while the host falls behind. Each step change
+// is announced in-band (0x55A7 record, or a `#TX` line in CSV mode).
+void usb_cdc_tx_status(tx_pacer_t *out, bool *auto_mode);
+// auto_mode=false pins `step`; auto_mode=true resumes adaptation from it.
+void usb_cdc_tx_set(bool auto_mode, uint8_t step);
 bool usb_cdc_read_line(char *buffer, size_t max_len);
 void usb_cdc_write_line(const char *text);
+bool usb_cdc_write_block(const uint8_t *data, size_t len);
+uint16_t usb_cdc_crc16(const uint8_t *data, size_t len);
 void usb_cdc_printf(const char *fmt, ...);
 void usb_cdc_poll(void);
 
@@ -25,6 +25,24 @@ static ads1220_config_t g_cfg;
 static int32_t g_filtered_uV = 0;
 static bool g_initialized = false;
 
+// Conversions collected by ads1220_poll() since the last ads1220_read_window().
+static int64_t g_acc_sum_uV = 0;
+static uint32_t g_acc_count = 0;
+static bool g_acc_saturated = false;
+static uint64_t g_last_conversion_us = 0;
+
+#define ADS1220_RATE_STEPS 7
+static const uint16_t k_normal_rates[ADS1220_RATE_STEPS] = {20, 45, 90, 175, 330, 600, 1000};
+static const uint16_t k_turbo_rates[ADS1220_RATE_STEPS] = {40, 90, 180, 350, 660, 1200, 2000};
+// Typical input-referred noise per conversion (nVrms, internal 2.048 V reference) at
+// gains 1, 16 and 128, rounded from the datasheet noise tables. Turbo mode at the same
+// DR code has about the same noise at twice the rate.
+static const float k_noise_nV[3][ADS1220_RATE_STEPS] = {
+    {3710.0f, 5810.0f, 7740.0f, 11290.0f, 15550.0f, 22360.0f, 35640.0f},
+    {320.0f, 480.0f, 680.0f, 980.0f, 1390.0f, 1980.0f, 3180.0f},
+    {150.0f, 230.0f, 320.0f, 460.0f, 640.0f, 910.0f, 1440.0f},
+};
+
 static inline void cs_select(void)
 {
     gpio_put(g_hw.cs_gpio, 0);
@@ -109,7 +127,13 @@ static void apply_registers(void)
     }
 
     uint8_t reg1 = 0x04;  // continuous conversion
-    reg1 |= (rate_to_bits(g_cfg.rate_sps) << 5);
+    if (g_cfg.op_mode == ADS1220_OP_TURBO) {
+        // Turbo doubles every DR code's rate; the codes map onto half the turbo rate.
+        reg1 |= (rate_to_bits((uint16_t)(g_cfg.rate_sps / 2u)) << 5);
+        reg1 |= (uint8_t)(ADS1220_OP_TURBO << 3);
+    } else {
+        reg1 |= (rate_to_bits(g_cfg.rate_sps) << 5);
+    }
 
     uint8_t reg2 = 0x10;  // internal reference, default settings
     if (g_cfg.mains_reject) {
@@ -164,6 +188,7 @@ void ads1220_init(const ads1220_hw_t *hw, const ads1220_config_t *config)
     apply_registers();
     write_command(ADS1220_CMD_START);
     g_filtered_uV = 0;
+    g_last_conversion_us = time_us_64();
     g_initialized = true;
 }
 
@@ -175,6 +200,103 @@ void ads1220_apply_config(const ads1220_config_t *config)
     }
     apply_registers();
     g_filtered_uV = 0;
+    g_acc_sum_uV = 0;
+    g_acc_count = 0;
+    g_acc_saturated = false;
+}
+
+static float conversion_noise_nV(uint8_t gain, int step)
+{
+    // Log-log interpolation between the gain 1/16/128 rows.
+    float lg = log2f((float)(gain ? gain : 1));
+    int row = 0;
+    float t = lg / 4.0f;
+    if (lg > 4.0f) {
+        row = 1;
+        t = (lg - 4.0f) / 3.0f;
+    }
+    if (t > 1.0f) {
+        t = 1.0f;
+    }
+    const float lo = logf(k_noise_nV[row][step]);
+    const float hi = logf(k_noise_nV[row + 1][step]);
+    return expf(lo + (hi - lo) * t);
+}
+
+void ads1220_plan(uint32_t window_ms, uint8_t gain, uint32_t noise_target_nV, bool want_mains, ads1220_plan_t *out)
+{
+    // Every candidate must back each window with at least one conversion. With a
+    // noise target the slowest candidate meeting it wins (least SPI/IRQ load and
+    // power); without one the quietest window mean wins. Requested mains rejection
+    // pins 20 SPS normal mode whenever that still meets both conditions.
+    ads1220_plan_t best = {
+        .rate_sps = k_turbo_rates[ADS1220_RATE_STEPS - 1],
+        .op_mode = ADS1220_OP_TURBO,
+        .mains_reject = false,
+        .per_window = 0,
+        .noise_nV = (uint32_t)conversion_noise_nV(gain, ADS1220_RATE_STEPS - 1),
+    };
+    bool have = false;
+    bool best_meets = false;
+    for (int step = 0; step < ADS1220_RATE_STEPS; ++step) {
+        for (int turbo = 0; turbo < 2; ++turbo) {
+            const uint16_t rate = turbo ? k_turbo_rates[step] : k_normal_rates[step];
+            const uint32_t per_window = (uint32_t)(((uint64_t)window_ms * rate) / 1000u);
+            if (per_window == 0) {
+                continue;
+            }
+            const float noise = conversion_noise_nV(gain, step) / sqrtf((float)per_window);
+            const bool meets = noise_target_nV == 0 || noise <= (float)noise_target_nV;
+            const bool mains = want_mains && !turbo && rate == k_normal_rates[0];
+            bool take;
+            if (!have) {
+                take = true;
+            } else if (best.mains_reject && best_meets) {
+                take = false;
+            } else if (mains && meets) {
+                take = true;
+            } else if (meets != best_meets) {
+                take = meets;
+            } else if (noise_target_nV != 0 && meets) {
+                take = rate < best.rate_sps;
+            } else {
+                take = noise < (float)best.noise_nV;
+            }
+            if (take) {
+                best.rate_sps = rate;
+                best.op_mode = turbo ? ADS1220_OP_TURBO : ADS1220_OP_NORMAL;
+                best.mains_reject = mains;
+                best.per_window = per_window > 0xFFFFu ? 0xFFFFu : (uint16_t)per_window;
+                best.noise_nV = (uint32_t)(noise + 0.5f);
+                best_meets = meets;
+                have = true;
+            }
+        }
+    }
+    *out = best;
+}
+
+static int64_t code_to_uV(int32_t raw)
+{
+    int64_t gain = g_cfg.gain;
+    if (gain <= 0) {
+        gain = 1;
+    }
+    int64_t microvolts = (int64_t)raw * ADS1220_VREF_UV;
+    return microvolts / (gain * ADS1220_FULL_SCALE);
+}
+
+static int32_t apply_average(int64_t microvolts)
+{
+    if (g_cfg.average_window > 1) {
+        if (g_filtered_uV == 0) {
+            g_filtered_uV = (int32_t)microvolts;
+        } else {
+            g_filtered_uV += (int32_t)((microvolts - g_filtered_uV) / (int32_t)g_cfg.average_window);
+        }
+        return g_filtered_uV;
+    }
+    return (int32_t)microvolts;
 }
 
 static bool ads1220_is_data_ready(void)
@@ -205,32 +327,59 @@ bool ads1220_read_uV(int32_t *value_uV, uint32_t timeout_ms, uint8_t *flags)
     }
 
     int32_t raw = read_raw_code();
-    int64_t gain = g_cfg.gain;
-    if (gain <= 0) {
-        gain = 1;
-    }
-    int64_t microvolts = (int64_t)raw * ADS1220_VREF_UV;
-    microvolts /= (gain * ADS1220_FULL_SCALE);
-
     if (flags != NULL) {
         if (raw >= 0x7FFFF0 || raw <= -0x7FFFF0) {
             *flags |= TERPS_FLAG_ADC_SATURATED;
         }
     }
+    *value_uV = apply_average(code_to_uV(raw));
+    return true;
+}
 
-    if (g_cfg.average_window > 1) {
-        if (g_filtered_uV == 0) {
-            g_filtered_uV = (int32_t)microvolts;
-        } else {
-            g_filtered_uV += (int32_t)((microvolts - g_filtered_uV) / (int32_t)g_cfg.average_window);
-        }
-        *value_uV = g_filtered_uV;
-    } else {
-        *value_uV = (int32_t)microvolts;
+bool ads1220_poll(void)
+{
+    if (!g_initialized || !ads1220_is_data_ready()) {
+        return false;
+    }
+    int32_t raw = read_raw_code();
+    if (raw >= 0x7FFFF0 || raw <= -0x7FFFF0) {
+        g_acc_saturated = true;
     }
+    g_acc_sum_uV += code_to_uV(raw);
+    g_acc_count++;
+    g_last_conversion_us = time_us_64();
     return true;
 }
 
+uint16_t ads1220_read_window(int32_t *value_uV, uint32_t stale_ms, uint8_t *flags)
+{
+    if (flags != NULL) {
+        *flags &= ~(TERPS_FLAG_ADC_TIMEOUT | TERPS_FLAG_ADC_SATURATED);
+    }
+    if (!g_initialized || value_uV == NULL) {
+        return 0;
+    }
+    ads1220_poll();
+    const uint32_t count = g_acc_count;
+    if (count == 0) {
+        // Nothing new this window: the caller keeps its last value. Only flag a
+        // timeout once the converter has been silent for longer than stale_ms.
+        const uint64_t silent_us = time_us_64() - g_last_conversion_us;
+        if (flags != NULL && silent_us > (uint64_t)(stale_ms > 0 ? stale_ms : 200) * 1000u) {
+            *flags |= TERPS_FLAG_ADC_TIMEOUT;
+        }
+        return 0;
+    }
+    if (flags != NULL && g_acc_saturated) {
+        *flags |= TERPS_FLAG_ADC_SATURATED;
+    }
+    *value_uV = apply_average(g_acc_sum_uV / (int64_t)count);
+    g_acc_sum_uV = 0;
+    g_acc_count = 0;
+    g_acc_saturated = false;
+    return count > 0xFFFFu ? 0xFFFFu : (uint16_t)count;
+}
+
 void ads1220_sleep(void)
 {
     if (!g_initialized) {
@@ -8,6 +8,8 @@ const terps_firmware_config_t terps_default_config = {
     .adc_gain = 16,
     .adc_rate_sps = 20,
     .adc_mains_reject = true,
+    .adc_auto_rate = true,
+    .adc_noise_target_nV = 0,
     .avg_window = 8,
     .binary_frames = false,
     .queue_length = 8,
@@ -23,4 +25,28 @@ const terps_firmware_config_t terps_default_config = {
     .debug_deglitch_stats = false,
     .unio_gpio = 6,
     .unio_bitrate_bps = 40000,
+    .unio_extra_gpio_mask = 0,
+    .settle_window = 20,
+    .settle_hold = 5,
+    .settle_f_slope_hz_s = 0.002f,
+    .settle_f_noise_hz = 0.002f,
+    .settle_v_slope_uV_s = 5.0f,
+    .settle_v_noise_uV = 5.0f,
+    .out_source = TERPS_OUT_OFF,
+    .out_pwm_gpio = TERPS_GPIO_UNUSED,
+    .out_pwm_bits = 12,
+    .out_dac = TERPS_OUT_DAC_NONE,
+    .out_dac_cs_gpio = TERPS_GPIO_UNUSED,
+    .out_in_lo = 0.0f,
+    .out_in_hi = 1.0f,
+    .out_min = 0.0f,
+    .out_max = 1.0f,
+    .out_fault_level = -1.0f,
+    .uart_tx_gpio = TERPS_GPIO_UNUSED,
+    .uart_baud = 921600,
+    .uart_de_gpio = TERPS_GPIO_UNUSED,
+    .uart_de_lead_us = 5,
+    .uart_de_tail_us = 5,
+    .ref_clk_gpio = TERPS_GPIO_UNUSED,
+    .ref_clk_hz = 10000000,
 };
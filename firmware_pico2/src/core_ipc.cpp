@@ -0,0 +1,227 @@
+#include "core_ipc.h"
+
+#include <string.h>
+
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+
+#ifdef SIO_IRQ_FIFO
+// RP2350: one banked FIFO IRQ, each core sees its own.
+#define IPC_FIFO_IRQ(core) SIO_IRQ_FIFO
+#else
+#define IPC_FIFO_IRQ(core) ((core) ? SIO_IRQ_PROC1 : SIO_IRQ_PROC0)
+#endif
+
+#define IPC_TOKEN(channel, index) (((uint32_t)(channel) << 16) | ((index) & 0xFFFFu))
+#define IPC_TOKEN_CHANNEL(token) ((uint8_t)((token) >> 16))
+
+static volatile ipc_mode_t g_mode = IPC_MODE_DOORBELL;
+// Channels with an unserviced doorbell, per consumer core. Written by that
+// core's FIFO IRQ and cleared by the same core's thread code.
+static volatile uint32_t g_pending[2];
+static uint32_t g_consumed[2];  // channels each core consumes
+static volatile uint32_t g_sleeps[2];
+
+static void __not_in_flash_func(ipc_fifo_irq)(void)
+{
+    const uint core = get_core_num();
+    uint32_t pending = 0;
+    while (multicore_fifo_rvalid()) {
+        const uint32_t token = multicore_fifo_pop_blocking();
+        const uint8_t channel = IPC_TOKEN_CHANNEL(token);
+        if (channel < IPC_MAX_CHANNELS) {
+            pending |= 1u << channel;
+        }
+    }
+    pending &= g_consumed[core];
+    // Clears ROE/WOF; the IRQ itself deasserts once the FIFO is empty.
+    multicore_fifo_clear_irq();
+    g_pending[core] |= pending;
+}
+
+void ipc_core_init(void)
+{
+    const uint core = get_core_num();
+    multicore_fifo_drain();
+    multicore_fifo_clear_irq();
+    // Start with every channel pending: anything published before this core
+    // installed its handler is picked up by the first drain.
+    g_pending[core] = g_consumed[core];
+    irq_set_exclusive_handler(IPC_FIFO_IRQ(core), ipc_fifo_irq);
+    irq_set_enabled(IPC_FIFO_IRQ(core), true);
+}
+
+bool ipc_ring_init(ipc_ring_t *ring,
+                   void *storage,
+                   uint32_t *stamps,
+                   uint16_t slot_size,
+                   uint16_t capacity,
+                   uint8_t channel,
+                   uint8_t consumer_core)
+{
+    if (ring == NULL || storage == NULL || stamps == NULL || slot_size == 0 || capacity < 2 ||
+        channel >= IPC_MAX_CHANNELS || consumer_core > 1) {
+        return false;
+    }
+    uint16_t pow2 = 1;
+    while ((uint32_t)pow2 * 2u <= capacity) {
+        pow2 = (uint16_t)(pow2 * 2u);
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->slots = (uint8_t *)storage;
+    ring->stamps = stamps;
+    ring->slot_size = slot_size;
+    ring->mask = (uint16_t)(pow2 - 1u);
+    ring->channel = channel;
+    ring->consumer_core = consumer_core;
+    ring->stats.lat_min_us = UINT32_MAX;
+    g_consumed[consumer_core] |= 1u << channel;
+    return true;
+}
+
+static void ring_doorbell(ipc_ring_t *ring, uint32_t head)
+{
+    if (get_core_num() == ring->consumer_core) {
+        // Produced from an IRQ on the consumer's own core: it is already awake
+        // once the handler returns, so a local flag is enough.
+        g_pending[ring->consumer_core] |= 1u << ring->channel;
+        return;
+    }
+    if (!multicore_fifo_wready()) {
+        // The consumer has doorbells queued and drains the whole ring on each.
+        ring->stats.fifo_full++;
+        return;
+    }
+    multicore_fifo_push_blocking(IPC_TOKEN(ring->channel, head));
+    ring->stats.doorbells++;
+}
+
+bool __not_in_flash_func(ipc_ring_push)(ipc_ring_t *ring, const void *item)
+{
+    const uint32_t head = ring->head;
+    const uint32_t tail = ring->tail;
+    if (head - tail > ring->mask) {
+        ring->stats.dropped++;
+        return false;
+    }
+    const uint32_t slot = head & ring->mask;
+    memcpy(ring->slots + (size_t)slot * ring->slot_size, item, ring->slot_size);
+    ring->stamps[slot] = time_us_32();
+    __dmb();
+    ring->head = head + 1u;
+    ring->stats.pushed++;
+    if (g_mode == IPC_MODE_POLL) {
+        return true;
+    }
+    // Publish head before re-reading tail; the consumer does the mirror image
+    // (tail, barrier, head), so either it sees this item or we see it idle.
+    __dmb();
+    if (ring->tail == head) {
+        ring_doorbell(ring, head);
+    } else {
+        ring->stats.coalesced++;
+    }
+    __sev();
+    return true;
+}
+
+bool ipc_ring_ready(ipc_ring_t *ring)
+{
+    if (ring->draining || g_mode == IPC_MODE_POLL) {
+        if (!ring->draining) {
+            ring->stats.wakeups++;
+        }
+        return true;
+    }
+    const uint32_t bit = 1u << ring->channel;
+    if ((g_pending[ring->consumer_core] & bit) == 0) {
+        return false;
+    }
+    const uint32_t irq_state = save_and_disable_interrupts();
+    g_pending[ring->consumer_core] &= ~bit;
+    restore_interrupts(irq_state);
+    ring->stats.wakeups++;
+    return true;
+}
+
+bool __not_in_flash_func(ipc_ring_pop)(ipc_ring_t *ring, void *item)
+{
+    const uint32_t tail = ring->tail;
+    if (ring->head == tail) {
+        if (!ring->draining) {
+            ring->stats.empty_checks++;
+        }
+        ring->draining = false;
+        return false;
+    }
+    __dmb();
+    const uint32_t slot = tail & ring->mask;
+    memcpy(item, ring->slots + (size_t)slot * ring->slot_size, ring->slot_size);
+    const uint32_t latency = time_us_32() - ring->stamps[slot];
+    __dmb();
+    ring->tail = tail + 1u;
+    __dmb();
+    ring->draining = true;
+
+    ipc_ring_stats_t *stats = &ring->stats;
+    stats->popped++;
+    stats->lat_sum_us += latency;
+    if (latency < stats->lat_min_us) {
+        stats->lat_min_us = latency;
+    }
+    if (latency > stats->lat_max_us) {
+        stats->lat_max_us = latency;
+    }
+    return true;
+}
+
+void ipc_wait(uint32_t timeout_us)
+{
+    const uint core = get_core_num();
+    if (g_mode == IPC_MODE_POLL || g_pending[core] != 0) {
+        return;
+    }
+    g_sleeps[core]++;
+    if (timeout_us == 0) {
+        // Any doorbell (SEV from the producer) or local interrupt ends the wait.
+        __wfe();
+    } else {
+        best_effort_wfe_or_timeout(make_timeout_time_us(timeout_us));
+    }
+}
+
+void ipc_set_mode(ipc_mode_t mode)
+{
+    g_mode = mode;
+    // Wake both cores so a sleeping consumer picks up the new mode.
+    __sev();
+}
+
+ipc_mode_t ipc_get_mode(void)
+{
+    return g_mode;
+}
+
+void ipc_ring_stats(const ipc_ring_t *ring, ipc_ring_stats_t *out)
+{
+    if (ring == NULL || out == NULL) {
+        return;
+    }
+    // Counters are written by one core each; a torn snapshot is off by one event at most.
+    memcpy(out, (const void *)&ring->stats, sizeof(*out));
+}
+
+void ipc_ring_reset_stats(ipc_ring_t *ring)
+{
+    memset(&ring->stats, 0, sizeof(ring->stats));
+    ring->stats.lat_min_us = UINT32_MAX;
+    g_sleeps[0] = 0;
+    g_sleeps[1] = 0;
+}
+
+uint32_t ipc_sleeps(uint8_t core)
+{
+    return core < 2 ? g_sleeps[core] : 0;
+}
@@ -0,0 +1,271 @@
+#include "ctrl_out.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+#define CTRL_OUT_PWM_BITS_MIN 8u
+#define CTRL_OUT_PWM_BITS_MAX 15u
+#define MCP4921_CTRL 0x3000u  // DAC A, unbuffered, 1x gain, active
+
+static ctrl_out_hw_t g_hw;
+static ctrl_out_scale_t g_scale;
+static ctrl_out_poly_t g_poly;
+static ctrl_out_stats_t g_stats;
+static critical_section_t g_lock;
+static uint16_t g_pwm_top;
+static bool g_have_level = false;
+
+static float clampf(float v, float lo, float hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static bool has_pwm(void)
+{
+    return g_hw.pwm_gpio != TERPS_GPIO_UNUSED;
+}
+
+static bool has_dac(void)
+{
+    return g_hw.dac != TERPS_OUT_DAC_NONE && g_hw.dac_cs_gpio != TERPS_GPIO_UNUSED && g_hw.spi != NULL;
+}
+
+// Horner in both variables; double keeps (f-X)^5 terms on a 30 kHz carrier exact
+// enough, and the RP2350 double coprocessor makes a full 8x8 surface a few µs.
+static double eval_poly(const ctrl_out_poly_t *poly, double f_hz, double v_uV)
+{
+    const double x = f_hz - poly->x;
+    const double y = v_uV - poly->y;
+    double sum = 0.0;
+    for (int i = (int)poly->rows - 1; i >= 0; --i) {
+        double row = 0.0;
+        for (int j = (int)poly->cols - 1; j >= 0; --j) {
+            row = row * y + poly->k[i][j];
+        }
+        sum = sum * x + row;
+    }
+    return sum;
+}
+
+static uint16_t dac_full_scale(void)
+{
+    return g_hw.dac == TERPS_OUT_DAC_DAC8551 ? 0xFFFFu : 0x0FFFu;
+}
+
+static void write_dac(uint16_t code)
+{
+    gpio_put(g_hw.dac_cs_gpio, 0);
+    if (g_hw.dac == TERPS_OUT_DAC_DAC8551) {
+        // DAC8551 shifts on the falling edge (mode 1); the ADS1220 driver runs mode 0.
+        const uint8_t word[3] = {0x00u, (uint8_t)(code >> 8), (uint8_t)code};
+        spi_set_format(g_hw.spi, 8, SPI_CPOL_0, SPI_CPHA_1, SPI_MSB_FIRST);
+        spi_write_blocking(g_hw.spi, word, sizeof(word));
+        spi_set_format(g_hw.spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    } else {
+        const uint16_t value = (uint16_t)(MCP4921_CTRL | (code & 0x0FFFu));
+        const uint8_t word[2] = {(uint8_t)(value >> 8), (uint8_t)value};
+        spi_write_blocking(g_hw.spi, word, sizeof(word));
+    }
+    gpio_put(g_hw.dac_cs_gpio, 1);
+}
+
+// Writes both sinks; the caller holds no lock (the DAC write takes ~20 µs).
+static void apply_level(float level, uint16_t *pwm_code, uint16_t *dac_code)
+{
+    *pwm_code = 0;
+    *dac_code = 0;
+    if (has_pwm()) {
+        // Level top+1 is 100 % duty.
+        *pwm_code = (uint16_t)lroundf(level * (float)(g_pwm_top + 1u));
+        pwm_set_gpio_level(g_hw.pwm_gpio, *pwm_code);
+    }
+    if (has_dac()) {
+        *dac_code = (uint16_t)lroundf(level * (float)dac_full_scale());
+        write_dac(*dac_code);
+    }
+}
+
+static float idle_level(const ctrl_out_scale_t *scale)
+{
+    return scale->fault_level >= 0.0f ? clampf(scale->fault_level, 0.0f, 1.0f) : scale->out_min;
+}
+
+void ctrl_out_init(const ctrl_out_hw_t *hw, const ctrl_out_scale_t *scale)
+{
+    g_hw = *hw;
+    g_scale = *scale;
+    memset(&g_poly, 0, sizeof(g_poly));
+    memset(&g_stats, 0, sizeof(g_stats));
+    critical_section_init(&g_lock);
+    g_have_level = false;
+
+    if (has_pwm()) {
+        uint8_t bits = g_hw.pwm_bits;
+        if (bits < CTRL_OUT_PWM_BITS_MIN) {
+            bits = CTRL_OUT_PWM_BITS_MIN;
+        } else if (bits > CTRL_OUT_PWM_BITS_MAX) {
+            bits = CTRL_OUT_PWM_BITS_MAX;
+        }
+        g_hw.pwm_bits = bits;
+        g_pwm_top = (uint16_t)((1u << bits) - 1u);
+        gpio_set_function(g_hw.pwm_gpio, GPIO_FUNC_PWM);
+        pwm_config cfg = pwm_get_default_config();
+        pwm_config_set_clkdiv(&cfg, 1.0f);
+        pwm_config_set_wrap(&cfg, g_pwm_top);
+        pwm_init(pwm_gpio_to_slice_num(g_hw.pwm_gpio), &cfg, true);
+    }
+    if (has_dac()) {
+        gpio_init(g_hw.dac_cs_gpio);
+        gpio_set_dir(g_hw.dac_cs_gpio, GPIO_OUT);
+        gpio_put(g_hw.dac_cs_gpio, 1);
+    }
+    const float level = idle_level(&g_scale);
+    apply_level(level, &g_stats.pwm_code, &g_stats.dac_code);
+    g_stats.level = level;
+}
+
+void ctrl_out_set_scale(const ctrl_out_scale_t *scale)
+{
+    critical_section_enter_blocking(&g_lock);
+    g_scale = *scale;
+    critical_section_exit(&g_lock);
+}
+
+void ctrl_out_get_scale(ctrl_out_scale_t *scale)
+{
+    critical_section_enter_blocking(&g_lock);
+    *scale = g_scale;
+    critical_section_exit(&g_lock);
+}
+
+bool ctrl_out_set_poly(const ctrl_out_poly_t *poly)
+{
+    if (poly->rows == 0 || poly->cols == 0 || poly->rows > CTRL_OUT_POLY_MAX || poly->cols > CTRL_OUT_POLY_MAX) {
+        return false;
+    }
+    critical_section_enter_blocking(&g_lock);
+    g_poly = *poly;
+    critical_section_exit(&g_lock);
+    return true;
+}
+
+uint8_t ctrl_out_poly_shape(uint8_t *cols)
+{
+    critical_section_enter_blocking(&g_lock);
+    const uint8_t rows = g_poly.rows;
+    if (cols != NULL) {
+        *cols = g_poly.cols;
+    }
+    critical_section_exit(&g_lock);
+    return rows;
+}
+
+void ctrl_out_update(float f_hz, int32_t diode_uV, bool f_valid, bool v_valid, uint64_t end_us)
+{
+    if (!has_pwm() && !has_dac()) {
+        return;
+    }
+    critical_section_enter_blocking(&g_lock);
+    const ctrl_out_scale_t scale = g_scale;
+    bool valid = false;
+    float value = 0.0f;
+    switch (scale.source) {
+        case TERPS_OUT_FREQ:
+            valid = f_valid;
+            value = f_hz;
+            break;
+        case TERPS_OUT_PRESSURE:
+            valid = f_valid && v_valid && g_poly.rows > 0;
+            if (valid) {
+                value = (float)eval_poly(&g_poly, (double)f_hz, (double)diode_uV);
+            }
+            break;
+        case TERPS_OUT_OFF:
+        default:
+            break;
+    }
+    critical_section_exit(&g_lock);
+    if (scale.source == TERPS_OUT_OFF) {
+        return;
+    }
+
+    float level;
+    bool clamped = false;
+    if (valid && scale.in_hi != scale.in_lo) {
+        const float frac = (value - scale.in_lo) / (scale.in_hi - scale.in_lo);
+        const float raw = scale.out_min + frac * (scale.out_max - scale.out_min);
+        level = clampf(raw, scale.out_min, scale.out_max);
+        clamped = level != raw;
+    } else if (scale.fault_level >= 0.0f || !g_have_level) {
+        valid = false;
+        level = idle_level(&scale);
+    } else {
+        // Hold: nothing to write, only count the window.
+        critical_section_enter_blocking(&g_lock);
+        g_stats.faults++;
+        critical_section_exit(&g_lock);
+        return;
+    }
+
+    uint16_t pwm_code;
+    uint16_t dac_code;
+    apply_level(level, &pwm_code, &dac_code);
+    const uint32_t latency_us = (uint32_t)(time_us_64() - end_us);
+    if (valid) {
+        g_have_level = true;
+    }
+
+    critical_section_enter_blocking(&g_lock);
+    if (valid) {
+        g_stats.updates++;
+        g_stats.value = value;
+        g_stats.last_us = latency_us;
+        g_stats.sum_us += latency_us;
+        if (latency_us > g_stats.max_us) {
+            g_stats.max_us = latency_us;
+        }
+        if (clamped) {
+            g_stats.clamped++;
+        }
+    } else {
+        g_stats.faults++;
+    }
+    g_stats.level = level;
+    g_stats.pwm_code = pwm_code;
+    g_stats.dac_code = dac_code;
+    critical_section_exit(&g_lock);
+}
+
+void ctrl_out_get_stats(ctrl_out_stats_t *stats)
+{
+    critical_section_enter_blocking(&g_lock);
+    *stats = g_stats;
+    critical_section_exit(&g_lock);
+}
+
+void ctrl_out_reset_stats(void)
+{
+    critical_section_enter_blocking(&g_lock);
+    g_stats.updates = 0;
+    g_stats.faults = 0;
+    g_stats.clamped = 0;
+    g_stats.last_us = 0;
+    g_stats.max_us = 0;
+    g_stats.sum_us = 0;
+    critical_section_exit(&g_lock);
+}
+
+uint32_t ctrl_out_pwm_period_ns(void)
+{
+    if (!has_pwm()) {
+        return 0;
+    }
+    const uint32_t sys_hz = clock_get_hz(clk_sys);
+    return sys_hz ? (uint32_t)(((uint64_t)(g_pwm_top + 1u) * 1000000000ull) / sys_hz) : 0u;
+}
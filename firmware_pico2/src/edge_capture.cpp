@@ -0,0 +1,159 @@
+#include "edge_capture.h"
+
+#include <string.h>
+
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+// Raw edge capture stored as period residuals against the previous period.
+// The stream is a sequence of nibbles (high nibble first in each byte):
+//   r in [-7, 7]          -> 1 nibble, two's complement
+//   r in [-127, 127]      -> escape nibble 0x8, then r as 8 bits
+//   r in [-32767, 32767]  -> 0x8, 0x80, then r as 16 bits
+//   otherwise             -> 0x8, 0x80, 0x8000, then the absolute period (32 bits)
+// Multi-nibble fields are MSB first. Decoding needs first_us from the status
+// block; the predictor starts at zero so the first period normally escapes to
+// the absolute form. Pushes run in the edge IRQ on core0, so the command-side
+// accessors only need to mask local interrupts.
+#define ESC4 0x8u
+#define ESC8 0x80u
+#define ESC16 0x8000u
+
+static uint8_t g_buffer[EDGE_CAPTURE_BYTES];
+static edge_capture_status_t g_status;
+static uint32_t g_nibbles;
+static uint64_t g_last_us;
+static uint32_t g_pred_period;
+
+static inline bool has_room(uint32_t nibbles)
+{
+    return g_nibbles + nibbles <= EDGE_CAPTURE_BYTES * 2u;
+}
+
+static inline void put_nibble(uint32_t value)
+{
+    uint8_t *byte = &g_buffer[g_nibbles >> 1];
+    if ((g_nibbles & 1u) == 0) {
+        *byte = (uint8_t)((value & 0x0Fu) << 4);
+    } else {
+        *byte |= (uint8_t)(value & 0x0Fu);
+    }
+    g_nibbles++;
+}
+
+static inline void put_bits(uint32_t value, uint32_t nibbles)
+{
+    while (nibbles-- > 0) {
+        put_nibble(value >> (nibbles * 4u));
+    }
+}
+
+void edge_capture_init(void)
+{
+    memset(&g_status, 0, sizeof(g_status));
+    g_nibbles = 0;
+    g_last_us = 0;
+    g_pred_period = 0;
+}
+
+void edge_capture_start(uint32_t max_edges)
+{
+    uint32_t irq_state = save_and_disable_interrupts();
+    edge_capture_init();
+    g_status.max_edges = max_edges;
+    g_status.armed = true;
+    restore_interrupts(irq_state);
+}
+
+void edge_capture_stop(void)
+{
+    uint32_t irq_state = save_and_disable_interrupts();
+    g_status.armed = false;
+    restore_interrupts(irq_state);
+}
+
+void __not_in_flash_func(edge_capture_push)(uint64_t timestamp_us)
+{
+    if (!g_status.armed) {
+        return;
+    }
+    if (g_status.edges == 0) {
+        g_status.first_us = timestamp_us;
+        g_last_us = timestamp_us;
+        g_status.edges = 1;
+        return;
+    }
+
+    const uint32_t period = (uint32_t)(timestamp_us - g_last_us);
+    const int32_t residual = (int32_t)(period - g_pred_period);
+    uint32_t nibbles;
+    if (residual >= -7 && residual <= 7) {
+        nibbles = 1;
+    } else if (residual >= -127 && residual <= 127) {
+        nibbles = 3;
+    } else if (residual >= -32767 && residual <= 32767) {
+        nibbles = 7;
+    } else {
+        nibbles = 15;
+    }
+    if (!has_room(nibbles)) {
+        g_status.overflow++;
+        g_status.armed = false;
+        return;
+    }
+
+    switch (nibbles) {
+        case 1:
+            put_nibble((uint32_t)residual);
+            g_status.tokens4++;
+            break;
+        case 3:
+            put_nibble(ESC4);
+            put_bits((uint32_t)residual & 0xFFu, 2);
+            g_status.tokens8++;
+            break;
+        case 7:
+            put_nibble(ESC4);
+            put_bits(ESC8, 2);
+            put_bits((uint32_t)residual & 0xFFFFu, 4);
+            g_status.tokens16++;
+            break;
+        default:
+            put_nibble(ESC4);
+            put_bits(ESC8, 2);
+            put_bits(ESC16, 4);
+            put_bits(period, 8);
+            g_status.tokens32++;
+            break;
+    }
+
+    g_last_us = timestamp_us;
+    g_pred_period = period;
+    g_status.edges++;
+    g_status.bytes_used = (g_nibbles + 1u) >> 1;
+    if (g_status.max_edges != 0 && g_status.edges >= g_status.max_edges) {
+        g_status.armed = false;
+    }
+}
+
+void edge_capture_status(edge_capture_status_t *out)
+{
+    if (out != NULL) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        *out = g_status;
+        restore_interrupts(irq_state);
+    }
+}
+
+size_t edge_capture_read(uint32_t offset, uint8_t *dst, size_t len)
+{
+    if (dst == NULL || offset >= g_status.bytes_used) {
+        return 0;
+    }
+    size_t available = g_status.bytes_used - offset;
+    if (len > available) {
+        len = available;
+    }
+    memcpy(dst, &g_buffer[offset], len);
+    return len;
+}
@@ -4,21 +4,26 @@
 #include <string.h>
 
 #include "config_default.h"
+#include "edge_capture.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
 #include "hardware/timer.h"
 #include "pico/multicore.h"
 #include "pico/stdlib.h"
 #include "pps_cal.h"
+#include "ref_clock.h"
 
 #define MIN_RECIP_EDGES 64
 #define MAX_QUEUE_DEPTH 32
 #define DEFAULT_FREQ_ESTIMATE 30000.0f
 #define MAX_FREQ_LIMIT 1000000.0f
 #define MIN_FREQ_LIMIT 1.0f
+#define MIN_SCHED_PERIOD_US 1000u
 
 static terps_firmware_config_t g_config;
-static queue_t g_result_queue;
+static ipc_ring_t g_result_ring;
+static freq_result_t g_result_slots[MAX_QUEUE_DEPTH];
+static uint32_t g_result_stamps[MAX_QUEUE_DEPTH];
 static critical_section_t g_lock;
 
 typedef struct {
@@ -38,10 +43,36 @@ typedef struct {
     uint64_t start_us;
     uint64_t end_us;
     uint64_t last_edge_us;
+    // TERPS_MODE_DUAL: same-polarity spans, so comparator duty asymmetry cancels.
+    uint32_t rise_edges;
+    uint32_t fall_edges;
+    uint64_t first_rise_us;
+    uint64_t last_rise_us;
+    uint64_t first_fall_us;
+    uint64_t last_fall_us;
+    uint64_t high_sum_us;
+    uint32_t high_count;
+    bool fall_irq_enabled;
+    // TERPS_MODE_REF: extended reference count at the first and last counted edge.
+    uint64_t ref_first;
+    uint64_t ref_last;
     alarm_id_t gate_alarm;
+    // Time-triggered windows (freq_counter_schedule).
+    bool sched_active;
+    terps_mode_t sched_mode;
+    uint64_t sched_next_us;
+    uint32_t sched_period_us;
+    uint16_t sched_period_frac;
+    uint16_t sched_frac_acc;
+    uint32_t sched_next_slot;
+    uint32_t window_slot;
+    uint32_t sched_late_max_us;
+    uint32_t sched_windows;
+    alarm_id_t sched_alarm;
 } freq_state_t;
 
 static freq_state_t g_state;
+static freq_edge_stats_t g_edge_stats;
 
 static inline float clamp_freq(float value)
 {
@@ -69,6 +100,18 @@ static void update_min_interval_locked(void)
     g_state.min_interval_us = min_interval;
 }
 
+static void reset_dual_locked(void)
+{
+    g_state.rise_edges = 0;
+    g_state.fall_edges = 0;
+    g_state.first_rise_us = 0;
+    g_state.last_rise_us = 0;
+    g_state.first_fall_us = 0;
+    g_state.last_fall_us = 0;
+    g_state.high_sum_us = 0;
+    g_state.high_count = 0;
+}
+
 static void reset_state_locked(void)
 {
     g_state.active = false;
@@ -81,12 +124,44 @@ static void reset_state_locked(void)
     g_state.start_us = 0;
     g_state.end_us = 0;
     g_state.last_edge_us = 0;
+    g_state.ref_first = 0;
+    g_state.ref_last = 0;
+    reset_dual_locked();
     if (g_state.gate_alarm >= 0) {
         cancel_alarm(g_state.gate_alarm);
         g_state.gate_alarm = -1;
     }
 }
 
+static bool dual_frequency_locked(float *freq_hz, uint16_t *duty_x1e4)
+{
+    const uint32_t rise_periods = g_state.rise_edges > 1 ? g_state.rise_edges - 1 : 0;
+    const uint32_t fall_periods = g_state.fall_edges > 1 ? g_state.fall_edges - 1 : 0;
+    const uint64_t rise_span = rise_periods ? g_state.last_rise_us - g_state.first_rise_us : 0;
+    const uint64_t fall_span = fall_periods ? g_state.last_fall_us - g_state.first_fall_us : 0;
+    if (rise_span + fall_span == 0) {
+        return false;
+    }
+    *freq_hz = ((float)(rise_periods + fall_periods) * 1e6f) / (float)(rise_span + fall_span);
+    float duty = 0.0f;
+    if (g_state.high_count) {
+        duty = ((float)g_state.high_sum_us / (float)g_state.high_count) * *freq_hz * 1e-6f;
+    }
+    if (duty > 1.0f) {
+        duty = 1.0f;
+    }
+    *duty_x1e4 = (uint16_t)(duty * 1e4f + 0.5f);
+
+    g_edge_stats.mode = TERPS_MODE_DUAL;
+    g_edge_stats.rise_edges = g_state.rise_edges;
+    g_edge_stats.fall_edges = g_state.fall_edges;
+    g_edge_stats.f_rise_hz = rise_span ? ((float)rise_periods * 1e6f) / (float)rise_span : 0.0f;
+    g_edge_stats.f_fall_hz = fall_span ? ((float)fall_periods * 1e6f) / (float)fall_span : 0.0f;
+    g_edge_stats.duty_x1e4 = *duty_x1e4;
+    g_edge_stats.glitch_count = g_state.glitch_count;
+    return true;
+}
+
 static void enqueue_result_locked(bool timeout_flag)
 {
     if (!g_state.window_open) {
@@ -109,7 +184,27 @@ static void enqueue_result_locked(bool timeout_flag)
     }
 
     float freq_hz = ((float)pulses * 1e6f) / (float)elapsed_us;
-    freq_hz *= (1.0f + g_state.timebase_ppm * 1e-6f);
+    uint16_t duty_x1e4 = 0;
+    int32_t f_hz_x1e4;
+    uint64_t ref_cycles = 0;
+    if (g_state.mode == TERPS_MODE_REF) {
+        // Whole periods between the first and last edge over the reference
+        // cycles between them: no Pico timebase involved, so no ppm trim.
+        ref_cycles = g_state.ref_last - g_state.ref_first;
+        if (pulses < 2 || ref_cycles == 0) {
+            reset_state_locked();
+            return;
+        }
+        f_hz_x1e4 = ref_clock_ratio_x1e4(pulses - 1u, ref_cycles, ref_clock_hz());
+        freq_hz = (float)f_hz_x1e4 * 1e-4f;
+    } else {
+        if (g_state.mode == TERPS_MODE_DUAL && !dual_frequency_locked(&freq_hz, &duty_x1e4)) {
+            reset_state_locked();
+            return;
+        }
+        freq_hz *= (1.0f + g_state.timebase_ppm * 1e-6f);
+        f_hz_x1e4 = (int32_t)llroundf(freq_hz * 1e4f);
+    }
     g_state.freq_estimate_hz = freq_hz;
     update_min_interval_locked();
 
@@ -121,18 +216,18 @@ static void enqueue_result_locked(bool timeout_flag)
         .tau_ms = (uint32_t)((float)elapsed_us / 1000.0f + 0.5f),
         .start_us = start_us,
         .end_us = end_us,
-        .f_hz_x1e4 = (int32_t)llroundf(freq_hz * 1e4f),
+        .f_hz_x1e4 = f_hz_x1e4,
         .f_hz = freq_hz,
         .glitch_count = g_state.glitch_count,
+        .duty_x1e4 = duty_x1e4,
+        .slot = g_state.sched_active ? g_state.window_slot : FREQ_SLOT_NONE,
         .sync_active = g_state.sync_forced,
         .timeout = timeout_flag,
+        .ref_cycles = ref_cycles,
     };
 
-    if (!queue_try_add(&g_result_queue, &result)) {
-        freq_result_t dropped;
-        queue_try_remove(&g_result_queue, &dropped);
-        queue_try_add(&g_result_queue, &result);
-    }
+    // Producers are serialised by g_lock, so the ring sees a single producer.
+    ipc_ring_push(&g_result_ring, &result);
     reset_state_locked();
 }
 
@@ -162,20 +257,36 @@ static int64_t gate_alarm_cb(alarm_id_t id, void *user_data)
 
 static void start_window_locked(terps_mode_t mode, uint32_t tau_ms)
 {
+    if (mode == TERPS_MODE_REF && !ref_clock_enabled()) {
+        mode = TERPS_MODE_RECIP;
+    }
     g_state.mode = mode;
     g_state.tau_ms = tau_ms;
     g_state.pulses = 0;
     g_state.raw_edges = 0;
     g_state.glitch_count = 0;
     g_state.last_edge_us = 0;
+    g_state.ref_first = 0;
+    g_state.ref_last = 0;
+    reset_dual_locked();
     g_state.sync_forced = false;
     g_state.active = true;
     g_state.window_open = (mode == TERPS_MODE_GATED);
     g_state.start_us = g_state.window_open ? time_us_64() : 0;
     g_state.end_us = g_state.start_us;
 
-    if (mode == TERPS_MODE_RECIP) {
+    // Falling-edge IRQs are switched on core0 (freq_counter_set_edge_irqs);
+    // this runs on core1 after boot, whose enables would not reach gpio_callback.
+    const bool dual = (mode == TERPS_MODE_DUAL);
+    if (g_state.sched_active) {
+        return;  // slot_alarm_cb closes the window on the next grid point
+    }
+
+    if (mode == TERPS_MODE_RECIP || mode == TERPS_MODE_REF || dual) {
         compute_target_edges_locked(tau_ms);
+        if (dual) {
+            g_state.target_edges *= 2u;
+        }
     } else {
         if (g_state.gate_alarm >= 0) {
             cancel_alarm(g_state.gate_alarm);
@@ -184,8 +295,9 @@ static void start_window_locked(terps_mode_t mode, uint32_t tau_ms)
     }
 }
 
-static void handle_edge_locked(uint64_t timestamp_us)
+static void handle_edge_locked(uint64_t timestamp_us, uint16_t ref_raw)
 {
+    edge_capture_push(timestamp_us);
     if (!g_state.active) {
         return;
     }
@@ -205,15 +317,111 @@ static void handle_edge_locked(uint64_t timestamp_us)
         g_state.start_us = timestamp_us;
     }
     g_state.end_us = timestamp_us;
+    if (g_state.mode == TERPS_MODE_REF) {
+        g_state.ref_last = ref_clock_extend(ref_raw);
+        if (g_state.pulses == 0) {
+            g_state.ref_first = g_state.ref_last;
+        }
+    }
     g_state.pulses++;
 
-    if (g_state.mode == TERPS_MODE_RECIP && g_state.pulses >= g_state.target_edges) {
+    const bool recip = g_state.mode == TERPS_MODE_RECIP || g_state.mode == TERPS_MODE_REF;
+    if (recip && !g_state.sched_active && g_state.pulses >= g_state.target_edges) {
+        enqueue_result_locked(false);
+    }
+}
+
+static void handle_dual_edge_locked(uint64_t timestamp_us, bool rising)
+{
+    if (rising) {
+        edge_capture_push(timestamp_us);
+    }
+    if (!g_state.active) {
+        return;
+    }
+
+    g_state.raw_edges++;
+    // Deglitch against the previous edge of the same polarity (one full period).
+    const uint64_t last = rising ? g_state.last_rise_us : g_state.last_fall_us;
+    if (last != 0 && timestamp_us - last < g_state.min_interval_us) {
+        g_state.glitch_count++;
+        return;
+    }
+
+    if (rising) {
+        if (g_state.rise_edges++ == 0) {
+            g_state.first_rise_us = timestamp_us;
+        }
+        g_state.last_rise_us = timestamp_us;
+    } else {
+        if (g_state.fall_edges++ == 0) {
+            g_state.first_fall_us = timestamp_us;
+        }
+        // High time of the current period; a missed rise would stretch it past a period.
+        const uint64_t high_us = timestamp_us - g_state.last_rise_us;
+        if (g_state.last_rise_us != 0 && (float)high_us * g_state.freq_estimate_hz < 1e6f) {
+            g_state.high_sum_us += high_us;
+            g_state.high_count++;
+        }
+        g_state.last_fall_us = timestamp_us;
+    }
+
+    if (!g_state.window_open) {
+        g_state.window_open = true;
+        g_state.start_us = timestamp_us;
+    }
+    g_state.end_us = timestamp_us;
+    g_state.pulses++;
+
+    if (!g_state.sched_active && g_state.pulses >= g_state.target_edges) {
+        enqueue_result_locked(false);
+    }
+}
+
+static int64_t slot_alarm_cb(alarm_id_t id, void *user_data)
+{
+    (void)id;
+    (void)user_data;
+    const uint64_t now = time_us_64();
+    critical_section_enter_blocking(&g_lock);
+    if (!g_state.sched_active) {
+        critical_section_exit(&g_lock);
+        return 0;
+    }
+    const uint64_t boundary = g_state.sched_next_us;
+    const uint64_t late = now > boundary ? now - boundary : 0;
+    if (late > g_state.sched_late_max_us) {
+        g_state.sched_late_max_us = late > UINT32_MAX ? UINT32_MAX : (uint32_t)late;
+    }
+    if (g_state.active) {
+        if (g_state.mode == TERPS_MODE_GATED) {
+            g_state.end_us = boundary;
+        }
         enqueue_result_locked(false);
     }
+    // Windows are stamped with the grid point, not the (late) callback time.
+    start_window_locked(g_state.sched_mode, g_state.tau_ms);
+    if (g_state.window_open) {
+        g_state.start_us = boundary;
+        g_state.end_us = boundary;
+    }
+    g_state.window_slot = g_state.sched_next_slot++;
+    const uint32_t acc = (uint32_t)g_state.sched_frac_acc + g_state.sched_period_frac;
+    g_state.sched_frac_acc = (uint16_t)acc;
+    const int64_t period = (int64_t)g_state.sched_period_us + (int64_t)(acc >> 16);
+    g_state.sched_next_us = boundary + (uint64_t)period;
+    g_state.sched_windows++;
+    critical_section_exit(&g_lock);
+    // Negative: re-arm relative to the previous target time, so callback
+    // latency never accumulates into the grid.
+    return -period;
 }
 
 static void handle_sync_locked(bool level_high)
 {
+    if (g_state.sched_active) {
+        return;  // the time grid replaces the sync line
+    }
     if (level_high) {
         g_state.sync_forced = true;
         start_window_locked(g_state.mode, g_state.tau_ms);
@@ -229,10 +437,20 @@ static void handle_sync_locked(bool level_high)
 static void gpio_callback(uint gpio, uint32_t events)
 {
     uint64_t now = time_us_64();
+    // Latched before the lock so a contended lock does not shift the reference count.
+    const uint16_t ref_raw = ref_clock_raw();
     critical_section_enter_blocking(&g_lock);
 
-    if (gpio == g_config.freq_gpio && (events & GPIO_IRQ_EDGE_RISE)) {
-        handle_edge_locked(now);
+    const uint32_t edges = events & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+    if (gpio == g_config.freq_gpio && g_state.mode == TERPS_MODE_DUAL && edges != 0) {
+        if (edges == (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)) {
+            // Both edges latched before service: order unknown, so neither is usable.
+            g_state.glitch_count++;
+        } else {
+            handle_dual_edge_locked(now, edges == GPIO_IRQ_EDGE_RISE);
+        }
+    } else if (gpio == g_config.freq_gpio && (events & GPIO_IRQ_EDGE_RISE)) {
+        handle_edge_locked(now, ref_raw);
     } else if (gpio == g_config.sync_gpio && (events & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL))) {
         bool high = (events & GPIO_IRQ_EDGE_RISE) != 0;
         handle_sync_locked(high);
@@ -254,7 +472,13 @@ void freq_counter_init(const terps_firmware_config_t *config)
     if (depth == 0 || depth > MAX_QUEUE_DEPTH) {
         depth = 8;
     }
-    queue_init(&g_result_queue, sizeof(freq_result_t), depth);
+    ipc_ring_init(&g_result_ring,
+                  g_result_slots,
+                  g_result_stamps,
+                  (uint16_t)sizeof(freq_result_t),
+                  (uint16_t)depth,
+                  TERPS_IPC_CH_FREQ,
+                  1u);
 
     memset(&g_state, 0, sizeof(g_state));
     g_state.freq_estimate_hz = DEFAULT_FREQ_ESTIMATE;
@@ -262,6 +486,7 @@ void freq_counter_init(const terps_firmware_config_t *config)
     g_state.timebase_ppm = config->timebase_ppm;
     g_state.tau_ms = config->tau_ms;
     g_state.gate_alarm = -1;
+    g_state.sched_alarm = -1;
     update_min_interval_locked();
 
     critical_section_init(&g_lock);
@@ -271,6 +496,11 @@ void freq_counter_init(const terps_firmware_config_t *config)
     gpio_pull_down(config->freq_gpio);
 
     gpio_set_irq_enabled_with_callback(config->freq_gpio, GPIO_IRQ_EDGE_RISE, true, gpio_callback);
+    freq_counter_set_edge_irqs(config->mode);
+
+    if (config->ref_clk_gpio != TERPS_GPIO_UNUSED) {
+        ref_clock_init(config->ref_clk_gpio, config->ref_clk_hz);
+    }
 
     if (config->sync_gpio != TERPS_GPIO_UNUSED) {
         gpio_init(config->sync_gpio);
@@ -288,6 +518,19 @@ void freq_counter_init(const terps_firmware_config_t *config)
     }
 }
 
+void freq_counter_set_edge_irqs(terps_mode_t mode)
+{
+    const bool dual = (mode == TERPS_MODE_DUAL);
+    critical_section_enter_blocking(&g_lock);
+    if (dual != g_state.fall_irq_enabled) {
+        // Falls arriving while the open window is still RECIP are ignored by
+        // gpio_callback; a DUAL window without them finishes on its rises alone.
+        gpio_set_irq_enabled(g_config.freq_gpio, GPIO_IRQ_EDGE_FALL, dual);
+        g_state.fall_irq_enabled = dual;
+    }
+    critical_section_exit(&g_lock);
+}
+
 void freq_counter_start_window(terps_mode_t mode, uint32_t tau_ms)
 {
     if (tau_ms == 0) {
@@ -297,7 +540,75 @@ void freq_counter_start_window(terps_mode_t mode, uint32_t tau_ms)
     critical_section_enter_blocking(&g_lock);
     g_state.min_interval_frac = g_config.min_interval_frac;
     g_state.timebase_ppm = g_config.timebase_ppm;
-    start_window_locked(mode, tau_ms);
+    if (g_state.sched_active) {
+        // Scheduled windows are opened by slot_alarm_cb; take the mode from the next slot on.
+        g_state.sched_mode = mode;
+        g_state.tau_ms = tau_ms;
+    } else {
+        start_window_locked(mode, tau_ms);
+    }
+    critical_section_exit(&g_lock);
+}
+
+bool freq_counter_schedule(uint64_t start_us, uint32_t period_us, uint16_t period_frac, uint32_t first_slot)
+{
+    if (period_us < MIN_SCHED_PERIOD_US || start_us <= time_us_64()) {
+        return false;
+    }
+    critical_section_enter_blocking(&g_lock);
+    if (g_state.sched_alarm > 0) {
+        cancel_alarm(g_state.sched_alarm);
+        g_state.sched_alarm = -1;
+    }
+    if (!g_state.sched_active) {
+        // Drop the free-running window; nothing is reported until the first grid point.
+        g_state.sched_mode = g_state.mode;
+        reset_state_locked();
+        g_state.sched_late_max_us = 0;
+        g_state.sched_windows = 0;
+    }
+    // A re-schedule while active (host drift correction) keeps the open window
+    // and moves its closing edge to the new grid.
+    g_state.sched_active = true;
+    g_state.sched_next_us = start_us;
+    g_state.sched_period_us = period_us;
+    g_state.sched_period_frac = period_frac;
+    g_state.sched_frac_acc = 0;
+    g_state.sched_next_slot = first_slot;
+    g_state.sched_alarm = add_alarm_at(from_us_since_boot(start_us), slot_alarm_cb, NULL, true);
+    const bool ok = g_state.sched_alarm > 0;
+    if (!ok) {
+        g_state.sched_active = false;
+    }
+    critical_section_exit(&g_lock);
+    return ok;
+}
+
+void freq_counter_unschedule(void)
+{
+    critical_section_enter_blocking(&g_lock);
+    if (g_state.sched_alarm > 0) {
+        cancel_alarm(g_state.sched_alarm);
+    }
+    g_state.sched_alarm = -1;
+    if (g_state.sched_active) {
+        g_state.sched_active = false;
+        reset_state_locked();
+        start_window_locked(g_state.sched_mode, g_state.tau_ms);
+    }
+    critical_section_exit(&g_lock);
+}
+
+void freq_counter_schedule_status(freq_schedule_status_t *out)
+{
+    critical_section_enter_blocking(&g_lock);
+    out->active = g_state.sched_active;
+    out->next_us = g_state.sched_next_us;
+    out->period_us = g_state.sched_period_us;
+    out->period_frac = g_state.sched_period_frac;
+    out->next_slot = g_state.sched_next_slot;
+    out->late_max_us = g_state.sched_late_max_us;
+    out->windows = g_state.sched_windows;
     critical_section_exit(&g_lock);
 }
 
@@ -309,9 +620,9 @@ void freq_counter_stop(void)
     critical_section_exit(&g_lock);
 }
 
-queue_t *freq_counter_queue(void)
+ipc_ring_t *freq_counter_ring(void)
 {
-    return &g_result_queue;
+    return &g_result_ring;
 }
 
 void freq_counter_on_sync(bool level_high)
@@ -329,11 +640,18 @@ void freq_counter_update_timebase_ppm(float ppm_correction)
 }
 
 float freq_counter_last_frequency(void)
+{
+    // One aligned word, written whole under g_lock: the load cannot tear, so
+    // readers need not stall the edge IRQ. latest_read() has the full record.
+    return *(volatile const float *)&g_state.freq_estimate_hz;
+}
+
+void freq_counter_edge_stats(freq_edge_stats_t *out)
 {
     critical_section_enter_blocking(&g_lock);
-    float value = g_state.freq_estimate_hz;
+    *out = g_edge_stats;
+    out->mode = g_state.mode;
     critical_section_exit(&g_lock);
-    return value;
 }
 
 void freq_counter_set_min_interval(float min_interval_frac)
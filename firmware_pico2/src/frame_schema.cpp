@@ -0,0 +1,114 @@
+#include "frame_schema.h"
+
+#include <string.h>
+
+#define FRAME_SCHEMA_MAX_PAYLOAD 255u
+
+static frame_schema_t *g_schemas[FRAME_SCHEMA_MAX_TYPES];
+static size_t g_schema_count = 0;
+
+uint8_t frame_field_size(uint8_t type)
+{
+    switch (type) {
+    case FRAME_TYPE_U8:
+    case FRAME_TYPE_I8:
+        return 1u;
+    case FRAME_TYPE_U16:
+    case FRAME_TYPE_I16:
+        return 2u;
+    case FRAME_TYPE_U32:
+    case FRAME_TYPE_I32:
+    case FRAME_TYPE_F32:
+        return 4u;
+    default:
+        return 0u;
+    }
+}
+
+bool frame_schema_register(frame_schema_t *schema)
+{
+    if (schema == NULL || g_schema_count >= FRAME_SCHEMA_MAX_TYPES || frame_schema_find(schema->packet_type)) {
+        return false;
+    }
+    size_t len = 0;
+    for (uint8_t i = 0; i < schema->nfields; ++i) {
+        const uint8_t size = frame_field_size(schema->fields[i].type);
+        if (size == 0) {
+            return false;
+        }
+        len += size;
+    }
+    if (len > FRAME_SCHEMA_MAX_PAYLOAD) {
+        return false;
+    }
+    schema->payload_len = (uint8_t)len;
+    g_schemas[g_schema_count++] = schema;
+    return true;
+}
+
+const frame_schema_t *frame_schema_find(uint8_t packet_type)
+{
+    for (size_t i = 0; i < g_schema_count; ++i) {
+        if (g_schemas[i]->packet_type == packet_type) {
+            return g_schemas[i];
+        }
+    }
+    return NULL;
+}
+
+size_t frame_schema_count(void)
+{
+    return g_schema_count;
+}
+
+const frame_schema_t *frame_schema_at(size_t index)
+{
+    return index < g_schema_count ? g_schemas[index] : NULL;
+}
+
+size_t frame_schema_encode(const frame_schema_t *schema, const void *src, uint8_t *dst, size_t capacity)
+{
+    if (schema->payload_len > capacity) {
+        return 0;
+    }
+    const uint8_t *base = (const uint8_t *)src;
+    size_t offset = 0;
+    for (uint8_t i = 0; i < schema->nfields; ++i) {
+        const frame_field_desc_t *field = &schema->fields[i];
+        const uint8_t size = frame_field_size(field->type);
+        // Members are stored in their wire type, so a little-endian copy is the encoding.
+        memcpy(&dst[offset], base + field->src_offset, size);
+        offset += size;
+    }
+    return offset;
+}
+
+size_t frame_schema_describe(const frame_schema_t *schema, uint8_t *dst, size_t capacity)
+{
+    if (capacity < 4u) {
+        return 0;
+    }
+    size_t pos = 0;
+    dst[pos++] = FRAME_SCHEMA_VERSION;
+    dst[pos++] = schema->packet_type;
+    dst[pos++] = schema->payload_len;
+    dst[pos++] = schema->nfields;
+    uint8_t offset = 0;
+    for (uint8_t i = 0; i < schema->nfields; ++i) {
+        const frame_field_desc_t *field = &schema->fields[i];
+        const size_t name_len = field->name ? strlen(field->name) : 0u;
+        if (name_len > 0xFFu || pos + 6u + name_len > capacity) {
+            return 0;
+        }
+        dst[pos++] = field->id;
+        dst[pos++] = field->type;
+        dst[pos++] = offset;
+        dst[pos++] = (uint8_t)field->scale_exp;
+        dst[pos++] = field->attr;
+        dst[pos++] = (uint8_t)name_len;
+        memcpy(&dst[pos], field->name, name_len);
+        pos += name_len;
+        offset = (uint8_t)(offset + frame_field_size(field->type));
+    }
+    return pos;
+}
@@ -0,0 +1,133 @@
+#include "hdr_hist.h"
+
+#include <string.h>
+
+static inline uint32_t bit_length(uint32_t value)
+{
+    return value == 0 ? 0u : 32u - (uint32_t)__builtin_clz(value);
+}
+
+uint32_t hdr_hist_bucket(uint32_t magnitude)
+{
+    const uint32_t len = bit_length(magnitude);
+    if (len <= HDR_HIST_PRECISION_BITS) {
+        return magnitude;
+    }
+    const uint32_t shift = len - HDR_HIST_PRECISION_BITS;
+    return shift * HDR_HIST_HALF + (magnitude >> shift);
+}
+
+uint32_t hdr_hist_bucket_lower(uint32_t index)
+{
+    if (index < 2u * HDR_HIST_HALF) {
+        return index;
+    }
+    const uint32_t shift = index / HDR_HIST_HALF - 1u;
+    return (index - shift * HDR_HIST_HALF) << shift;
+}
+
+uint32_t hdr_hist_bucket_width(uint32_t index)
+{
+    if (index < 2u * HDR_HIST_HALF) {
+        return 1u;
+    }
+    return 1u << (index / HDR_HIST_HALF - 1u);
+}
+
+void hdr_hist_reset(hdr_hist_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+}
+
+void hdr_hist_record(hdr_hist_t *hist, int32_t value)
+{
+    if (value >= 0) {
+        hist->pos[hdr_hist_bucket((uint32_t)value)]++;
+    } else {
+        hist->neg[hdr_hist_bucket((uint32_t)(-(int64_t)value))]++;
+    }
+    if (hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if (hist->count == 0 || value > hist->max) {
+        hist->max = value;
+    }
+    hist->count++;
+}
+
+static int32_t bucket_value(uint32_t index, bool negative)
+{
+    // Midpoint of the bucket; exact for the unit-width buckets.
+    const int64_t mid = (int64_t)hdr_hist_bucket_lower(index) + (hdr_hist_bucket_width(index) - 1u) / 2u;
+    return (int32_t)(negative ? -mid : mid);
+}
+
+int32_t hdr_hist_quantile(const hdr_hist_t *hist, float q)
+{
+    if (hist->count == 0) {
+        return 0;
+    }
+    if (q <= 0.0f) {
+        return hist->min;
+    }
+    if (q >= 1.0f) {
+        return hist->max;
+    }
+    // Rank of the order statistic (1-based), matching the host implementation.
+    uint32_t rank = (uint32_t)(q * (float)hist->count + 0.5f);
+    if (rank < 1u) {
+        rank = 1u;
+    }
+    uint32_t seen = 0;
+    int32_t value = hist->max;
+    bool found = false;
+    for (uint32_t i = HDR_HIST_BUCKETS; i-- > 0 && !found;) {
+        seen += hist->neg[i];
+        if (hist->neg[i] != 0 && seen >= rank) {
+            value = bucket_value(i, true);
+            found = true;
+        }
+    }
+    for (uint32_t i = 0; i < HDR_HIST_BUCKETS && !found; ++i) {
+        seen += hist->pos[i];
+        if (hist->pos[i] != 0 && seen >= rank) {
+            value = bucket_value(i, false);
+            found = true;
+        }
+    }
+    if (value < hist->min) {
+        value = hist->min;
+    }
+    if (value > hist->max) {
+        value = hist->max;
+    }
+    return value;
+}
+
+static size_t put_entry(uint8_t *dst, uint16_t index, uint32_t count)
+{
+    dst[0] = (uint8_t)(index & 0xFFu);
+    dst[1] = (uint8_t)(index >> 8);
+    memcpy(&dst[2], &count, sizeof(count));
+    return HDR_HIST_ENTRY_BYTES;
+}
+
+size_t hdr_hist_export(const hdr_hist_t *hist, uint8_t *dst, size_t capacity)
+{
+    size_t used = 0;
+    for (uint32_t i = 0; i < HDR_HIST_BUCKETS; ++i) {
+        if (hist->neg[i] != 0) {
+            if (used + HDR_HIST_ENTRY_BYTES > capacity) {
+                return used;
+            }
+            used += put_entry(&dst[used], (uint16_t)(i | HDR_HIST_NEGATIVE), hist->neg[i]);
+        }
+        if (hist->pos[i] != 0) {
+            if (used + HDR_HIST_ENTRY_BYTES > capacity) {
+                return used;
+            }
+            used += put_entry(&dst[used], (uint16_t)i, hist->pos[i]);
+        }
+    }
+    return used;
+}
@@ -0,0 +1,47 @@
+#include "latest.h"
+
+#include <string.h>
+
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+static terps_latest_t g_copies[2];
+static volatile uint32_t g_seq = 0;
+static volatile uint32_t g_retries = 0;
+
+void __not_in_flash_func(latest_publish)(const terps_latest_t *m)
+{
+    const uint32_t seq = g_seq;
+    // Readers move to copy 1 while copy 0 is rewritten, then back.
+    g_seq = seq + 1u;
+    __dmb();
+    memcpy(&g_copies[0], m, sizeof(*m));
+    __dmb();
+    g_seq = seq + 2u;
+    __dmb();
+    memcpy(&g_copies[1], m, sizeof(*m));
+    __dmb();
+}
+
+bool __not_in_flash_func(latest_read)(terps_latest_t *out)
+{
+    uint32_t seq = g_seq;
+    for (;;) {
+        __dmb();
+        memcpy(out, &g_copies[seq & 1u], sizeof(*out));
+        __dmb();
+        const uint32_t again = g_seq;
+        if (again == seq) {
+            break;
+        }
+        seq = again;
+        // Only counted, never waited on: a lost increment from two readers is harmless.
+        g_retries = g_retries + 1u;
+    }
+    return out->windows != 0;
+}
+
+uint32_t latest_retries(void)
+{
+    return g_retries;
+}
@@ -5,31 +5,98 @@
 
 #include "ads1220.h"
 #include "config_default.h"
+#include "core_ipc.h"
+#include "ctrl_out.h"
+#include "edge_capture.h"
 #include "edge_counter.h"
 #include "eeprom_coeff.h"
+#include "frame_schema.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
+#include "hardware/pwm.h"
 #include "hardware/spi.h"
+#include "hardware/sync.h"
+#include "hdr_hist.h"
+#include "latest.h"
 #include "pico/multicore.h"
 #include "pico/stdlib.h"
 #include "pps_cal.h"
+#include "ref_clock.h"
+#include "settle.h"
 #include "terps_config.h"
+#include "trace_log.h"
 #include "tusb.h"
+#include "uart_out.h"
+#include "uni_o.h"
 #include "usb_cdc.h"
 
 #define FRAME_QUEUE_DEPTH 16
+#define FRAME_QUEUE_MAX 64
+#define CORE0_IDLE_US 1000u
+#define TRACE_DRAIN_PER_SPIN 4
+#define EEPROM_BLOCK_MAGIC 0xEEu
+#define EEPROM_BLOCK_VERSION 1u
+#define EEPROM_BLOCK_OVERHEAD 14u
+#define CAPTURE_READ_CHUNK 2048u
+#define HIST_EXPORT_BYTES (2u * HDR_HIST_BUCKETS * HDR_HIST_ENTRY_BYTES)
 
 static terps_firmware_config_t g_config;
-static queue_t *g_freq_queue;
-static queue_t g_frame_queue;
+// Core hand-off (core_ipc.h): window results into core1, frames back to core0.
+static ipc_ring_t *g_freq_ring;
+static ipc_ring_t g_frame_ring;
+static terps_frame_t g_frame_slots[FRAME_QUEUE_MAX];
+static uint32_t g_frame_stamps[FRAME_QUEUE_MAX];
 static bool g_binary_mode = true;
 static int32_t g_last_diode_uV = 0;
+static bool g_have_diode = false;  // core1: a conversion has arrived since boot
+static uint32_t g_latest_windows = 0;  // core1 only
 static rps_eeprom_t g_eeprom_cache;
 static bool g_eeprom_valid = false;
+// Lock-step readout of every configured UNI/O bus (EEPROM.SCAN / EEPROM.BUSES).
+static uint8_t g_unio_images[UNIO_MAX_BUSES][sizeof(g_eeprom_cache.bytes)];
+static unio_bus_result_t g_unio_results[UNIO_MAX_BUSES];
+static uint16_t g_unio_scan_start = 0;
+static uint16_t g_unio_scan_len = 0;
+static uint32_t g_unio_scan_us = 0;
+static bool g_unio_scanned = false;
+
+// Frame-to-frame noise distributions, recorded on core1 and read by the
+// command handler on core0 under g_hist_lock. Frequency deltas are in
+// 1e-4 Hz (f_hz_x1e4), diode deltas in µV. HIST.RESET starts a new window.
+static hdr_hist_t g_hist_freq;
+static hdr_hist_t g_hist_diode;
+static hdr_hist_t g_hist_snapshot;
+static critical_section_t g_hist_lock;
+static bool g_hist_have_prev = false;
+static bool g_hist_have_prev_v = false;  // the diode pair only spans fresh conversions
+static int32_t g_hist_prev_f_x1e4 = 0;
+static int32_t g_hist_prev_diode_uV = 0;
+
+// ADC co-scheduling: core0 plans the data rate for the current window length,
+// core1 owns the SPI bus and applies the pending config between conversions.
+static critical_section_t g_adc_lock;
+static ads1220_config_t g_adc_cfg;
+static ads1220_plan_t g_adc_plan;
+static uint32_t g_adc_window_ms = 0;
+static volatile bool g_adc_pending = false;
+static uint32_t g_adc_frames = 0;
+static uint32_t g_adc_fresh_total = 0;
+static uint16_t g_adc_fresh_min = 0xFFFFu;
+static uint32_t g_adc_reused = 0;
+
+// Warm-up / step settling: updated on core1 per frame, configured and read by
+// core0 commands under g_settle_lock.
+static settle_detector_t g_settle;
+static critical_section_t g_settle_lock;
+
+// OUT.POLY stages a surface here; OUT.K fills it and OUT.POLY.COMMIT hands it to ctrl_out.
+static ctrl_out_poly_t g_out_poly_stage;
+static uint64_t g_out_poly_missing = 0;  // bit i*CTRL_OUT_POLY_MAX+j: K[i][j] not yet sent
 
 static void core1_main(void);
 static void process_frequency_result(const freq_result_t *freq);
 static void handle_cdc_command(const char *line);
+static void setup_unio_buses(void);
 
 static void setup_adc(void)
 {
@@ -47,15 +114,146 @@ static void setup_adc(void)
         .rate_sps = g_config.adc_rate_sps,
         .mains_reject = g_config.adc_mains_reject,
         .average_window = g_config.avg_window > 0 ? g_config.avg_window : 8,
+        .op_mode = ADS1220_OP_NORMAL,
     };
 
+    critical_section_init(&g_adc_lock);
+    g_adc_window_ms = g_config.tau_ms;
+    if (g_config.adc_auto_rate) {
+        ads1220_plan(g_adc_window_ms,
+                     g_config.adc_gain,
+                     g_config.adc_noise_target_nV,
+                     g_config.adc_mains_reject,
+                     &g_adc_plan);
+        cfg.rate_sps = g_adc_plan.rate_sps;
+        cfg.op_mode = g_adc_plan.op_mode;
+        cfg.mains_reject = g_adc_plan.mains_reject;
+    } else {
+        g_adc_plan.rate_sps = cfg.rate_sps;
+        g_adc_plan.op_mode = cfg.op_mode;
+        g_adc_plan.mains_reject = cfg.mains_reject;
+        g_adc_plan.per_window = (uint16_t)(((uint64_t)g_adc_window_ms * cfg.rate_sps) / 1000u);
+    }
+    g_adc_cfg = cfg;
     ads1220_init(&hw, &cfg);
 }
 
+// Re-plan for a new window length (tau or schedule period); core1 applies it.
+static void adc_replan(uint32_t window_ms)
+{
+    critical_section_enter_blocking(&g_adc_lock);
+    g_adc_window_ms = window_ms;
+    if (g_config.adc_auto_rate) {
+        ads1220_plan(window_ms,
+                     g_config.adc_gain,
+                     g_config.adc_noise_target_nV,
+                     g_config.adc_mains_reject,
+                     &g_adc_plan);
+    } else {
+        // Manual rate: keep it, but report what it yields for this window.
+        const uint16_t rate = g_adc_plan.rate_sps;
+        g_adc_plan.per_window = (uint16_t)(((uint64_t)window_ms * rate) / 1000u);
+        g_adc_plan.noise_nV = 0;
+    }
+    g_adc_cfg.rate_sps = g_adc_plan.rate_sps;
+    g_adc_cfg.op_mode = g_adc_plan.op_mode;
+    g_adc_cfg.mains_reject = g_adc_plan.mains_reject;
+    g_adc_pending = true;
+    __sev();  // core1 may be asleep in ipc_wait()
+    g_adc_frames = 0;
+    g_adc_fresh_total = 0;
+    g_adc_fresh_min = 0xFFFFu;
+    g_adc_reused = 0;
+    critical_section_exit(&g_adc_lock);
+    // A new window length changes both noise floors; judge settling afresh.
+    critical_section_enter_blocking(&g_settle_lock);
+    settle_reset(&g_settle);
+    critical_section_exit(&g_settle_lock);
+}
+
+static void adc_apply_pending(void)
+{
+    if (!g_adc_pending) {
+        return;
+    }
+    critical_section_enter_blocking(&g_adc_lock);
+    ads1220_config_t cfg = g_adc_cfg;
+    g_adc_pending = false;
+    critical_section_exit(&g_adc_lock);
+    ads1220_apply_config(&cfg);
+}
+
+static void adc_count_frame(uint16_t fresh)
+{
+    critical_section_enter_blocking(&g_adc_lock);
+    g_adc_frames++;
+    g_adc_fresh_total += fresh;
+    if (fresh < g_adc_fresh_min) {
+        g_adc_fresh_min = fresh;
+    }
+    if (fresh == 0) {
+        g_adc_reused++;
+    }
+    critical_section_exit(&g_adc_lock);
+}
+
+static void setup_settle(void)
+{
+    const settle_limits_t limits = {
+        .window = g_config.settle_window,
+        .hold = g_config.settle_hold,
+        .f_slope_hz_s = g_config.settle_f_slope_hz_s,
+        .f_noise_hz = g_config.settle_f_noise_hz,
+        .v_slope_uV_s = g_config.settle_v_slope_uV_s,
+        .v_noise_uV = g_config.settle_v_noise_uV,
+    };
+    critical_section_init(&g_settle_lock);
+    settle_init(&g_settle, &limits);
+}
+
+static void setup_ctrl_out(void)
+{
+    ctrl_out_hw_t hw = {
+        .pwm_gpio = g_config.out_pwm_gpio,
+        .pwm_bits = g_config.out_pwm_bits,
+        .dac = g_config.out_dac,
+        .dac_cs_gpio = g_config.out_dac_cs_gpio,
+        .spi = spi0,
+    };
+    const ctrl_out_scale_t scale = {
+        .source = g_config.out_source,
+        .in_lo = g_config.out_in_lo,
+        .in_hi = g_config.out_in_hi,
+        .out_min = g_config.out_min,
+        .out_max = g_config.out_max,
+        .fault_level = g_config.out_fault_level,
+    };
+    if (ref_clock_enabled() && hw.pwm_gpio != TERPS_GPIO_UNUSED && pwm_gpio_to_slice_num(hw.pwm_gpio) == ref_clock_slice()) {
+        // The reference clock owns the slice; its counter cannot also generate PWM.
+        hw.pwm_gpio = TERPS_GPIO_UNUSED;
+    }
+    ctrl_out_init(&hw, &scale);
+}
+
+static void setup_uart_out(void)
+{
+    if (g_config.uart_tx_gpio == TERPS_GPIO_UNUSED) {
+        return;
+    }
+    const uart_out_hw_t hw = {
+        .tx_gpio = g_config.uart_tx_gpio,
+        .baud = g_config.uart_baud,
+        .de_gpio = g_config.uart_de_gpio,
+        .de_lead_us = g_config.uart_de_lead_us,
+        .de_tail_us = g_config.uart_de_tail_us,
+    };
+    uart_out_init(&hw);
+}
+
 static void init_config(void)
 {
     g_config = terps_default_config;
-    if (g_config.queue_length == 0 || g_config.queue_length > 64) {
+    if (g_config.queue_length == 0 || g_config.queue_length > FRAME_QUEUE_MAX) {
         g_config.queue_length = FRAME_QUEUE_DEPTH;
     }
     if (g_config.adc_timeout_ms == 0) {
@@ -70,6 +268,18 @@ static void init_usb(void)
     usb_cdc_init(g_binary_mode ? TERPS_STREAM_BINARY : TERPS_STREAM_CSV);
 }
 
+// Returns true when it sent anything, so the loop spins again instead of sleeping.
+static bool drain_trace_log(void)
+{
+    trace_entry_t entry;
+    int sent = 0;
+    while (sent < TRACE_DRAIN_PER_SPIN && trace_log_pop(&entry)) {
+        usb_cdc_send_trace(&entry);
+        ++sent;
+    }
+    return sent > 0;
+}
+
 static void feed_pps_correction(void)
 {
     if (g_config.pps_gpio == TERPS_GPIO_UNUSED) {
@@ -84,22 +294,39 @@ int main()
 {
     stdio_init_all();
     init_config();
+    trace_log_init();
 
-    queue_init(&g_frame_queue, sizeof(terps_frame_t), g_config.queue_length);
+    ipc_ring_init(&g_frame_ring,
+                  g_frame_slots,
+                  g_frame_stamps,
+                  (uint16_t)sizeof(terps_frame_t),
+                  (uint16_t)g_config.queue_length,
+                  TERPS_IPC_CH_FRAME,
+                  0u);
+    critical_section_init(&g_hist_lock);
+    hdr_hist_reset(&g_hist_freq);
+    hdr_hist_reset(&g_hist_diode);
+    setup_settle();
 
+    edge_capture_init();
     freq_counter_init(&g_config);
-    g_freq_queue = freq_counter_queue();
+    g_freq_ring = freq_counter_ring();
     setup_adc();
+    setup_ctrl_out();
     if (g_config.pps_gpio != TERPS_GPIO_UNUSED) {
         pps_cal_init(g_config.pps_gpio);
         gpio_set_irq_enabled(g_config.pps_gpio, GPIO_IRQ_EDGE_RISE, true);
     }
     init_usb();
+    setup_uart_out();
     if (g_config.unio_gpio != TERPS_GPIO_UNUSED) {
         rps_eeprom_init(g_config.unio_gpio, g_config.unio_bitrate_bps);
+        setup_unio_buses();
     }
 
     multicore_launch_core1(core1_main);
+    // After the launch handshake the SIO FIFOs carry only ring doorbells.
+    ipc_core_init();
 
     sleep_ms(200);
     freq_counter_start_window(g_config.mode, g_config.tau_ms);
@@ -109,26 +336,90 @@ int main()
         usb_cdc_poll();
 
         terps_frame_t frame;
-        if (queue_try_remove(&g_frame_queue, &frame)) {
+        bool busy = false;
+        if (ipc_ring_ready(&g_frame_ring) && ipc_ring_pop(&g_frame_ring, &frame)) {
             usb_cdc_send_frame(&frame);
+            busy = true;
+        }
+        // A bounded batch every pass: a steady frame stream must not starve the trace ring.
+        if (drain_trace_log()) {
+            busy = true;
         }
 
         char cmd[128];
         if (usb_cdc_read_line(cmd, sizeof(cmd))) {
             handle_cdc_command(cmd);
+            busy = true;
         }
 
         feed_pps_correction();
+        if (!busy) {
+            // USB, PPS and frame doorbells all wake this early; the bound keeps
+            // trace draining and PPS bookkeeping running when nothing else does.
+            ipc_wait(CORE0_IDLE_US);
+        }
+    }
+}
+
+static void __not_in_flash_func(adc_drdy_irq)(void)
+{
+    // Only wakes core1 from WFE; ads1220_poll() reads the conversion.
+    if (gpio_get_irq_event_mask(g_config.spi_drdy_gpio) & GPIO_IRQ_EDGE_FALL) {
+        gpio_acknowledge_irq(g_config.spi_drdy_gpio, GPIO_IRQ_EDGE_FALL);
     }
 }
 
 static void core1_main(void)
 {
+    ipc_core_init();
+    if (g_config.spi_drdy_gpio != TERPS_GPIO_UNUSED) {
+        // Enabled from core1 so the DRDY interrupt is routed here, not to core0.
+        gpio_add_raw_irq_handler(g_config.spi_drdy_gpio, adc_drdy_irq);
+        gpio_set_irq_enabled(g_config.spi_drdy_gpio, GPIO_IRQ_EDGE_FALL, true);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+    uart_out_attach_irq();
     while (true) {
+        // Drain conversions as they land so every one inside a window is averaged.
+        adc_apply_pending();
+        bool busy = ads1220_poll();
         freq_result_t freq;
-        queue_remove_blocking(g_freq_queue, &freq);
-        process_frequency_result(&freq);
+        if (ipc_ring_ready(g_freq_ring)) {
+            while (ipc_ring_pop(g_freq_ring, &freq)) {
+                process_frequency_result(&freq);
+                busy = true;
+            }
+        }
+        if (!busy && !g_adc_pending) {
+            // Woken by a result doorbell, ADS1220 DRDY or the window alarm.
+            ipc_wait(0);
+        }
+    }
+}
+
+// `v_fresh` is false when the window reused the previous conversion: the
+// frequency pair still counts, the diode pair waits for the next conversion.
+static void record_noise(const terps_frame_t *frame, bool valid, bool v_fresh)
+{
+    critical_section_enter_blocking(&g_hist_lock);
+    if (!valid) {
+        g_hist_have_prev = false;
+        g_hist_have_prev_v = false;
+    } else {
+        if (g_hist_have_prev) {
+            hdr_hist_record(&g_hist_freq, frame->f_hz_x1e4 - g_hist_prev_f_x1e4);
+        }
+        g_hist_prev_f_x1e4 = frame->f_hz_x1e4;
+        g_hist_have_prev = true;
+        if (v_fresh) {
+            if (g_hist_have_prev_v) {
+                hdr_hist_record(&g_hist_diode, frame->diode_uV - g_hist_prev_diode_uV);
+            }
+            g_hist_prev_diode_uV = frame->diode_uV;
+            g_hist_have_prev_v = true;
+        }
     }
+    critical_section_exit(&g_hist_lock);
 }
 
 static void process_frequency_result(const freq_result_t *freq)
@@ -140,18 +431,28 @@ static void process_frequency_result(const freq_result_t *freq)
 
     uint8_t adc_flags = 0;
     int32_t v_uV = g_last_diode_uV;
-    bool adc_ok = ads1220_read_uV(&v_uV, g_config.adc_timeout_ms, &adc_flags);
+    const uint16_t adc_fresh = ads1220_read_window(&v_uV, g_config.adc_timeout_ms, &adc_flags);
+    const bool adc_ok = adc_fresh > 0;
     if (adc_ok) {
         g_last_diode_uV = v_uV;
+        g_have_diode = true;
     }
+    adc_count_frame(adc_fresh);
     frame_flags |= adc_flags;
     frame_flags |= pps_cal_status_flags();
 
+    // Control output first: everything below only feeds the USB stream.
+    ctrl_out_update(freq->f_hz,
+                    g_last_diode_uV,
+                    !freq->timeout,
+                    !(adc_flags & (TERPS_FLAG_ADC_TIMEOUT | TERPS_FLAG_ADC_SATURATED)),
+                    freq->end_us);
+
     if (!adc_ok && (adc_flags & TERPS_FLAG_ADC_TIMEOUT) && g_config.debug_deglitch_stats) {
-        printf("[ads1220] DRDY timeout\n");
+        TRACE0(TRACE_ADC_DRDY_TIMEOUT);
     }
     if (g_config.debug_deglitch_stats && freq->timeout) {
-        printf("[freq] window timeout pulses=%u\n", freq->pulses);
+        TRACE1(TRACE_FREQ_WINDOW_TIMEOUT, freq->pulses);
     }
 
     terps_frame_t frame = {0};
@@ -160,26 +461,55 @@ static void process_frequency_result(const freq_result_t *freq)
     frame.tau_ms = (uint16_t)freq->tau_ms;
     frame.f_hz = freq->f_hz;
     frame.mode = (uint8_t)freq->mode;
+    frame.slot = freq->slot;
+    frame.adc_fresh = adc_fresh > 0xFFu ? 0xFFu : (uint8_t)adc_fresh;
     frame.diode_uV = g_last_diode_uV;
     frame.adc_gain = g_config.adc_gain;
     frame.flags = frame_flags;
-    float ppm = pps_cal_correction_ppm();
+    // REF windows are timed by the reference clock; no timebase correction applies.
+    float ppm = freq->mode == TERPS_MODE_REF ? 0.0f : pps_cal_correction_ppm();
     frame.ppm_corr = ppm;
     frame.ppm_corr_x1e2 = (int16_t)lroundf(ppm * 100.0f);
 
-    if (g_config.debug_deglitch_stats && !g_binary_mode) {
-        printf("# raw=%u kept=%u dropped=%u min_interval_us=%u\n",
+    if (g_config.debug_deglitch_stats) {
+        TRACE4(TRACE_FREQ_DEGLITCH,
                freq->raw_pulses,
                freq->pulses,
                freq->glitch_count,
                freq->min_interval_us);
+        if (freq->mode == TERPS_MODE_DUAL) {
+            TRACE2(TRACE_FREQ_DUTY, freq->duty_x1e4, freq->pulses);
+        }
     }
 
-    if (!queue_try_add(&g_frame_queue, &frame)) {
-        terps_frame_t dropped;
-        queue_try_remove(&g_frame_queue, &dropped);
-        queue_try_add(&g_frame_queue, &frame);
+    // Only real faults break the histories. A window without a new conversion
+    // is normal (one conversion per window or fewer, or a slow ADC.RATE); it
+    // carries the previous diode value, which the settle fit simply repeats.
+    const bool valid = g_have_diode && !freq->timeout && !(adc_flags & TERPS_FLAG_ADC_TIMEOUT);
+    record_noise(&frame, valid, adc_ok);
+    critical_section_enter_blocking(&g_settle_lock);
+    if (settle_update(&g_settle,
+                      frame.ts_ms,
+                      frame.f_hz_x1e4,
+                      frame.diode_uV,
+                      valid && !(adc_flags & TERPS_FLAG_ADC_SATURATED))) {
+        frame.flags |= TERPS_FLAG_SETTLED;
     }
+    critical_section_exit(&g_settle_lock);
+
+    terps_latest_t latest = {
+        .windows = ++g_latest_windows,
+        .start_us = freq->start_us,
+        .end_us = freq->end_us,
+        .pulses = freq->pulses,
+        .frame = frame,
+    };
+    latest_publish(&latest);
+
+    // The UART copy leaves from here, independent of USB; a full ring drops
+    // this frame there (UART.STATUS) or here (IPC.STATUS FRAME_DROPPED).
+    uart_out_send_frame(&frame, freq->end_us);
+    ipc_ring_push(&g_frame_ring, &frame);
 
     freq_counter_start_window(g_config.mode, g_config.tau_ms);
 }
@@ -208,12 +538,12 @@ static void send_hex_block(const uint8_t *data, size_t len)
     }
 }
 
-static void handle_eeprom_dump(uint16_t addr, size_t length)
+static bool load_eeprom(uint16_t addr, size_t length)
 {
     if (addr >= 0x200) {
         usb_cdc_write_line("ERR BAD_ADDR\n");
         usb_cdc_write_line("END\n");
-        return;
+        return false;
     }
     size_t max_len = sizeof(g_eeprom_cache.bytes);
     if (length == 0 || length > max_len) {
@@ -229,15 +559,115 @@ static void handle_eeprom_dump(uint16_t addr, size_t length)
         g_eeprom_valid = false;
         usb_cdc_write_line("ERR UNIO_NO_DEVICE\n");
         usb_cdc_write_line("END\n");
-        return;
+        return false;
     }
     if (status != RPS_EEPROM_OK) {
         g_eeprom_valid = false;
         usb_cdc_write_line("ERR EEPROM_IO\n");
         usb_cdc_write_line("END\n");
-        return;
+        return false;
     }
     g_eeprom_valid = true;
+    return true;
+}
+
+// Reads [addr, addr+length) from all buses at once. Bus 0 also refreshes the
+// EEPROM.DUMP / EEPROM.READB cache.
+static void scan_eeprom_buses(uint16_t addr, size_t length)
+{
+    const size_t nbus = unio_bus_count();
+    uint8_t *bufs[UNIO_MAX_BUSES];
+    for (size_t bus = 0; bus < UNIO_MAX_BUSES; ++bus) {
+        bufs[bus] = g_unio_images[bus];
+    }
+    const uint32_t start_us = time_us_32();
+    unio_read_buses((1u << nbus) - 1u, addr, bufs, length, g_unio_results);
+    g_unio_scan_us = time_us_32() - start_us;
+    g_unio_scan_start = addr;
+    g_unio_scan_len = (uint16_t)length;
+    g_unio_scanned = true;
+    if (nbus > 0 && g_unio_results[0].status == UNIO_STATUS_OK) {
+        memcpy(g_eeprom_cache.bytes, g_unio_images[0], length);
+        g_eeprom_cache.device_address = g_unio_results[0].device_addr;
+        g_eeprom_cache.start_addr = addr;
+        g_eeprom_cache.length = length;
+        g_eeprom_valid = true;
+    }
+}
+
+static void setup_unio_buses(void)
+{
+    uint gpios[UNIO_MAX_BUSES];
+    size_t count = 0;
+    gpios[count++] = g_config.unio_gpio;
+    for (uint gpio = 0; gpio < 32u && count < UNIO_MAX_BUSES; ++gpio) {
+        if ((g_config.unio_extra_gpio_mask & (1u << gpio)) && gpio != g_config.unio_gpio) {
+            gpios[count++] = gpio;
+        }
+    }
+    if (count > 1 && unio_init_buses(gpios, count, g_config.unio_bitrate_bps) > 1) {
+        // One sensor per bus: load every coefficient image before streaming starts.
+        scan_eeprom_buses(0, sizeof(g_eeprom_cache.bytes));
+    }
+}
+
+static void report_eeprom_buses(void)
+{
+    if (!g_unio_scanned) {
+        usb_cdc_write_line("ERR NOT_SCANNED\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    const size_t nbus = unio_bus_count();
+    size_t ok = 0;
+    for (size_t bus = 0; bus < nbus; ++bus) {
+        ok += g_unio_results[bus].status == UNIO_STATUS_OK ? 1u : 0u;
+    }
+    static const char *const k_status[] = {"OK", "NO_DEVICE", "IO_ERROR"};
+    usb_cdc_printf("OK BUSES=%u OK=%u START=0x%04X LEN=%u US=%lu\n",
+                   (unsigned)nbus,
+                   (unsigned)ok,
+                   (unsigned)g_unio_scan_start,
+                   (unsigned)g_unio_scan_len,
+                   (unsigned long)g_unio_scan_us);
+    for (size_t bus = 0; bus < nbus; ++bus) {
+        const unio_bus_result_t *result = &g_unio_results[bus];
+        usb_cdc_printf("B %u GPIO=%u STATUS=%s DEV=0x%02X\n",
+                       (unsigned)bus,
+                       (unsigned)unio_bus_gpio(bus),
+                       k_status[result->status],
+                       (unsigned)result->device_addr);
+        if (result->status == UNIO_STATUS_OK) {
+            send_hex_block(g_unio_images[bus], g_unio_scan_len);
+        }
+    }
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_eeprom_scan(uint16_t addr, size_t length)
+{
+    if (unio_bus_count() == 0) {
+        usb_cdc_write_line("ERR UNIO_NO_DEVICE\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    if (addr >= 0x200) {
+        usb_cdc_write_line("ERR BAD_ADDR\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    if (length == 0 || length > 0x200u - addr) {
+        length = 0x200u - addr;
+    }
+    scan_eeprom_buses(addr, length);
+    report_eeprom_buses();
+}
+
+static void handle_eeprom_dump(uint16_t addr, size_t length)
+{
+    if (!load_eeprom(addr, length)) {
+        return;
+    }
     char header[160];
     snprintf(header,
              sizeof(header),
@@ -250,6 +680,825 @@ static void handle_eeprom_dump(uint16_t addr, size_t length)
     usb_cdc_write_line("END\n");
 }
 
+static void handle_eeprom_readb(uint16_t addr, size_t length)
+{
+    if (!load_eeprom(addr, length)) {
+        return;
+    }
+    // Block layout (little-endian): magic 0x55 0xEE, version, device address,
+    // start, length, UNI/O bitrate, image bytes, CRC16-CCITT over version..image.
+    static uint8_t block[EEPROM_BLOCK_OVERHEAD + sizeof(g_eeprom_cache.bytes)];
+    const uint16_t start = g_eeprom_cache.start_addr;
+    const uint16_t len = (uint16_t)g_eeprom_cache.length;
+    const uint32_t bitrate = g_config.unio_bitrate_bps;
+    size_t offset = 0;
+    block[offset++] = TERPS_PACKET_MAGIC;
+    block[offset++] = EEPROM_BLOCK_MAGIC;
+    block[offset++] = EEPROM_BLOCK_VERSION;
+    block[offset++] = g_eeprom_cache.device_address;
+    memcpy(&block[offset], &start, sizeof(start));
+    offset += sizeof(start);
+    memcpy(&block[offset], &len, sizeof(len));
+    offset += sizeof(len);
+    memcpy(&block[offset], &bitrate, sizeof(bitrate));
+    offset += sizeof(bitrate);
+    memcpy(&block[offset], g_eeprom_cache.bytes, len);
+    offset += len;
+    const uint16_t crc = usb_cdc_crc16(&block[2], offset - 2);
+    memcpy(&block[offset], &crc, sizeof(crc));
+    offset += sizeof(crc);
+
+    char header[160];
+    snprintf(header,
+             sizeof(header),
+             "OK DEV=0x%02X START=0x%04X LEN=%u BIN=%u\n",
+             (unsigned)g_eeprom_cache.device_address,
+             (unsigned)start,
+             (unsigned)len,
+             (unsigned)offset);
+    usb_cdc_write_line(header);
+    usb_cdc_write_block(block, offset);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_capture_status(void)
+{
+    edge_capture_status_t status;
+    edge_capture_status(&status);
+    char line[200];
+    snprintf(line,
+             sizeof(line),
+             "OK ARMED=%u EDGES=%lu MAX=%lu BYTES=%lu FIRST_US=%llu T4=%lu T8=%lu T16=%lu T32=%lu "
+             "OVERFLOW=%lu\n",
+             status.armed ? 1u : 0u,
+             (unsigned long)status.edges,
+             (unsigned long)status.max_edges,
+             (unsigned long)status.bytes_used,
+             (unsigned long long)status.first_us,
+             (unsigned long)status.tokens4,
+             (unsigned long)status.tokens8,
+             (unsigned long)status.tokens16,
+             (unsigned long)status.tokens32,
+             (unsigned long)status.overflow);
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_capture_read(uint32_t offset, uint32_t length)
+{
+    static uint8_t chunk[CAPTURE_READ_CHUNK + 2];
+    if (length == 0 || length > CAPTURE_READ_CHUNK) {
+        length = CAPTURE_READ_CHUNK;
+    }
+    size_t got = edge_capture_read(offset, chunk, length);
+    const uint16_t crc = usb_cdc_crc16(chunk, got);
+    memcpy(&chunk[got], &crc, sizeof(crc));
+
+    char header[96];
+    snprintf(header,
+             sizeof(header),
+             "OK OFFSET=%lu LEN=%u BIN=%u\n",
+             (unsigned long)offset,
+             (unsigned)got,
+             (unsigned)(got + sizeof(crc)));
+    usb_cdc_write_line(header);
+    usb_cdc_write_block(chunk, got + sizeof(crc));
+    usb_cdc_write_line("END\n");
+}
+
+static void snapshot_hist(char series, hdr_hist_t *out)
+{
+    critical_section_enter_blocking(&g_hist_lock);
+    memcpy(out, series == 'V' ? &g_hist_diode : &g_hist_freq, sizeof(*out));
+    critical_section_exit(&g_hist_lock);
+}
+
+static int format_hist_summary(char *dst, size_t cap, char series, const hdr_hist_t *hist)
+{
+    return snprintf(dst,
+                    cap,
+                    " %c_N=%lu %c_MIN=%ld %c_P50=%ld %c_P90=%ld %c_P99=%ld %c_P999=%ld %c_MAX=%ld",
+                    series,
+                    (unsigned long)hist->count,
+                    series,
+                    (long)hist->min,
+                    series,
+                    (long)hdr_hist_quantile(hist, 0.5f),
+                    series,
+                    (long)hdr_hist_quantile(hist, 0.9f),
+                    series,
+                    (long)hdr_hist_quantile(hist, 0.99f),
+                    series,
+                    (long)hdr_hist_quantile(hist, 0.999f),
+                    series,
+                    (long)hist->max);
+}
+
+static void handle_hist_status(void)
+{
+    char line[320];
+    int pos = snprintf(line, sizeof(line), "OK P=%u", (unsigned)HDR_HIST_PRECISION_BITS);
+    const char series[2] = {'F', 'V'};
+    for (size_t i = 0; i < sizeof(series) && pos > 0 && (size_t)pos < sizeof(line); ++i) {
+        snapshot_hist(series[i], &g_hist_snapshot);
+        pos += format_hist_summary(line + pos, sizeof(line) - (size_t)pos, series[i], &g_hist_snapshot);
+    }
+    if (pos > 0 && (size_t)pos < sizeof(line) - 1) {
+        line[pos++] = '\n';
+        line[pos] = '\0';
+    }
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_hist_reset(void)
+{
+    critical_section_enter_blocking(&g_hist_lock);
+    hdr_hist_reset(&g_hist_freq);
+    hdr_hist_reset(&g_hist_diode);
+    g_hist_have_prev = false;
+    g_hist_have_prev_v = false;
+    critical_section_exit(&g_hist_lock);
+    usb_cdc_write_line("OK\n");
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_hist_readb(char series)
+{
+    static uint8_t block[HIST_EXPORT_BYTES + 2];
+    if (series != 'F' && series != 'V') {
+        usb_cdc_write_line("ERR BAD_SERIES\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    snapshot_hist(series, &g_hist_snapshot);
+    size_t used = hdr_hist_export(&g_hist_snapshot, block, HIST_EXPORT_BYTES);
+    const uint16_t crc = usb_cdc_crc16(block, used);
+    memcpy(&block[used], &crc, sizeof(crc));
+
+    char header[160];
+    snprintf(header,
+             sizeof(header),
+             "OK SERIES=%c P=%u N=%lu MIN=%ld MAX=%ld ENTRIES=%u BIN=%u\n",
+             series,
+             (unsigned)HDR_HIST_PRECISION_BITS,
+             (unsigned long)g_hist_snapshot.count,
+             (long)g_hist_snapshot.min,
+             (long)g_hist_snapshot.max,
+             (unsigned)(used / HDR_HIST_ENTRY_BYTES),
+             (unsigned)(used + sizeof(crc)));
+    usb_cdc_write_line(header);
+    usb_cdc_write_block(block, used + sizeof(crc));
+    usb_cdc_write_line("END\n");
+}
+
+static const char *mode_name(terps_mode_t mode)
+{
+    switch (mode) {
+    case TERPS_MODE_GATED:
+        return "GATED";
+    case TERPS_MODE_DUAL:
+        return "DUAL";
+    case TERPS_MODE_REF:
+        return "REF";
+    default:
+        return "RECIP";
+    }
+}
+
+static void handle_edge_mode(const char *arg)
+{
+    while (*arg == ' ') {
+        ++arg;
+    }
+    if (*arg != '\0') {
+        if (strncmp(arg, "GATED", 5) == 0) {
+            g_config.mode = TERPS_MODE_GATED;
+        } else if (strncmp(arg, "RECIP", 5) == 0) {
+            g_config.mode = TERPS_MODE_RECIP;
+        } else if (strncmp(arg, "DUAL", 4) == 0) {
+            // Falling edges must already be enabled when core1 opens the first DUAL window.
+            freq_counter_set_edge_irqs(TERPS_MODE_DUAL);
+            g_config.mode = TERPS_MODE_DUAL;
+        } else if (strncmp(arg, "REF", 3) == 0) {
+            if (!ref_clock_enabled()) {
+                usb_cdc_write_line("ERR NO_REF\n");
+                usb_cdc_write_line("END\n");
+                return;
+            }
+            g_config.mode = TERPS_MODE_REF;
+        } else {
+            usb_cdc_write_line("ERR BAD_MODE\n");
+            usb_cdc_write_line("END\n");
+            return;
+        }
+    }
+    // Core1 picks the new mode up when it opens the next window.
+    freq_counter_set_edge_irqs(g_config.mode);
+    char line[48];
+    snprintf(line, sizeof(line), "OK MODE=%s\n", mode_name(g_config.mode));
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_edge_status(void)
+{
+    freq_edge_stats_t stats;
+    freq_counter_edge_stats(&stats);
+    char line[160];
+    snprintf(line,
+             sizeof(line),
+             "OK MODE=%s RISE=%lu FALL=%lu F_RISE=%.4f F_FALL=%.4f DUTY=%.4f GLITCHES=%lu\n",
+             mode_name(stats.mode),
+             (unsigned long)stats.rise_edges,
+             (unsigned long)stats.fall_edges,
+             (double)stats.f_rise_hz,
+             (double)stats.f_fall_hz,
+             (double)stats.duty_x1e4 / 1e4,
+             (unsigned long)stats.glitch_count);
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_ref_status(void)
+{
+    ref_clock_status_t st;
+    ref_clock_status(&st);
+    usb_cdc_printf("OK ENABLED=%u GPIO=%lu HZ=%lu SLICE=%lu COUNT=%llu SAMPLES=%lu XTAL_PPM=%.3f SPAN_MS=%lu\n",
+                   st.enabled ? 1u : 0u,
+                   (unsigned long)(st.enabled ? st.gpio : 0u),
+                   (unsigned long)st.hz,
+                   (unsigned long)st.slice,
+                   (unsigned long long)st.count,
+                   (unsigned long)st.samples,
+                   (double)st.xtal_ppm,
+                   (unsigned long)st.span_ms);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_meas_last(void)
+{
+    terps_latest_t m;
+    if (!latest_read(&m)) {
+        usb_cdc_write_line("ERR NO_DATA\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    const uint64_t now = time_us_64();
+    char line[384];
+    snprintf(line,
+             sizeof(line),
+             "OK WINDOWS=%lu TS_MS=%lu F_HZ=%.4f TAU_MS=%u PULSES=%lu DIODE_UV=%ld GAIN=%u FLAGS=0x%02X MODE=%s "
+             "SLOT=%ld PPM=%.2f START_US=%llu END_US=%llu AGE_US=%llu RETRIES=%lu\n",
+             (unsigned long)m.windows,
+             (unsigned long)m.frame.ts_ms,
+             (double)m.frame.f_hz_x1e4 / 1e4,
+             (unsigned)m.frame.tau_ms,
+             (unsigned long)m.pulses,
+             (long)m.frame.diode_uV,
+             (unsigned)m.frame.adc_gain,
+             (unsigned)m.frame.flags,
+             mode_name((terps_mode_t)m.frame.mode),
+             m.frame.slot == FREQ_SLOT_NONE ? -1L : (long)m.frame.slot,
+             (double)m.frame.ppm_corr,
+             (unsigned long long)m.start_us,
+             (unsigned long long)m.end_us,
+             (unsigned long long)(now > m.end_us ? now - m.end_us : 0u),
+             (unsigned long)latest_retries());
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_adc_status(void)
+{
+    critical_section_enter_blocking(&g_adc_lock);
+    const ads1220_plan_t plan = g_adc_plan;
+    const uint32_t window_ms = g_adc_window_ms;
+    const uint32_t frames = g_adc_frames;
+    const uint32_t fresh_total = g_adc_fresh_total;
+    const uint16_t fresh_min = frames ? g_adc_fresh_min : 0;
+    const uint32_t reused = g_adc_reused;
+    critical_section_exit(&g_adc_lock);
+    char line[200];
+    snprintf(line,
+             sizeof(line),
+             "OK AUTO=%u RATE=%u OPMODE=%s MAINS=%u WINDOW_MS=%lu PER_WINDOW=%u NOISE_NV=%lu TARGET_NV=%lu "
+             "FRAMES=%lu FRESH_MEAN=%.2f FRESH_MIN=%u REUSED=%lu\n",
+             g_config.adc_auto_rate ? 1u : 0u,
+             (unsigned)plan.rate_sps,
+             plan.op_mode == ADS1220_OP_TURBO ? "TURBO" : "NORMAL",
+             plan.mains_reject ? 1u : 0u,
+             (unsigned long)window_ms,
+             (unsigned)plan.per_window,
+             (unsigned long)plan.noise_nV,
+             (unsigned long)g_config.adc_noise_target_nV,
+             (unsigned long)frames,
+             frames ? (double)fresh_total / (double)frames : 0.0,
+             (unsigned)fresh_min,
+             (unsigned long)reused);
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static uint32_t adc_window_ms(void)
+{
+    freq_schedule_status_t sched;
+    freq_counter_schedule_status(&sched);
+    if (sched.active) {
+        return (sched.period_us + 500u) / 1000u;
+    }
+    return g_config.tau_ms;
+}
+
+static void handle_adc_auto(const char *args)
+{
+    unsigned auto_rate = 1;
+    unsigned long target_nV = g_config.adc_noise_target_nV;
+    sscanf(args, "%u %lu", &auto_rate, &target_nV);
+    g_config.adc_auto_rate = auto_rate != 0;
+    g_config.adc_noise_target_nV = (uint32_t)target_nV;
+    adc_replan(adc_window_ms());
+    handle_adc_status();
+}
+
+static void handle_adc_rate(const char *args)
+{
+    unsigned rate = 0;
+    char op[8] = "NORMAL";
+    if (sscanf(args, "%u %7s", &rate, op) < 1 || rate == 0) {
+        usb_cdc_write_line("ERR ARGS\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    critical_section_enter_blocking(&g_adc_lock);
+    g_config.adc_auto_rate = false;
+    g_adc_plan.rate_sps = (uint16_t)rate;
+    g_adc_plan.op_mode = strncmp(op, "TURBO", 5) == 0 ? ADS1220_OP_TURBO : ADS1220_OP_NORMAL;
+    g_adc_plan.mains_reject = g_config.adc_mains_reject && g_adc_plan.op_mode == ADS1220_OP_NORMAL && rate <= 20u;
+    critical_section_exit(&g_adc_lock);
+    adc_replan(adc_window_ms());
+    handle_adc_status();
+}
+
+static void handle_time_now(void)
+{
+    char line[48];
+    snprintf(line, sizeof(line), "OK T_US=%llu\n", (unsigned long long)time_us_64());
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_sched_status(void)
+{
+    freq_schedule_status_t status;
+    freq_counter_schedule_status(&status);
+    char line[160];
+    snprintf(line,
+             sizeof(line),
+             "OK ACTIVE=%u NEXT_US=%llu PERIOD_US=%lu PERIOD_FRAC=%u SLOT=%lu WINDOWS=%lu LATE_MAX_US=%lu "
+             "NOW_US=%llu\n",
+             status.active ? 1u : 0u,
+             (unsigned long long)status.next_us,
+             (unsigned long)status.period_us,
+             (unsigned)status.period_frac,
+             (unsigned long)status.next_slot,
+             (unsigned long)status.windows,
+             (unsigned long)status.late_max_us,
+             (unsigned long long)time_us_64());
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_sched_start(const char *args)
+{
+    unsigned long long start_us = 0;
+    unsigned long period_us = 0;
+    unsigned long first_slot = 0;
+    unsigned long period_frac = 0;
+    if (sscanf(args, "%llu %lu %lu %lu", &start_us, &period_us, &first_slot, &period_frac) < 2 ||
+        period_frac > 0xFFFFu) {
+        usb_cdc_write_line("ERR ARGS\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    if (start_us <= time_us_64()) {
+        usb_cdc_write_line("ERR PAST\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    if (!freq_counter_schedule((uint64_t)start_us, (uint32_t)period_us, (uint16_t)period_frac, (uint32_t)first_slot)) {
+        usb_cdc_write_line("ERR SCHED\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    adc_replan(adc_window_ms());
+    handle_sched_status();
+}
+
+static void handle_settle_status(void)
+{
+    critical_section_enter_blocking(&g_settle_lock);
+    const settle_detector_t det = g_settle;
+    critical_section_exit(&g_settle_lock);
+    char line[320];
+    snprintf(line,
+             sizeof(line),
+             "OK SETTLED=%u FILL=%u WINDOW=%u HOLD=%u PASSING=%u SETTLE_MS=%lu DROPS=%lu "
+             "F_SLOPE=%.6f F_NOISE=%.6f V_SLOPE=%.3f V_NOISE=%.3f "
+             "F_SLOPE_MAX=%.6f F_NOISE_MAX=%.6f V_SLOPE_MAX=%.3f V_NOISE_MAX=%.3f\n",
+             det.settled ? 1u : 0u,
+             (unsigned)det.fill,
+             (unsigned)det.limits.window,
+             (unsigned)det.limits.hold,
+             (unsigned)det.passing,
+             (unsigned long)det.settled_ms,
+             (unsigned long)det.transitions,
+             (double)det.f_slope_hz_s,
+             (double)det.f_noise_hz,
+             (double)det.v_slope_uV_s,
+             (double)det.v_noise_uV,
+             (double)det.limits.f_slope_hz_s,
+             (double)det.limits.f_noise_hz,
+             (double)det.limits.v_slope_uV_s,
+             (double)det.limits.v_noise_uV);
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_settle_set(const char *args)
+{
+    critical_section_enter_blocking(&g_settle_lock);
+    settle_limits_t limits = g_settle.limits;
+    critical_section_exit(&g_settle_lock);
+    unsigned window = limits.window;
+    unsigned hold = limits.hold;
+    if (sscanf(args,
+               "%u %u %f %f %f %f",
+               &window,
+               &hold,
+               &limits.f_slope_hz_s,
+               &limits.f_noise_hz,
+               &limits.v_slope_uV_s,
+               &limits.v_noise_uV) < 1 ||
+        window < 3u || window > SETTLE_MAX_WINDOW) {
+        usb_cdc_write_line("ERR ARGS\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    limits.window = (uint16_t)window;
+    limits.hold = (uint16_t)hold;
+    critical_section_enter_blocking(&g_settle_lock);
+    settle_init(&g_settle, &limits);
+    critical_section_exit(&g_settle_lock);
+    handle_settle_status();
+}
+
+static int format_ring_stats(char *out, size_t len, const char *prefix, const ipc_ring_t *ring)
+{
+    ipc_ring_stats_t st;
+    ipc_ring_stats(ring, &st);
+    const uint32_t lat_avg = st.popped ? (uint32_t)(st.lat_sum_us / st.popped) : 0u;
+    return snprintf(out,
+                    len,
+                    " %s_PUSHED=%lu %s_DROPPED=%lu %s_DOORBELLS=%lu %s_COALESCED=%lu %s_FIFO_FULL=%lu"
+                    " %s_POPPED=%lu %s_WAKEUPS=%lu %s_EMPTY=%lu %s_LAT_US=%lu/%lu/%lu",
+                    prefix, (unsigned long)st.pushed,
+                    prefix, (unsigned long)st.dropped,
+                    prefix, (unsigned long)st.doorbells,
+                    prefix, (unsigned long)st.coalesced,
+                    prefix, (unsigned long)st.fifo_full,
+                    prefix, (unsigned long)st.popped,
+                    prefix, (unsigned long)st.wakeups,
+                    prefix, (unsigned long)st.empty_checks,
+                    prefix, (unsigned long)(st.popped ? st.lat_min_us : 0u),
+                    (unsigned long)lat_avg,
+                    (unsigned long)st.lat_max_us);
+}
+
+static void handle_ipc_status(void)
+{
+    // Worst case with 10-digit counters is 542 bytes including the newline.
+    char line[576];
+    int pos = snprintf(line,
+                       sizeof(line),
+                       "OK MODE=%s SLEEPS0=%lu SLEEPS1=%lu",
+                       ipc_get_mode() == IPC_MODE_POLL ? "POLL" : "DOORBELL",
+                       (unsigned long)ipc_sleeps(0),
+                       (unsigned long)ipc_sleeps(1));
+    if (pos > 0 && (size_t)pos < sizeof(line)) {
+        pos += format_ring_stats(line + pos, sizeof(line) - (size_t)pos, "FREQ", g_freq_ring);
+    }
+    if (pos > 0 && (size_t)pos < sizeof(line)) {
+        pos += format_ring_stats(line + pos, sizeof(line) - (size_t)pos, "FRAME", &g_frame_ring);
+    }
+    if (pos < 0) {
+        pos = 0;
+    }
+    if ((size_t)pos > sizeof(line) - 2) {
+        pos = (int)(sizeof(line) - 2);
+    }
+    // Always terminate the reply, or END would join it on the host side.
+    line[pos++] = '\n';
+    line[pos] = '\0';
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_tx_status(void)
+{
+    tx_pacer_t pacer;
+    bool auto_mode = true;
+    usb_cdc_tx_status(&pacer, &auto_mode);
+    static const char *const k_levels[] = {"NORMAL", "BATCH", "SUMMARY"};
+    usb_cdc_printf("OK AUTO=%u STEP=%u LEVEL=%s BATCH=%u MERGE=%u DRAIN_BPS=%lu CAPACITY_BPS=%lu "
+                   "DEMAND_BPS=%lu CHANGES=%lu STALLS=%lu DROPPED=%lu\n",
+                   auto_mode ? 1u : 0u,
+                   (unsigned)pacer.step,
+                   k_levels[tx_pacer_level(&pacer)],
+                   (unsigned)tx_pacer_batch(&pacer),
+                   (unsigned)tx_pacer_merge(&pacer),
+                   (unsigned long)pacer.drain_Bps,
+                   (unsigned long)pacer.capacity_Bps,
+                   (unsigned long)pacer.demand_Bps,
+                   (unsigned long)pacer.changes,
+                   (unsigned long)pacer.stalls,
+                   (unsigned long)pacer.dropped);
+    usb_cdc_write_line("END\n");
+}
+
+static const char *out_source_name(terps_out_source_t source)
+{
+    switch (source) {
+        case TERPS_OUT_FREQ:
+            return "FREQ";
+        case TERPS_OUT_PRESSURE:
+            return "PRESSURE";
+        case TERPS_OUT_OFF:
+        default:
+            return "OFF";
+    }
+}
+
+static void handle_out_status(void)
+{
+    ctrl_out_scale_t scale;
+    ctrl_out_stats_t st;
+    uint8_t cols = 0;
+    ctrl_out_get_scale(&scale);
+    ctrl_out_get_stats(&st);
+    const uint8_t rows = ctrl_out_poly_shape(&cols);
+    const uint32_t mean_us = st.updates ? (uint32_t)(st.sum_us / st.updates) : 0u;
+    char line[384];
+    snprintf(line,
+             sizeof(line),
+             "OK SRC=%s PWM_GPIO=%ld PWM_BITS=%u PWM_PERIOD_NS=%lu DAC=%u DAC_CS=%ld "
+             "IN_LO=%.6g IN_HI=%.6g OUT_MIN=%.4f OUT_MAX=%.4f FAULT=%.4f POLY=%ux%u "
+             "VALUE=%.6g LEVEL=%.5f PWM_CODE=%u DAC_CODE=%u UPDATES=%lu FAULTS=%lu CLAMPED=%lu "
+             "LAT_US=%lu LAT_MAX_US=%lu LAT_MEAN_US=%lu\n",
+             out_source_name(scale.source),
+             g_config.out_pwm_gpio == TERPS_GPIO_UNUSED ? -1L : (long)g_config.out_pwm_gpio,
+             (unsigned)g_config.out_pwm_bits,
+             (unsigned long)ctrl_out_pwm_period_ns(),
+             (unsigned)g_config.out_dac,
+             g_config.out_dac_cs_gpio == TERPS_GPIO_UNUSED ? -1L : (long)g_config.out_dac_cs_gpio,
+             (double)scale.in_lo,
+             (double)scale.in_hi,
+             (double)scale.out_min,
+             (double)scale.out_max,
+             (double)scale.fault_level,
+             (unsigned)rows,
+             (unsigned)cols,
+             (double)st.value,
+             (double)st.level,
+             (unsigned)st.pwm_code,
+             (unsigned)st.dac_code,
+             (unsigned long)st.updates,
+             (unsigned long)st.faults,
+             (unsigned long)st.clamped,
+             (unsigned long)st.last_us,
+             (unsigned long)st.max_us,
+             (unsigned long)mean_us);
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void out_error(const char *reply)
+{
+    usb_cdc_write_line(reply);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_out_src(const char *arg)
+{
+    while (*arg == ' ') {
+        arg++;
+    }
+    ctrl_out_scale_t scale;
+    ctrl_out_get_scale(&scale);
+    if (strncmp(arg, "OFF", 3) == 0) {
+        scale.source = TERPS_OUT_OFF;
+    } else if (strncmp(arg, "FREQ", 4) == 0) {
+        scale.source = TERPS_OUT_FREQ;
+    } else if (strncmp(arg, "PRESSURE", 8) == 0) {
+        if (ctrl_out_poly_shape(NULL) == 0) {
+            out_error("ERR NO_POLY\n");
+            return;
+        }
+        scale.source = TERPS_OUT_PRESSURE;
+    } else {
+        out_error("ERR ARG\n");
+        return;
+    }
+    ctrl_out_set_scale(&scale);
+    handle_out_status();
+}
+
+static void handle_out_scale(const char *args)
+{
+    ctrl_out_scale_t scale;
+    ctrl_out_get_scale(&scale);
+    if (sscanf(args, "%f %f %f %f", &scale.in_lo, &scale.in_hi, &scale.out_min, &scale.out_max) < 2 ||
+        scale.in_hi == scale.in_lo || scale.out_min < 0.0f || scale.out_max > 1.0f ||
+        scale.out_min > scale.out_max) {
+        out_error("ERR ARGS\n");
+        return;
+    }
+    ctrl_out_set_scale(&scale);
+    handle_out_status();
+}
+
+static void handle_out_fault(const char *arg)
+{
+    ctrl_out_scale_t scale;
+    ctrl_out_get_scale(&scale);
+    float level = -1.0f;
+    while (*arg == ' ') {
+        arg++;
+    }
+    if (strncmp(arg, "HOLD", 4) != 0 && (sscanf(arg, "%f", &level) != 1 || level < 0.0f || level > 1.0f)) {
+        out_error("ERR ARG\n");
+        return;
+    }
+    scale.fault_level = level;
+    ctrl_out_set_scale(&scale);
+    handle_out_status();
+}
+
+static void handle_out_poly(const char *args)
+{
+    unsigned rows = 0;
+    unsigned cols = 0;
+    double x = 0.0;
+    double y = 0.0;
+    if (sscanf(args, "%u %u %lf %lf", &rows, &cols, &x, &y) != 4 || rows == 0 || cols == 0 ||
+        rows > CTRL_OUT_POLY_MAX || cols > CTRL_OUT_POLY_MAX) {
+        out_error("ERR ARGS\n");
+        return;
+    }
+    memset(&g_out_poly_stage, 0, sizeof(g_out_poly_stage));
+    g_out_poly_stage.rows = (uint8_t)rows;
+    g_out_poly_stage.cols = (uint8_t)cols;
+    g_out_poly_stage.x = x;
+    g_out_poly_stage.y = y;
+    g_out_poly_missing = 0;
+    for (unsigned i = 0; i < rows; ++i) {
+        for (unsigned j = 0; j < cols; ++j) {
+            g_out_poly_missing |= 1ull << (i * CTRL_OUT_POLY_MAX + j);
+        }
+    }
+    usb_cdc_printf("OK STAGED=%ux%u\n", rows, cols);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_out_k(const char *args)
+{
+    unsigned i = 0;
+    unsigned j = 0;
+    double k = 0.0;
+    if (sscanf(args, "%u %u %lf", &i, &j, &k) != 3 || i >= g_out_poly_stage.rows || j >= g_out_poly_stage.cols) {
+        out_error("ERR ARGS\n");
+        return;
+    }
+    g_out_poly_stage.k[i][j] = k;
+    g_out_poly_missing &= ~(1ull << (i * CTRL_OUT_POLY_MAX + j));
+    usb_cdc_write_line("OK\n");
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_out_poly_commit(void)
+{
+    if (g_out_poly_stage.rows == 0 || g_out_poly_missing != 0) {
+        out_error("ERR INCOMPLETE\n");
+        return;
+    }
+    ctrl_out_set_poly(&g_out_poly_stage);
+    handle_out_status();
+}
+
+static void handle_uart_status(void)
+{
+    uart_out_stats_t st;
+    uart_out_get_stats(&st);
+    const uint32_t mean_us = st.queued ? (uint32_t)(st.wire_sum_us / st.queued) : 0u;
+    char line[384];
+    snprintf(line,
+             sizeof(line),
+             "OK ENABLED=%u TX_GPIO=%ld BAUD=%lu DE_GPIO=%ld DE_LEAD_US=%u DE_TAIL_US=%u "
+             "QUEUED=%lu SENT=%lu BYTES=%lu DROPPED=%lu ENCODE_ERR=%lu DEPTH_MAX=%u SLOTS=%u DE_CYCLES=%lu "
+             "START_US=%lu START_MAX_US=%lu WIRE_US=%lu WIRE_MAX_US=%lu WIRE_MEAN_US=%lu\n",
+             uart_out_enabled() ? 1u : 0u,
+             g_config.uart_tx_gpio == TERPS_GPIO_UNUSED ? -1L : (long)g_config.uart_tx_gpio,
+             (unsigned long)g_config.uart_baud,
+             g_config.uart_de_gpio == TERPS_GPIO_UNUSED ? -1L : (long)g_config.uart_de_gpio,
+             (unsigned)g_config.uart_de_lead_us,
+             (unsigned)g_config.uart_de_tail_us,
+             (unsigned long)st.queued,
+             (unsigned long)st.sent,
+             (unsigned long)st.bytes,
+             (unsigned long)st.dropped,
+             (unsigned long)st.encode_errors,
+             (unsigned)st.depth_max,
+             (unsigned)UART_OUT_SLOTS,
+             (unsigned long)st.de_cycles,
+             (unsigned long)st.start_last_us,
+             (unsigned long)st.start_max_us,
+             (unsigned long)st.wire_last_us,
+             (unsigned long)st.wire_max_us,
+             (unsigned long)mean_us);
+    usb_cdc_write_line(line);
+    usb_cdc_write_line("END\n");
+}
+
+static void handle_ipc_mode(const char *arg)
+{
+    while (*arg == ' ') {
+        arg++;
+    }
+    if (strncmp(arg, "POLL", 4) == 0) {
+        ipc_set_mode(IPC_MODE_POLL);
+    } else if (strncmp(arg, "DOORBELL", 8) == 0) {
+        ipc_set_mode(IPC_MODE_DOORBELL);
+    } else {
+        usb_cdc_write_line("ERR ARG\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    // Counters restart so the two modes can be compared over equal runs.
+    ipc_ring_reset_stats(g_freq_ring);
+    ipc_ring_reset_stats(&g_frame_ring);
+    handle_ipc_status();
+}
+
+static const char *frame_type_name(uint8_t type)
+{
+    switch (type) {
+    case FRAME_TYPE_U8:
+        return "u8";
+    case FRAME_TYPE_I8:
+        return "i8";
+    case FRAME_TYPE_U16:
+        return "u16";
+    case FRAME_TYPE_I16:
+        return "i16";
+    case FRAME_TYPE_U32:
+        return "u32";
+    case FRAME_TYPE_I32:
+        return "i32";
+    case FRAME_TYPE_F32:
+        return "f32";
+    default:
+        return "?";
+    }
+}
+
+static void handle_schema(void)
+{
+    usb_cdc_printf("OK VER=%u TYPES=%u\n", (unsigned)FRAME_SCHEMA_VERSION, (unsigned)frame_schema_count());
+    for (size_t i = 0; i < frame_schema_count(); ++i) {
+        const frame_schema_t *schema = frame_schema_at(i);
+        usb_cdc_printf("T 0x%02X LEN=%u FIELDS=%u\n",
+                       (unsigned)schema->packet_type,
+                       (unsigned)schema->payload_len,
+                       (unsigned)schema->nfields);
+        unsigned offset = 0;
+        for (uint8_t f = 0; f < schema->nfields; ++f) {
+            const frame_field_desc_t *field = &schema->fields[f];
+            usb_cdc_printf("F %u %s %s %u %d %u\n",
+                           (unsigned)field->id,
+                           field->name,
+                           frame_type_name(field->type),
+                           offset,
+                           (int)field->scale_exp,
+                           (unsigned)field->attr);
+            offset += frame_field_size(field->type);
+        }
+    }
+    usb_cdc_write_line("END\n");
+    if (g_binary_mode) {
+        usb_cdc_request_schema();
+    }
+}
+
 static void handle_info_dev(void)
 {
     char line[180];
@@ -266,6 +1515,12 @@ static void handle_info_dev(void)
                         (unsigned)g_eeprom_cache.device_address,
                         (unsigned)g_eeprom_cache.length);
     }
+    if (pos > 0 && (size_t)pos < sizeof(line)) {
+        pos += snprintf(line + pos,
+                        sizeof(line) - (size_t)pos,
+                        " trace_dropped=%lu",
+                        (unsigned long)trace_log_dropped());
+    }
     if (pos >= 0 && (size_t)pos < sizeof(line) - 1) {
         line[pos++] = '\n';
         line[pos] = '\0';
@@ -289,11 +1544,216 @@ static void handle_cdc_command(const char *line)
         handle_eeprom_dump((uint16_t)(addr & 0xFFFFu), (size_t)length);
         return;
     }
+    if (strncmp(line, "EEPROM.READB", 12) == 0) {
+        uint32_t addr = 0;
+        uint32_t length = sizeof(g_eeprom_cache.bytes);
+        int consumed = sscanf(line + 12, "%u %u", &addr, &length);
+        if (consumed <= 0) {
+            addr = 0;
+            length = sizeof(g_eeprom_cache.bytes);
+        } else if (consumed == 1) {
+            length = sizeof(g_eeprom_cache.bytes);
+        }
+        handle_eeprom_readb((uint16_t)(addr & 0xFFFFu), (size_t)length);
+        return;
+    }
+    if (strncmp(line, "EEPROM.SCAN", 11) == 0) {
+        uint32_t addr = 0;
+        uint32_t length = 0;
+        sscanf(line + 11, "%u %u", &addr, &length);
+        handle_eeprom_scan((uint16_t)(addr > 0xFFFFu ? 0xFFFFu : addr), (size_t)length);
+        return;
+    }
+    if (strncmp(line, "EEPROM.BUSES", 12) == 0) {
+        report_eeprom_buses();
+        return;
+    }
     if (strncmp(line, "EEPROM.PARSE", 12) == 0) {
         usb_cdc_write_line("ERR UNSUPPORTED\n");
         usb_cdc_write_line("END\n");
         return;
     }
+    if (strncmp(line, "CAPTURE.START", 13) == 0) {
+        uint32_t max_edges = 0;
+        sscanf(line + 13, "%u", &max_edges);
+        edge_capture_start(max_edges);
+        usb_cdc_write_line("OK\n");
+        usb_cdc_write_line("END\n");
+        return;
+    }
+    if (strncmp(line, "CAPTURE.STOP", 12) == 0) {
+        edge_capture_stop();
+        handle_capture_status();
+        return;
+    }
+    if (strncmp(line, "CAPTURE.STATUS", 14) == 0) {
+        handle_capture_status();
+        return;
+    }
+    if (strncmp(line, "CAPTURE.READ", 12) == 0) {
+        uint32_t offset = 0;
+        uint32_t length = CAPTURE_READ_CHUNK;
+        sscanf(line + 12, "%u %u", &offset, &length);
+        handle_capture_read(offset, length);
+        return;
+    }
+    if (strncmp(line, "EDGE.MODE", 9) == 0) {
+        handle_edge_mode(line + 9);
+        return;
+    }
+    if (strncmp(line, "EDGE.STATUS", 11) == 0) {
+        handle_edge_status();
+        return;
+    }
+    if (strncmp(line, "MEAS.LAST", 9) == 0) {
+        handle_meas_last();
+        return;
+    }
+    if (strncmp(line, "REF.STATUS", 10) == 0) {
+        handle_ref_status();
+        return;
+    }
+    if (strncmp(line, "HIST.STATUS", 11) == 0) {
+        handle_hist_status();
+        return;
+    }
+    if (strncmp(line, "HIST.RESET", 10) == 0) {
+        handle_hist_reset();
+        return;
+    }
+    if (strncmp(line, "HIST.READB", 10) == 0) {
+        char series = 'F';
+        sscanf(line + 10, " %c", &series);
+        handle_hist_readb(series);
+        return;
+    }
+    if (strncmp(line, "ADC.STATUS", 10) == 0) {
+        handle_adc_status();
+        return;
+    }
+    if (strncmp(line, "ADC.AUTO", 8) == 0) {
+        handle_adc_auto(line + 8);
+        return;
+    }
+    if (strncmp(line, "ADC.RATE", 8) == 0) {
+        handle_adc_rate(line + 8);
+        return;
+    }
+    if (strncmp(line, "TIME.NOW", 8) == 0) {
+        handle_time_now();
+        return;
+    }
+    if (strncmp(line, "SCHED.START", 11) == 0) {
+        handle_sched_start(line + 11);
+        return;
+    }
+    if (strncmp(line, "SCHED.STOP", 10) == 0) {
+        freq_counter_unschedule();
+        adc_replan(adc_window_ms());
+        handle_sched_status();
+        return;
+    }
+    if (strncmp(line, "SCHED.STATUS", 12) == 0) {
+        handle_sched_status();
+        return;
+    }
+    if (strncmp(line, "SETTLE.STATUS", 13) == 0) {
+        handle_settle_status();
+        return;
+    }
+    if (strncmp(line, "SETTLE.RESET", 12) == 0) {
+        critical_section_enter_blocking(&g_settle_lock);
+        settle_reset(&g_settle);
+        critical_section_exit(&g_settle_lock);
+        handle_settle_status();
+        return;
+    }
+    if (strncmp(line, "SETTLE.SET", 10) == 0) {
+        handle_settle_set(line + 10);
+        return;
+    }
+    if (strncmp(line, "IPC.STATUS", 10) == 0) {
+        handle_ipc_status();
+        return;
+    }
+    if (strncmp(line, "IPC.MODE", 8) == 0) {
+        handle_ipc_mode(line + 8);
+        return;
+    }
+    if (strncmp(line, "IPC.RESET", 9) == 0) {
+        ipc_ring_reset_stats(g_freq_ring);
+        ipc_ring_reset_stats(&g_frame_ring);
+        handle_ipc_status();
+        return;
+    }
+    if (strncmp(line, "TX.STATUS", 9) == 0) {
+        handle_tx_status();
+        return;
+    }
+    if (strncmp(line, "TX.STEP", 7) == 0) {
+        unsigned step = 0;
+        if (sscanf(line + 7, "%u", &step) != 1) {
+            usb_cdc_write_line("ERR ARG\n");
+            usb_cdc_write_line("END\n");
+            return;
+        }
+        usb_cdc_tx_set(false, (uint8_t)(step > 0xFFu ? 0xFFu : step));
+        handle_tx_status();
+        return;
+    }
+    if (strncmp(line, "TX.AUTO", 7) == 0) {
+        tx_pacer_t pacer;
+        usb_cdc_tx_status(&pacer, NULL);
+        usb_cdc_tx_set(true, pacer.step);
+        handle_tx_status();
+        return;
+    }
+    if (strncmp(line, "OUT.STATUS", 10) == 0) {
+        handle_out_status();
+        return;
+    }
+    if (strncmp(line, "OUT.RESET", 9) == 0) {
+        ctrl_out_reset_stats();
+        handle_out_status();
+        return;
+    }
+    if (strncmp(line, "OUT.SRC", 7) == 0) {
+        handle_out_src(line + 7);
+        return;
+    }
+    if (strncmp(line, "OUT.SCALE", 9) == 0) {
+        handle_out_scale(line + 9);
+        return;
+    }
+    if (strncmp(line, "OUT.FAULT", 9) == 0) {
+        handle_out_fault(line + 9);
+        return;
+    }
+    if (strncmp(line, "OUT.POLY.COMMIT", 15) == 0) {
+        handle_out_poly_commit();
+        return;
+    }
+    if (strncmp(line, "OUT.POLY", 8) == 0) {
+        handle_out_poly(line + 8);
+        return;
+    }
+    if (strncmp(line, "OUT.K", 5) == 0) {
+        handle_out_k(line + 5);
+        return;
+    }
+    if (strncmp(line, "UART.STATUS", 11) == 0) {
+        handle_uart_status();
+        return;
+    }
+    if (strncmp(line, "UART.RESET", 10) == 0) {
+        uart_out_reset_stats();
+        handle_uart_status();
+        return;
+    }
+    if (strncmp(line, "SCHEMA", 6) == 0) {
+        handle_schema();
+        return;
+    }
     if (strncmp(line, "INFO.DEV", 8) == 0) {
         handle_info_dev();
         return;
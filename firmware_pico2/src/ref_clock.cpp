@@ -0,0 +1,153 @@
+#include "ref_clock.h"
+
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+#include "terps_config.h"
+
+#define REF_CLOCK_MIN_KEEPALIVE_US 100
+
+static bool g_enabled = false;
+static uint32_t g_gpio = 0;
+static uint32_t g_hz = 0;
+static uint32_t g_slice = 0;
+static critical_section_t g_lock;
+static uint16_t g_last_raw = 0;
+static uint64_t g_count = 0;
+static uint32_t g_samples = 0;
+static int64_t g_keepalive_us = 0;
+static uint64_t g_t0_us = 0;
+static uint64_t g_t_last_us = 0;
+static uint64_t g_count_at_t_last = 0;
+
+static int64_t keepalive_cb(alarm_id_t id, void *user_data)
+{
+    (void)id;
+    (void)user_data;
+    const uint16_t raw = ref_clock_raw();
+    const uint64_t now = time_us_64();
+    const uint64_t count = ref_clock_extend(raw);
+    critical_section_enter_blocking(&g_lock);
+    g_t_last_us = now;
+    g_count_at_t_last = count;
+    critical_section_exit(&g_lock);
+    return -g_keepalive_us;
+}
+
+bool ref_clock_init(uint32_t gpio, uint32_t hz)
+{
+    g_enabled = false;
+    if (gpio == TERPS_GPIO_UNUSED || hz == 0 || pwm_gpio_to_channel(gpio) != PWM_CHAN_B) {
+        return false;
+    }
+    g_gpio = gpio;
+    g_hz = hz;
+    g_slice = pwm_gpio_to_slice_num(gpio);
+    // ref_clock_extend() runs inside edge_counter's critical section, and nested
+    // critical sections must not share a striped spin lock, so claim our own.
+    if (!critical_section_is_initialized(&g_lock)) {
+        critical_section_init_with_lock_num(&g_lock, (uint)spin_lock_claim_unused(true));
+    }
+
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+    pwm_config cfg = pwm_get_default_config();
+    pwm_config_set_clkdiv_mode(&cfg, PWM_DIV_B_RISING);
+    pwm_config_set_clkdiv(&cfg, 1.0f);
+    pwm_config_set_wrap(&cfg, 0xFFFFu);
+    pwm_init(g_slice, &cfg, true);
+
+    g_last_raw = pwm_get_counter(g_slice);
+    g_count = 0;
+    g_samples = 0;
+    g_t0_us = time_us_64();
+    g_t_last_us = g_t0_us;
+    g_count_at_t_last = 0;
+    g_enabled = true;
+
+    // A quarter wrap keeps every pair of samples within the signed 16-bit range.
+    g_keepalive_us = (int64_t)((16384ull * 1000000ull) / hz);
+    if (g_keepalive_us < REF_CLOCK_MIN_KEEPALIVE_US) {
+        g_keepalive_us = REF_CLOCK_MIN_KEEPALIVE_US;
+    }
+    add_alarm_in_us(g_keepalive_us, keepalive_cb, NULL, true);
+    return true;
+}
+
+bool ref_clock_enabled(void)
+{
+    return g_enabled;
+}
+
+uint32_t ref_clock_slice(void)
+{
+    return g_slice;
+}
+
+uint32_t ref_clock_hz(void)
+{
+    return g_hz;
+}
+
+uint16_t __not_in_flash_func(ref_clock_raw)(void)
+{
+    return g_enabled ? pwm_get_counter(g_slice) : 0u;
+}
+
+uint64_t ref_clock_extend(uint16_t raw)
+{
+    critical_section_enter_blocking(&g_lock);
+    const int16_t delta = (int16_t)(uint16_t)(raw - g_last_raw);
+    uint64_t count;
+    if (delta >= 0) {
+        g_count += (uint64_t)delta;
+        g_last_raw = raw;
+        g_samples++;
+        count = g_count;
+    } else {
+        // Latched before the previous sample (e.g. by an IRQ that waited on the lock).
+        count = g_count - (uint64_t)(-(int32_t)delta);
+    }
+    critical_section_exit(&g_lock);
+    return count;
+}
+
+int32_t ref_clock_ratio_x1e4(uint32_t periods, uint64_t cycles, uint32_t ref_hz)
+{
+    if (cycles == 0) {
+        return 0;
+    }
+    // periods * ref_hz fits easily; splitting off the whole part keeps the
+    // scaled remainder below cycles * 1e4, so nothing overflows.
+    const uint64_t num = (uint64_t)periods * ref_hz;
+    const uint64_t whole = num / cycles;
+    const uint64_t rem = num % cycles;
+    const uint64_t value = whole * 10000ull + (rem * 10000ull + cycles / 2u) / cycles;
+    return value > (uint64_t)INT32_MAX ? INT32_MAX : (int32_t)value;
+}
+
+void ref_clock_status(ref_clock_status_t *out)
+{
+    out->enabled = g_enabled;
+    out->gpio = g_gpio;
+    out->hz = g_hz;
+    out->slice = g_slice;
+    out->xtal_ppm = 0.0f;
+    out->span_ms = 0;
+    if (!g_enabled) {
+        out->count = 0;
+        out->samples = 0;
+        return;
+    }
+    critical_section_enter_blocking(&g_lock);
+    out->count = g_count;
+    out->samples = g_samples;
+    const uint64_t span_us = g_t_last_us - g_t0_us;
+    const uint64_t cycles = g_count_at_t_last;
+    critical_section_exit(&g_lock);
+    if (cycles > 0) {
+        const double ref_us = (double)cycles * 1e6 / (double)g_hz;
+        out->xtal_ppm = (float)(((double)span_us - ref_us) / ref_us * 1e6);
+        out->span_ms = (uint32_t)(span_us / 1000u);
+    }
+}
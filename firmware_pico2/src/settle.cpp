@@ -0,0 +1,138 @@
+#include "settle.h"
+
+#include <math.h>
+#include <string.h>
+
+#define SETTLE_RELEASE_FACTOR 1.5f
+
+typedef struct {
+    float slope;
+    float noise;
+} line_fit_t;
+
+static uint16_t clamp_window(uint16_t window)
+{
+    if (window < 3u) {
+        return 3u;
+    }
+    return window > SETTLE_MAX_WINDOW ? (uint16_t)SETTLE_MAX_WINDOW : window;
+}
+
+// Least-squares line through (t, y). Values are taken relative to the newest
+// sample so single-precision sums keep their resolution on a 30 kHz carrier.
+static line_fit_t fit_line(const settle_detector_t *det, const int32_t *series, float scale)
+{
+    const uint16_t n = det->fill;
+    const uint16_t cap = det->limits.window;
+    const uint16_t newest = (uint16_t)((det->head + cap - 1u) % cap);
+    const uint32_t t_ref = det->t_ms[newest];
+    const int32_t y_ref = series[newest];
+
+    float st = 0.0f;
+    float sy = 0.0f;
+    for (uint16_t i = 0; i < n; ++i) {
+        st += (float)(int32_t)(det->t_ms[i] - t_ref) * 1e-3f;
+        sy += (float)(series[i] - y_ref) * scale;
+    }
+    const float mt = st / (float)n;
+    const float my = sy / (float)n;
+    float stt = 0.0f;
+    float sty = 0.0f;
+    float syy = 0.0f;
+    for (uint16_t i = 0; i < n; ++i) {
+        const float dt = (float)(int32_t)(det->t_ms[i] - t_ref) * 1e-3f - mt;
+        const float dy = (float)(series[i] - y_ref) * scale - my;
+        stt += dt * dt;
+        sty += dt * dy;
+        syy += dy * dy;
+    }
+    line_fit_t fit = {0.0f, 0.0f};
+    if (stt > 0.0f) {
+        fit.slope = sty / stt;
+        syy -= fit.slope * sty;
+    }
+    fit.noise = sqrtf(fmaxf(syy, 0.0f) / (float)(n - 2u));
+    return fit;
+}
+
+static bool within(float value, float limit, float factor)
+{
+    return limit <= 0.0f || fabsf(value) <= limit * factor;
+}
+
+void settle_init(settle_detector_t *det, const settle_limits_t *limits)
+{
+    memset(det, 0, sizeof(*det));
+    det->limits = *limits;
+    det->limits.window = clamp_window(limits->window);
+    settle_reset(det);
+}
+
+void settle_reset(settle_detector_t *det)
+{
+    det->head = 0;
+    det->fill = 0;
+    det->passing = 0;
+    if (det->settled) {
+        det->transitions++;
+    }
+    det->settled = false;
+    det->settled_ms = 0;
+    det->armed_ms = 0;
+}
+
+bool settle_update(settle_detector_t *det, uint32_t t_ms, int32_t f_hz_x1e4, int32_t v_uV, bool valid)
+{
+    if (!valid) {
+        settle_reset(det);
+        return false;
+    }
+    const uint16_t cap = det->limits.window;
+    if (det->fill == 0) {
+        det->armed_ms = t_ms;
+    }
+    det->t_ms[det->head] = t_ms;
+    det->f_x1e4[det->head] = f_hz_x1e4;
+    det->v_uV[det->head] = v_uV;
+    det->head = (uint16_t)((det->head + 1u) % cap);
+    if (det->fill < cap) {
+        det->fill++;
+    }
+    if (det->fill < cap) {
+        return false;
+    }
+
+    const line_fit_t f = fit_line(det, det->f_x1e4, 1e-4f);
+    const line_fit_t v = fit_line(det, det->v_uV, 1.0f);
+    det->f_slope_hz_s = f.slope;
+    det->f_noise_hz = f.noise;
+    det->v_slope_uV_s = v.slope;
+    det->v_noise_uV = v.noise;
+
+    // Hysteresis: a settled sensor is only released once a statistic clears the
+    // limit by SETTLE_RELEASE_FACTOR, so fit noise near a limit does not toggle
+    // the flag. A real step overshoots the residual limit by far more than that.
+    const settle_limits_t *lim = &det->limits;
+    const float k = det->settled ? SETTLE_RELEASE_FACTOR : 1.0f;
+    const bool pass = within(f.slope, lim->f_slope_hz_s, k) && within(f.noise, lim->f_noise_hz, k) &&
+                      within(v.slope, lim->v_slope_uV_s, k) && within(v.noise, lim->v_noise_uV, k);
+    if (!pass) {
+        det->passing = 0;
+        if (det->settled) {
+            // Time the next settling from the disturbance, not from the first arm.
+            det->settled = false;
+            det->settled_ms = 0;
+            det->armed_ms = t_ms;
+            det->transitions++;
+        }
+        return false;
+    }
+    if (det->passing < UINT16_MAX) {
+        det->passing++;
+    }
+    if (!det->settled && det->passing >= lim->hold) {
+        det->settled = true;
+        det->settled_ms = t_ms - det->armed_ms;
+    }
+    return det->settled;
+}
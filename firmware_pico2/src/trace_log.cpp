@@ -0,0 +1,86 @@
+#include "trace_log.h"
+
+#include <string.h>
+
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+// One single-producer ring per core; core0 is the only consumer. Producers
+// mask local interrupts for the few stores it takes to fill a slot so IRQ
+// handlers on the same core cannot interleave with thread-level writers.
+#define TRACE_RING_DEPTH 64
+#define TRACE_CORE_COUNT 2
+
+typedef struct {
+    trace_entry_t entries[TRACE_RING_DEPTH];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+} trace_ring_t;
+
+static trace_ring_t g_rings[TRACE_CORE_COUNT];
+static uint32_t g_next_core = 0;
+
+void trace_log_init(void)
+{
+    memset(g_rings, 0, sizeof(g_rings));
+    g_next_core = 0;
+}
+
+void __not_in_flash_func(trace_log_write)(trace_id_t id,
+                                          uint8_t nargs,
+                                          uint32_t a0,
+                                          uint32_t a1,
+                                          uint32_t a2,
+                                          uint32_t a3)
+{
+    const uint core = get_core_num();
+    trace_ring_t *ring = &g_rings[core & 1u];
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    const uint32_t head = ring->head;
+    if (head - ring->tail >= TRACE_RING_DEPTH) {
+        ring->dropped++;
+        restore_interrupts(irq_state);
+        return;
+    }
+    trace_entry_t *entry = &ring->entries[head % TRACE_RING_DEPTH];
+    entry->ts_us = time_us_32();
+    entry->id = (uint16_t)id;
+    entry->core = (uint8_t)core;
+    entry->nargs = nargs > TRACE_LOG_MAX_ARGS ? TRACE_LOG_MAX_ARGS : nargs;
+    entry->args[0] = a0;
+    entry->args[1] = a1;
+    entry->args[2] = a2;
+    entry->args[3] = a3;
+    __dmb();
+    ring->head = head + 1;
+    restore_interrupts(irq_state);
+}
+
+bool trace_log_pop(trace_entry_t *out)
+{
+    if (out == NULL) {
+        return false;
+    }
+    // Alternate between cores so a chatty core cannot starve the other.
+    for (uint32_t i = 0; i < TRACE_CORE_COUNT; ++i) {
+        trace_ring_t *ring = &g_rings[(g_next_core + i) % TRACE_CORE_COUNT];
+        const uint32_t tail = ring->tail;
+        if (ring->head == tail) {
+            continue;
+        }
+        __dmb();
+        *out = ring->entries[tail % TRACE_RING_DEPTH];
+        __dmb();
+        ring->tail = tail + 1;
+        g_next_core = (g_next_core + i + 1) % TRACE_CORE_COUNT;
+        return true;
+    }
+    return false;
+}
+
+uint32_t trace_log_dropped(void)
+{
+    return g_rings[0].dropped + g_rings[1].dropped;
+}
@@ -0,0 +1,158 @@
+#include "tx_pacer.h"
+
+#include <string.h>
+
+#define TX_PACER_ALPHA 0.5f
+#define TX_PACER_RELEASE_MARGIN 0.7f
+#define TX_PACER_PROBE_HOLDS_MIN 4u
+#define TX_PACER_PROBE_HOLDS_MAX 64u
+
+void tx_pacer_default_limits(tx_pacer_limits_t *limits, uint32_t fifo_size)
+{
+    limits->fifo_size = fifo_size;
+    limits->batch_max = 8;
+    limits->batch_ms = 20;
+    limits->merge_max = 64;
+    limits->sample_ms = 50;
+    limits->hold_ms = 1000;
+    limits->high_fill = 0.75f;
+    limits->low_fill = 0.25f;
+}
+
+void tx_pacer_init(tx_pacer_t *pacer, const tx_pacer_limits_t *limits)
+{
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->limits = *limits;
+    if (pacer->limits.fifo_size == 0) {
+        pacer->limits.fifo_size = 1;
+    }
+    if (pacer->limits.batch_max == 0) {
+        pacer->limits.batch_max = 1;
+    }
+    uint8_t max_step = 1;
+    for (uint32_t merge = 2; merge <= pacer->limits.merge_max; merge *= 2u) {
+        max_step++;
+    }
+    pacer->max_step = max_step;
+    pacer->probe_holds = TX_PACER_PROBE_HOLDS_MIN;
+}
+
+void tx_pacer_set_step(tx_pacer_t *pacer, uint8_t step)
+{
+    pacer->step = step > pacer->max_step ? pacer->max_step : step;
+    pacer->calm_since_us = pacer->last_us;
+}
+
+static uint16_t merge_for(uint8_t step)
+{
+    return step >= 2 ? (uint16_t)(1u << (step - 1u)) : 1u;
+}
+
+void tx_pacer_offer(tx_pacer_t *pacer, uint32_t normal_bytes)
+{
+    pacer->offered += normal_bytes;
+}
+
+void tx_pacer_wrote(tx_pacer_t *pacer, uint32_t bytes)
+{
+    pacer->written += bytes;
+}
+
+void tx_pacer_stall(tx_pacer_t *pacer, uint32_t frames_lost)
+{
+    pacer->stall_pending = true;
+    pacer->stalls++;
+    pacer->dropped += frames_lost;
+}
+
+bool tx_pacer_sample(tx_pacer_t *pacer, uint64_t now_us, uint32_t fifo_free)
+{
+    const tx_pacer_limits_t *lim = &pacer->limits;
+    const uint32_t occupancy = fifo_free >= lim->fifo_size ? 0u : lim->fifo_size - fifo_free;
+    const uint32_t drained = pacer->written - occupancy;
+    if (!pacer->started) {
+        pacer->started = true;
+        pacer->last_us = now_us;
+        pacer->calm_since_us = now_us;
+        pacer->drained_prev = drained;
+        pacer->offered = 0;
+        return false;
+    }
+    const uint64_t dt_us = now_us - pacer->last_us;
+    if (dt_us < (uint64_t)lim->sample_ms * 1000u && !pacer->stall_pending) {
+        return false;
+    }
+    if (dt_us == 0) {
+        return false;
+    }
+    const float dt_s = (float)dt_us * 1e-6f;
+    const float drain = (float)(uint32_t)(drained - pacer->drained_prev) / dt_s;
+    const float demand = (float)pacer->offered / dt_s;
+    pacer->drain_Bps += TX_PACER_ALPHA * (drain - pacer->drain_Bps);
+    pacer->demand_Bps += TX_PACER_ALPHA * (demand - pacer->demand_Bps);
+    pacer->drained_prev = drained;
+    pacer->offered = 0;
+    pacer->last_us = now_us;
+
+    const float fill = (float)occupancy / (float)lim->fifo_size;
+    if (fill > lim->low_fill) {
+        // Data was waiting the whole time: what left is what the host can take.
+        pacer->capacity_Bps = pacer->capacity_at_us ? pacer->drain_Bps : drain;
+        pacer->capacity_at_us = now_us;
+    }
+
+    const uint64_t hold_us = (uint64_t)lim->hold_ms * 1000u;
+    uint8_t target = pacer->step;
+    if (pacer->stall_pending || fill >= lim->high_fill) {
+        if (target < pacer->max_step) {
+            target++;
+        }
+        if (pacer->down_at_us && now_us - pacer->down_at_us < 2u * hold_us &&
+            pacer->probe_holds < TX_PACER_PROBE_HOLDS_MAX) {
+            pacer->probe_holds = (uint8_t)(pacer->probe_holds * 2u);
+        }
+        pacer->down_at_us = 0;
+        pacer->calm_since_us = now_us;
+    } else if (fill <= lim->low_fill) {
+        if (target > 0 && now_us - pacer->calm_since_us >= hold_us) {
+            const float need = pacer->demand_Bps / (float)merge_for((uint8_t)(target - 1u));
+            const bool stale = pacer->capacity_at_us == 0 ||
+                               now_us - pacer->capacity_at_us >= hold_us * pacer->probe_holds;
+            if (stale || need < TX_PACER_RELEASE_MARGIN * pacer->capacity_Bps) {
+                target--;
+                pacer->down_at_us = now_us;
+                if (target == 0) {
+                    pacer->probe_holds = TX_PACER_PROBE_HOLDS_MIN;
+                }
+            }
+            pacer->calm_since_us = now_us;
+        }
+    } else {
+        pacer->calm_since_us = now_us;
+    }
+    pacer->stall_pending = false;
+    if (target == pacer->step) {
+        return false;
+    }
+    pacer->step = target;
+    pacer->changes++;
+    return true;
+}
+
+tx_level_t tx_pacer_level(const tx_pacer_t *pacer)
+{
+    if (pacer->step == 0) {
+        return TX_LEVEL_NORMAL;
+    }
+    return pacer->step == 1 ? TX_LEVEL_BATCH : TX_LEVEL_SUMMARY;
+}
+
+uint16_t tx_pacer_batch(const tx_pacer_t *pacer)
+{
+    return pacer->step >= 1 ? pacer->limits.batch_max : 1u;
+}
+
+uint16_t tx_pacer_merge(const tx_pacer_t *pacer)
+{
+    return merge_for(pacer->step);
+}
@@ -0,0 +1,246 @@
+#include "uart_out.h"
+
+#include <string.h>
+
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+#include "pico/stdlib.h"
+#include "terps_config.h"
+
+#define UART_OUT_BITS_PER_CHAR 10u  // 8N1
+#define UART_OUT_DE_RECHECK_US 20
+
+typedef struct {
+    uint8_t data[UART_OUT_SLOT_BYTES];
+    uint8_t len;
+} uart_slot_t;
+
+static uart_out_hw_t g_hw;
+static uart_inst_t *g_uart = NULL;
+static int g_dma = -1;
+static uart_slot_t g_slots[UART_OUT_SLOTS];
+// head: next slot core1 fills; tail: slot on (or next for) the DMA. Both only
+// move forward; head - tail is the depth.
+static volatile uint32_t g_head = 0;
+static volatile uint32_t g_tail = 0;
+static volatile bool g_dma_busy = false;
+static uint16_t g_seq = 0;
+static critical_section_t g_lock;
+static uart_out_stats_t g_stats;
+// When the transmitter will have shifted out everything handed to it so far.
+static uint64_t g_wire_free_us = 0;
+static uint32_t g_char_ns = 0;
+static bool g_de_on = false;
+static alarm_id_t g_de_alarm = 0;
+
+static uart_inst_t *uart_for_tx_pin(uint32_t gpio)
+{
+    // TX is function UART on pins 4n; uart0 at 0/12/16/28, uart1 at 4/8/20/24.
+    if (gpio > 28u || (gpio & 3u) != 0u) {
+        return NULL;
+    }
+    return ((gpio + 4u) >> 3) & 1u ? uart1 : uart0;
+}
+
+static uint32_t wire_us(uint32_t bytes)
+{
+    return (uint32_t)(((uint64_t)bytes * g_char_ns + 999u) / 1000u);
+}
+
+static int64_t de_release_cb(alarm_id_t id, void *user_data)
+{
+    (void)id;
+    (void)user_data;
+    critical_section_enter_blocking(&g_lock);
+    int64_t again = 0;
+    if (g_dma_busy || g_head != g_tail) {
+        // A new packet went out after the alarm was set; its completion re-arms.
+    } else if (uart_get_hw(g_uart)->fr & UART_UARTFR_BUSY_BITS) {
+        again = -UART_OUT_DE_RECHECK_US;
+    } else {
+        gpio_put(g_hw.de_gpio, 0);
+        g_de_on = false;
+        g_stats.de_cycles++;
+    }
+    if (again == 0) {
+        g_de_alarm = 0;
+    }
+    critical_section_exit(&g_lock);
+    return again;
+}
+
+// Caller holds g_lock and has checked head != tail.
+static void start_next_locked(void)
+{
+    const uart_slot_t *slot = &g_slots[g_tail % UART_OUT_SLOTS];
+    const uint64_t now = time_us_64();
+    uint64_t begin = now > g_wire_free_us ? now : g_wire_free_us;
+    if (g_hw.de_gpio != TERPS_GPIO_UNUSED) {
+        if (g_de_alarm != 0) {
+            cancel_alarm(g_de_alarm);
+            g_de_alarm = 0;
+        }
+        if (!g_de_on) {
+            gpio_put(g_hw.de_gpio, 1);
+            g_de_on = true;
+            busy_wait_us_32(g_hw.de_lead_us);
+            begin = time_us_64();
+        }
+    }
+    g_wire_free_us = begin + wire_us(slot->len);
+    g_dma_busy = true;
+    dma_channel_transfer_from_buffer_now((uint)g_dma, slot->data, slot->len);
+}
+
+static void __not_in_flash_func(uart_dma_irq)(void)
+{
+    if (g_dma < 0 || !dma_channel_get_irq0_status((uint)g_dma)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0((uint)g_dma);
+    critical_section_enter_blocking(&g_lock);
+    const uart_slot_t *done = &g_slots[g_tail % UART_OUT_SLOTS];
+    g_stats.sent++;
+    g_stats.bytes += done->len;
+    g_tail = g_tail + 1u;
+    g_dma_busy = false;
+    if (g_head != g_tail) {
+        start_next_locked();
+    } else if (g_hw.de_gpio != TERPS_GPIO_UNUSED && g_de_on && g_de_alarm == 0) {
+        // The last bytes are still in the TX FIFO; release DE after they leave.
+        g_de_alarm = add_alarm_at(from_us_since_boot(g_wire_free_us + g_hw.de_tail_us), de_release_cb, NULL, true);
+    }
+    critical_section_exit(&g_lock);
+}
+
+bool uart_out_init(const uart_out_hw_t *hw)
+{
+    g_hw = *hw;
+    g_uart = uart_for_tx_pin(hw->tx_gpio);
+    if (g_uart == NULL || hw->baud == 0) {
+        g_uart = NULL;
+        return false;
+    }
+    g_dma = dma_claim_unused_channel(false);
+    if (g_dma < 0) {
+        g_uart = NULL;
+        return false;
+    }
+    critical_section_init(&g_lock);
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_head = g_tail = 0;
+
+    const uint actual = uart_init(g_uart, hw->baud);
+    uart_set_fifo_enabled(g_uart, true);
+    gpio_set_function(hw->tx_gpio, GPIO_FUNC_UART);
+    g_char_ns = (uint32_t)((UART_OUT_BITS_PER_CHAR * 1000000000ull) / (actual ? actual : hw->baud));
+
+    if (hw->de_gpio != TERPS_GPIO_UNUSED) {
+        gpio_init(hw->de_gpio);
+        gpio_set_dir(hw->de_gpio, GPIO_OUT);
+        gpio_put(hw->de_gpio, 0);
+    }
+
+    dma_channel_config cfg = dma_channel_get_default_config((uint)g_dma);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, uart_get_dreq_num(g_uart, true));
+    dma_channel_configure((uint)g_dma, &cfg, uart_get_dr_address(g_uart), NULL, 0, false);
+    dma_channel_set_irq0_enabled((uint)g_dma, true);
+    return true;
+}
+
+bool uart_out_enabled(void)
+{
+    return g_uart != NULL;
+}
+
+void uart_out_attach_irq(void)
+{
+    if (g_uart == NULL) {
+        return;
+    }
+    irq_add_shared_handler(DMA_IRQ_0, uart_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+bool uart_out_send_frame(const terps_frame_t *frame, uint64_t end_us)
+{
+    if (g_uart == NULL || frame == NULL) {
+        return false;
+    }
+    terps_frame_t out = *frame;
+    out.seq = g_seq++;
+    if (g_head - g_tail >= UART_OUT_SLOTS) {
+        critical_section_enter_blocking(&g_lock);
+        g_stats.dropped++;
+        critical_section_exit(&g_lock);
+        return false;
+    }
+    // The slot at head belongs to this core until head moves past it.
+    uart_slot_t *slot = &g_slots[g_head % UART_OUT_SLOTS];
+    const size_t len = usb_cdc_encode_binary(&out, slot->data, sizeof(slot->data));
+    critical_section_enter_blocking(&g_lock);
+    if (len == 0) {
+        g_stats.encode_errors++;
+        critical_section_exit(&g_lock);
+        return false;
+    }
+    slot->len = (uint8_t)len;
+    g_head = g_head + 1u;
+    g_stats.queued++;
+    const uint16_t depth = (uint16_t)(g_head - g_tail);
+    if (depth > g_stats.depth_max) {
+        g_stats.depth_max = depth;
+    }
+    if (!g_dma_busy) {
+        start_next_locked();
+    }
+    // Queued packets follow the one on the DMA back to back at line rate, so
+    // this packet's wire end is known now.
+    uint64_t wire_end = g_wire_free_us;
+    for (uint32_t i = g_tail + 1u; i < g_head; ++i) {
+        wire_end += wire_us(g_slots[i % UART_OUT_SLOTS].len);
+    }
+    const uint64_t now = time_us_64();
+    const uint32_t start = (uint32_t)(now - end_us);
+    const uint32_t wire = (uint32_t)(wire_end - end_us);
+    g_stats.start_last_us = start;
+    if (start > g_stats.start_max_us) {
+        g_stats.start_max_us = start;
+    }
+    g_stats.wire_last_us = wire;
+    g_stats.wire_sum_us += wire;
+    if (wire > g_stats.wire_max_us) {
+        g_stats.wire_max_us = wire;
+    }
+    critical_section_exit(&g_lock);
+    return true;
+}
+
+void uart_out_get_stats(uart_out_stats_t *stats)
+{
+    if (g_uart == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    critical_section_enter_blocking(&g_lock);
+    *stats = g_stats;
+    critical_section_exit(&g_lock);
+}
+
+void uart_out_reset_stats(void)
+{
+    if (g_uart == NULL) {
+        return;
+    }
+    critical_section_enter_blocking(&g_lock);
+    const uint32_t de_cycles = g_stats.de_cycles;
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.de_cycles = de_cycles;
+    critical_section_exit(&g_lock);
+}
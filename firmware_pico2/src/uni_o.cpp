@@ -12,6 +12,7 @@ constexpr uint32_t UNIO_MIN_HALF_US = 5;
 constexpr uint32_t UNIO_MAX_HALF_US = 200;
 constexpr uint8_t UNIO_START_HEADER = 0x55;
 constexpr uint8_t UNIO_CMD_READ = 0x03;
+constexpr uint32_t UNIO_GPIO_NONE = 0xFFFFFFFFu;
 
 enum class BitReadResult {
     Zero,
@@ -20,203 +21,215 @@ enum class BitReadResult {
     Error,
 };
 
-static uint g_gpio = 0;
-static bool g_initialized = false;
+static uint g_bus_gpio[UNIO_MAX_BUSES];
+static uint32_t g_bus_line[UNIO_MAX_BUSES];  // 1u << gpio
+static size_t g_bus_count = 0;
 static uint32_t g_half_bit_us = 20;
 static uint32_t g_bitrate_bps = 0;
 static uint8_t g_last_device_addr = 0;
 static unio_status_t g_last_status = UNIO_STATUS_NO_DEVICE;
+static uint32_t g_deadline_us = 0;
+
+// One transaction over several buses. `lines` holds the SCIO lines still in
+// it; a bus that fails a step is released, dropped from `lines` and keeps its
+// status, the others carry on with unchanged timing.
+struct Round {
+    uint32_t lines;
+    unio_status_t status[UNIO_MAX_BUSES];
+};
 
-static inline void drive_high()
+// Every edge is scheduled on an absolute deadline, so the per-bit work for
+// eight buses does not stretch the bit period.
+static inline void start_timing()
 {
-    gpio_put(g_gpio, 1);
-    gpio_set_dir(g_gpio, true);
+    g_deadline_us = time_us_32();
 }
 
-static inline void drive_low()
+static inline void wait_us(uint32_t us)
 {
-    gpio_put(g_gpio, 0);
-    gpio_set_dir(g_gpio, true);
+    g_deadline_us += us;
+    while ((int32_t)(time_us_32() - g_deadline_us) < 0) {
+        tight_loop_contents();
+    }
 }
 
-static inline void release_line()
+static inline void half_delay()
 {
-    gpio_set_dir(g_gpio, false);
+    wait_us(g_half_bit_us);
 }
 
-static inline bool sample_line()
+static inline void drive(uint32_t lines, uint32_t high)
 {
-    return gpio_get(g_gpio);
+    gpio_put_masked(lines, high);
+    gpio_set_dir_out_masked(lines);
 }
 
-static inline void half_delay()
+static inline void release_lines(uint32_t lines)
 {
-    busy_wait_us_32(g_half_bit_us);
+    gpio_set_dir_in_masked(lines);
 }
 
-static void standby_pulse()
+static void standby_pulse(uint32_t lines)
 {
-    if (!g_initialized) {
+    if (lines == 0) {
         return;
     }
-    release_line();
+    release_lines(lines);
     busy_wait_us_32(UNIO_T_STANDBY_US);
 }
 
-static void tx_bit(bool bit, bool release_after)
+static void fail(Round& round, size_t bus, unio_status_t status)
 {
-    if (bit) {
-        drive_high();
-        half_delay();
-        drive_low();
-        half_delay();
-    } else {
-        drive_low();
-        half_delay();
-        drive_high();
-        half_delay();
-    }
+    release_lines(g_bus_line[bus]);
+    round.lines &= ~g_bus_line[bus];
+    round.status[bus] = status;
+}
+
+// Lines in `ones` send a 1 (high then low), the other lines a 0.
+static void tx_bits(uint32_t lines, uint32_t ones, bool release_after)
+{
+    drive(lines, ones);
+    half_delay();
+    drive(lines, ~ones & lines);
+    half_delay();
     if (release_after) {
-        release_line();
+        release_lines(lines);
     }
 }
 
-static void tx_byte(uint8_t value)
+static void tx_byte(uint32_t lines, uint8_t value)
 {
     for (int bit = 7; bit >= 0; --bit) {
-        tx_bit(((value >> bit) & 0x01u) != 0, false);
+        tx_bits(lines, ((value >> bit) & 0x01u) ? lines : 0u, false);
     }
-    release_line();
+    release_lines(lines);
 }
 
-static BitReadResult rx_bit(bool& value_out)
+static void rx_bits(uint32_t lines, uint32_t& first, uint32_t& second)
 {
-    release_line();
+    release_lines(lines);
     half_delay();
-    bool first = sample_line();
+    first = gpio_get_all();
     half_delay();
-    bool second = sample_line();
+    second = gpio_get_all();
+}
 
-    if (!first && second) {
-        value_out = false;
+static BitReadResult decode_bit(uint32_t line, uint32_t first, uint32_t second)
+{
+    const bool a = (first & line) != 0;
+    const bool b = (second & line) != 0;
+    if (!a && b) {
         return BitReadResult::Zero;
     }
-    if (first && !second) {
-        value_out = true;
+    if (a && !b) {
         return BitReadResult::One;
     }
-    if (first && second) {
-        return BitReadResult::Idle;
-    }
-    return BitReadResult::Error;
+    return a ? BitReadResult::Idle : BitReadResult::Error;
 }
 
-static bool expect_mak_from_slave()
+static void expect_mak_from_slave(Round& round)
 {
-    bool value = false;
-    BitReadResult res = rx_bit(value);
-    if (res == BitReadResult::Idle) {
-        g_last_status = UNIO_STATUS_NO_DEVICE;
-        return false;
+    uint32_t first = 0;
+    uint32_t second = 0;
+    rx_bits(round.lines, first, second);
+    for (size_t bus = 0; bus < g_bus_count; ++bus) {
+        if (!(round.lines & g_bus_line[bus])) {
+            continue;
+        }
+        const BitReadResult res = decode_bit(g_bus_line[bus], first, second);
+        if (res == BitReadResult::Idle) {
+            fail(round, bus, UNIO_STATUS_NO_DEVICE);
+        } else if (res != BitReadResult::One) {
+            fail(round, bus, UNIO_STATUS_IO_ERROR);
+        }
     }
-    if (res != BitReadResult::One) {
-        g_last_status = UNIO_STATUS_IO_ERROR;
-        return false;
+    if (round.lines) {
+        tx_bits(round.lines, 0u, true);  // SAK = 0
     }
-    tx_bit(false, true);  // SAK = 0
-    return true;
 }
 
-static bool send_mak_to_slave(bool more)
+static void send_mak_to_slave(Round& round, bool more)
 {
-    tx_bit(more, true);
-    bool ack_value = false;
-    BitReadResult res = rx_bit(ack_value);
-    if (res == BitReadResult::Idle) {
-        g_last_status = UNIO_STATUS_NO_DEVICE;
-        return false;
-    }
-    if (res != BitReadResult::Zero || ack_value) {
-        g_last_status = UNIO_STATUS_IO_ERROR;
-        return false;
+    tx_bits(round.lines, more ? round.lines : 0u, true);
+    uint32_t first = 0;
+    uint32_t second = 0;
+    rx_bits(round.lines, first, second);
+    for (size_t bus = 0; bus < g_bus_count; ++bus) {
+        if (!(round.lines & g_bus_line[bus])) {
+            continue;
+        }
+        const BitReadResult res = decode_bit(g_bus_line[bus], first, second);
+        if (res == BitReadResult::Idle) {
+            fail(round, bus, UNIO_STATUS_NO_DEVICE);
+        } else if (res != BitReadResult::Zero) {
+            fail(round, bus, UNIO_STATUS_IO_ERROR);
+        }
     }
-    return true;
 }
 
-static bool rx_byte(uint8_t& value_out)
+static void rx_byte(Round& round, uint8_t* const* bufs, size_t index)
 {
-    uint8_t value = 0;
+    uint8_t value[UNIO_MAX_BUSES] = {0};
     for (int bit = 7; bit >= 0; --bit) {
-        bool bit_value = false;
-        BitReadResult res = rx_bit(bit_value);
-        if (res == BitReadResult::Idle) {
-            g_last_status = UNIO_STATUS_NO_DEVICE;
-            return false;
+        uint32_t first = 0;
+        uint32_t second = 0;
+        rx_bits(round.lines, first, second);
+        for (size_t bus = 0; bus < g_bus_count; ++bus) {
+            if (!(round.lines & g_bus_line[bus])) {
+                continue;
+            }
+            const BitReadResult res = decode_bit(g_bus_line[bus], first, second);
+            if (res == BitReadResult::Idle) {
+                fail(round, bus, UNIO_STATUS_NO_DEVICE);
+            } else if (res == BitReadResult::Error) {
+                fail(round, bus, UNIO_STATUS_IO_ERROR);
+            } else if (res == BitReadResult::One) {
+                value[bus] |= (uint8_t)(1u << bit);
+            }
         }
-        if (res == BitReadResult::Error) {
-            g_last_status = UNIO_STATUS_IO_ERROR;
-            return false;
-        }
-        if (bit_value) {
-            value |= (uint8_t)(1u << bit);
+    }
+    for (size_t bus = 0; bus < g_bus_count; ++bus) {
+        if (round.lines & g_bus_line[bus]) {
+            bufs[bus][index] = value[bus];
         }
     }
-    value_out = value;
-    return true;
 }
 
-static bool start_header()
+static void start_header(uint32_t lines)
 {
-    standby_pulse();
-    drive_low();
-    busy_wait_us_32(UNIO_T_HDR_US);
-    tx_byte(UNIO_START_HEADER);
-    return true;
+    standby_pulse(lines);
+    start_timing();
+    drive(lines, 0u);
+    wait_us(UNIO_T_HDR_US);
+    tx_byte(lines, UNIO_START_HEADER);
 }
 
-static bool execute_read(uint8_t device_addr, uint16_t addr, uint8_t* buf, size_t len)
+static void execute_read(Round& round, uint8_t device_addr, uint16_t addr, uint8_t* const* bufs, size_t len)
 {
-    if (!start_header()) {
-        g_last_status = UNIO_STATUS_IO_ERROR;
-        return false;
-    }
-
-    tx_byte(device_addr);
-    if (!expect_mak_from_slave()) {
-        return false;
-    }
-
-    tx_byte(UNIO_CMD_READ);
-    if (!expect_mak_from_slave()) {
-        return false;
-    }
-
-    tx_byte((uint8_t)((addr >> 8) & 0xFFu));
-    if (!expect_mak_from_slave()) {
-        return false;
-    }
-
-    tx_byte((uint8_t)(addr & 0xFFu));
-    if (!expect_mak_from_slave()) {
-        return false;
+    start_header(round.lines);
+
+    const uint8_t header[4] = {
+        device_addr,
+        UNIO_CMD_READ,
+        (uint8_t)((addr >> 8) & 0xFFu),
+        (uint8_t)(addr & 0xFFu),
+    };
+    for (uint8_t byte : header) {
+        if (round.lines == 0) {
+            return;
+        }
+        tx_byte(round.lines, byte);
+        expect_mak_from_slave(round);
     }
 
-    for (size_t i = 0; i < len; ++i) {
-        uint8_t value = 0;
-        if (!rx_byte(value)) {
-            return false;
+    for (size_t i = 0; i < len && round.lines; ++i) {
+        rx_byte(round, bufs, i);
+        if (round.lines == 0) {
+            return;
         }
-        buf[i] = value;
         bool more = (i + 1) < len;
-        if (!send_mak_to_slave(more)) {
-            return false;
-        }
+        send_mak_to_slave(round, more);
     }
-
-    standby_pulse();
-    g_last_status = UNIO_STATUS_OK;
-    g_last_device_addr = device_addr;
-    return true;
 }
 
 static uint32_t compute_half_period(uint32_t bitrate_bps)
@@ -242,50 +255,117 @@ static uint32_t compute_half_period(uint32_t bitrate_bps)
 
 extern "C" {
 
-void unio_init(uint gpio_scio, uint32_t bitrate_bps)
+size_t unio_init_buses(const uint* gpios, size_t count, uint32_t bitrate_bps)
 {
-    g_gpio = gpio_scio;
     g_bitrate_bps = (bitrate_bps == 0) ? 20000 : bitrate_bps;
     g_half_bit_us = compute_half_period(g_bitrate_bps);
     g_last_device_addr = 0;
     g_last_status = UNIO_STATUS_NO_DEVICE;
-    g_initialized = false;
+    g_bus_count = 0;
 
-    if (gpio_scio == 0xFFFFFFFFu) {
-        return;
+    for (size_t i = 0; gpios != nullptr && i < count && g_bus_count < UNIO_MAX_BUSES; ++i) {
+        const uint gpio = gpios[i];
+        if (gpio == UNIO_GPIO_NONE || gpio >= 32u) {
+            continue;
+        }
+        gpio_init(gpio);
+        gpio_pull_up(gpio);
+        gpio_put(gpio, 1);
+        g_bus_gpio[g_bus_count] = gpio;
+        g_bus_line[g_bus_count] = 1u << gpio;
+        release_lines(g_bus_line[g_bus_count]);
+        g_bus_count++;
     }
+    return g_bus_count;
+}
 
-    gpio_init(gpio_scio);
-    gpio_pull_up(gpio_scio);
-    gpio_put(gpio_scio, 1);
-    release_line();
-    g_initialized = true;
+void unio_init(uint gpio_scio, uint32_t bitrate_bps)
+{
+    unio_init_buses(&gpio_scio, 1, bitrate_bps);
 }
 
-bool unio_read(uint16_t addr, uint8_t* buf, size_t len)
+size_t unio_bus_count(void)
 {
-    if (!g_initialized || buf == nullptr || len == 0) {
-        g_last_status = g_initialized ? UNIO_STATUS_IO_ERROR : UNIO_STATUS_NO_DEVICE;
-        return false;
+    return g_bus_count;
+}
+
+uint unio_bus_gpio(size_t bus)
+{
+    return bus < g_bus_count ? g_bus_gpio[bus] : UNIO_GPIO_NONE;
+}
+
+bool unio_read_buses(uint32_t bus_mask, uint16_t addr, uint8_t* const* bufs, size_t len,
+                     unio_bus_result_t* results)
+{
+    uint32_t pending_lines = 0;
+    for (size_t bus = 0; bus < UNIO_MAX_BUSES; ++bus) {
+        if (!(bus_mask & (1u << bus))) {
+            continue;
+        }
+        if (bus >= g_bus_count) {
+            results[bus].status = UNIO_STATUS_NO_DEVICE;
+            continue;
+        }
+        results[bus].status = (bufs[bus] == nullptr || len == 0) ? UNIO_STATUS_IO_ERROR : UNIO_STATUS_NO_DEVICE;
+        results[bus].device_addr = 0;
+        if (results[bus].status == UNIO_STATUS_NO_DEVICE) {
+            pending_lines |= g_bus_line[bus];
+        }
     }
     if (len > 512) {
         len = 512;
     }
 
+    // All pending buses try the same device address in one lock-step round;
+    // a bus without a device there simply joins the next round.
     const uint8_t start_addr = 0xA0;
     const uint8_t end_addr = 0xAE;
-    for (uint8_t dev = start_addr; dev <= end_addr; dev = (uint8_t)(dev + 2)) {
-        if (execute_read(dev, addr, buf, len)) {
-            return true;
+    for (uint8_t dev = start_addr; dev <= end_addr && pending_lines; dev = (uint8_t)(dev + 2)) {
+        Round round;
+        round.lines = pending_lines;
+        for (size_t bus = 0; bus < g_bus_count; ++bus) {
+            round.status[bus] = UNIO_STATUS_OK;
         }
-        if (g_last_status == UNIO_STATUS_IO_ERROR) {
-            standby_pulse();
-            return false;
+        execute_read(round, dev, addr, bufs, len);
+        standby_pulse(pending_lines);
+        for (size_t bus = 0; bus < g_bus_count; ++bus) {
+            if (!(pending_lines & g_bus_line[bus])) {
+                continue;
+            }
+            if (round.lines & g_bus_line[bus]) {
+                results[bus].status = UNIO_STATUS_OK;
+                results[bus].device_addr = dev;
+                pending_lines &= ~g_bus_line[bus];
+            } else if (round.status[bus] == UNIO_STATUS_IO_ERROR) {
+                results[bus].status = UNIO_STATUS_IO_ERROR;
+                pending_lines &= ~g_bus_line[bus];
+            }
         }
-        standby_pulse();
     }
-    g_last_status = UNIO_STATUS_NO_DEVICE;
-    return false;
+
+    bool all_ok = true;
+    for (size_t bus = 0; bus < UNIO_MAX_BUSES; ++bus) {
+        if ((bus_mask & (1u << bus)) && results[bus].status != UNIO_STATUS_OK) {
+            all_ok = false;
+        }
+    }
+    return all_ok;
+}
+
+bool unio_read(uint16_t addr, uint8_t* buf, size_t len)
+{
+    if (g_bus_count == 0 || buf == nullptr || len == 0) {
+        g_last_status = g_bus_count ? UNIO_STATUS_IO_ERROR : UNIO_STATUS_NO_DEVICE;
+        return false;
+    }
+    uint8_t* bufs[UNIO_MAX_BUSES] = {buf};
+    unio_bus_result_t results[UNIO_MAX_BUSES] = {};
+    const bool ok = unio_read_buses(1u, addr, bufs, len, results);
+    g_last_status = results[0].status;
+    if (ok) {
+        g_last_device_addr = results[0].device_addr;
+    }
+    return ok;
 }
 
 unio_status_t unio_last_status(void)
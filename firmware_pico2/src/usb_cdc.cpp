@@ -1,5 +1,6 @@
 #include "usb_cdc.h"
 
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
@@ -8,11 +9,116 @@
 #include "pico/time.h"
 #include "tusb.h"
 
+#include "frame_schema.h"
+#include "terps_config.h"
+
+#ifdef CFG_TUD_CDC_TX_BUFSIZE
+#define TX_FIFO_BYTES CFG_TUD_CDC_TX_BUFSIZE
+#else
+#define TX_FIFO_BYTES 256u
+#endif
+#define TX_STAGE_BYTES 1024u
+#define TX_WRITE_WAIT_MS 5u
+#define TX_STATE_LINE_MAX 160u
+#define FRAME_PACKET_MAX 64u
+
 static terps_stream_mode_t g_mode = TERPS_STREAM_CSV;
 static char g_cmd_buffer[128];
 static size_t g_cmd_len = 0;
+static bool g_schema_pending = false;
+static bool g_was_connected = false;
+
+// Wire layout of TERPS_PACKET_FRAME. Append new fields at the end with a new
+// ID; hosts that predate them decode the prefix and skip unknown IDs.
+static const frame_field_desc_t k_frame_fields[] = {
+    {FRAME_FIELD_TS_MS, FRAME_TYPE_U32, 0, 0, offsetof(terps_frame_t, ts_ms), "ts_ms"},
+    {FRAME_FIELD_F_HZ, FRAME_TYPE_I32, -4, 0, offsetof(terps_frame_t, f_hz_x1e4), "f_hz"},
+    {FRAME_FIELD_TAU_MS, FRAME_TYPE_U16, 0, 0, offsetof(terps_frame_t, tau_ms), "tau_ms"},
+    {FRAME_FIELD_DIODE_UV, FRAME_TYPE_I32, 0, 0, offsetof(terps_frame_t, diode_uV), "diode_uV"},
+    {FRAME_FIELD_ADC_GAIN, FRAME_TYPE_U8, 0, 0, offsetof(terps_frame_t, adc_gain), "adc_gain"},
+    {FRAME_FIELD_FLAGS, FRAME_TYPE_U8, 0, 0, offsetof(terps_frame_t, flags), "flags"},
+    {FRAME_FIELD_PPM_CORR, FRAME_TYPE_I16, -2, 0, offsetof(terps_frame_t, ppm_corr_x1e2), "ppm_corr"},
+    {FRAME_FIELD_MODE, FRAME_TYPE_U8, 0, 0, offsetof(terps_frame_t, mode), "mode"},
+    {FRAME_FIELD_SLOT, FRAME_TYPE_U32, 0, FRAME_ATTR_ALL_ONES_NONE, offsetof(terps_frame_t, slot), "slot"},
+    {FRAME_FIELD_ADC_FRESH, FRAME_TYPE_U8, 0, 0, offsetof(terps_frame_t, adc_fresh), "adc_fresh"},
+    {FRAME_FIELD_SEQ, FRAME_TYPE_U16, 0, 0, offsetof(terps_frame_t, seq), "seq"},
+};
+
+static frame_schema_t g_frame_schema = {
+    TERPS_PACKET_FRAME,
+    (uint8_t)(sizeof(k_frame_fields) / sizeof(k_frame_fields[0])),
+    0,
+    k_frame_fields,
+};
+
+typedef struct {
+    uint32_t ts_ms;
+    uint8_t step;
+    uint8_t level;
+    uint16_t batch;
+    uint16_t merge;
+    uint32_t drain_Bps;
+    uint32_t capacity_Bps;
+    uint32_t demand_Bps;
+    uint32_t stalls;
+    uint32_t dropped;
+} tx_state_record_t;
+
+static const frame_field_desc_t k_tx_state_fields[] = {
+    {1, FRAME_TYPE_U32, 0, 0, offsetof(tx_state_record_t, ts_ms), "ts_ms"},
+    {2, FRAME_TYPE_U8, 0, 0, offsetof(tx_state_record_t, step), "step"},
+    {3, FRAME_TYPE_U8, 0, 0, offsetof(tx_state_record_t, level), "level"},
+    {4, FRAME_TYPE_U16, 0, 0, offsetof(tx_state_record_t, batch), "batch"},
+    {5, FRAME_TYPE_U16, 0, 0, offsetof(tx_state_record_t, merge), "merge"},
+    {6, FRAME_TYPE_U32, 0, 0, offsetof(tx_state_record_t, drain_Bps), "drain_Bps"},
+    {7, FRAME_TYPE_U32, 0, 0, offsetof(tx_state_record_t, capacity_Bps), "capacity_Bps"},
+    {8, FRAME_TYPE_U32, 0, 0, offsetof(tx_state_record_t, demand_Bps), "demand_Bps"},
+    {9, FRAME_TYPE_U32, 0, 0, offsetof(tx_state_record_t, stalls), "stalls"},
+    {10, FRAME_TYPE_U32, 0, 0, offsetof(tx_state_record_t, dropped), "dropped"},
+};
+
+static frame_schema_t g_tx_state_schema = {
+    TERPS_PACKET_TX_STATE,
+    (uint8_t)(sizeof(k_tx_state_fields) / sizeof(k_tx_state_fields[0])),
+    0,
+    k_tx_state_fields,
+};
+
+// Adaptive TX: frames are staged and flushed per batch; at summary steps
+// `merge` frames are folded into one before staging.
+static tx_pacer_t g_pacer;
+static bool g_tx_auto = true;
+static bool g_tx_announce_pending = false;
+// Counts frame packets as they are staged. A gap on the host means packets
+// lost to a dropped batch or a corrupted stream.
+static uint16_t g_frame_seq = 0;
+static uint8_t g_stage[TX_STAGE_BYTES];
+static size_t g_stage_len = 0;
+static uint16_t g_stage_frames = 0;
+static uint32_t g_stage_since_ms = 0;
+
+typedef struct {
+    uint16_t count;
+    double f_sum;
+    int64_t v_sum;
+    uint32_t tau_sum;
+    uint32_t fresh_sum;
+    uint8_t flags_or;
+    uint8_t flags_and;
+    uint32_t first_slot;
+} merge_acc_t;
+
+static merge_acc_t g_merge;
 
 
+static uint32_t cdc_write(const void *data, uint32_t len)
+{
+    // Every byte handed to the FIFO is counted so the pacer can tell how much the host drained.
+    const uint32_t written = tud_cdc_write(data, len);
+    tx_pacer_wrote(&g_pacer, written);
+    return written;
+}
+
 static bool ensure_write_capacity(uint32_t needed_bytes, uint32_t timeout_ms)
 {
     uint32_t start = to_ms_since_boot(get_absolute_time());
@@ -48,13 +154,45 @@ static uint16_t crc16_ccitt(const uint8_t *data, size_t len)
 void usb_cdc_init(terps_stream_mode_t mode)
 {
     g_mode = mode;
+    if (frame_schema_find(TERPS_PACKET_FRAME) == NULL) {
+        frame_schema_register(&g_frame_schema);
+        frame_schema_register(&g_tx_state_schema);
+    }
+    tx_pacer_limits_t limits;
+    tx_pacer_default_limits(&limits, TX_FIFO_BYTES);
+    tx_pacer_init(&g_pacer, &limits);
+    g_stage_len = 0;
+    g_stage_frames = 0;
+    g_tx_announce_pending = false;
+    memset(&g_merge, 0, sizeof(g_merge));
+    g_schema_pending = mode == TERPS_STREAM_BINARY;
 }
 
 void usb_cdc_set_mode(terps_stream_mode_t mode)
 {
+    if (mode == TERPS_STREAM_BINARY && g_mode != TERPS_STREAM_BINARY) {
+        g_schema_pending = true;
+    }
     g_mode = mode;
 }
 
+void usb_cdc_request_schema(void)
+{
+    g_schema_pending = true;
+}
+
+bool usb_cdc_send_schema(void)
+{
+    uint8_t payload[255];
+    bool ok = true;
+    for (size_t i = 0; i < frame_schema_count(); ++i) {
+        const frame_schema_t *schema = frame_schema_at(i);
+        const size_t len = frame_schema_describe(schema, payload, sizeof(payload));
+        ok = len > 0 && usb_cdc_send_packet(TERPS_PACKET_SCHEMA, payload, len) && ok;
+    }
+    return ok;
+}
+
 static bool cdc_wait_ready(void)
 {
     uint32_t start = to_ms_since_boot(get_absolute_time());
@@ -68,54 +206,55 @@ static bool cdc_wait_ready(void)
     return true;
 }
 
-bool usb_cdc_send_frame(const terps_frame_t *frame)
+// Encode one frame as a full 0x55AA packet (header, payload, CRC). Returns the
+// byte count, 0 on failure.
+size_t usb_cdc_encode_binary(const terps_frame_t *frame, uint8_t *dst, size_t capacity)
 {
-    if (frame == NULL) {
-        return false;
+    if (capacity < 5u) {
+        return 0;
     }
-    if (!cdc_wait_ready()) {
-        return false;
+    const size_t len = frame_schema_encode(&g_frame_schema, frame, dst + 3, capacity - 5u);
+    if (len == 0) {
+        return 0;
     }
+    dst[0] = TERPS_PACKET_MAGIC;
+    dst[1] = TERPS_PACKET_FRAME;
+    dst[2] = (uint8_t)len;
+    const uint16_t crc = crc16_ccitt(dst + 3, len);
+    memcpy(dst + 3 + len, &crc, sizeof(crc));
+    return len + 5u;
+}
 
+// Encode one frame exactly as it goes on the wire: a 0x55AA packet in binary
+// mode, a CSV line otherwise.
+static size_t encode_frame(const terps_frame_t *frame, uint8_t *dst, size_t capacity)
+{
     if (g_mode == TERPS_STREAM_BINARY) {
-        uint8_t payload[19];
-        size_t offset = 0;
-        memcpy(&payload[offset], &frame->ts_ms, sizeof(frame->ts_ms));
-        offset += sizeof(frame->ts_ms);
-        memcpy(&payload[offset], &frame->f_hz_x1e4, sizeof(frame->f_hz_x1e4));
-        offset += sizeof(frame->f_hz_x1e4);
-        memcpy(&payload[offset], &frame->tau_ms, sizeof(frame->tau_ms));
-        offset += sizeof(frame->tau_ms);
-        memcpy(&payload[offset], &frame->diode_uV, sizeof(frame->diode_uV));
-        offset += sizeof(frame->diode_uV);
-        payload[offset++] = frame->adc_gain;
-        payload[offset++] = frame->flags;
-        memcpy(&payload[offset], &frame->ppm_corr_x1e2, sizeof(frame->ppm_corr_x1e2));
-        offset += sizeof(frame->ppm_corr_x1e2);
-        payload[offset++] = frame->mode;
-
-        const uint8_t header[3] = {0x55, 0xAA, (uint8_t)offset};
-        const uint16_t crc = crc16_ccitt(payload, offset);
-        uint8_t crc_bytes[2];
-        memcpy(crc_bytes, &crc, sizeof(crc));
-
-        uint32_t total_len = sizeof(header) + (uint32_t)offset + sizeof(crc_bytes);
-        if (!ensure_write_capacity(total_len, 100)) {
-            return false;
-        }
-        tud_cdc_write(header, sizeof(header));
-        tud_cdc_write(payload, offset);
-        tud_cdc_write(crc_bytes, sizeof(crc_bytes));
-        tud_cdc_write_flush();
-        return true;
+        return usb_cdc_encode_binary(frame, dst, capacity);
     }
 
-    char line[160];
-    const char *mode_str = frame->mode == 0 ? "GATED" : "RECIP";
+    const char *mode_str = "RECIP";
+    switch ((terps_mode_t)frame->mode) {
+    case TERPS_MODE_GATED:
+        mode_str = "GATED";
+        break;
+    case TERPS_MODE_DUAL:
+        mode_str = "DUAL";
+        break;
+    case TERPS_MODE_REF:
+        mode_str = "REF";
+        break;
+    default:
+        break;
+    }
+    char slot_str[12] = "-1";
+    if (frame->slot != 0xFFFFFFFFu) {
+        snprintf(slot_str, sizeof(slot_str), "%lu", (unsigned long)frame->slot);
+    }
     int written = snprintf(
-        line,
-        sizeof(line),
-        "%lu,%.4f,%u,%.1f,%u,%u,%.2f,%s\r\n",
+        (char *)dst,
+        capacity,
+        "%lu,%.4f,%u,%.1f,%u,%u,%.2f,%s,%s,%u\r\n",
         (unsigned long)frame->ts_ms,
         frame->f_hz,
         frame->tau_ms,
@@ -123,15 +262,271 @@ bool usb_cdc_send_frame(const terps_frame_t *frame)
         frame->adc_gain,
         frame->flags,
         frame->ppm_corr,
-        mode_str);
+        mode_str,
+        slot_str,
+        frame->adc_fresh);
+    if (written <= 0 || (size_t)written >= capacity) {
+        return 0;
+    }
+    return (size_t)written;
+}
 
-    if (written <= 0) {
+static bool stage_flush(void)
+{
+    if (g_stage_len == 0) {
+        return true;
+    }
+    const uint16_t frames = g_stage_frames;
+    const size_t len = g_stage_len;
+    g_stage_len = 0;
+    g_stage_frames = 0;
+    // A short wait only: a host that cannot keep up escalates the pacer
+    // instead of stalling core0 for the old 100 ms per frame.
+    if (!ensure_write_capacity((uint32_t)len, TX_WRITE_WAIT_MS)) {
+        tx_pacer_stall(&g_pacer, frames);
         return false;
     }
+    cdc_write(g_stage, (uint32_t)len);
+    tud_cdc_write_flush();
+    return true;
+}
+
+static void merge_add(const terps_frame_t *frame)
+{
+    if (g_merge.count == 0) {
+        memset(&g_merge, 0, sizeof(g_merge));
+        g_merge.flags_and = 0xFFu;
+        g_merge.first_slot = frame->slot;
+    }
+    g_merge.count++;
+    g_merge.f_sum += (double)frame->f_hz;
+    g_merge.v_sum += frame->diode_uV;
+    g_merge.tau_sum += frame->tau_ms;
+    g_merge.fresh_sum += frame->adc_fresh;
+    g_merge.flags_or |= frame->flags;
+    g_merge.flags_and &= frame->flags;
+}
+
+// Fold the accumulated windows into one frame: means for f and V, summed
+// window length and conversions. Fault flags are OR-ed; the PPS-locked and
+// settled flags are kept only if every merged window had them.
+static void merge_take(const terps_frame_t *last, terps_frame_t *out)
+{
+    const uint8_t status_bits = TERPS_FLAG_PPS_LOCKED | TERPS_FLAG_SETTLED;
+    *out = *last;
+    out->f_hz = (float)(g_merge.f_sum / g_merge.count);
+    out->f_hz_x1e4 = (int32_t)llround(g_merge.f_sum * 1e4 / g_merge.count);
+    out->diode_uV = (int32_t)(g_merge.v_sum / (int64_t)g_merge.count);
+    out->tau_ms = (uint16_t)(g_merge.tau_sum > 0xFFFFu ? 0xFFFFu : g_merge.tau_sum);
+    out->adc_fresh = (uint8_t)(g_merge.fresh_sum > 0xFFu ? 0xFFu : g_merge.fresh_sum);
+    out->slot = g_merge.first_slot;
+    out->flags = (uint8_t)(((g_merge.flags_or & ~status_bits) | (g_merge.flags_and & status_bits)) |
+                           TERPS_FLAG_SUMMARY);
+    g_merge.count = 0;
+}
+
+// Never waits for FIFO room: a congested link keeps the announcement pending
+// and pacer_tick() retries it, always with the current state.
+static bool announce_tx_state(void)
+{
+    stage_flush();
+    if (g_mode == TERPS_STREAM_BINARY) {
+        const tx_state_record_t record = {
+            to_ms_since_boot(get_absolute_time()),
+            g_pacer.step,
+            (uint8_t)tx_pacer_level(&g_pacer),
+            tx_pacer_batch(&g_pacer),
+            tx_pacer_merge(&g_pacer),
+            (uint32_t)g_pacer.drain_Bps,
+            (uint32_t)g_pacer.capacity_Bps,
+            (uint32_t)g_pacer.demand_Bps,
+            g_pacer.stalls,
+            g_pacer.dropped,
+        };
+        uint8_t payload[40];
+        const size_t len = frame_schema_encode(&g_tx_state_schema, &record, payload, sizeof(payload));
+        if (len == 0 || tud_cdc_write_available() < len + 5u) {
+            return false;
+        }
+        return usb_cdc_send_packet(TERPS_PACKET_TX_STATE, payload, len);
+    }
+    if (tud_cdc_write_available() < TX_STATE_LINE_MAX) {
+        return false;
+    }
+    static const char *const k_levels[] = {"NORMAL", "BATCH", "SUMMARY"};
+    usb_cdc_printf("#TX STEP=%u LEVEL=%s BATCH=%u MERGE=%u DRAIN_BPS=%lu CAPACITY_BPS=%lu DEMAND_BPS=%lu "
+                   "STALLS=%lu DROPPED=%lu\r\n",
+                   (unsigned)g_pacer.step,
+                   k_levels[tx_pacer_level(&g_pacer)],
+                   (unsigned)tx_pacer_batch(&g_pacer),
+                   (unsigned)tx_pacer_merge(&g_pacer),
+                   (unsigned long)g_pacer.drain_Bps,
+                   (unsigned long)g_pacer.capacity_Bps,
+                   (unsigned long)g_pacer.demand_Bps,
+                   (unsigned long)g_pacer.stalls,
+                   (unsigned long)g_pacer.dropped);
+    return true;
+}
+
+static void pacer_tick(void)
+{
+    const uint64_t now_us = to_us_since_boot(get_absolute_time());
+    const uint8_t before = g_pacer.step;
+    tx_pacer_sample(&g_pacer, now_us, tud_cdc_write_available());
+    if (!g_tx_auto) {
+        g_pacer.step = before;
+    } else if (g_pacer.step != before) {
+        if (tx_pacer_merge(&g_pacer) == 1u) {
+            g_merge.count = 0;  // partial summary is dropped when merging stops
+        }
+        g_tx_announce_pending = true;
+    }
+    if (g_tx_announce_pending) {
+        g_tx_announce_pending = !announce_tx_state();
+    }
+}
+
+bool usb_cdc_send_frame(const terps_frame_t *frame)
+{
+    if (frame == NULL) {
+        return false;
+    }
+    if (!cdc_wait_ready()) {
+        return false;
+    }
+    pacer_tick();
+    if (g_mode == TERPS_STREAM_BINARY && g_schema_pending) {
+        // Announce the layout before the first frame a (re)connected host sees.
+        stage_flush();
+        g_schema_pending = !usb_cdc_send_schema();
+    }
+
+    uint8_t encoded[FRAME_PACKET_MAX + 96];
+    terps_frame_t out = *frame;
+    out.seq = g_frame_seq;
+    size_t len = encode_frame(&out, encoded, sizeof(encoded));
+    if (len == 0) {
+        return false;
+    }
+    tx_pacer_offer(&g_pacer, (uint32_t)len);
+
+    const uint16_t merge = tx_pacer_merge(&g_pacer);
+    if (merge > 1u) {
+        merge_add(frame);
+        if (g_merge.count < merge) {
+            return true;
+        }
+        merge_take(frame, &out);
+        out.seq = g_frame_seq;
+        len = encode_frame(&out, encoded, sizeof(encoded));
+        if (len == 0) {
+            return false;
+        }
+    }
+    g_frame_seq++;
+
+    if (g_stage_len + len > sizeof(g_stage)) {
+        stage_flush();
+    }
+    if (g_stage_frames == 0) {
+        g_stage_since_ms = to_ms_since_boot(get_absolute_time());
+    }
+    memcpy(&g_stage[g_stage_len], encoded, len);
+    g_stage_len += len;
+    g_stage_frames++;
+    if (g_stage_frames >= tx_pacer_batch(&g_pacer)) {
+        return stage_flush();
+    }
+    return true;
+}
+
+void usb_cdc_tx_status(tx_pacer_t *out, bool *auto_mode)
+{
+    if (out != NULL) {
+        *out = g_pacer;
+    }
+    if (auto_mode != NULL) {
+        *auto_mode = g_tx_auto;
+    }
+}
+
+void usb_cdc_tx_set(bool auto_mode, uint8_t step)
+{
+    const uint8_t before = g_pacer.step;
+    g_tx_auto = auto_mode;
+    tx_pacer_set_step(&g_pacer, step);
+    if (g_pacer.step != before) {
+        if (tx_pacer_merge(&g_pacer) == 1u) {
+            g_merge.count = 0;
+        }
+        g_tx_announce_pending = !announce_tx_state();
+    }
+}
+
+bool usb_cdc_send_packet(uint8_t type, const uint8_t *payload, size_t len)
+{
+    if (payload == NULL || len > 0xFFu) {
+        return false;
+    }
+    const uint8_t header[3] = {TERPS_PACKET_MAGIC, type, (uint8_t)len};
+    const uint16_t crc = crc16_ccitt(payload, len);
+    uint8_t crc_bytes[2];
+    memcpy(crc_bytes, &crc, sizeof(crc));
+
+    uint32_t total_len = sizeof(header) + (uint32_t)len + sizeof(crc_bytes);
+    if (!ensure_write_capacity(total_len, 100)) {
+        return false;
+    }
+    cdc_write(header, sizeof(header));
+    cdc_write(payload, (uint32_t)len);
+    cdc_write(crc_bytes, sizeof(crc_bytes));
+    tud_cdc_write_flush();
+    return true;
+}
+
+bool usb_cdc_send_trace(const trace_entry_t *entry)
+{
+    if (entry == NULL || !tud_cdc_connected()) {
+        return false;
+    }
+    const uint8_t nargs = entry->nargs > TRACE_LOG_MAX_ARGS ? TRACE_LOG_MAX_ARGS : entry->nargs;
+
+    if (g_mode == TERPS_STREAM_BINARY) {
+        uint8_t payload[8 + 4 * TRACE_LOG_MAX_ARGS];
+        size_t offset = 0;
+        memcpy(&payload[offset], &entry->ts_us, sizeof(entry->ts_us));
+        offset += sizeof(entry->ts_us);
+        memcpy(&payload[offset], &entry->id, sizeof(entry->id));
+        offset += sizeof(entry->id);
+        payload[offset++] = entry->core;
+        payload[offset++] = nargs;
+        memcpy(&payload[offset], entry->args, 4u * nargs);
+        offset += 4u * nargs;
+        return usb_cdc_send_packet(TERPS_PACKET_TRACE, payload, offset);
+    }
+
+    char line[96];
+    int written = snprintf(line,
+                           sizeof(line),
+                           "#L %u %u %lu",
+                           (unsigned)entry->id,
+                           (unsigned)entry->core,
+                           (unsigned long)entry->ts_us);
+    for (uint8_t i = 0; i < nargs && written > 0 && (size_t)written < sizeof(line); ++i) {
+        written += snprintf(line + written,
+                            sizeof(line) - (size_t)written,
+                            " %lu",
+                            (unsigned long)entry->args[i]);
+    }
+    if (written <= 0 || (size_t)written > sizeof(line) - 3) {
+        return false;
+    }
+    line[written++] = '\r';
+    line[written++] = '\n';
     if (!ensure_write_capacity((uint32_t)written, 100)) {
         return false;
     }
-    tud_cdc_write(line, (uint32_t)written);
+    cdc_write(line, (uint32_t)written);
     tud_cdc_write_flush();
     return true;
 }
@@ -175,11 +570,53 @@ void usb_cdc_write_line(const char *text)
         return;
     }
     size_t len = strlen(text);
-    if (!ensure_write_capacity((uint32_t)len, 100)) {
-        return;
+    // Status replies can exceed the TX FIFO; hand them over a FIFO's worth at a time.
+    while (len > 0) {
+        const uint32_t chunk = len > TX_FIFO_BYTES ? TX_FIFO_BYTES : (uint32_t)len;
+        if (!ensure_write_capacity(chunk, 100)) {
+            return;
+        }
+        cdc_write(text, chunk);
+        tud_cdc_write_flush();
+        text += chunk;
+        len -= chunk;
+    }
+}
+
+bool usb_cdc_write_block(const uint8_t *data, size_t len)
+{
+    if (data == NULL) {
+        return false;
+    }
+    // The whole block is staged by the caller, so it is pushed through the
+    // FIFO as it drains and flushed once instead of per line.
+    uint32_t start = to_ms_since_boot(get_absolute_time());
+    size_t sent = 0;
+    while (sent < len) {
+        if (!tud_cdc_connected()) {
+            return false;
+        }
+        uint32_t available = tud_cdc_write_available();
+        if (available == 0) {
+            tud_task();
+            if (to_ms_since_boot(get_absolute_time()) - start > 500) {
+                return false;
+            }
+            continue;
+        }
+        size_t chunk = len - sent;
+        if (chunk > available) {
+            chunk = available;
+        }
+        sent += cdc_write(data + sent, (uint32_t)chunk);
     }
-    tud_cdc_write(text, (uint32_t)len);
     tud_cdc_write_flush();
+    return true;
+}
+
+uint16_t usb_cdc_crc16(const uint8_t *data, size_t len)
+{
+    return crc16_ccitt(data, len);
 }
 
 void usb_cdc_printf(const char *fmt, ...)
@@ -202,4 +639,16 @@ void usb_cdc_printf(const char *fmt, ...)
 void usb_cdc_poll(void)
 {
     tud_task();
+    if (g_stage_frames > 0 &&
+        to_ms_since_boot(get_absolute_time()) - g_stage_since_ms >= g_pacer.limits.batch_ms) {
+        stage_flush();
+    }
+    if (tud_cdc_connected()) {
+        pacer_tick();
+    }
+    const bool connected = tud_cdc_connected();
+    if (connected && !g_was_connected && g_mode == TERPS_STREAM_BINARY) {
+        g_schema_pending = true;
+    }
+    g_was_connected = connected;
 }
@@ -0,0 +1,74 @@
+"""Benchmark the chunked CSV loader against a plain pandas read on a synthetic sample log."""
+
+from __future__ import annotations
+
+import argparse
+import time
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+from bslfs.fastcsv import read_csv_columns
+
+HEADER = "ts_ms,frequency_hz,tau_ms,diode_uV,pressure,adc_gain,flags,ppm_corr,mode\n"
+
+
+def write_synthetic_log(path: Path, size_mb: int, rows_per_block: int = 100_000) -> None:
+    """Write a CsvLogger-shaped file of roughly `size_mb` MiB, with metadata lines."""
+    rng = np.random.default_rng(0)
+    target = size_mb * 1024 * 1024
+    with path.open("w", encoding="utf-8") as fh:
+        fh.write("# coeff_source=config coeff_order=5 unit=Pa\n")
+        fh.write(HEADER)
+        ts = 0.0
+        while fh.tell() < target:
+            idx = np.arange(rows_per_block)
+            block = pd.DataFrame(
+                {
+                    "ts_ms": ts + 100.0 * idx,
+                    "frequency_hz": 30000.0 + rng.normal(scale=0.01, size=idx.size),
+                    "tau_ms": 100.0,
+                    "diode_uV": 600000.0 + rng.normal(scale=5.0, size=idx.size),
+                    "pressure": 101325.0 + rng.normal(scale=1.0, size=idx.size),
+                    "adc_gain": 16,
+                    "flags": rng.integers(0, 16, size=idx.size),
+                    "ppm_corr": 0.0,
+                    "mode": "RECIP",
+                }
+            )
+            block.to_csv(fh, header=False, index=False)
+            fh.write("# coeff_source=eeprom\n")
+            ts += 100.0 * rows_per_block
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--file", type=Path, default=Path("out/bench_log.csv"))
+    parser.add_argument("--size-mb", type=int, default=1024, help="Generate a file of this size if missing")
+    parser.add_argument("--workers", type=int, default=None)
+    parser.add_argument("--chunk-mb", type=int, default=32)
+    args = parser.parse_args()
+    if not args.file.exists():
+        args.file.parent.mkdir(parents=True, exist_ok=True)
+        write_synthetic_log(args.file, args.size_mb)
+    size_mb = args.file.stat().st_size / (1024 * 1024)
+
+    start = time.perf_counter()
+    frame = pd.read_csv(args.file, comment="#")
+    pandas_s = time.perf_counter() - start
+    rows = len(frame)
+    del frame
+
+    start = time.perf_counter()
+    table = read_csv_columns(args.file, chunk_bytes=args.chunk_mb << 20, workers=args.workers)
+    fast_s = time.perf_counter() - start
+    assert len(table) == rows
+
+    print(f"file={size_mb:.0f}MiB rows={rows} metadata_lines={len(table.metadata)}")
+    print(f"pandas  {pandas_s:.2f}s {size_mb / pandas_s:.0f}MiB/s")
+    print(f"chunked {fast_s:.2f}s {size_mb / fast_s:.0f}MiB/s")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,45 @@
+"""Edge-to-output latency of the firmware control output versus the USB round trip it replaces."""
+
+from __future__ import annotations
+
+import argparse
+
+import numpy as np
+
+from bslfs.terps.ctrl_out import OutputLatencySpec, output_latency_us, usb_round_trip_us
+
+CASES = [
+    ("PWM 12b freq", dict(pwm_bits=12)),
+    ("PWM 15b freq", dict(pwm_bits=15)),
+    ("PWM 12b 6x4 surface", dict(pwm_bits=12, poly_terms=24)),
+    ("MCP4921 6x4 surface", dict(pwm_bits=None, dac="MCP4921", poly_terms=24)),
+    ("DAC8551 8x8 surface", dict(pwm_bits=None, dac="DAC8551", poly_terms=64)),
+]
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--windows", type=int, default=100000)
+    parser.add_argument("--adc-rate", type=float, default=20.0, help="ADS1220 data rate (SPS)")
+    parser.add_argument("--host-ms", type=float, default=2.0, help="Fixed host read + compute time")
+    parser.add_argument("--host-jitter-ms", type=float, default=8.0, help="Mean exponential host delay")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(args.seed)
+    print("path                     p50_us    p99_us    max_us  write_p99_us  budget_us")
+    for name, kwargs in CASES:
+        spec = OutputLatencySpec(adc_rate_sps=args.adc_rate, **kwargs)
+        measured, effective = output_latency_us(spec, args.windows, rng)
+        p50, p99 = np.percentile(effective, [50, 99])
+        print(
+            f"{name:22s}  {p50:8.1f}  {p99:8.1f}  {effective.max():8.1f}  "
+            f"{np.percentile(measured, 99):12.1f}  {spec.budget_us:9.0f}"
+        )
+    usb = usb_round_trip_us(args.windows, rng, host_ms=args.host_ms, host_jitter_ms=args.host_jitter_ms)
+    p50, p99 = np.percentile(usb, [50, 99])
+    print(f"{'USB round trip':22s}  {p50:8.1f}  {p99:8.1f}  {usb.max():8.1f}  {'-':>12s}  {'-':>9s}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,68 @@
+"""Compare the per-sample CSV logger with the group-commit writer on the target filesystem."""
+
+from __future__ import annotations
+
+import argparse
+import time
+from pathlib import Path
+from typing import Dict
+
+from bslfs.terps.processing import CsvLogger, SampleRecord
+from bslfs.terps.writer import GroupCommitLogger
+
+
+def _proc_io() -> Dict[str, int]:
+    """Return /proc/self/io counters (Linux only; empty elsewhere)."""
+    try:
+        text = Path("/proc/self/io").read_text(encoding="ascii")
+    except OSError:
+        return {}
+    return {key: int(value) for key, value in (line.split(": ") for line in text.splitlines())}
+
+
+def _run(logger, samples: int) -> Dict[str, float]:
+    before = _proc_io()
+    start = time.perf_counter()
+    for idx in range(samples):
+        logger.append(
+            SampleRecord(idx * 10.0, 30000.0 + idx * 1e-4, 100.0, 600000.0, 101325.0, 16, 0, 0.0, "RECIP")
+        )
+    enqueued = time.perf_counter() - start
+    logger.close()
+    total = time.perf_counter() - start
+    after = _proc_io()
+    logical = logger.path.stat().st_size
+    result = {
+        "append_us": 1e6 * enqueued / samples,
+        "samples_per_s": samples / total,
+        "logical_bytes": float(logical),
+    }
+    if before and after:
+        result["write_syscalls"] = float(after["syscw"] - before["syscw"])
+        result["device_bytes"] = float(after["write_bytes"] - before["write_bytes"])
+        result["amplification"] = result["device_bytes"] / max(logical, 1)
+    return result
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--dir", type=Path, default=Path("out/bench"), help="Directory on the disk under test")
+    parser.add_argument("--samples", type=int, default=20000)
+    parser.add_argument("--commit-rows", type=int, default=256)
+    parser.add_argument("--fsync-interval", type=float, default=5.0)
+    args = parser.parse_args()
+    args.dir.mkdir(parents=True, exist_ok=True)
+
+    loggers = {
+        "sync": CsvLogger(args.dir / "sync.csv"),
+        "group": GroupCommitLogger(
+            args.dir / "group.csv", commit_rows=args.commit_rows, fsync_interval_s=args.fsync_interval
+        ),
+    }
+    for name, logger in loggers.items():
+        result = _run(logger, args.samples)
+        print(name, " ".join(f"{key}={value:.3g}" for key, value in result.items()))
+
+
+if __name__ == "__main__":
+    main()
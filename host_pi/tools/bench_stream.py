@@ -0,0 +1,65 @@
+"""Measure sample-stream fan-out throughput with many local subscribers."""
+
+from __future__ import annotations
+
+import argparse
+import tempfile
+import threading
+import time
+from pathlib import Path
+from typing import List
+
+from bslfs.terps.processing import SampleRecord
+from bslfs.terps.stream import SampleStreamServer, SubscriptionSpec, subscribe
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--clients", type=int, default=32)
+    parser.add_argument("--distinct", type=int, default=4, help="Number of distinct subscription specs")
+    parser.add_argument("--samples", type=int, default=100_000)
+    parser.add_argument("--batch", type=int, default=64)
+    args = parser.parse_args()
+
+    path = Path(tempfile.mkdtemp()) / "bench.sock"
+    server = SampleStreamServer(path, max_backlog=64 << 20)
+    server.start()
+    specs = [SubscriptionSpec(decimate=1 + idx % args.distinct) for idx in range(args.clients)]
+    received: List[int] = [0] * args.clients
+    published = args.samples // args.batch * args.batch
+
+    def consume(idx: int) -> None:
+        expected = -(-published // specs[idx].decimate)
+        for _ in subscribe(path, specs[idx], timeout=30.0):
+            received[idx] += 1
+            if received[idx] >= expected:
+                break
+
+    threads = [threading.Thread(target=consume, args=(idx,), daemon=True) for idx in range(args.clients)]
+    for thread in threads:
+        thread.start()
+    while server.stats()["connected"] < args.clients:
+        time.sleep(0.01)
+
+    batch = [
+        SampleRecord(float(i), 30000.0, 100.0, 600000.0, 101325.0, 16, 0, 0.0, "RECIP")
+        for i in range(args.batch)
+    ]
+    start = time.perf_counter()
+    for _ in range(published // args.batch):
+        server.publish(batch)
+    publish_s = time.perf_counter() - start
+    for thread in threads:
+        thread.join()
+    total_s = time.perf_counter() - start
+    server.close()
+    delivered = sum(received)
+    print(
+        f"clients={args.clients} channels={args.distinct} samples={published} "
+        f"publish={published / publish_s:.0f}/s delivered_rows={delivered} "
+        f"fan_out={delivered / total_s:.0f} rows/s"
+    )
+
+
+if __name__ == "__main__":
+    main()
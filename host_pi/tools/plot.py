@@ -5,12 +5,13 @@ from __future__ import annotations
 from pathlib import Path
 
 import matplotlib.pyplot as plt
-import pandas as pd
+
+from bslfs.fastcsv import read_csv_columns
 
 
 def plot_timeseries(csv_path: Path) -> None:
     """Plot frequency and pressure from a processed CSV log."""
-    data = pd.read_csv(csv_path)
+    data = read_csv_columns(csv_path, usecols=["ts_ms", "frequency_hz", "pressure"]).columns
     fig, ax1 = plt.subplots(figsize=(10, 5))
     ax1.plot(data["ts_ms"] / 1000.0, data["frequency_hz"], label="frequency [Hz]", color="tab:blue")
     ax1.set_xlabel("Time [s]")
@@ -8,6 +8,8 @@ from typing import Optional
 import numpy as np
 import pandas as pd
 
+from .fastcsv import read_csv_columns
+
 REQUIRED_COLUMNS = {"pressure_ref", "output", "cycle_id"}
 OPTIONAL_COLUMNS = {"temp"}
 
@@ -45,7 +47,7 @@ def load_calibration_csv(path: str | Path) -> CalibrationData:
     if not path.exists():  # pragma: no cover - defensive
         raise FileNotFoundError(path)
 
-    df = pd.read_csv(path)
+    df = read_csv_columns(path).to_dataframe()
     missing = REQUIRED_COLUMNS - set(df.columns)
     if missing:
         raise ValueError(f"Missing required columns: {sorted(missing)}")
@@ -0,0 +1,202 @@
+"""Chunked, memory-mapped CSV loader for calibration files and TERPS sample logs."""
+from __future__ import annotations
+
+import io
+import mmap
+import os
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+
+DEFAULT_CHUNK_BYTES = 32 * 1024 * 1024
+
+
+@dataclass
+class CsvTable:
+    """Typed column arrays plus the `# key=value` lines found in the file.
+
+    Each metadata entry is paired with the index of the first data row that
+    follows it, so coefficient changes recorded mid-log can be mapped back to
+    the samples they apply to.
+    """
+
+    columns: Dict[str, np.ndarray]
+    metadata: List[Tuple[int, Dict[str, str]]] = field(default_factory=list)
+
+    def __len__(self) -> int:
+        return len(next(iter(self.columns.values()))) if self.columns else 0
+
+    def to_dataframe(self) -> pd.DataFrame:
+        return pd.DataFrame(self.columns, copy=False)
+
+
+def parse_metadata_line(line: str) -> Dict[str, str]:
+    """Decode a `# key=value key=value` line as written by `CsvLogger`."""
+
+    data: Dict[str, str] = {}
+    for token in line.lstrip("#").split():
+        if "=" in token:
+            key, value = token.split("=", 1)
+            data[key] = value
+    return data
+
+
+def read_csv_columns(
+    path: str | Path,
+    *,
+    chunk_bytes: int = DEFAULT_CHUNK_BYTES,
+    workers: Optional[int] = None,
+    usecols: Optional[List[str]] = None,
+) -> CsvTable:
+    """Load a CSV file into per-column numpy arrays.
+
+    The file is memory-mapped and split on line boundaries into chunks of
+    roughly ``chunk_bytes``. Chunks are tokenised in parallel by pandas' C
+    parser (which releases the GIL while parsing numbers), then concatenated
+    column by column with the usual numpy type promotion.
+    Leading and interleaved ``#`` lines are collected as metadata.
+    """
+
+    path = Path(path)
+    with path.open("rb") as fh:
+        size = os.fstat(fh.fileno()).st_size
+        if size == 0:
+            return CsvTable(columns={})
+        with mmap.mmap(fh.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            return _read_mapped(mm, size, chunk_bytes, workers, usecols)
+
+
+def _read_mapped(
+    mm: mmap.mmap,
+    size: int,
+    chunk_bytes: int,
+    workers: Optional[int],
+    usecols: Optional[List[str]],
+) -> CsvTable:
+    header, pos, metadata = _read_header(mm, size)
+    if header is None:
+        return CsvTable(columns={}, metadata=metadata)
+
+    bounds = _chunk_bounds(mm, pos, size, max(chunk_bytes, 1 << 16))
+    view = memoryview(mm)
+    try:
+        with ThreadPoolExecutor(max_workers=workers or os.cpu_count() or 1) as pool:
+            parts = list(
+                pool.map(lambda span: _parse_chunk(view[span[0] : span[1]], header, usecols), bounds)
+            )
+    finally:
+        view.release()
+
+    row_base = 0
+    for frame, comments in parts:
+        for row, line in comments:
+            metadata.append((row_base + row, parse_metadata_line(line)))
+        row_base += len(frame)
+    names = list(parts[0][0].columns)
+    columns = {
+        name: np.concatenate([frame[name].to_numpy() for frame, _ in parts]) for name in names
+    }
+    return CsvTable(columns=columns, metadata=metadata)
+
+
+@dataclass
+class CsvLayout:
+    """Header and line-aligned byte ranges of a CSV file, for partial scans."""
+
+    header: List[str]
+    chunks: List[Tuple[int, int]]
+
+
+def csv_layout(path: str | Path, chunk_bytes: int = DEFAULT_CHUNK_BYTES) -> CsvLayout:
+    path = Path(path)
+    with path.open("rb") as fh:
+        size = os.fstat(fh.fileno()).st_size
+        if size == 0:
+            return CsvLayout(header=[], chunks=[])
+        with mmap.mmap(fh.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            header, pos, _ = _read_header(mm, size)
+            if header is None:
+                return CsvLayout(header=[], chunks=[])
+            return CsvLayout(header=header, chunks=_chunk_bounds(mm, pos, size, max(chunk_bytes, 1 << 16)))
+
+
+def read_csv_range(
+    path: str | Path,
+    header: List[str],
+    start: int,
+    stop: int,
+    usecols: Optional[List[str]] = None,
+) -> pd.DataFrame:
+    """Parse the rows in ``[start, stop)``; bounds must come from `csv_layout`."""
+
+    with Path(path).open("rb") as fh:
+        fh.seek(start)
+        raw = fh.read(stop - start)
+    return _parse_chunk(memoryview(raw), header, usecols)[0]
+
+
+def _read_header(
+    mm: mmap.mmap, size: int
+) -> Tuple[Optional[List[str]], int, List[Tuple[int, Dict[str, str]]]]:
+    metadata: List[Tuple[int, Dict[str, str]]] = []
+    pos = 0
+    while pos < size:
+        end = mm.find(b"\n", pos)
+        end = size if end < 0 else end
+        line = mm[pos:end].decode("utf-8").rstrip("\r")
+        pos = end + 1
+        if line.startswith("#"):
+            metadata.append((0, parse_metadata_line(line)))
+        elif line.strip():
+            return [name.strip() for name in line.split(",")], pos, metadata
+    return None, pos, metadata
+
+
+def _chunk_bounds(mm: mmap.mmap, start: int, size: int, chunk_bytes: int) -> List[Tuple[int, int]]:
+    bounds: List[Tuple[int, int]] = []
+    while start < size:
+        stop = min(start + chunk_bytes, size)
+        if stop < size:
+            newline = mm.find(b"\n", stop)
+            stop = size if newline < 0 else newline + 1
+        bounds.append((start, stop))
+        start = stop
+    return bounds or [(start, start)]
+
+
+def _parse_chunk(
+    data: memoryview,
+    header: List[str],
+    usecols: Optional[List[str]],
+) -> Tuple[pd.DataFrame, List[Tuple[int, str]]]:
+    raw = bytes(data)
+    comments: List[Tuple[int, str]] = []
+    pos = 0 if raw.startswith(b"#") else raw.find(b"\n#")
+    counted = 0
+    rows_before = 0
+    while pos >= 0:
+        start = pos if raw[pos : pos + 1] == b"#" else pos + 1
+        end = raw.find(b"\n", start)
+        end = len(raw) if end < 0 else end
+        rows_before += raw.count(b"\n", counted, start)
+        comments.append((rows_before, raw[start:end].decode("utf-8").rstrip("\r")))
+        rows_before -= 1  # the comment line's own newline is not a row
+        counted = start
+        pos = raw.find(b"\n#", end)
+    if not raw.strip():
+        frame = pd.DataFrame({name: pd.Series(dtype=float) for name in usecols or header})
+        return frame, comments
+    frame = pd.read_csv(
+        io.BytesIO(raw),
+        header=None,
+        names=header,
+        usecols=usecols,
+        comment="#",
+        engine="c",
+        skip_blank_lines=True,
+    )
+    return frame, comments
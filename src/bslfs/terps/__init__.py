@@ -7,11 +7,14 @@ helpers used by the Raspberry Pi host application. Keeping this logic inside
 introducing a parallel package.
 """
 
+from .capture import decode_edges, encode_edges
 from .coeff import Coeff, CoeffManager, coeff_from_sensor_poly, coeff_metadata
 from .config import AdcConfig, HostRuntime, SensorPoly, TerpsConfig, load_config
 from .frames import Frame, FrameFormat, FrameParser, crc16_ccitt
 from .processing import PressureCalculator, SampleRecord
 from .runner import TerpsHost
+from .tracelog import TraceRecord, TraceStringTable
+from .writer import GroupCommitLogger
 
 __all__ = [
     "AdcConfig",
@@ -19,6 +22,8 @@ __all__ = [
     "SensorPoly",
     "TerpsConfig",
     "load_config",
+    "decode_edges",
+    "encode_edges",
     "Coeff",
     "CoeffManager",
     "coeff_from_sensor_poly",
@@ -30,4 +35,7 @@ __all__ = [
     "PressureCalculator",
     "SampleRecord",
     "TerpsHost",
+    "TraceRecord",
+    "TraceStringTable",
+    "GroupCommitLogger",
 ]
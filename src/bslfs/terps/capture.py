@@ -0,0 +1,229 @@
+"""
+Codec for the firmware's compressed raw edge capture (`CAPTURE.*` commands).
+
+Each period is stored as a residual against the previous period in a nibble
+stream: one nibble for |r| <= 7, an escape plus 8 bits for |r| <= 127, two
+escapes plus 16 bits for |r| <= 32767, and three escapes plus the absolute
+32-bit period otherwise. `encode_edges` mirrors `edge_capture_push()` so the
+format can be validated against synthetic and recorded traces on the host.
+"""
+
+from __future__ import annotations
+
+import struct
+import time
+from dataclasses import dataclass, field
+from typing import Callable, Dict, List, Sequence, Tuple, Union
+
+import numpy as np
+
+from .coeff import BinaryExecutor, _parse_header_tokens
+from .frames import crc16_ccitt
+
+ESC4 = 0x8
+ESC8 = 0x80
+ESC16 = 0x8000
+CAPTURE_READ_CHUNK = 2048
+
+Timestamps = Union[Sequence[int], np.ndarray]
+
+
+@dataclass
+class CaptureStats:
+    edges: int = 0
+    tokens4: int = 0
+    tokens8: int = 0
+    tokens16: int = 0
+    tokens32: int = 0
+    nibbles: int = 0
+
+    @property
+    def bytes_used(self) -> int:
+        return (self.nibbles + 1) // 2
+
+    @property
+    def bits_per_edge(self) -> float:
+        periods = max(self.edges - 1, 1)
+        return 4.0 * self.nibbles / periods
+
+    def ratio(self, raw_bytes_per_edge: int = 4) -> float:
+        """Compression ratio against storing each edge as a raw timestamp."""
+        return raw_bytes_per_edge * self.edges / max(self.bytes_used, 1)
+
+
+@dataclass
+class ResidualSummary:
+    periods: int
+    min: int
+    max: int
+    std: float
+    token_share: Dict[str, float] = field(default_factory=dict)
+
+
+class _NibbleWriter:
+    def __init__(self) -> None:
+        self.data = bytearray()
+        self.count = 0
+
+    def put(self, value: int, nibbles: int = 1) -> None:
+        for shift in range(nibbles - 1, -1, -1):
+            nibble = (value >> (4 * shift)) & 0xF
+            if self.count % 2 == 0:
+                self.data.append(nibble << 4)
+            else:
+                self.data[-1] |= nibble
+            self.count += 1
+
+
+def encode_edges(timestamps_us: Timestamps) -> Tuple[bytes, CaptureStats]:
+    stats = CaptureStats()
+    writer = _NibbleWriter()
+    if len(timestamps_us) == 0:
+        return b"", stats
+    stats.edges = 1
+    last = int(timestamps_us[0])
+    pred = 0
+    for raw in timestamps_us[1:]:
+        ts = int(raw)
+        period = (ts - last) & 0xFFFFFFFF
+        residual = period - pred
+        if -7 <= residual <= 7:
+            writer.put(residual)
+            stats.tokens4 += 1
+        elif -127 <= residual <= 127:
+            writer.put(ESC4)
+            writer.put(residual, 2)
+            stats.tokens8 += 1
+        elif -32767 <= residual <= 32767:
+            writer.put(ESC4)
+            writer.put(ESC8, 2)
+            writer.put(residual, 4)
+            stats.tokens16 += 1
+        else:
+            writer.put(ESC4)
+            writer.put(ESC8, 2)
+            writer.put(ESC16, 4)
+            writer.put(period, 8)
+            stats.tokens32 += 1
+        last = ts
+        pred = period
+        stats.edges += 1
+    stats.nibbles = writer.count
+    return bytes(writer.data), stats
+
+
+def _signed(value: int, bits: int) -> int:
+    sign = 1 << (bits - 1)
+    return (value ^ sign) - sign
+
+
+def decode_edges(data: bytes, first_us: int, edges: int) -> np.ndarray:
+    """Expand a capture stream back into absolute timestamps (µs)."""
+
+    out = np.empty(max(edges, 0), dtype=np.int64)
+    if edges <= 0:
+        return out
+    raw = np.frombuffer(data, dtype=np.uint8)
+    nib: List[int] = np.column_stack([raw >> 4, raw & 0xF]).ravel().tolist()
+    pos = 0
+
+    def take(count: int) -> int:
+        nonlocal pos
+        if pos + count > len(nib):
+            raise ValueError("Capture stream truncated")
+        value = 0
+        for item in nib[pos : pos + count]:
+            value = (value << 4) | item
+        pos += count
+        return value
+
+    out[0] = first_us
+    last = int(first_us)
+    pred = 0
+    for idx in range(1, edges):
+        token = take(1)
+        if token != ESC4:
+            period = pred + _signed(token, 4)
+        else:
+            value = take(2)
+            if value != ESC8:
+                period = pred + _signed(value, 8)
+            else:
+                value = take(4)
+                if value != ESC16:
+                    period = pred + _signed(value, 16)
+                else:
+                    period = take(8)
+        period &= 0xFFFFFFFF
+        last += period
+        out[idx] = last
+        pred = period
+    return out
+
+
+def residual_stats(timestamps_us: Timestamps) -> ResidualSummary:
+    ts = np.asarray(timestamps_us, dtype=np.int64)
+    periods = np.diff(ts)
+    if periods.size < 2:
+        return ResidualSummary(periods=int(periods.size), min=0, max=0, std=0.0)
+    residuals = np.diff(periods)
+    mag = np.abs(residuals)
+    total = float(residuals.size)
+    share = {
+        "4": float(np.count_nonzero(mag <= 7)) / total,
+        "8": float(np.count_nonzero((mag > 7) & (mag <= 127))) / total,
+        "16": float(np.count_nonzero((mag > 127) & (mag <= 32767))) / total,
+        "32": float(np.count_nonzero(mag > 32767)) / total,
+    }
+    return ResidualSummary(
+        periods=int(periods.size),
+        min=int(residuals.min()),
+        max=int(residuals.max()),
+        std=float(residuals.std()),
+        token_share=share,
+    )
+
+
+def read_capture(
+    executor: Callable[[str, float], Sequence[str]],
+    binary_executor: BinaryExecutor,
+    timeout: float,
+    max_edges: int = 0,
+    wait_s: float = 10.0,
+) -> Tuple[np.ndarray, Dict[str, str]]:
+    """
+    Arm a capture, wait until the firmware disarms (edge limit or buffer full),
+    then pull the stream in CRC-checked chunks and decode it.
+    """
+    lines = executor(f"CAPTURE.START {max_edges}", timeout)
+    if not lines or not lines[0].startswith("OK"):
+        raise ValueError(f"CAPTURE.START failed: {lines[0] if lines else 'no reply'}")
+    deadline = time.monotonic() + wait_s
+    while True:
+        status = _parse_header_tokens(executor("CAPTURE.STATUS", timeout)[0])
+        if status.get("ARMED") == "0":
+            break
+        if time.monotonic() >= deadline:
+            status = _parse_header_tokens(executor("CAPTURE.STOP", timeout)[0])
+            break
+        time.sleep(0.1)
+
+    total = int(status.get("BYTES", "0"))
+    data = bytearray()
+    while len(data) < total:
+        lines, block = binary_executor(
+            f"CAPTURE.READ {len(data)} {CAPTURE_READ_CHUNK}", timeout
+        )
+        if not lines or not lines[0].startswith("OK"):
+            raise ValueError(f"CAPTURE.READ failed: {lines[0] if lines else 'no reply'}")
+        length = int(_parse_header_tokens(lines[0]).get("LEN", "0"))
+        if length == 0 or len(block) != length + 2:
+            raise ValueError(f"CAPTURE.READ returned {len(block)} bytes for LEN={length}")
+        crc_expected = struct.unpack_from("<H", block, length)[0]
+        if crc16_ccitt(block[:length]) != crc_expected:
+            raise ValueError(f"CAPTURE.READ CRC mismatch at offset {len(data)}")
+        data.extend(block[:length])
+
+    edges = int(status.get("EDGES", "0"))
+    timestamps = decode_edges(bytes(data), int(status.get("FIRST_US", "0")), edges)
+    return timestamps, status
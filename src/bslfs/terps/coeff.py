@@ -3,11 +3,12 @@ from __future__ import annotations
 import json
 import logging
 import struct
-from dataclasses import dataclass, field
+from dataclasses import dataclass
 from pathlib import Path
 from typing import Callable, Dict, Iterable, List, Optional, Sequence, Tuple
 
 from .config import SensorPoly, TerpsConfig
+from .frames import crc16_ccitt
 
 logger = logging.getLogger(__name__)
 
@@ -15,6 +16,9 @@ RPS_EEPROM_SIZE = 0x200
 RPS_EEPROM_CHECKSUM = 0x1234
 RPS_UNIT_DEFAULT = "Pa"
 K_TABLE_BASE = 0x0100
+EEPROM_BLOCK_MAGIC = b"\x55\xEE"
+EEPROM_BLOCK_VERSION = 1
+_EEPROM_BLOCK_HEADER = struct.Struct("<2sBBHHI")
 
 
 def _is_printable(byte_value: int) -> bool:
@@ -110,6 +114,105 @@ def parse_eeprom_dump(lines: Sequence[str]) -> Tuple[bytes, Dict[str, str]]:
     return data, header_map
 
 
+def parse_eeprom_block(lines: Sequence[str], block: bytes) -> Tuple[bytes, Dict[str, str]]:
+    """
+    Decode an `EEPROM.READB` reply: the `OK ... BIN=<n>` header line plus the
+    framed binary image that follows it. Returns the same shape as
+    `parse_eeprom_dump` so callers can switch transfer modes transparently.
+    """
+    if not lines:
+        raise ValueError("EEPROM block reply is empty")
+    header = lines[0].strip()
+    if not header.startswith("OK"):
+        raise ValueError(f"Unexpected EEPROM header: {header}")
+    header_map = _parse_header_tokens(header)
+    header_size = _EEPROM_BLOCK_HEADER.size
+    if len(block) < header_size + 2:
+        raise ValueError(f"EEPROM block too short ({len(block)} bytes)")
+    magic, version, device_addr, start, length, bitrate = _EEPROM_BLOCK_HEADER.unpack_from(block)
+    if magic != EEPROM_BLOCK_MAGIC:
+        raise ValueError("EEPROM block magic mismatch")
+    if version != EEPROM_BLOCK_VERSION:
+        raise ValueError(f"Unsupported EEPROM block version {version}")
+    end = header_size + length
+    if len(block) != end + 2:
+        raise ValueError(f"EEPROM length mismatch (expected {length}, got {len(block) - header_size - 2})")
+    crc_expected = struct.unpack_from("<H", block, end)[0]
+    crc_actual = crc16_ccitt(block[2:end])
+    if crc_actual != crc_expected:
+        raise ValueError(
+            f"EEPROM block CRC mismatch (expected 0x{crc_expected:04X}, got 0x{crc_actual:04X})"
+        )
+    header_map.update(
+        {
+            "DEV": f"0x{device_addr:02X}",
+            "START": f"0x{start:04X}",
+            "LEN": str(length),
+            "BITRATE": str(bitrate),
+        }
+    )
+    return bytes(block[header_size:end]), header_map
+
+
+@dataclass
+class EepromBusImage:
+    bus: int
+    gpio: int
+    status: str
+    device_address: int
+    data: bytes = b""
+
+
+def parse_eeprom_scan(lines: Sequence[str]) -> Tuple[List[EepromBusImage], Dict[str, str]]:
+    """
+    Decode an `EEPROM.SCAN` / `EEPROM.BUSES` reply: the summary header, then
+    one `B <bus> GPIO= STATUS= DEV=` line per UNI/O bus, followed by the hex
+    image for buses that read OK.
+    """
+    if not lines:
+        raise ValueError("EEPROM scan reply is empty")
+    header = lines[0].strip()
+    if not header.startswith("OK"):
+        raise ValueError(f"Firmware reported error: {header}")
+    header_map = _parse_header_tokens(header)
+    expected_len = int(header_map.get("LEN", "0"))
+    buses: List[EepromBusImage] = []
+    hex_parts: List[str] = []
+
+    def close_bus() -> None:
+        if not buses:
+            return
+        data = bytes.fromhex("".join(hex_parts))
+        if buses[-1].status == "OK" and len(data) != expected_len:
+            raise ValueError(f"Bus {buses[-1].bus}: expected {expected_len} bytes, got {len(data)}")
+        buses[-1].data = data
+        hex_parts.clear()
+
+    for line in lines[1:]:
+        stripped = line.strip()
+        if not stripped:
+            continue
+        if stripped == "END":
+            break
+        if stripped.startswith("B "):
+            close_bus()
+            fields = _parse_header_tokens(stripped)
+            buses.append(
+                EepromBusImage(
+                    bus=int(stripped.split()[1]),
+                    gpio=int(fields.get("GPIO", "-1")),
+                    status=fields.get("STATUS", "?"),
+                    device_address=int(fields.get("DEV", "0"), 0),
+                )
+            )
+            continue
+        hex_parts.append(stripped)
+    close_bus()
+    if len(buses) != int(header_map.get("BUSES", len(buses))):
+        raise ValueError("EEPROM scan reply is missing buses")
+    return buses, header_map
+
+
 def _decode_ascii_field(blob: bytes) -> str:
     return blob.decode("ascii", errors="ignore").rstrip("\x00").strip()
 
@@ -189,16 +292,43 @@ class DefaultConfig:
         return self._coeff
 
 
+BinaryExecutor = Callable[[str, float], Tuple[Sequence[str], bytes]]
+
+
+def read_eeprom_image(
+    executor: Callable[[str, float], Sequence[str]],
+    binary_executor: Optional[BinaryExecutor],
+    timeout: float,
+) -> Tuple[bytes, Dict[str, str]]:
+    """
+    Fetch the 512-byte image, preferring the framed `EEPROM.READB` transfer and
+    falling back to the hex `EEPROM.DUMP` text for firmware without it.
+    """
+    if binary_executor is not None:
+        lines, block = binary_executor(f"EEPROM.READB 0 {RPS_EEPROM_SIZE}", timeout)
+        if lines and not lines[0].startswith("ERR UNKNOWN_CMD"):
+            if lines[0].startswith("ERR"):
+                raise ValueError(f"Firmware reported error: {lines[0].strip()}")
+            return parse_eeprom_block(lines, block)
+    lines = executor(f"EEPROM.DUMP 0 {RPS_EEPROM_SIZE}", timeout)
+    return parse_eeprom_dump(lines)
+
+
 class EepromOverCdc:
-    def __init__(self, executor: Callable[[str, float], Sequence[str]], timeout_sec: float = 2.0) -> None:
+    def __init__(
+        self,
+        executor: Callable[[str, float], Sequence[str]],
+        timeout_sec: float = 2.0,
+        binary_executor: Optional[BinaryExecutor] = None,
+    ) -> None:
         self._executor = executor
+        self._binary_executor = binary_executor
         self._timeout = timeout_sec
         self._last_blob: Optional[bytes] = None
         self._last_coeff: Optional[Coeff] = None
 
     def fetch(self) -> Coeff:
-        lines = self._executor("EEPROM.DUMP 0 512", self._timeout)
-        blob, header = parse_eeprom_dump(lines)
+        blob, header = read_eeprom_image(self._executor, self._binary_executor, self._timeout)
         if self._last_blob == blob and self._last_coeff is not None:
             return self._last_coeff
         device_addr = None
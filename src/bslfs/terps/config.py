@@ -20,6 +20,17 @@ class HostRuntime:
     reconnect_max_sec: float = 5.0
     stats_log_interval: float = 60.0
     binary_chunk_size: int = 256
+    trace_strings: Optional[str] = None
+    log_writer: str = "group"  # group | sync
+    log_commit_rows: int = 256
+    log_commit_interval_sec: float = 1.0
+    log_fsync_interval_sec: float = 5.0
+    batch_max_frames: int = 64
+    drop_flags: int = 0  # frames with any of these flag bits are not logged
+    require_flags: int = 0  # frames missing any of these flag bits are not logged
+    stream_socket: Optional[str] = None
+    schedule_period_ms: float = 0.0  # >0 aligns gate windows to k * period of host time
+    schedule_resync_sec: float = 60.0
 
 
 @dataclass
@@ -138,6 +149,21 @@ def load_config(path: Path | str, overrides: Sequence[str] | None = None) -> Ter
             reconnect_max_sec=float(host_data.get("reconnect_max_sec", 5.0)),
             stats_log_interval=float(host_data.get("stats_log_interval", 60.0)),
             binary_chunk_size=int(host_data.get("binary_chunk_size", 256)),
+            trace_strings=(
+                str(host_data["trace_strings"]) if host_data.get("trace_strings") else None
+            ),
+            log_writer=str(host_data.get("log_writer", "group")),
+            log_commit_rows=int(host_data.get("log_commit_rows", 256)),
+            log_commit_interval_sec=float(host_data.get("log_commit_interval_sec", 1.0)),
+            log_fsync_interval_sec=float(host_data.get("log_fsync_interval_sec", 5.0)),
+            batch_max_frames=int(host_data.get("batch_max_frames", 64)),
+            drop_flags=int(host_data.get("drop_flags", 0)),
+            require_flags=int(host_data.get("require_flags", 0)),
+            stream_socket=(
+                str(host_data["stream_socket"]) if host_data.get("stream_socket") else None
+            ),
+            schedule_period_ms=float(host_data.get("schedule_period_ms", 0.0)),
+            schedule_resync_sec=float(host_data.get("schedule_resync_sec", 60.0)),
         ),
     )
 
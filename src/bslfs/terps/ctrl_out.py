@@ -0,0 +1,245 @@
+"""
+Host model of the firmware control output (`ctrl_out.cpp`) and its latency.
+
+`ControlOutputModel` repeats the per-window scaling, limits and fault handling
+so a configuration can be checked before it drives an actuator. The latency
+model walks the path a window takes on the Pico — closing edge, IRQ and
+doorbell, core1 wake, ADC read, surface evaluation, PWM latch or DAC write —
+and `run_output_pipeline()` feeds it the windows the edge simulator produces,
+so the edge-to-output budget can be checked against the USB round trip it
+replaces (`usb_round_trip_us`).
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+from typing import List, Optional
+
+import numpy as np
+
+from .config import SensorPoly
+from .sim import EdgeCounterModel, EdgeTraceSpec, quantize_us, synthetic_edge_times
+
+SOURCES = ("OFF", "FREQ", "PRESSURE")
+DAC_BITS = {"MCP4921": 12, "DAC8551": 16}
+DAC_WORD_BITS = {"MCP4921": 16, "DAC8551": 24}
+POLY_MAX = 8
+
+
+@dataclass
+class OutputScale:
+    """Mirror of `ctrl_out_scale_t`."""
+
+    source: str = "OFF"
+    in_lo: float = 0.0
+    in_hi: float = 1.0
+    out_min: float = 0.0
+    out_max: float = 1.0
+    fault_level: float = -1.0  # < 0 holds the last level
+
+    def __post_init__(self) -> None:
+        if self.source not in SOURCES:
+            raise ValueError(f"source must be one of {SOURCES}")
+        if self.in_hi == self.in_lo:
+            raise ValueError("in_hi must differ from in_lo")
+        if not 0.0 <= self.out_min <= self.out_max <= 1.0:
+            raise ValueError("need 0 <= out_min <= out_max <= 1")
+
+
+def eval_poly(poly: SensorPoly, f_hz: float, diode_uV: float) -> float:
+    """Horner evaluation in the same order as `eval_poly()` on the device."""
+
+    x = f_hz - poly.X
+    y = diode_uV - poly.Y
+    total = 0.0
+    for row in reversed(poly.K):
+        acc = 0.0
+        for k in reversed(row):
+            acc = acc * y + k
+        total = total * x + acc
+    return total
+
+
+@dataclass
+class ControlOutputModel:
+    scale: OutputScale
+    poly: Optional[SensorPoly] = None
+    pwm_bits: Optional[int] = 12
+    dac: Optional[str] = None
+    level: float = field(init=False)
+    have_level: bool = field(init=False, default=False)
+    updates: int = field(init=False, default=0)
+    faults: int = field(init=False, default=0)
+    clamped: int = field(init=False, default=0)
+
+    def __post_init__(self) -> None:
+        if self.pwm_bits is not None:
+            self.pwm_bits = min(max(int(self.pwm_bits), 8), 15)
+        if self.dac is not None and self.dac not in DAC_BITS:
+            raise ValueError(f"dac must be one of {tuple(DAC_BITS)}")
+        self.level = self._idle_level()
+
+    def _idle_level(self) -> float:
+        fault = self.scale.fault_level
+        return min(max(fault, 0.0), 1.0) if fault >= 0.0 else self.scale.out_min
+
+    def update(self, f_hz: float, diode_uV: float = 0.0, f_valid: bool = True, v_valid: bool = True) -> Optional[float]:
+        """One window; returns the level written, or None when nothing was written."""
+
+        scale = self.scale
+        if scale.source == "OFF":
+            return None
+        if scale.source == "FREQ":
+            valid, value = f_valid, f_hz
+        else:
+            valid = f_valid and v_valid and self.poly is not None
+            # The device evaluates in double and stores the result as float.
+            value = float(np.float32(eval_poly(self.poly, f_hz, diode_uV))) if valid else 0.0
+        if valid:
+            frac = (value - scale.in_lo) / (scale.in_hi - scale.in_lo)
+            raw = scale.out_min + frac * (scale.out_max - scale.out_min)
+            self.level = min(max(raw, scale.out_min), scale.out_max)
+            self.clamped += self.level != raw
+            self.updates += 1
+            self.have_level = True
+            return self.level
+        self.faults += 1
+        if scale.fault_level >= 0.0 or not self.have_level:
+            self.level = self._idle_level()
+            return self.level
+        return None
+
+    @property
+    def pwm_code(self) -> int:
+        return int(round(self.level * (1 << self.pwm_bits))) if self.pwm_bits else 0
+
+    @property
+    def dac_code(self) -> int:
+        return int(round(self.level * ((1 << DAC_BITS[self.dac]) - 1))) if self.dac else 0
+
+
+def poly_commands(poly: SensorPoly) -> List[str]:
+    """`OUT.POLY` / `OUT.K` / `OUT.POLY.COMMIT` lines that upload ``poly``."""
+
+    rows, cols = len(poly.K), len(poly.K[0])
+    if rows > POLY_MAX or cols > POLY_MAX:
+        raise ValueError(f"firmware surface is limited to {POLY_MAX}x{POLY_MAX}")
+    lines = [f"OUT.POLY {rows} {cols} {poly.X!r} {poly.Y!r}"]
+    for i, row in enumerate(poly.K):
+        lines.extend(f"OUT.K {i} {j} {float(k)!r}" for j, k in enumerate(row))
+    lines.append("OUT.POLY.COMMIT")
+    return lines
+
+
+@dataclass
+class OutputLatencySpec:
+    """
+    Timing of one output update on the Pico, in µs. ``adc_read_us`` is a
+    4-byte RDATA at 1 MHz; it delays the update when core1 is already inside
+    one (probability adc_rate_sps × adc_read_us) and when a conversion is
+    waiting at the window's own ADC read.
+    """
+
+    sys_hz: float = 150e6
+    pwm_bits: Optional[int] = 12
+    dac: Optional[str] = None
+    spi_hz: float = 1e6
+    edge_irq_us: float = 2.0
+    wake_us: float = 1.5
+    wake_jitter_us: float = 1.0
+    adc_rate_sps: float = 20.0
+    adc_read_us: float = 40.0
+    eval_us_per_term: float = 0.15
+    poly_terms: int = 0
+    budget_us: float = 100.0
+
+    @property
+    def pwm_period_us(self) -> float:
+        return (1 << self.pwm_bits) / self.sys_hz * 1e6 if self.pwm_bits else 0.0
+
+    @property
+    def dac_write_us(self) -> float:
+        return DAC_WORD_BITS[self.dac] / self.spi_hz * 1e6 + 1.0 if self.dac else 0.0
+
+
+@dataclass
+class OutputTrace:
+    end_us: np.ndarray
+    freq_hz: np.ndarray
+    level: np.ndarray
+    measured_us: np.ndarray   # what OUT.STATUS reports (write completed)
+    effective_us: np.ndarray  # until the analog output follows (PWM latch included)
+
+    def percentile(self, q: float, effective: bool = True) -> float:
+        data = self.effective_us if effective else self.measured_us
+        return float(np.percentile(data, q)) if len(data) else 0.0
+
+
+def output_latency_us(spec: OutputLatencySpec, n: int, rng: np.random.Generator) -> tuple:
+    """(measured, effective) latency samples for ``n`` windows."""
+
+    wake = spec.edge_irq_us + spec.wake_us + rng.uniform(0.0, spec.wake_jitter_us, size=n)
+    busy_p = min(spec.adc_rate_sps * spec.adc_read_us * 1e-6, 1.0)
+    busy = np.where(rng.random(n) < busy_p, rng.uniform(0.0, spec.adc_read_us, size=n), 0.0)
+    pending = np.where(rng.random(n) < busy_p, spec.adc_read_us, 0.0)
+    compute = 0.5 + spec.eval_us_per_term * spec.poly_terms
+    measured = wake + busy + pending + compute + spec.dac_write_us + (0.1 if spec.pwm_bits else 0.0)
+    # The PWM compare latches at the next counter wrap; a DAC updates on CS rising.
+    latch = rng.uniform(0.0, spec.pwm_period_us, size=n) if spec.pwm_bits else np.zeros(n)
+    return measured, measured + latch
+
+
+def usb_round_trip_us(
+    n: int,
+    rng: np.random.Generator,
+    core0_us: float = 20.0,
+    usb_frame_us: float = 1000.0,
+    host_ms: float = 2.0,
+    host_jitter_ms: float = 8.0,
+) -> np.ndarray:
+    """
+    The loop the output replaces: frame to core0, IN transfer on the next USB
+    frame, host read + compute (fixed plus exponential scheduling delay),
+    setpoint back on an OUT transfer and core0's command handling.
+    """
+
+    core0 = rng.uniform(0.0, core0_us, size=n) + rng.uniform(0.0, core0_us, size=n)
+    usb = rng.uniform(0.0, usb_frame_us, size=n) + rng.uniform(0.0, usb_frame_us, size=n)
+    host = (host_ms + rng.exponential(host_jitter_ms, size=n)) * 1e3
+    return core0 + usb + host
+
+
+def run_output_pipeline(
+    edges: EdgeTraceSpec,
+    n_edges: int,
+    counter: EdgeCounterModel,
+    output: ControlOutputModel,
+    latency: OutputLatencySpec,
+    diode_uV: float = 0.0,
+    seed: Optional[int] = None,
+) -> OutputTrace:
+    """Synthetic edges -> counter windows -> output levels and latencies."""
+
+    times_s = synthetic_edge_times(edges, n_edges)
+    ts_us = quantize_us(times_s)
+    ends: List[int] = []
+    freqs: List[float] = []
+    levels: List[float] = []
+    for ts in ts_us.tolist():
+        result = counter.on_edge(ts, True)
+        if result is None:
+            continue
+        freq = float(np.float32(result[0]))
+        level = output.update(freq, diode_uV)
+        ends.append(ts)
+        freqs.append(freq)
+        levels.append(output.level if level is None else level)
+    rng = np.random.default_rng(seed)
+    measured, effective = output_latency_us(latency, len(ends), rng)
+    return OutputTrace(
+        end_us=np.asarray(ends, dtype=np.int64),
+        freq_hz=np.asarray(freqs, dtype=float),
+        level=np.asarray(levels, dtype=float),
+        measured_us=measured,
+        effective_us=effective,
+    )
@@ -1,17 +1,28 @@
 from __future__ import annotations
 
+import binascii
 import csv
 import enum
 import logging
-import struct
 from dataclasses import dataclass
-from typing import Any, Dict, Iterable, Iterator, Optional
+from typing import Any, Callable, Dict, Iterable, Iterator, Optional
+
+from .schema import PACKET_SCHEMA, SchemaError, SchemaRegistry
+from .tracelog import TraceRecord, decode_trace_payload
 
 
 FLAG_SYNC_ACTIVE = 0x01
 FLAG_ADC_TIMEOUT = 0x02
 FLAG_PPS_LOCKED = 0x04
 FLAG_ADC_SATURATED = 0x08
+FLAG_SETTLED = 0x10
+FLAG_SUMMARY = 0x20  # several windows merged by the device TX pacer
+
+PACKET_MAGIC = 0x55
+PACKET_FRAME = 0xAA
+PACKET_TRACE = 0xA5
+
+SLOT_NONE = 0xFFFFFFFF
 
 
 class FrameFormat(str, enum.Enum):
@@ -29,9 +40,15 @@ class Frame:
     flags: int
     ppm_corr: float
     mode: str
+    slot: int = -1
+    adc_fresh: int = -1  # ADC conversions averaged into v_uV; 0 = reused, -1 = not reported
+    seq: int = -1  # 16-bit packet counter (binary frames), -1 = not reported
 
 
 def crc16_ccitt(data: bytes, poly: int = 0x1021, init: int = 0xFFFF) -> int:
+    if poly == 0x1021:
+        # binascii implements the same CRC-CCITT in C.
+        return binascii.crc_hqx(data, init)
     crc = init
     for byte in data:
         crc ^= byte << 8
@@ -47,14 +64,46 @@ def crc16_ccitt(data: bytes, poly: int = 0x1021, init: int = 0xFFFF) -> int:
 class FrameParser:
     """
     Streaming frame parser supporting CSV lines and binary packets.
-    The binary format follows the 0x55AA magic header described in the spec.
+    The binary format follows the 0x55AA magic header described in the spec;
+    0x55A5 packets carry deferred firmware log records and are routed to
+    `on_trace` instead of the frame stream. 0x55A6 packets carry the record
+    layouts (see `schema.py`): frames are decoded from the latest announced
+    schema, and other announced record types are passed to `on_record`.
+
+    A rejected packet (unknown length, CRC mismatch) only costs its first
+    byte: scanning resumes at the next 0x55 inside it, so one corrupted byte
+    does not take the following packets with it. `lost_bytes` counts every
+    byte not consumed by a valid packet, `resyncs` the gaps, and `lost_frames`
+    the frames missing from the `seq` counter (firmware that sends it).
     """
 
-    def __init__(self, fmt: FrameFormat):
+    def __init__(
+        self,
+        fmt: FrameFormat,
+        on_trace: Optional[Callable[[TraceRecord], None]] = None,
+        on_record: Optional[Callable[[int, Dict[str, Any]], None]] = None,
+    ):
         self.fmt = fmt
         self._buffer = bytearray()
-        self._stats: Dict[str, int] = {"frames": 0, "crc_errors": 0, "length_errors": 0}
-        self._payload_len = struct.calcsize("<IiHiBBhB")
+        self._stats: Dict[str, int] = {
+            "frames": 0,
+            "crc_errors": 0,
+            "length_errors": 0,
+            "trace_records": 0,
+            "schema_packets": 0,
+            "schema_errors": 0,
+            "records": 0,
+            "lost_bytes": 0,
+            "resyncs": 0,
+            "lost_frames": 0,
+            "seq_resets": 0,
+        }
+        self._gap = 0
+        self._last_seq: Optional[int] = None
+        self._on_trace = on_trace
+        self._on_record = on_record
+        # Survives reset(): the device only re-announces on connect or SCHEMA.
+        self.schemas = SchemaRegistry(frame_type=PACKET_FRAME, frame_cls=Frame)
         self._log = logging.getLogger(__name__)
 
     def parse_csv(self, lines: Iterable[str]) -> Iterator[Frame]:
@@ -72,6 +121,8 @@ class FrameParser:
                 flags=int(row["flags"]),
                 ppm_corr=float(row["ppm_corr"]),
                 mode=row["mode"],
+                slot=int(row.get("slot") or -1),
+                adc_fresh=int(row.get("adc_fresh") or -1),
             )
 
     def parse_binary(self, chunks: Iterable[bytes]) -> Iterator[Frame]:
@@ -82,72 +133,122 @@ class FrameParser:
             yield from self._extract_frames()
 
     def _extract_frames(self) -> Iterator[Frame]:
-        header = b"\x55\xAA"
-        while True:
-            start = self._buffer.find(header)
-            if start < 0:
-                self._buffer.clear()
-                break
-            if len(self._buffer) < start + 3:
-                # Insufficient length to read frame len
-                break
-            length = self._buffer[start + 2]
-            frame_end = start + 3 + length + 2  # payload + CRC16
-            if len(self._buffer) < frame_end:
-                break
-            if length != self._payload_len:
-                self._stats["length_errors"] += 1
-                self._log.debug("Discarding frame with unexpected payload length: %s", length)
-                del self._buffer[:frame_end]
-                continue
-            payload = bytes(self._buffer[start + 3 : start + 3 + length])
-            crc_expected = struct.unpack_from("<H", self._buffer, frame_end - 2)[0]
-            body = payload
-            crc_actual = crc16_ccitt(body)
-            if crc_actual != crc_expected:
-                # Drop the corrupted frame
-                self._stats["crc_errors"] += 1
-                self._log.debug(
-                    "CRC mismatch (expected=%04X, actual=%04X)", crc_expected, crc_actual
-                )
-                del self._buffer[: frame_end]
-                continue
-            frame = self._decode_body(body)
-            if frame:
-                self._stats["frames"] += 1
-                yield frame
-            del self._buffer[: frame_end]
+        buf = self._buffer
+        stats = self._stats
+        known = self.schemas.schemas
+        pos = 0
+        try:
+            while True:
+                start = buf.find(PACKET_MAGIC, pos)
+                if start < 0:
+                    self._skip(len(buf) - pos)
+                    pos = len(buf)
+                    break
+                if start > pos:
+                    self._skip(start - pos)
+                    pos = start
+                if len(buf) - pos < 3:
+                    # Insufficient length to read packet type and length
+                    break
+                packet_type = buf[pos + 1]
+                length = buf[pos + 2]
+                if packet_type in known:
+                    if not self.schemas.accepts(packet_type, length):
+                        stats["length_errors"] += 1
+                        self._log.debug("Rejecting packet with unexpected payload length: %s", length)
+                        self._skip(1)
+                        pos += 1
+                        continue
+                elif packet_type not in (PACKET_TRACE, PACKET_SCHEMA):
+                    self._skip(1)
+                    pos += 1
+                    continue
+                frame_end = pos + 3 + length + 2  # payload + CRC16
+                if len(buf) < frame_end:
+                    break
+                body = bytes(buf[pos + 3 : frame_end - 2])
+                crc_expected = buf[frame_end - 2] | (buf[frame_end - 1] << 8)
+                crc_actual = crc16_ccitt(body)
+                if crc_actual != crc_expected:
+                    # Retry from the next magic byte inside the rejected packet.
+                    stats["crc_errors"] += 1
+                    self._log.debug(
+                        "CRC mismatch (expected=%04X, actual=%04X)", crc_expected, crc_actual
+                    )
+                    self._skip(1)
+                    pos += 1
+                    continue
+                pos = frame_end
+                if self._gap:
+                    stats["resyncs"] += 1
+                    self._gap = 0
+                if packet_type == PACKET_TRACE:
+                    self._handle_trace(body)
+                    continue
+                if packet_type == PACKET_SCHEMA:
+                    self._handle_schema(body)
+                    continue
+                if packet_type != PACKET_FRAME:
+                    self._handle_record(packet_type, body)
+                    continue
+                frame = self._decode_body(body)
+                if frame:
+                    stats["frames"] += 1
+                    if frame.seq >= 0:
+                        self._track_seq(frame.seq)
+                    yield frame
+        finally:
+            del buf[:pos]
 
-    def _decode_body(self, body: bytes) -> Optional[Frame]:
-        if len(body) != 4 + 4 + 2 + 4 + 1 + 1 + 2 + 1:
-            return None
-        (
-            ts_ms_raw,
-            f_hz_raw,
-            tau_ms_raw,
-            v_uV_raw,
-            adc_gain,
-            flags,
-            ppm_corr_raw,
-            mode,
-        ) = struct.unpack("<IiHiBBhB", body)
-        ts_ms = ts_ms_raw / 1.0
-        f_hz = f_hz_raw / 1e4
-        tau_ms = tau_ms_raw / 1.0
-        v_uV = v_uV_raw / 1.0
-        ppm_corr = ppm_corr_raw / 1e2
-        mode_str = {0: "GATED", 1: "RECIP"}.get(mode, f"UNKNOWN({mode})")
-        return Frame(
-            ts_ms=ts_ms,
-            f_hz=f_hz,
-            tau_ms=tau_ms,
-            v_uV=v_uV,
-            adc_gain=adc_gain,
-            flags=flags,
-            ppm_corr=ppm_corr,
-            mode=mode_str,
+    def _skip(self, count: int) -> None:
+        self._stats["lost_bytes"] += count
+        self._gap += count
+
+    def _track_seq(self, seq: int) -> None:
+        last = self._last_seq
+        self._last_seq = seq
+        if last is None:
+            return
+        missing = (seq - last - 1) & 0xFFFF
+        if missing >= 0x8000:
+            # Backwards jump: the device restarted its counter.
+            self._stats["seq_resets"] += 1
+            return
+        self._stats["lost_frames"] += missing
+
+    def _handle_trace(self, body: bytes) -> None:
+        record = decode_trace_payload(body)
+        if record is None:
+            self._stats["length_errors"] += 1
+            return
+        self._stats["trace_records"] += 1
+        if self._on_trace is not None:
+            self._on_trace(record)
+
+    def _handle_schema(self, body: bytes) -> None:
+        try:
+            schema = self.schemas.register_packet(body)
+        except SchemaError as exc:
+            self._stats["schema_errors"] += 1
+            self._log.warning("Ignoring malformed schema packet: %s", exc)
+            return
+        self._stats["schema_packets"] += 1
+        self._log.debug(
+            "Schema for 0x%02X: %d bytes, %d fields", schema.packet_type, schema.payload_len, len(schema.fields)
         )
 
+    def _handle_record(self, packet_type: int, body: bytes) -> None:
+        record = self.schemas.decode(packet_type, body)
+        if record is None:
+            self._stats["length_errors"] += 1
+            return
+        self._stats["records"] += 1
+        if self._on_record is not None:
+            self._on_record(packet_type, record)
+
+    def _decode_body(self, body: bytes) -> Optional[Frame]:
+        return self.schemas.decode(PACKET_FRAME, body)
+
     def iter_frames(self, source: Iterable[str] | Iterable[bytes]) -> Iterator[Frame]:
         if self.fmt is FrameFormat.CSV:
             assert isinstance(source, Iterable)
@@ -159,6 +260,9 @@ class FrameParser:
 
     def reset(self) -> None:
         self._buffer.clear()
+        self._gap = 0
+        # Frames missed while disconnected are not stream errors.
+        self._last_seq = None
 
 
 def iterate_text_stream(handle: Iterable[str]) -> Iterator[str]:
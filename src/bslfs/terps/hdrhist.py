@@ -0,0 +1,263 @@
+"""
+Log-linear (HDR-style) histograms for frequency and pressure distributions.
+
+Values are scaled by ``unit`` and rounded to integers. Magnitudes below
+``2**precision_bits`` get exact unit-width buckets; above that each power of
+two is split into ``2**(precision_bits-1)`` equal buckets, so any quantile is
+reported within a relative error of ``2**-precision_bits`` of the true order
+statistic. The bucket layout and rank rule match the firmware `hdr_hist.cpp`
+so exports from `HIST.READB` merge directly with host-side histograms.
+"""
+
+from __future__ import annotations
+
+import json
+import struct
+from pathlib import Path
+from typing import Any, Callable, Dict, Iterable, Optional, Sequence, Tuple, Union
+
+import numpy as np
+
+from ..fastcsv import csv_layout, read_csv_range
+from .coeff import BinaryExecutor, _parse_header_tokens
+from .frames import crc16_ccitt
+
+DEFAULT_PRECISION_BITS = 6
+MAX_MAGNITUDE = 0xFFFFFFFF
+FIRMWARE_NEGATIVE = 0x8000
+_ENTRY = struct.Struct("<HI")
+
+Values = Union[Sequence[float], np.ndarray]
+
+
+def bucket_count(precision_bits: int) -> int:
+    return (34 - precision_bits) << (precision_bits - 1)
+
+
+def bucket_index(magnitude: np.ndarray, precision_bits: int) -> np.ndarray:
+    """Vectorised `hdr_hist_bucket()` for non-negative integer magnitudes."""
+
+    mag = np.asarray(magnitude, dtype=np.int64)
+    # frexp exponent equals the bit length for integers below 2**53.
+    length = np.frexp(mag.astype(np.float64))[1].astype(np.int64)
+    shift = np.maximum(length - precision_bits, 0)
+    half = 1 << (precision_bits - 1)
+    return np.where(shift == 0, mag, shift * half + (mag >> shift))
+
+
+def bucket_lower(index: np.ndarray, precision_bits: int) -> np.ndarray:
+    idx = np.asarray(index, dtype=np.int64)
+    half = 1 << (precision_bits - 1)
+    shift = np.maximum(idx // half - 1, 0)
+    return np.where(idx < 2 * half, idx, (idx - shift * half) << shift)
+
+
+def bucket_width(index: np.ndarray, precision_bits: int) -> np.ndarray:
+    idx = np.asarray(index, dtype=np.int64)
+    half = 1 << (precision_bits - 1)
+    return np.where(idx < 2 * half, 1, np.int64(1) << np.maximum(idx // half - 1, 0))
+
+
+class LogLinearHistogram:
+    """Mergeable fixed-footprint histogram of signed values."""
+
+    def __init__(self, precision_bits: int = DEFAULT_PRECISION_BITS, unit: float = 1.0):
+        if not 1 <= precision_bits <= 16:
+            raise ValueError("precision_bits must be between 1 and 16")
+        if unit <= 0:
+            raise ValueError("unit must be positive")
+        self.precision_bits = precision_bits
+        self.unit = float(unit)
+        size = bucket_count(precision_bits)
+        self.pos = np.zeros(size, dtype=np.int64)
+        self.neg = np.zeros(size, dtype=np.int64)
+        self.count = 0
+        self._min = 0
+        self._max = 0
+
+    @property
+    def relative_error(self) -> float:
+        return 2.0 ** -self.precision_bits
+
+    @property
+    def min(self) -> float:
+        return self._min * self.unit
+
+    @property
+    def max(self) -> float:
+        return self._max * self.unit
+
+    def record(self, values: Values) -> None:
+        data = np.asarray(values, dtype=np.float64)
+        data = data[np.isfinite(data)]
+        if data.size == 0:
+            return
+        scaled = np.clip(np.rint(data / self.unit), -MAX_MAGNITUDE, MAX_MAGNITUDE).astype(np.int64)
+        negative = scaled < 0
+        size = self.pos.size
+        if negative.any():
+            self.neg += np.bincount(bucket_index(-scaled[negative], self.precision_bits), minlength=size)
+        if not negative.all():
+            self.pos += np.bincount(bucket_index(scaled[~negative], self.precision_bits), minlength=size)
+        self._update_range(int(scaled.min()), int(scaled.max()), int(scaled.size))
+
+    def merge(self, other: "LogLinearHistogram") -> None:
+        if other.precision_bits != self.precision_bits or other.unit != self.unit:
+            raise ValueError("Cannot merge histograms with different precision or unit")
+        if other.count == 0:
+            return
+        self.pos += other.pos
+        self.neg += other.neg
+        self._update_range(other._min, other._max, other.count)
+
+    def quantile(self, q: float) -> float:
+        return self._quantile_raw(q) * self.unit
+
+    def quantiles(self, qs: Iterable[float]) -> Dict[float, float]:
+        return {q: self.quantile(q) for q in qs}
+
+    def to_dict(self) -> Dict[str, Any]:
+        pos = np.flatnonzero(self.pos)
+        neg = np.flatnonzero(self.neg)
+        return {
+            "precision_bits": self.precision_bits,
+            "unit": self.unit,
+            "count": self.count,
+            "min": self._min,
+            "max": self._max,
+            "pos": [[int(i), int(self.pos[i])] for i in pos],
+            "neg": [[int(i), int(self.neg[i])] for i in neg],
+        }
+
+    @staticmethod
+    def from_dict(data: Dict[str, Any]) -> "LogLinearHistogram":
+        hist = LogLinearHistogram(int(data["precision_bits"]), float(data["unit"]))
+        for index, count in data.get("pos", []):
+            hist.pos[int(index)] = int(count)
+        for index, count in data.get("neg", []):
+            hist.neg[int(index)] = int(count)
+        hist.count = int(data["count"])
+        hist._min = int(data["min"])
+        hist._max = int(data["max"])
+        return hist
+
+    def save(self, path: Path | str) -> None:
+        Path(path).write_text(json.dumps(self.to_dict()), encoding="utf-8")
+
+    @staticmethod
+    def load(path: Path | str) -> "LogLinearHistogram":
+        return LogLinearHistogram.from_dict(json.loads(Path(path).read_text(encoding="utf-8")))
+
+    def _update_range(self, lo: int, hi: int, n: int) -> None:
+        if self.count == 0:
+            self._min, self._max = lo, hi
+        else:
+            self._min = min(self._min, lo)
+            self._max = max(self._max, hi)
+        self.count += n
+
+    def _quantile_raw(self, q: float) -> int:
+        if self.count == 0:
+            return 0
+        if q <= 0.0:
+            return self._min
+        if q >= 1.0:
+            return self._max
+        rank = max(int(q * self.count + 0.5), 1)
+        # Walk from the most negative value upwards: neg buckets high to low, then pos.
+        neg_cum = np.cumsum(self.neg[::-1])
+        neg_total = int(neg_cum[-1])
+        if rank <= neg_total:
+            index = self.neg.size - 1 - int(np.searchsorted(neg_cum, rank))
+            value = -self._midpoint(index)
+        else:
+            pos_cum = np.cumsum(self.pos)
+            index = int(np.searchsorted(pos_cum, rank - neg_total))
+            value = self._midpoint(index)
+        return min(max(value, self._min), self._max)
+
+    def _midpoint(self, index: int) -> int:
+        idx = np.array([index])
+        lower = int(bucket_lower(idx, self.precision_bits)[0])
+        width = int(bucket_width(idx, self.precision_bits)[0])
+        return lower + (width - 1) // 2
+
+
+def parse_firmware_export(header: Dict[str, str], block: bytes, unit: float = 1.0) -> LogLinearHistogram:
+    """Rebuild a histogram from the sparse `HIST.READB` payload (CRC already stripped)."""
+
+    precision = int(header.get("P", str(DEFAULT_PRECISION_BITS)))
+    if len(block) % _ENTRY.size:
+        raise ValueError(f"HIST.READB payload of {len(block)} bytes is not a whole number of entries")
+    hist = LogLinearHistogram(precision, unit)
+    for raw_index, count in _ENTRY.iter_unpack(block):
+        target = hist.neg if raw_index & FIRMWARE_NEGATIVE else hist.pos
+        index = raw_index & ~FIRMWARE_NEGATIVE
+        if index >= target.size:
+            raise ValueError(f"HIST.READB bucket {index} out of range for P={precision}")
+        target[index] += count
+    hist.count = int(header.get("N", "0"))
+    if int(hist.pos.sum() + hist.neg.sum()) != hist.count:
+        raise ValueError("HIST.READB bucket counts do not add up to N")
+    hist._min = int(header.get("MIN", "0"))
+    hist._max = int(header.get("MAX", "0"))
+    return hist
+
+
+def read_firmware_hist(
+    binary_executor: BinaryExecutor,
+    series: str,
+    timeout: float,
+    unit: float = 1.0,
+) -> Tuple[LogLinearHistogram, Dict[str, str]]:
+    """Fetch one on-device noise histogram (`F` = 1e-4 Hz, `V` = µV deltas)."""
+
+    lines, block = binary_executor(f"HIST.READB {series}", timeout)
+    if not lines or not lines[0].startswith("OK"):
+        raise ValueError(f"HIST.READB failed: {lines[0] if lines else 'no reply'}")
+    header = _parse_header_tokens(lines[0])
+    if len(block) < 2:
+        raise ValueError("HIST.READB returned no CRC")
+    payload = block[:-2]
+    crc_expected = struct.unpack_from("<H", block, len(payload))[0]
+    if crc16_ccitt(payload) != crc_expected:
+        raise ValueError("HIST.READB CRC mismatch")
+    return parse_firmware_export(header, payload, unit), header
+
+
+def histogram_csv_column(
+    paths: Sequence[Path],
+    field: str,
+    hist: LogLinearHistogram,
+    diff: bool = False,
+    reader: Optional[Callable[[Path, str], Iterable[np.ndarray]]] = None,
+) -> int:
+    """
+    Stream one column of each log into ``hist`` chunk by chunk, so memory is
+    bounded by the chunk size rather than the log length. With ``diff`` the
+    frame-to-frame deltas are recorded instead (noise rather than level).
+    """
+
+    read = reader or _iter_csv_column
+    rows = 0
+    for path in paths:
+        previous: Optional[float] = None
+        for values in read(path, field):
+            rows += int(values.size)
+            if diff:
+                if values.size == 0:
+                    continue
+                joined = values if previous is None else np.concatenate(([previous], values))
+                previous = float(values[-1])
+                values = np.diff(joined)
+            hist.record(values)
+    return rows
+
+
+def _iter_csv_column(path: Path, field: str) -> Iterable[np.ndarray]:
+    layout = csv_layout(path)
+    if layout.header and field not in layout.header:
+        raise ValueError(f"{path}: no column named {field!r}")
+    for start, stop in layout.chunks:
+        frame = read_csv_range(path, layout.header, start, stop, usecols=[field])
+        yield frame[field].to_numpy(dtype=np.float64)
@@ -0,0 +1,363 @@
+"""
+Time-coherent join of several sensor streams onto one host-time grid.
+
+Each device reports `ts_ms` on its own clock. `ClockMapper` maps it to host
+milliseconds from (device ts, host arrival) pairs: the skew is a least-squares
+fit over a sliding window and the offset follows the lower envelope of the
+residuals, since transport only ever delays a sample. `StreamJoiner` buffers a
+bounded number of mapped samples per device and emits one `JoinedRecord` per
+grid tick once every device has reported past it, either interpolating each
+device at the tick or averaging over the tick window weighted by overlap with
+each sample's gate interval.
+
+A device that stalls cannot hold the join back for longer than
+`max_lateness_ms`: ticks further behind the newest data are emitted with that
+device missing (NaN), and samples arriving for already emitted ticks are
+counted as late and dropped.
+"""
+
+from __future__ import annotations
+
+import csv
+import math
+from collections import deque
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Callable, Deque, Dict, Iterator, List, Optional, Sequence, TextIO, Tuple
+
+import numpy as np
+
+from ..fastcsv import csv_layout, read_csv_range
+from .processing import SampleRecord
+
+JOIN_MODES = ("interpolate", "window")
+
+# (host ms, host ms at gate start, value, flags)
+_Sample = Tuple[float, float, float, int]
+
+
+@dataclass
+class JoinedRecord:
+    ts_ms: float
+    values: Tuple[float, ...]
+    flags: Tuple[int, ...]
+    present: int
+
+    @property
+    def complete(self) -> bool:
+        return self.present == (1 << len(self.values)) - 1
+
+
+class ClockMapper:
+    """Online device-ms to host-ms mapping with skew and envelope offset."""
+
+    def __init__(
+        self,
+        window: int = 4096,
+        refit_every: int = 64,
+        min_span_ms: float = 20000.0,
+        max_skew_ppm: float = 1000.0,
+    ):
+        self._dev: Deque[float] = deque(maxlen=max(window, 2))
+        self._host: Deque[float] = deque(maxlen=max(window, 2))
+        self._refit_every = max(refit_every, 1)
+        self._min_span = min_span_ms
+        self._max_skew = max_skew_ppm * 1e-6
+        self._pending = 0
+        self._dev0: Optional[float] = None
+        self.slope = 1.0
+        self.offset = 0.0
+
+    def observe(self, dev_ms: float, host_ms: float) -> None:
+        if self._dev0 is None:
+            self._dev0 = dev_ms
+            self.offset = host_ms
+        self._dev.append(dev_ms - self._dev0)
+        self._host.append(host_ms)
+        # The offset tracks the minimum-delay sample immediately; the skew is refit periodically.
+        self.offset = min(self.offset, host_ms - self.slope * (dev_ms - self._dev0))
+        self._pending += 1
+        if self._pending >= self._refit_every:
+            self._refit()
+
+    def to_host(self, dev_ms: np.ndarray) -> np.ndarray:
+        if self._dev0 is None:
+            raise ValueError("ClockMapper has no observations")
+        return self.offset + self.slope * (np.asarray(dev_ms, dtype=np.float64) - self._dev0)
+
+    @property
+    def skew_ppm(self) -> float:
+        """How fast the device clock runs relative to the host."""
+        return (1.0 / self.slope - 1.0) * 1e6
+
+    def _refit(self) -> None:
+        self._pending = 0
+        dev = np.fromiter(self._dev, dtype=np.float64, count=len(self._dev))
+        host = np.fromiter(self._host, dtype=np.float64, count=len(self._host))
+        # Millisecond transport jitter swamps ppm skew over short spans.
+        if dev[-1] - dev[0] < self._min_span:
+            return
+        slope = float(np.polyfit(dev, host, 1)[0])
+        self.slope = min(max(slope, 1.0 - self._max_skew), 1.0 + self._max_skew)
+        self.offset = float(np.min(host - self.slope * dev))
+
+
+class StreamJoiner:
+    """
+    Bounded-memory join of `len(devices)` sample streams on a `period_ms` grid.
+
+    `push()` takes device timestamps plus the host arrival time of the batch
+    and returns the records that became ready; registered callbacks see the
+    same lists. With `map_clock=False` device timestamps are used as host
+    time directly (offline joins of logs that share a time base).
+    """
+
+    def __init__(
+        self,
+        devices: Sequence[str],
+        period_ms: float,
+        mode: str = "interpolate",
+        max_gap_ms: Optional[float] = None,
+        max_lateness_ms: float = 1000.0,
+        max_buffer: int = 4096,
+        map_clock: bool = True,
+        clock_window: int = 4096,
+    ):
+        if not devices:
+            raise ValueError("StreamJoiner needs at least one device")
+        if mode not in JOIN_MODES:
+            raise ValueError(f"mode must be one of {JOIN_MODES}")
+        if period_ms <= 0:
+            raise ValueError("period_ms must be positive")
+        self.devices = tuple(devices)
+        self.period_ms = float(period_ms)
+        self.mode = mode
+        self.max_gap_ms = float(max_gap_ms) if max_gap_ms is not None else 4.0 * self.period_ms
+        self.max_lateness_ms = float(max_lateness_ms)
+        self.max_buffer = max(int(max_buffer), 2)
+        self.map_clock = map_clock
+        self.clocks = [ClockMapper(clock_window) for _ in self.devices]
+        self._buffers: List[Deque[_Sample]] = [deque() for _ in self.devices]
+        self._watermarks = [-math.inf] * len(self.devices)
+        self._next_tick: Optional[float] = None
+        self._last_tick = -math.inf
+        self._callbacks: List[Callable[[List[JoinedRecord]], None]] = []
+        self._stats: Dict[str, float] = {
+            "pushed": 0,
+            "emitted": 0,
+            "incomplete": 0,
+            "late": 0,
+            "overflow": 0,
+            "max_buffered": 0,
+            "latency_ms_sum": 0.0,
+            "latency_ms_max": 0.0,
+        }
+
+    def register_callback(self, callback: Callable[[List[JoinedRecord]], None]) -> None:
+        self._callbacks.append(callback)
+
+    def push(
+        self,
+        device: int,
+        ts_ms: Sequence[float],
+        values: Sequence[float],
+        flags: Optional[Sequence[int]] = None,
+        tau_ms: Optional[Sequence[float]] = None,
+        arrival_ms: Optional[float] = None,
+    ) -> List[JoinedRecord]:
+        dev_ts = np.asarray(ts_ms, dtype=np.float64)
+        if dev_ts.size == 0:
+            return []
+        if self.map_clock:
+            if arrival_ms is None:
+                raise ValueError("arrival_ms is required when map_clock is enabled")
+            clock = self.clocks[device]
+            # Only the newest sample of a batch left the device just before arrival.
+            clock.observe(float(dev_ts[-1]), float(arrival_ms))
+            host_ts = clock.to_host(dev_ts)
+        else:
+            host_ts = dev_ts
+        vals = np.asarray(values, dtype=np.float64)
+        flag_arr = np.zeros(dev_ts.size, dtype=np.int64) if flags is None else np.asarray(flags, dtype=np.int64)
+        buffer = self._buffers[device]
+        watermark = self._watermarks[device]
+        previous_end = buffer[-1][0] if buffer else None
+        for idx in range(dev_ts.size):
+            t = float(host_ts[idx])
+            if self.map_clock and buffer and t < watermark:
+                t = watermark  # a skew refit may nudge the mapping backwards slightly
+            if t <= self._last_tick or t < watermark:
+                self._stats["late"] += 1
+                continue
+            if tau_ms is not None and tau_ms[idx] > 0:
+                start = t - float(tau_ms[idx])
+            else:
+                start = previous_end if previous_end is not None else t - self.period_ms
+            if len(buffer) >= self.max_buffer:
+                buffer.popleft()
+                self._stats["overflow"] += 1
+            buffer.append((t, start, float(vals[idx]), int(flag_arr[idx])))
+            previous_end = t
+            watermark = t
+        self._watermarks[device] = watermark
+        self._stats["pushed"] += int(dev_ts.size)
+        self._stats["max_buffered"] = max(self._stats["max_buffered"], sum(len(b) for b in self._buffers))
+        if self._next_tick is None and watermark > -math.inf:
+            self._next_tick = math.ceil(float(host_ts[0]) / self.period_ms) * self.period_ms
+        now = float(arrival_ms) if arrival_ms is not None else max(self._watermarks)
+        return self._advance(now, force=False)
+
+    def push_samples(
+        self, device: int, samples: Sequence[SampleRecord], arrival_ms: Optional[float] = None, field: str = "pressure"
+    ) -> List[JoinedRecord]:
+        return self.push(
+            device,
+            [s.ts_ms for s in samples],
+            [getattr(s, field) for s in samples],
+            [s.flags for s in samples],
+            [s.tau_ms for s in samples],
+            arrival_ms,
+        )
+
+    def flush(self) -> List[JoinedRecord]:
+        """Emit every tick up to the newest data, marking missing devices."""
+        return self._advance(max(self._watermarks), force=True)
+
+    def stats(self) -> Dict[str, float]:
+        data = dict(self._stats)
+        emitted = data["emitted"]
+        data["latency_ms_mean"] = data.pop("latency_ms_sum") / emitted if emitted else 0.0
+        data["buffered"] = sum(len(buffer) for buffer in self._buffers)
+        if self.map_clock:
+            for name, clock in zip(self.devices, self.clocks):
+                data[f"skew_ppm.{name}"] = clock.skew_ppm
+        return data
+
+    def _advance(self, now_ms: float, force: bool) -> List[JoinedRecord]:
+        out: List[JoinedRecord] = []
+        lead = max(self._watermarks)
+        while self._next_tick is not None and self._next_tick <= lead:
+            tick = self._next_tick
+            ready = min(self._watermarks) >= tick
+            if not ready and not force and lead - tick <= self.max_lateness_ms:
+                break
+            record = self._emit(tick)
+            out.append(record)
+            if not record.complete:
+                self._stats["incomplete"] += 1
+            latency = max(now_ms - tick, 0.0)
+            self._stats["latency_ms_sum"] += latency
+            self._stats["latency_ms_max"] = max(self._stats["latency_ms_max"], latency)
+            self._last_tick = tick
+            self._next_tick = tick + self.period_ms
+        if out:
+            self._stats["emitted"] += len(out)
+            for callback in self._callbacks:
+                callback(out)
+        return out
+
+    def _emit(self, tick: float) -> JoinedRecord:
+        values: List[float] = []
+        flags: List[int] = []
+        present = 0
+        for idx, buffer in enumerate(self._buffers):
+            if self.mode == "interpolate":
+                value, flag = self._interpolate(buffer, tick)
+            else:
+                value, flag = self._window(buffer, tick)
+            if not math.isnan(value):
+                present |= 1 << idx
+            values.append(value)
+            flags.append(flag)
+            # Keep the newest sample at or before the tick as the next anchor.
+            while len(buffer) >= 2 and buffer[1][0] <= tick:
+                buffer.popleft()
+        return JoinedRecord(ts_ms=tick, values=tuple(values), flags=tuple(flags), present=present)
+
+    def _interpolate(self, buffer: Deque[_Sample], tick: float) -> Tuple[float, int]:
+        before: Optional[_Sample] = None
+        for sample in buffer:
+            if sample[0] == tick:
+                return sample[2], sample[3]
+            if sample[0] > tick:
+                if before is None or sample[0] - before[0] > self.max_gap_ms:
+                    break
+                frac = (tick - before[0]) / (sample[0] - before[0])
+                return before[2] + frac * (sample[2] - before[2]), before[3] | sample[3]
+            before = sample
+        return math.nan, 0
+
+    def _window(self, buffer: Deque[_Sample], tick: float) -> Tuple[float, int]:
+        lo = tick - self.period_ms
+        weight = 0.0
+        total = 0.0
+        flag = 0
+        for end, start, value, sample_flags in buffer:
+            if start >= tick:
+                break
+            overlap = min(end, tick) - max(start, lo)
+            if overlap <= 0:
+                continue
+            weight += overlap
+            total += overlap * value
+            flag |= sample_flags
+        if weight <= 0:
+            return math.nan, 0
+        return total / weight, flag
+
+
+class JoinedCsvWriter:
+    """`ts_ms,<field>.<device>...,flags.<device>...,present` rows for joined output."""
+
+    def __init__(self, handle: TextIO, devices: Sequence[str], field: str = "pressure"):
+        self._writer = csv.writer(handle)
+        self._writer.writerow(
+            ["ts_ms"] + [f"{field}.{name}" for name in devices] + [f"flags.{name}" for name in devices] + ["present"]
+        )
+
+    def write(self, records: Sequence[JoinedRecord]) -> None:
+        self._writer.writerows(
+            [record.ts_ms, *("" if math.isnan(v) else v for v in record.values), *record.flags, record.present]
+            for record in records
+        )
+
+
+def join_logs(paths: Sequence[Path], joiner: StreamJoiner, field: str = "pressure") -> Iterator[List[JoinedRecord]]:
+    """
+    Offline join of archived logs on their `ts_ms` column. Chunks are read
+    from whichever file is furthest behind, so only about one chunk per file
+    is in memory at a time.
+    """
+
+    layouts = [csv_layout(path) for path in paths]
+    for path, layout in zip(paths, layouts):
+        missing = [name for name in ("ts_ms", field) if layout.header and name not in layout.header]
+        if missing:
+            raise ValueError(f"{path}: missing columns {missing}")
+    positions = [0] * len(paths)
+    reached = [-math.inf] * len(paths)
+    while True:
+        pending = [idx for idx, layout in enumerate(layouts) if positions[idx] < len(layout.chunks)]
+        if not pending:
+            break
+        idx = min(pending, key=lambda i: reached[i])
+        start, stop = layouts[idx].chunks[positions[idx]]
+        positions[idx] += 1
+        usecols = [name for name in ("ts_ms", "tau_ms", field, "flags") if name in layouts[idx].header]
+        frame = read_csv_range(paths[idx], layouts[idx].header, start, stop, usecols=usecols)
+        if frame.empty:
+            continue
+        ts = frame["ts_ms"].to_numpy(dtype=np.float64)
+        reached[idx] = float(ts[-1])
+        emitted = joiner.push(
+            idx,
+            ts,
+            frame[field].to_numpy(dtype=np.float64),
+            frame["flags"].to_numpy(dtype=np.int64) if "flags" in frame else None,
+            frame["tau_ms"].to_numpy(dtype=np.float64) if "tau_ms" in frame else None,
+        )
+        if emitted:
+            yield emitted
+    tail = joiner.flush()
+    if tail:
+        yield tail
@@ -0,0 +1,244 @@
+"""
+Predict frequency resolution, pressure noise and latency per counting mode and tau.
+
+Per-window frequency noise (1σ) for a carrier ``f`` and window ``τ``:
+
+* GATED counts whole periods inside a timer window. Both window edges fall at
+  a random carrier phase, so the count error is triangular with σ = 1/√6
+  periods: ``σ_f = 1 / (√6 · τ)``.
+* RECIP timestamps the first and last edge of the window. Each stamp carries
+  comparator jitter ``σ_j`` plus timer quantisation ``q`` (uniform, q²/12):
+  ``σ_f = f · √(2 (σ_j² + q²/12)) / τ``.
+* DUAL pools independent rise→rise and fall→fall spans, halving the variance.
+
+All modes then pass through the firmware's float32 frequency, adding
+ulp(f)/√12. The diode channel averages ``⌊τ · rate⌋`` conversions, and pressure
+noise combines both through the local slopes ∂P/∂f, ∂P/∂V of the sensor
+polynomial. The timebase error (crystal tolerance, or the PPS loop residual
+when locked) is a bias rather than noise and is reported separately.
+
+`validate_candidate` replays matching synthetic traces through
+`EdgeCounterModel` (RECIP/DUAL) or a timer-gated count (GATED) so each
+prediction can be checked against the host simulator.
+"""
+
+from __future__ import annotations
+
+import math
+from dataclasses import asdict, dataclass
+from typing import Any, Dict, Iterable, List, Optional, Sequence
+
+import numpy as np
+
+from .config import SensorPoly
+from .processing import PressureCalculator
+from .sim import EdgeCounterModel, EdgeTraceSpec, interleave_edges, quantize_us, run_counter, synthetic_square_wave
+
+MODES = ("GATED", "RECIP", "DUAL")
+DEFAULT_TAUS_MS = (10.0, 20.0, 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0)
+DEFAULT_MIN_INTERVAL_FRAC = 0.25
+
+
+@dataclass
+class AcquisitionSpec:
+    """What is known about a sensor/board combination before choosing a preset."""
+
+    carrier_hz: float = 30000.0
+    ts_resolution_s: float = 1e-6
+    jitter_s: float = 20e-9
+    pps_locked: bool = False
+    crystal_ppm: float = 20.0
+    pps_residual_ppm: float = 0.05
+    adc_rate_sps: float = 20.0
+    adc_noise_uV: float = 1.0  # RMS per conversion
+    adc_gain: int = 16
+    mains_reject: bool = True
+    dp_df: float = 1.0  # pressure per Hz
+    dp_dv: float = 0.0  # pressure per µV
+
+
+@dataclass
+class ModePrediction:
+    mode: str
+    tau_ms: float
+    freq_noise_hz: float
+    freq_resolution_hz: float  # smallest step a single window resolves
+    diode_noise_uV: float
+    conversions: int
+    pressure_noise: float
+    timebase_bias: float  # pressure error from timebase ppm, not averaged away
+    latency_ms: float
+    min_interval_frac: float
+    sim_freq_noise_hz: Optional[float] = None
+
+    def as_row(self) -> Dict[str, Any]:
+        return {key: value for key, value in asdict(self).items() if value is not None}
+
+
+def sensitivities(poly: SensorPoly, frequency_hz: Optional[float] = None, diode_uV: Optional[float] = None) -> tuple:
+    """Central-difference ∂P/∂f and ∂P/∂V of the sensor polynomial at an operating point."""
+
+    calc = PressureCalculator(poly)
+    f0 = poly.X if frequency_hz is None else frequency_hz
+    v0 = poly.Y if diode_uV is None else diode_uV
+    df, dv = 0.5, 50.0
+    dp_df = (calc.evaluate(f0 + df, v0) - calc.evaluate(f0 - df, v0)) / (2.0 * df)
+    dp_dv = (calc.evaluate(f0, v0 + dv) - calc.evaluate(f0, v0 - dv)) / (2.0 * dv)
+    return dp_df, dp_dv
+
+
+def float32_ulp(value: float) -> float:
+    return float(np.spacing(np.float32(value)))
+
+
+def recommend_min_interval_frac(spec: AcquisitionSpec) -> float:
+    """
+    Largest deglitch lockout that still keeps genuine edges safe: a real period
+    can come in early by about 6σ of the edge-to-edge jitter plus one timer tick.
+    """
+
+    period = 1.0 / spec.carrier_hz
+    margin = 6.0 * math.sqrt(2.0) * spec.jitter_s + spec.ts_resolution_s
+    return float(min(0.5, max(0.05, 1.0 - margin / period)))
+
+
+def predict(spec: AcquisitionSpec, mode: str, tau_ms: float) -> ModePrediction:
+    if mode not in MODES:
+        raise ValueError(f"mode must be one of {MODES}")
+    tau = tau_ms * 1e-3
+    f = spec.carrier_hz
+    stamp_var = spec.jitter_s**2 + spec.ts_resolution_s**2 / 12.0
+    if mode == "GATED":
+        sigma_f = 1.0 / (math.sqrt(6.0) * tau)
+        resolution = 1.0 / tau
+        latency = tau
+    else:
+        spans = 2.0 if mode == "DUAL" else 1.0
+        sigma_f = f * math.sqrt(2.0 * stamp_var / spans) / tau
+        # One timer tick of span moves the estimate by f·q/τ.
+        resolution = f * spec.ts_resolution_s / tau if spec.ts_resolution_s else sigma_f
+        # The window closes on the first edge after tau.
+        latency = tau + 1.0 / f
+    sigma_f = math.sqrt(sigma_f**2 + float32_ulp(f) ** 2 / 12.0)
+
+    conversions = int(tau * spec.adc_rate_sps)
+    # With no fresh conversion the previous value is reused: noise does not average down.
+    sigma_v = spec.adc_noise_uV / math.sqrt(max(conversions, 1))
+    pressure_noise = math.hypot(spec.dp_df * sigma_f, spec.dp_dv * sigma_v)
+    ppm = spec.pps_residual_ppm if spec.pps_locked else spec.crystal_ppm
+    return ModePrediction(
+        mode=mode,
+        tau_ms=tau_ms,
+        freq_noise_hz=sigma_f,
+        freq_resolution_hz=resolution,
+        diode_noise_uV=sigma_v,
+        conversions=conversions,
+        pressure_noise=pressure_noise,
+        timebase_bias=abs(spec.dp_df) * f * ppm * 1e-6,
+        latency_ms=latency * 1e3,
+        min_interval_frac=recommend_min_interval_frac(spec),
+    )
+
+
+def predict_all(
+    spec: AcquisitionSpec,
+    taus_ms: Iterable[float] = DEFAULT_TAUS_MS,
+    modes: Sequence[str] = MODES,
+) -> List[ModePrediction]:
+    return [predict(spec, mode, tau) for mode in modes for tau in taus_ms]
+
+
+def validate_candidate(
+    spec: AcquisitionSpec,
+    prediction: ModePrediction,
+    windows: int = 40,
+    max_edges: int = 400_000,
+    seed: int = 0,
+) -> float:
+    """Frequency standard deviation over simulated windows (stored in `sim_freq_noise_hz`)."""
+
+    tau = prediction.tau_ms * 1e-3
+    per_window = spec.carrier_hz * tau
+    windows = int(max(min(windows, max_edges // max(per_window, 1.0)), 8))
+    # With a carrier that is an exact multiple of 1/τ (or of the tick) every
+    # window would sit at the same phase. The prediction averages over phase,
+    # so pool runs at carriers detuned by quarter-spaced fractions of 1/τ.
+    detunes = (0.125, 0.375, 0.625, 0.875)
+    residuals = []
+    for index, detune in enumerate(detunes):
+        freqs = _simulate_windows(
+            spec, prediction.mode, tau, spec.carrier_hz + detune / tau, -(-windows // len(detunes)), seed + index
+        )
+        # Drop the first window: it starts on an arbitrary edge, not a window boundary.
+        residuals.append(freqs[1:] - freqs[1:].mean())
+    pooled = np.concatenate(residuals)
+    sim = float(np.sqrt(np.sum(pooled * pooled) / max(pooled.size - len(detunes), 1)))
+    prediction.sim_freq_noise_hz = sim
+    return sim
+
+
+def _simulate_windows(spec: AcquisitionSpec, mode: str, tau: float, f: float, windows: int, seed: int) -> np.ndarray:
+    per_window = f * tau
+    trace = EdgeTraceSpec(freq_hz=f, jitter_s=spec.jitter_s, seed=seed)
+    periods = int(per_window * (windows + 2)) + 2
+    rise, fall = synthetic_square_wave(trace, periods, start_s=0.1234567)
+    scale = 1e-6 / spec.ts_resolution_s
+    rise_ticks = quantize_us(rise * scale)
+    if mode == "GATED":
+        edges = np.arange(windows + 2) * tau * 1e6 * scale + rise_ticks[0] + 0.5
+        freqs = np.diff(np.searchsorted(rise_ticks, edges)) / tau
+    else:
+        dual = mode == "DUAL"
+        model = EdgeCounterModel(
+            dual,
+            int(round(per_window)),
+            min_interval_frac=recommend_min_interval_frac(spec),
+            freq_hint_hz=f / scale,
+        )
+        if dual:
+            ts, rising = interleave_edges(rise_ticks, quantize_us(fall * scale))
+        else:
+            ts, rising = rise_ticks, np.ones(rise_ticks.size, dtype=bool)
+        # The model counts in µs; finer ticks read as a proportionally lower carrier.
+        freqs = run_counter(model, ts, rising)[:, 0] * scale
+    return freqs.astype(np.float32).astype(float)
+
+
+def choose_presets(
+    predictions: Sequence[ModePrediction],
+    targets: Sequence[float] = (),
+    max_latency_ms: float = 1000.0,
+) -> Dict[str, ModePrediction]:
+    """
+    Per target pressure noise: the lowest-latency candidate that meets it.
+    Without targets: the quietest candidate of each mode within ``max_latency_ms``.
+    """
+
+    chosen: Dict[str, ModePrediction] = {}
+    if targets:
+        for target in targets:
+            ok = [p for p in predictions if p.pressure_noise <= target and p.latency_ms <= max_latency_ms]
+            if ok:
+                chosen[f"plan_{target:g}"] = min(ok, key=lambda p: (p.latency_ms, p.pressure_noise))
+        return chosen
+    for mode in MODES:
+        ok = [p for p in predictions if p.mode == mode and p.latency_ms <= max_latency_ms]
+        if ok:
+            chosen[mode.lower()] = min(ok, key=lambda p: (p.pressure_noise, p.latency_ms))
+    return chosen
+
+
+def to_preset(spec: AcquisitionSpec, prediction: ModePrediction) -> Dict[str, Any]:
+    """A `PRESETS`-style entry (runner.py), usable with `run --preset-file`."""
+
+    return {
+        "mode": prediction.mode,
+        "tau_ms": prediction.tau_ms,
+        "min_interval_frac": round(prediction.min_interval_frac, 3),
+        "timebase_ppm": 0.0,
+        "adc": {
+            "gain": spec.adc_gain,
+            "rate_sps": int(spec.adc_rate_sps),
+            "mains_reject": spec.mains_reject,
+        },
+    }
@@ -1,15 +1,17 @@
 from __future__ import annotations
 
 import csv
+import time
 from dataclasses import dataclass
 from pathlib import Path
-from typing import Callable, Dict, Iterable, List, Optional, TextIO
+from typing import Callable, Dict, Iterable, List, Optional, Sequence, TextIO, Union
 
 import numpy as np
 
 from .coeff import Coeff, coeff_metadata
 from .config import SensorPoly, TerpsConfig
 from .frames import Frame
+from .writer import GroupCommitLogger
 
 
 @dataclass
@@ -25,6 +27,8 @@ class SampleRecord:
     flags: int
     ppm_corr: float
     mode: str
+    slot: int = -1
+    adc_fresh: int = -1
 
 
 class PressureCalculator:
@@ -49,6 +53,14 @@ class PressureCalculator:
         y_powers = np.power(y, y_indices, dtype=float)
         return float(np.sum(self._k * np.outer(x_powers, y_powers)))
 
+    def evaluate_batch(self, frequency_hz: np.ndarray, diode_uV: np.ndarray) -> np.ndarray:
+        """Vectorised `evaluate` over equally sized frequency/voltage arrays."""
+        x = np.asarray(frequency_hz, dtype=float) - self.sensor_poly.X
+        y = np.asarray(diode_uV, dtype=float) - self.sensor_poly.Y
+        x_powers = np.power.outer(x, np.arange(self._rows, dtype=float))
+        y_powers = np.power.outer(y, np.arange(self._cols, dtype=float))
+        return np.sum((x_powers @ self._k) * y_powers, axis=1)
+
 
 class CsvLogger:
     """
@@ -76,6 +88,8 @@ class CsvLogger:
                 "flags",
                 "ppm_corr",
                 "mode",
+                "slot",
+                "adc_fresh",
             ]
             self._handle = csv.DictWriter(self._file_handle, fieldnames=fieldnames)
             for line in self._pending_metadata:
@@ -90,6 +104,10 @@ class CsvLogger:
         if self._file_handle is not None:
             self._file_handle.flush()
 
+    def append_batch(self, samples: Sequence[SampleRecord]) -> None:
+        for sample in samples:
+            self.append(sample)
+
     def set_metadata(self, metadata: Dict[str, str]) -> None:
         if not metadata:
             return
@@ -109,16 +127,45 @@ class CsvLogger:
             self._handle = None
 
 
+def _make_logger(config: TerpsConfig) -> Optional[Union[CsvLogger, GroupCommitLogger]]:
+    if not config.output_csv:
+        return None
+    host = config.host
+    if host.log_writer == "sync":
+        return CsvLogger(config.output_csv)
+    if host.log_writer != "group":
+        raise ValueError(f"Unsupported host.log_writer '{host.log_writer}'")
+    return GroupCommitLogger(
+        config.output_csv,
+        commit_rows=host.log_commit_rows,
+        commit_interval_s=host.log_commit_interval_sec,
+        fsync_interval_s=host.log_fsync_interval_sec,
+    )
+
+
+PIPELINE_STAGES = ("decode", "filter", "pressure", "records", "log", "callbacks")
+
+
 class SamplePipeline:
     """
     Glue that converts frames into processed samples and optionally logs them.
+
+    Frames are handled in batches: field extraction, flag filtering and the
+    pressure polynomial run as array operations, and the logger receives the
+    whole batch at once. Coefficient updates are staged and only take effect
+    at the next batch boundary, so every sample in a batch shares one version.
     """
 
     def __init__(self, config: TerpsConfig, coeff: Coeff):
         self.config = config
         self.coeff = coeff
-        self.logger = CsvLogger(config.output_csv) if config.output_csv else None
+        self.coeff_version = 0
+        self.logger = _make_logger(config)
         self._callbacks: List[Callable[[SampleRecord], None]] = []
+        self._batch_callbacks: List[Callable[[List[SampleRecord]], None]] = []
+        self._pending_coeff: Optional[Coeff] = None
+        self._timers: Dict[str, float] = dict.fromkeys(PIPELINE_STAGES, 0.0)
+        self._counts: Dict[str, int] = {"batches": 0, "frames": 0, "filtered": 0, "adc_reused": 0}
         poly = coeff.as_sensor_poly()
         self.config.sensor_poly = poly
         self.calculator = PressureCalculator(poly)
@@ -126,10 +173,45 @@ class SamplePipeline:
             self.logger.set_metadata(coeff_metadata(coeff))
 
     def process(self, frames: Iterable[Frame]) -> List[SampleRecord]:
+        batch_size = max(1, self.config.host.batch_max_frames)
         processed: List[SampleRecord] = []
+        batch: List[Frame] = []
         for frame in frames:
-            pressure = self.calculator.evaluate(frame.f_hz, frame.v_uV)
-            sample = SampleRecord(
+            batch.append(frame)
+            if len(batch) >= batch_size:
+                processed.extend(self.process_batch(batch))
+                batch = []
+        if batch:
+            processed.extend(self.process_batch(batch))
+        return processed
+
+    def process_batch(self, frames: Sequence[Frame]) -> List[SampleRecord]:
+        self._swap_coeff()
+        if not frames:
+            return []
+        timers = self._timers
+        count = len(frames)
+        t0 = time.perf_counter()
+        f_hz = np.fromiter((frame.f_hz for frame in frames), dtype=float, count=count)
+        v_uV = np.fromiter((frame.v_uV for frame in frames), dtype=float, count=count)
+        # Frames whose diode value repeats the previous conversion (tau shorter than the ADC period).
+        self._counts["adc_reused"] += sum(1 for frame in frames if frame.adc_fresh == 0)
+        t1 = time.perf_counter()
+        drop_mask = self.config.host.drop_flags
+        require_mask = self.config.host.require_flags
+        if drop_mask or require_mask:
+            flags = np.fromiter((frame.flags for frame in frames), dtype=np.int64, count=count)
+            keep = np.flatnonzero(((flags & drop_mask) == 0) & ((flags & require_mask) == require_mask))
+            if keep.size != count:
+                frames = [frames[idx] for idx in keep.tolist()]
+                f_hz = f_hz[keep]
+                v_uV = v_uV[keep]
+                self._counts["filtered"] += count - int(keep.size)
+        t2 = time.perf_counter()
+        pressures = self.calculator.evaluate_batch(f_hz, v_uV).tolist()
+        t3 = time.perf_counter()
+        samples = [
+            SampleRecord(
                 ts_ms=frame.ts_ms,
                 frequency_hz=frame.f_hz,
                 tau_ms=frame.tau_ms,
@@ -139,19 +221,56 @@ class SamplePipeline:
                 flags=frame.flags,
                 ppm_corr=frame.ppm_corr,
                 mode=frame.mode,
+                slot=frame.slot,
+                adc_fresh=frame.adc_fresh,
             )
-            processed.append(sample)
-            if self.logger:
-                self.logger.append(sample)
+            for frame, pressure in zip(frames, pressures)
+        ]
+        t4 = time.perf_counter()
+        if self.logger and samples:
+            self.logger.append_batch(samples)
+        t5 = time.perf_counter()
         for callback in self._callbacks:
-            callback(sample)
-        return processed
+            for sample in samples:
+                callback(sample)
+        for batch_callback in self._batch_callbacks:
+            batch_callback(samples)
+        t6 = time.perf_counter()
+        timers["decode"] += t1 - t0
+        timers["filter"] += t2 - t1
+        timers["pressure"] += t3 - t2
+        timers["records"] += t4 - t3
+        timers["log"] += t5 - t4
+        timers["callbacks"] += t6 - t5
+        self._counts["batches"] += 1
+        self._counts["frames"] += count
+        return samples
+
+    def stats(self) -> Dict[str, float]:
+        """Batch/frame counters plus cumulative per-stage time in seconds."""
+        data: Dict[str, float] = {key: float(value) for key, value in self._counts.items()}
+        data["coeff_version"] = float(self.coeff_version)
+        for stage, seconds in self._timers.items():
+            data[f"{stage}_s"] = seconds
+        return data
 
     def register_callback(self, callback: Callable[[SampleRecord], None]) -> None:
         self._callbacks.append(callback)
 
+    def register_batch_callback(self, callback: Callable[[List[SampleRecord]], None]) -> None:
+        self._batch_callbacks.append(callback)
+
     def update_coeff(self, coeff: Coeff) -> None:
+        """Stage a coefficient set; it is swapped in before the next batch."""
+        self._pending_coeff = coeff
+
+    def _swap_coeff(self) -> None:
+        coeff = self._pending_coeff
+        if coeff is None:
+            return
+        self._pending_coeff = None
         self.coeff = coeff
+        self.coeff_version += 1
         poly = coeff.as_sensor_poly()
         self.config.sensor_poly = poly
         self.calculator = PressureCalculator(poly)
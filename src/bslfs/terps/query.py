@@ -0,0 +1,220 @@
+"""
+Range queries and grouped aggregates over archived sample logs.
+
+Each log gets a sidecar index (`<log>.idx.json`) describing line-aligned byte
+chunks with their row count, `ts_ms` range and the OR/AND of their flag
+bits. Time-range and flag predicates are checked against the index first so
+non-matching chunks are never read; surviving chunks are scanned in parallel
+and reduced to per-bucket partial aggregates that are merged at the end.
+"""
+
+from __future__ import annotations
+
+import json
+import logging
+import os
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import asdict, dataclass, field
+from pathlib import Path
+from typing import List, Optional, Sequence, Tuple
+
+import numpy as np
+import pandas as pd
+
+from ..fastcsv import csv_layout, read_csv_range
+
+logger = logging.getLogger(__name__)
+
+INDEX_VERSION = 1
+INDEX_CHUNK_BYTES = 4 * 1024 * 1024
+
+
+@dataclass
+class ChunkIndex:
+    start: int
+    stop: int
+    rows: int
+    ts_min: float
+    ts_max: float
+    flags_any: int
+    flags_all: int
+
+
+@dataclass
+class LogIndex:
+    path: str
+    size: int
+    mtime_ns: int
+    header: List[str]
+    chunks: List[ChunkIndex] = field(default_factory=list)
+
+    @staticmethod
+    def sidecar(path: Path) -> Path:
+        return path.with_name(path.name + ".idx.json")
+
+
+@dataclass
+class QuerySpec:
+    fields: Tuple[str, ...] = ("pressure",)
+    ts_from: Optional[float] = None
+    ts_to: Optional[float] = None
+    require_flags: int = 0
+    reject_flags: int = 0
+    bucket_ms: Optional[float] = None
+
+    def chunk_may_match(self, chunk: ChunkIndex) -> bool:
+        if chunk.rows == 0:
+            return False
+        if self.ts_from is not None and chunk.ts_max < self.ts_from:
+            return False
+        if self.ts_to is not None and chunk.ts_min >= self.ts_to:
+            return False
+        if self.require_flags and (chunk.flags_any & self.require_flags) != self.require_flags:
+            return False
+        if self.reject_flags and chunk.flags_all & self.reject_flags:
+            return False
+        return True
+
+
+@dataclass
+class QueryStats:
+    files: int = 0
+    chunks_total: int = 0
+    chunks_scanned: int = 0
+    rows_scanned: int = 0
+    rows_matched: int = 0
+    bytes_scanned: int = 0
+
+
+def build_index(path: Path, chunk_bytes: int = INDEX_CHUNK_BYTES) -> LogIndex:
+    stat = path.stat()
+    layout = csv_layout(path, chunk_bytes)
+    index = LogIndex(
+        path=str(path), size=stat.st_size, mtime_ns=stat.st_mtime_ns, header=layout.header
+    )
+    for start, stop in layout.chunks:
+        frame = read_csv_range(path, layout.header, start, stop, usecols=["ts_ms", "flags"])
+        if frame.empty:
+            index.chunks.append(ChunkIndex(start, stop, 0, 0.0, 0.0, 0, 0))
+            continue
+        ts = frame["ts_ms"].to_numpy(dtype=float)
+        flags = frame["flags"].to_numpy(dtype=np.int64)
+        index.chunks.append(
+            ChunkIndex(
+                start=start,
+                stop=stop,
+                rows=int(ts.size),
+                ts_min=float(ts.min()),
+                ts_max=float(ts.max()),
+                flags_any=int(np.bitwise_or.reduce(flags)),
+                flags_all=int(np.bitwise_and.reduce(flags)),
+            )
+        )
+    sidecar = LogIndex.sidecar(path)
+    payload = {"version": INDEX_VERSION, **asdict(index)}
+    try:
+        sidecar.write_text(json.dumps(payload), encoding="utf-8")
+    except OSError as exc:  # read-only archive: keep the in-memory index
+        logger.warning("Cannot write index %s: %s", sidecar, exc)
+    return index
+
+
+def load_index(path: Path, chunk_bytes: int = INDEX_CHUNK_BYTES) -> LogIndex:
+    """Return the sidecar index, rebuilding it when missing or stale."""
+
+    sidecar = LogIndex.sidecar(path)
+    stat = path.stat()
+    try:
+        data = json.loads(sidecar.read_text(encoding="utf-8"))
+        if (
+            data.get("version") == INDEX_VERSION
+            and data.get("size") == stat.st_size
+            and data.get("mtime_ns") == stat.st_mtime_ns
+        ):
+            return LogIndex(
+                path=str(path),
+                size=int(data["size"]),
+                mtime_ns=int(data["mtime_ns"]),
+                header=list(data["header"]),
+                chunks=[ChunkIndex(**chunk) for chunk in data["chunks"]],
+            )
+    except (OSError, ValueError, KeyError, TypeError):
+        pass
+    return build_index(path, chunk_bytes)
+
+
+def _scan_chunk(
+    path: Path, header: List[str], chunk: ChunkIndex, spec: QuerySpec
+) -> Tuple[pd.DataFrame, int, int]:
+    usecols = sorted({"ts_ms", "flags", *spec.fields}, key=header.index)
+    frame = read_csv_range(path, header, chunk.start, chunk.stop, usecols=usecols)
+    rows = len(frame)
+    mask = np.ones(rows, dtype=bool)
+    ts = frame["ts_ms"].to_numpy(dtype=float)
+    if spec.ts_from is not None:
+        mask &= ts >= spec.ts_from
+    if spec.ts_to is not None:
+        mask &= ts < spec.ts_to
+    if spec.require_flags or spec.reject_flags:
+        flags = frame["flags"].to_numpy(dtype=np.int64)
+        mask &= (flags & spec.require_flags) == spec.require_flags
+        mask &= (flags & spec.reject_flags) == 0
+    selected = frame.loc[mask, list(spec.fields)]
+    if spec.bucket_ms:
+        bucket = np.floor(ts[mask] / spec.bucket_ms) * spec.bucket_ms
+    else:
+        bucket = np.zeros(int(mask.sum()))
+    grouped = selected.groupby(bucket)
+    partial = pd.concat(
+        {"count": grouped.size().to_frame("n"), "sum": grouped.sum(), "min": grouped.min(), "max": grouped.max()},
+        axis=1,
+    )
+    return partial, rows, int(mask.sum())
+
+
+def run_query(
+    paths: Sequence[Path], spec: QuerySpec, workers: Optional[int] = None
+) -> Tuple[pd.DataFrame, QueryStats]:
+    """
+    Evaluate `spec` over `paths`. The result has one row per bucket
+    (`bucket_ms` start, or 0 when ungrouped) with `count` and
+    `<field>_mean/_min/_max` columns.
+    """
+
+    stats = QueryStats(files=len(paths))
+    tasks: List[Tuple[Path, List[str], ChunkIndex]] = []
+    for path in paths:
+        index = load_index(Path(path))
+        missing = [name for name in ("ts_ms", "flags", *spec.fields) if name not in index.header]
+        if missing:
+            raise ValueError(f"{path}: missing columns {missing}")
+        stats.chunks_total += len(index.chunks)
+        for chunk in index.chunks:
+            if spec.chunk_may_match(chunk):
+                tasks.append((Path(path), index.header, chunk))
+    stats.chunks_scanned = len(tasks)
+    stats.bytes_scanned = sum(chunk.stop - chunk.start for _, _, chunk in tasks)
+
+    with ThreadPoolExecutor(max_workers=workers or os.cpu_count() or 1) as pool:
+        partials = list(pool.map(lambda task: _scan_chunk(task[0], task[1], task[2], spec), tasks))
+
+    columns = ["bucket", "count"] + [f"{name}_{agg}" for name in spec.fields for agg in ("mean", "min", "max")]
+    frames = [partial for partial, _, matched in partials if matched]
+    for _, rows, matched in partials:
+        stats.rows_scanned += rows
+        stats.rows_matched += matched
+    if not frames:
+        return pd.DataFrame(columns=columns), stats
+
+    merged = pd.concat(frames)
+    level = merged.index
+    count = merged["count"]["n"].groupby(level).sum()
+    total = merged["sum"].groupby(level).sum()
+    lows = merged["min"].groupby(level).min()
+    highs = merged["max"].groupby(level).max()
+    result = pd.DataFrame({"bucket": count.index.to_numpy(), "count": count.to_numpy()})
+    for name in spec.fields:
+        result[f"{name}_mean"] = (total[name] / count).to_numpy()
+        result[f"{name}_min"] = lows[name].to_numpy()
+        result[f"{name}_max"] = highs[name].to_numpy()
+    return result[columns], stats
@@ -1,5 +1,6 @@
 from __future__ import annotations
 
+import json
 import logging
 import queue
 import sys
@@ -7,7 +8,7 @@ import threading
 import time
 from dataclasses import dataclass, field
 from pathlib import Path
-from typing import TYPE_CHECKING, Any, Callable, Dict, List, Optional, Sequence
+from typing import TYPE_CHECKING, Any, Callable, Dict, List, Optional, Sequence, Tuple
 
 import typer
 
@@ -16,6 +17,7 @@ try:
 except ImportError:  # pragma: no cover - handled in CLI validation
     serial = None  # type: ignore[assignment]
 
+from .capture import Timestamps, encode_edges, read_capture, residual_stats
 from .coeff import (
     Coeff,
     CoeffManager,
@@ -23,13 +25,34 @@ from .coeff import (
     EepromOverCdc,
     ManualOverride,
     RPS_EEPROM_SIZE,
-    parse_eeprom_dump,
+    parse_eeprom_scan,
     parse_rps_eeprom,
+    read_eeprom_image,
     save_manual_coeff,
 )
 from .config import TerpsConfig, load_config
+from .ctrl_out import SOURCES, poly_commands
 from .frames import Frame, FrameFormat, FrameParser
+from .join import JOIN_MODES, JoinedCsvWriter, StreamJoiner, join_logs
+from .hdrhist import LogLinearHistogram, histogram_csv_column, read_firmware_hist
+from .noise_model import (
+    DEFAULT_TAUS_MS,
+    MODES,
+    AcquisitionSpec,
+    choose_presets,
+    predict_all,
+    sensitivities,
+    to_preset,
+    validate_candidate,
+)
 from .processing import SamplePipeline
+from .query import QuerySpec, load_index, run_query
+from .schedule import SlotScheduler
+from .schema import PACKET_TX_STATE
+from .surface import FIT_METHODS, fit_surface, load_calibration
+from .stream import AGGREGATES, SampleStreamServer, SubscriptionSpec, subscribe
+from .tracelog import TraceRecord, TraceStringTable, format_record, parse_trace_line
+from .txpace import parse_tx_line
 
 logger = logging.getLogger(__name__)
 
@@ -62,8 +85,8 @@ PRESETS: Dict[str, Dict[str, Any]] = {
 }
 
 
-def preset_overrides(preset: str) -> list[str]:
-    data = PRESETS[preset]
+def preset_overrides(preset: str, presets: Optional[Dict[str, Dict[str, Any]]] = None) -> list[str]:
+    data = (presets or PRESETS)[preset]
     overrides = [
         f"mode={data['mode']}",
         f"tau_ms={data['tau_ms']}",
@@ -83,12 +106,27 @@ class SerialSettings:
     timeout: float = 2.0
 
 
+CommandReply = Tuple[List[str], bytes]
+
+
+def _binary_length(header: str) -> int:
+    for token in header.split()[1:]:
+        if token.upper().startswith("BIN="):
+            try:
+                return max(int(token[4:], 0), 0)
+            except ValueError:
+                return 0
+    return 0
+
+
 @dataclass
 class CommandRequest:
     command: str
-    response: "queue.Queue[List[str]]"
+    response: "queue.Queue[CommandReply]"
     timeout: float
     started: float = field(default=0.0)
+    binary: bool = False
+    payload: bytes = b""
 
 
 class SerialReaderThread(threading.Thread):
@@ -104,11 +142,13 @@ class SerialReaderThread(threading.Thread):
         self.frame_format = frame_format
         self.config = config
         self.queue = frame_queue
-        self.parser = FrameParser(frame_format)
+        self.parser = FrameParser(frame_format, on_trace=self._on_trace, on_record=self._on_record)
         self._stop_event = threading.Event()
         self._serial_handle = None
         self._dropped = 0
         self._reconnects = 0
+        self._tx_changes = 0
+        self.tx_state: Optional[Dict[str, object]] = None
         self._connected_once = False
         self.last_exception: Optional[Exception] = None
         self._log = logging.getLogger(__name__)
@@ -116,6 +156,13 @@ class SerialReaderThread(threading.Thread):
         self._active_command: Optional[CommandRequest] = None
         self._command_buffer: List[str] = []
         self._ready_event = threading.Event()
+        self._device_log = logging.getLogger("bslfs.terps.device")
+        self._trace_table: Optional[TraceStringTable] = None
+        if config.host.trace_strings:
+            try:
+                self._trace_table = TraceStringTable.load(config.host.trace_strings)
+            except (OSError, ValueError) as exc:
+                self._log.warning("Failed to load trace string table: %s", exc)
 
     def run(self) -> None:  # pragma: no cover - exercised via integration-style tests
         initial_delay = max(self.config.host.reconnect_initial_sec, 0.1)
@@ -181,6 +228,7 @@ class SerialReaderThread(threading.Thread):
         stats = self.parser.stats()
         stats["dropped"] = self._dropped
         stats["reconnects"] = self._reconnects
+        stats["tx_changes"] = self._tx_changes
         return stats
 
     def _emit(self, frame: Frame) -> None:
@@ -190,11 +238,40 @@ class SerialReaderThread(threading.Thread):
             self._dropped += 1
             self._log.warning("Frame queue full (%d), dropping frame", self.queue.qsize())
 
+    def _on_trace(self, record: TraceRecord) -> None:
+        self._device_log.info("%s", format_record(record, self._trace_table))
+
+    def _on_record(self, packet_type: int, record: Dict[str, object]) -> None:
+        if packet_type == PACKET_TX_STATE:
+            self._on_tx_state(record)
+
+    def _on_tx_state(self, record: Dict[str, object]) -> None:
+        # The device changed its USB packing; summary frames cover several windows.
+        self._tx_changes += 1
+        self.tx_state = record
+        self._log.info(
+            "Device TX step %s (batch=%s merge=%s, drain %s B/s of %s B/s demand)",
+            record.get("step"),
+            record.get("batch"),
+            record.get("merge"),
+            record.get("drain_Bps"),
+            record.get("demand_Bps"),
+        )
+
     def execute_command(self, command: str, timeout: float = 2.0) -> List[str]:
+        return self._submit_command(command, timeout, binary=False)[0]
+
+    def execute_binary_command(self, command: str, timeout: float = 2.0) -> CommandReply:
+        """Run a command whose `OK ... BIN=<n>` header is followed by n raw bytes."""
+        return self._submit_command(command, timeout, binary=True)
+
+    def _submit_command(self, command: str, timeout: float, *, binary: bool) -> CommandReply:
         if not self._ready_event.wait(timeout):
             raise TimeoutError("Serial device not ready")
-        response: "queue.Queue[List[str]]" = queue.Queue(maxsize=1)
-        request = CommandRequest(command=command.strip(), response=response, timeout=timeout)
+        response: "queue.Queue[CommandReply]" = queue.Queue(maxsize=1)
+        request = CommandRequest(
+            command=command.strip(), response=response, timeout=timeout, binary=binary
+        )
         self._command_queue.put(request)
         try:
             return response.get(timeout=timeout)
@@ -218,6 +295,15 @@ class SerialReaderThread(threading.Thread):
                 continue
             if self._handle_command_line(line):
                 continue
+            if line.startswith("#"):
+                tx_state = parse_tx_line(line)
+                if tx_state is not None:
+                    self._on_tx_state(tx_state)
+                    continue
+                record = parse_trace_line(line)
+                if record is not None:
+                    self._on_trace(record)
+                continue
             yield line
 
     def _iter_binary_chunks(self, chunk_size: int):
@@ -247,14 +333,14 @@ class SerialReaderThread(threading.Thread):
         except queue.Empty:
             return
         if self._serial_handle is None:
-            request.response.put(["ERR NOT_CONNECTED"])
+            request.response.put((["ERR NOT_CONNECTED"], b""))
             return
         payload = (request.command + "\n").encode("ascii", errors="ignore")
         try:
             self._serial_handle.write(payload)
             self._serial_handle.flush()
         except Exception as exc:
-            request.response.put([f"ERR WRITE_FAILED {exc}"])
+            request.response.put(([f"ERR WRITE_FAILED {exc}"], b""))
             return
         request.started = time.monotonic()
         self._active_command = request
@@ -280,13 +366,26 @@ class SerialReaderThread(threading.Thread):
             self._command_buffer.append(stripped)
         if stripped == "END":
             self._complete_command(self._command_buffer.copy())
+        elif self._active_command.binary and stripped.startswith("OK"):
+            self._active_command.payload = self._read_exact(_binary_length(stripped))
         return True
 
+    def _read_exact(self, length: int) -> bytes:
+        data = bytearray()
+        deadline = time.monotonic() + max(self.settings.timeout, 1.0)
+        while len(data) < length and self._serial_handle is not None:
+            chunk = self._serial_handle.read(length - len(data))
+            if chunk:
+                data.extend(chunk)
+            elif time.monotonic() > deadline:
+                break
+        return bytes(data)
+
     def _complete_command(self, lines: List[str]) -> None:
         if self._active_command is None:
             return
         try:
-            self._active_command.response.put_nowait(lines)
+            self._active_command.response.put_nowait((lines, self._active_command.payload))
         except queue.Full:
             pass
         finally:
@@ -331,6 +430,30 @@ class SerialCommandClient:
                 return lines
         raise TimeoutError(f"Timeout waiting for '{command}' response")
 
+    def execute_binary(self, command: str, timeout: Optional[float] = None) -> CommandReply:
+        deadline = time.monotonic() + (timeout or self._timeout)
+        payload = (command.strip() + "\n").encode("ascii", errors="ignore")
+        self._serial.reset_input_buffer()
+        self._serial.write(payload)
+        self._serial.flush()
+        lines: List[str] = []
+        block = bytearray()
+        while time.monotonic() < deadline:
+            raw = self._serial.readline()
+            if not raw:
+                continue
+            decoded = raw.decode("utf-8", errors="ignore").rstrip("\r\n")
+            lines.append(decoded)
+            if decoded == "END":
+                return lines, bytes(block)
+            if len(lines) == 1 and decoded.startswith("OK"):
+                remaining = _binary_length(decoded)
+                while remaining > 0 and time.monotonic() < deadline:
+                    chunk = self._serial.read(remaining)
+                    block.extend(chunk)
+                    remaining -= len(chunk)
+        raise TimeoutError(f"Timeout waiting for '{command}' response")
+
     def close(self) -> None:
         try:
             self._serial.close()
@@ -338,6 +461,20 @@ class SerialCommandClient:
             pass
 
 
+def _format_pipeline_stats(stats: Dict[str, float]) -> str:
+    frames = max(stats.get("frames", 0.0), 1.0)
+    batches = max(stats.get("batches", 0.0), 1.0)
+    stages = " ".join(
+        f"{key[:-2]}={1e6 * value / frames:.2f}us" for key, value in stats.items() if key.endswith("_s")
+    )
+    return (
+        f"batches={int(stats.get('batches', 0))} avg_batch={frames / batches:.1f} "
+        f"filtered={int(stats.get('filtered', 0))} adc_reused={int(stats.get('adc_reused', 0))} "
+        f"coeff_version={int(stats.get('coeff_version', 0))} "
+        f"per-frame: {stages}"
+    )
+
+
 class TerpsHost:
     """Host-side orchestrator running on Raspberry Pi."""
 
@@ -362,48 +499,77 @@ class TerpsHost:
         self.pipeline = SamplePipeline(config, initial_coeff)
         if self.plotter:
             self.pipeline.register_callback(self.plotter.on_sample)
+        self.stream_server: Optional[SampleStreamServer] = None
+        if config.host.stream_socket:
+            self.stream_server = SampleStreamServer(config.host.stream_socket)
+            self.pipeline.register_batch_callback(self.stream_server.publish)
         self._coeff_manager: Optional[CoeffManager] = None
         self._eeprom_provider: Optional[EepromOverCdc] = None
+        self._scheduler: Optional[SlotScheduler] = None
 
     def run(self) -> None:
-        if self.settings.port == "-":
-            self._run_from_stream()
-            return
+        if self.stream_server is not None:
+            self.stream_server.start()
+        try:
+            if self.settings.port == "-":
+                self._run_from_stream()
+            else:
+                self._run_serial()
+        finally:
+            if self.stream_server is not None:
+                logger.info("Stream server: %s", self.stream_server.stats())
+                self.stream_server.close()
+
+    def _run_serial(self) -> None:
 
         frame_queue: "queue.Queue[Frame]" = queue.Queue(maxsize=self.config.host.queue_maxsize)
         reader = SerialReaderThread(self.settings, self.frame_format, self.config, frame_queue)
         reader.start()
         self._setup_coeff_manager(reader)
+        self._setup_scheduler(reader)
         processed = 0
+        batch_max = max(1, self.config.host.batch_max_frames)
         interval_sec = max(float(self.config.host.stats_log_interval), 5.0)
         next_log = time.monotonic() + interval_sec
 
         def emit_stats() -> None:
             stats = reader.stats()
             logger.info(
-                "processed=%d frames=%d crc_errors=%d length_errors=%d dropped=%d reconnects=%d",
+                "processed=%d frames=%d crc_errors=%d length_errors=%d lost_bytes=%d lost_frames=%d "
+                "dropped=%d reconnects=%d",
                 processed,
                 stats.get("frames", 0),
                 stats.get("crc_errors", 0),
                 stats.get("length_errors", 0),
+                stats.get("lost_bytes", 0),
+                stats.get("lost_frames", 0),
                 stats.get("dropped", 0),
                 stats.get("reconnects", 0),
             )
+            logger.debug("pipeline %s", _format_pipeline_stats(self.pipeline.stats()))
+
         try:
             while True:
                 try:
-                    frame = frame_queue.get(timeout=1.0)
+                    batch = [frame_queue.get(timeout=1.0)]
                 except queue.Empty:
+                    self._resync_schedule()
                     if time.monotonic() >= next_log:
                         emit_stats()
                         next_log = time.monotonic() + interval_sec
                     continue
-                self.pipeline.process([frame])
+                while len(batch) < batch_max:
+                    try:
+                        batch.append(frame_queue.get_nowait())
+                    except queue.Empty:
+                        break
+                self.pipeline.process_batch(batch)
                 if self._coeff_manager is not None:
                     updated = self._coeff_manager.refresh(time.monotonic())
                     if updated is not None:
                         self._apply_coeff(updated)
-                processed += 1
+                self._resync_schedule()
+                processed += len(batch)
                 if time.monotonic() >= next_log:
                     emit_stats()
                     next_log = time.monotonic() + interval_sec
@@ -415,14 +581,20 @@ class TerpsHost:
             final_stats = reader.stats()
             self.pipeline.close()
             logger.info(
-                "Final stats: processed=%d frames=%d crc_errors=%d length_errors=%d dropped=%d reconnects=%d",
+                "Final stats: processed=%d frames=%d crc_errors=%d length_errors=%d lost_bytes=%d "
+                "lost_frames=%d dropped=%d reconnects=%d",
                 processed,
                 final_stats.get("frames", 0),
                 final_stats.get("crc_errors", 0),
                 final_stats.get("length_errors", 0),
+                final_stats.get("lost_bytes", 0),
+                final_stats.get("lost_frames", 0),
                 final_stats.get("dropped", 0),
                 final_stats.get("reconnects", 0),
             )
+            logger.info("Pipeline: %s", _format_pipeline_stats(self.pipeline.stats()))
+            if self._scheduler is not None:
+                logger.info("Schedule: %s", self._scheduler.stats())
             if self.plotter:
                 self.plotter.close()
 
@@ -451,7 +623,9 @@ class TerpsHost:
         reader.wait_ready(wait_timeout)
         eeprom_provider = None
         if self._coeff_mode != "manual" and self.frame_format is FrameFormat.CSV:
-            eeprom_provider = EepromOverCdc(reader.execute_command)
+            eeprom_provider = EepromOverCdc(
+                reader.execute_command, binary_executor=reader.execute_binary_command
+            )
             self._eeprom_provider = eeprom_provider
         elif self._coeff_mode != "manual" and self.frame_format is FrameFormat.BINARY:
             logger.warning("Disabling EEPROM refresh while streaming binary frames")
@@ -464,6 +638,33 @@ class TerpsHost:
         )
         self._apply_coeff(self._coeff_manager.current)
 
+    def _setup_scheduler(self, reader: SerialReaderThread) -> None:
+        period_ms = self.config.host.schedule_period_ms
+        if period_ms <= 0:
+            return
+        scheduler = SlotScheduler(
+            reader.execute_command,
+            period_ms,
+            timeout=max(self.settings.timeout, 1.0),
+            resync_sec=self.config.host.schedule_resync_sec,
+        )
+        try:
+            slot = scheduler.start()
+        except (RuntimeError, TimeoutError, ValueError) as exc:
+            logger.warning("Time-triggered acquisition unavailable: %s", exc)
+            return
+        logger.info("Scheduled windows every %.3f ms from slot %d (rtt=%.0f us)", period_ms, slot, scheduler.stats()["rtt_us"])
+        self._scheduler = scheduler
+
+    def _resync_schedule(self) -> None:
+        if self._scheduler is None:
+            return
+        try:
+            if self._scheduler.maybe_resync():
+                logger.info("Schedule re-anchored: %s", self._scheduler.stats())
+        except (RuntimeError, TimeoutError, ValueError) as exc:
+            logger.warning("Schedule resync failed: %s", exc)
+
     def _apply_coeff(self, coeff) -> None:
         self.pipeline.update_coeff(coeff)
         if self.plotter and hasattr(self.plotter, "set_coeff_source"):
@@ -486,15 +687,56 @@ def coeff_dump(
     settings = SerialSettings(port=port, baudrate=baudrate, timeout=timeout)
     client = SerialCommandClient(settings)
     try:
-        lines = client.execute("EEPROM.DUMP 0 512", timeout=timeout)
+        blob, header = read_eeprom_image(
+            lambda cmd, tmo: client.execute(cmd, timeout=tmo),
+            lambda cmd, tmo: client.execute_binary(cmd, timeout=tmo),
+            timeout,
+        )
     finally:
         client.close()
-    blob, header = parse_eeprom_dump(lines)
     data = blob[:RPS_EEPROM_SIZE]
     out.write_bytes(data)
     typer.echo(f"Saved {len(data)} bytes from device {header.get('DEV', '?')} to {out}")
 
 
+@coeff_app.command("scan")
+def coeff_scan(
+    port: str = typer.Option("/dev/ttyACM0", "--port", "-p", help="Serial device"),
+    baudrate: int = typer.Option(921600, "--baud", help="Serial baudrate"),
+    timeout: float = typer.Option(5.0, "--timeout", help="Serial timeout (seconds)"),
+    out_dir: Optional[Path] = typer.Option(None, "--out-dir", help="Write rps_eeprom_bus<N>.bin per bus"),
+):
+    """Read the EEPROM on every UNI/O bus at once (firmware `EEPROM.SCAN`)."""
+
+    settings = SerialSettings(port=port, baudrate=baudrate, timeout=timeout)
+    client = SerialCommandClient(settings)
+    try:
+        lines = client.execute(f"EEPROM.SCAN 0 {RPS_EEPROM_SIZE}", timeout=timeout)
+    finally:
+        client.close()
+    try:
+        buses, header = parse_eeprom_scan(lines)
+    except ValueError as exc:
+        typer.echo(f"Scan failed: {exc}")
+        raise typer.Exit(code=1) from exc
+    typer.echo(f"{header.get('OK', '?')}/{len(buses)} buses read in {int(header.get('US', 0)) / 1000:.1f} ms")
+    if out_dir is not None:
+        out_dir.mkdir(parents=True, exist_ok=True)
+    for image in buses:
+        detail = ""
+        if image.status == "OK":
+            try:
+                coeff = parse_rps_eeprom(image.data, source="eeprom", device_address=image.device_address)
+                detail = f"serial={coeff.serial or 'n/a'} order={coeff.order}"
+            except ValueError as exc:
+                detail = f"checksum FAILED ({exc})"
+            if out_dir is not None:
+                (out_dir / f"rps_eeprom_bus{image.bus}.bin").write_bytes(image.data)
+        typer.echo(
+            f"bus {image.bus} gpio={image.gpio} {image.status} dev=0x{image.device_address:02X} {detail}".rstrip()
+        )
+
+
 @coeff_app.command("parse")
 def coeff_parse(
     input_path: Path = typer.Option(..., "--in", help="EEPROM binary file", exists=True, readable=True)
@@ -553,8 +795,470 @@ def coeff_set(
     typer.echo(f"Wrote manual coefficient profile to {out}")
 
 
+@coeff_app.command("fit")
+def coeff_fit(
+    inputs: List[Path] = typer.Argument(..., help="Calibration CSV files", exists=True, readable=True),
+    out: Path = typer.Option(..., "--out", help="Destination config JSON"),
+    nx: int = typer.Option(3, "--nx", help="Frequency axis order"),
+    ny: int = typer.Option(2, "--ny", help="Voltage axis order"),
+    x_ref: Optional[float] = typer.Option(None, "--x-ref", help="Reference frequency (default: midrange)"),
+    y_ref: Optional[float] = typer.Option(None, "--y-ref", help="Reference diode voltage µV (default: midrange)"),
+    method: str = typer.Option("lsq", "--method", help="lsq|minimax"),
+    f_col: str = typer.Option("frequency_hz", "--f-col", help="Frequency column"),
+    v_col: str = typer.Option("diode_uV", "--v-col", help="Diode voltage column"),
+    p_col: str = typer.Option("pressure_ref", "--p-col", help="Reference pressure column"),
+    w_col: Optional[str] = typer.Option(None, "--w-col", help="Optional per-point weight column"),
+    base: Optional[Path] = typer.Option(None, "--base", help="Config JSON to copy other sections from"),
+):
+    """Fit sensor_poly K from reference-pressure data and write a config JSON."""
+    if method not in FIT_METHODS:
+        raise typer.BadParameter(f"--method must be one of {', '.join(FIT_METHODS)}")
+    try:
+        f, v, p, w = load_calibration(inputs, f_col, v_col, p_col, w_col)
+        started = time.perf_counter()
+        fit = fit_surface(f, v, p, nx, ny, x_ref=x_ref, y_ref=y_ref, weights=w, method=method)
+        elapsed = time.perf_counter() - started
+    except ValueError as exc:
+        raise typer.BadParameter(str(exc)) from exc
+    base_data = json.loads(base.read_text(encoding="utf-8")) if base is not None else None
+    fit.save(out, base_data)
+    typer.echo(
+        f"Fitted {nx}x{ny} {method} surface on {fit.residuals.size} points in {elapsed * 1000:.0f} ms: "
+        f"rms={fit.rms:.6g} max={fit.max_abs:.6g} cond={fit.condition:.3g}"
+    )
+    if "minimax_lower_bound" in fit.metadata:
+        typer.echo(f"Minimax lower bound: {fit.metadata['minimax_lower_bound']:.6g} ({fit.iterations} iterations)")
+    typer.echo(f"X_ref: {fit.sensor_poly.X:.6f}  Y_ref: {fit.sensor_poly.Y:.6f}")
+    typer.echo(f"Wrote config with sensor_poly to {out}")
+
+
+capture_app = typer.Typer(help="Raw edge capture utilities.")
+
+
+def _echo_capture_summary(timestamps: Timestamps) -> None:
+    _, stats = encode_edges(timestamps)
+    summary = residual_stats(timestamps)
+    typer.echo(f"Edges: {stats.edges}  bytes: {stats.bytes_used}  bits/edge: {stats.bits_per_edge:.2f}")
+    typer.echo(f"Ratio vs u32 timestamps: {stats.ratio(4):.1f}x  vs u64: {stats.ratio(8):.1f}x")
+    typer.echo(
+        f"Tokens: 4b={stats.tokens4} 8b={stats.tokens8} 16b={stats.tokens16} 32b={stats.tokens32}"
+    )
+    typer.echo(f"Residual (us): min={summary.min} max={summary.max} std={summary.std:.3f}")
+
+
+@capture_app.command("record")
+def capture_record(
+    port: str = typer.Option("/dev/ttyACM0", "--port", "-p", help="Serial device"),
+    baudrate: int = typer.Option(921600, "--baud", help="Serial baudrate"),
+    timeout: float = typer.Option(2.0, "--timeout", help="Serial timeout (seconds)"),
+    max_edges: int = typer.Option(0, "--edges", help="Stop after N edges (0 = until buffer full)"),
+    wait: float = typer.Option(10.0, "--wait", help="Maximum capture duration (seconds)"),
+    out: Path = typer.Option(Path("edges.csv"), "--out", help="Output CSV of edge timestamps"),
+):
+    settings = SerialSettings(port=port, baudrate=baudrate, timeout=timeout)
+    client = SerialCommandClient(settings)
+    try:
+        timestamps, status = read_capture(
+            lambda cmd, tmo: client.execute(cmd, timeout=tmo),
+            lambda cmd, tmo: client.execute_binary(cmd, timeout=tmo),
+            timeout,
+            max_edges=max_edges,
+            wait_s=wait,
+        )
+    finally:
+        client.close()
+    if status.get("OVERFLOW", "0") != "0":
+        typer.echo("Capture buffer filled before the edge limit was reached")
+    out.write_text("ts_us\n" + "".join(f"{int(ts)}\n" for ts in timestamps), encoding="utf-8")
+    typer.echo(f"Saved {len(timestamps)} edge timestamps to {out}")
+    _echo_capture_summary(timestamps)
+
+
+@capture_app.command("stats")
+def capture_stats(
+    input_path: Path = typer.Option(..., "--in", help="Edge timestamp CSV", exists=True, readable=True)
+):
+    lines = input_path.read_text(encoding="utf-8").split()
+    timestamps = [int(token) for token in lines if token.isdigit()]
+    if len(timestamps) < 3:
+        raise typer.BadParameter("Need at least three edge timestamps")
+    _echo_capture_summary(timestamps)
+
+
+out_app = typer.Typer(help="Firmware control output (PWM / SPI DAC).")
+
+
+def _out_execute(port: str, baudrate: int, timeout: float, commands: Sequence[str]) -> List[str]:
+    """Run ``commands`` in order; stops at the first ERR reply and returns the last reply."""
+
+    client = SerialCommandClient(SerialSettings(port=port, baudrate=baudrate, timeout=timeout))
+    try:
+        lines: List[str] = []
+        for command in commands:
+            lines = client.execute(command, timeout=timeout)
+            if lines and lines[0].startswith("ERR"):
+                typer.echo(f"{command}: {lines[0]}")
+                raise typer.Exit(code=1)
+        return lines
+    finally:
+        client.close()
+
+
+def _echo_out_status(lines: Sequence[str]) -> None:
+    for line in lines:
+        if line.startswith("OK"):
+            typer.echo("\n".join(line.split()[1:]))
+
+
+@out_app.command("status")
+def out_status(
+    port: str = typer.Option("/dev/ttyACM0", "--port", "-p", help="Serial device"),
+    baudrate: int = typer.Option(921600, "--baud", help="Serial baudrate"),
+    timeout: float = typer.Option(2.0, "--timeout", help="Serial timeout (seconds)"),
+    reset: bool = typer.Option(False, "--reset", help="Clear the latency and update counters"),
+):
+    """Show source, scaling, last level and edge-to-output latency."""
+
+    _echo_out_status(_out_execute(port, baudrate, timeout, ["OUT.RESET" if reset else "OUT.STATUS"]))
+
+
+@out_app.command("set")
+def out_set(
+    source: str = typer.Option(..., "--source", help="OFF, FREQ or PRESSURE"),
+    in_lo: float = typer.Option(..., "--in-lo", help="Source value (Hz or pressure) at --min"),
+    in_hi: float = typer.Option(..., "--in-hi", help="Source value at --max"),
+    out_min: float = typer.Option(0.0, "--min", help="Lower output limit, fraction of full scale"),
+    out_max: float = typer.Option(1.0, "--max", help="Upper output limit, fraction of full scale"),
+    fault: Optional[float] = typer.Option(None, "--fault", help="Level on invalid windows (default: hold)"),
+    config_path: Optional[Path] = typer.Option(
+        None, "--config", "-c", help="Upload sensor_poly from this config first (PRESSURE)"
+    ),
+    port: str = typer.Option("/dev/ttyACM0", "--port", "-p", help="Serial device"),
+    baudrate: int = typer.Option(921600, "--baud", help="Serial baudrate"),
+    timeout: float = typer.Option(2.0, "--timeout", help="Serial timeout (seconds)"),
+):
+    """Configure the control output; pressure uses the surface uploaded with --config."""
+
+    source = source.upper()
+    if source not in SOURCES:
+        raise typer.BadParameter(f"--source must be one of {', '.join(SOURCES)}")
+    commands: List[str] = []
+    if config_path is not None:
+        commands += poly_commands(load_config(config_path).sensor_poly)
+    commands += [
+        f"OUT.SCALE {in_lo!r} {in_hi!r} {out_min!r} {out_max!r}",
+        "OUT.FAULT HOLD" if fault is None else f"OUT.FAULT {fault!r}",
+        f"OUT.SRC {source}",
+    ]
+    _echo_out_status(_out_execute(port, baudrate, timeout, commands))
+
+
+log_app = typer.Typer(help="Queries over archived sample logs.")
+
+
+@log_app.command("index")
+def log_index(
+    inputs: List[Path] = typer.Argument(..., help="Sample log CSV files", exists=True, readable=True),
+):
+    """Build or refresh the `<log>.idx.json` chunk indexes."""
+    for path in inputs:
+        index = load_index(path)
+        typer.echo(f"{path}: {len(index.chunks)} chunks, {sum(chunk.rows for chunk in index.chunks)} rows")
+
+
+@log_app.command("query")
+def log_query(
+    inputs: List[Path] = typer.Argument(..., help="Sample log CSV files", exists=True, readable=True),
+    fields: Optional[List[str]] = typer.Option(None, "--field", "-f", help="Column to aggregate (repeatable)"),
+    ts_from: Optional[float] = typer.Option(None, "--from-ms", help="Inclusive lower ts_ms bound"),
+    ts_to: Optional[float] = typer.Option(None, "--to-ms", help="Exclusive upper ts_ms bound"),
+    require_flags: int = typer.Option(0, "--require-flags", help="Only rows with all of these flag bits"),
+    reject_flags: int = typer.Option(0, "--reject-flags", help="Skip rows with any of these flag bits"),
+    bucket_ms: Optional[float] = typer.Option(None, "--bucket-ms", help="Group by ts_ms buckets of this width"),
+    fmt: str = typer.Option("csv", "--format", help="csv|json"),
+    workers: Optional[int] = typer.Option(None, "--workers", help="Scan threads (default: CPU count)"),
+):
+    """Grouped count/mean/min/max with chunk skipping via min/max indexes."""
+    if fmt not in {"csv", "json"}:
+        raise typer.BadParameter("--format must be csv or json")
+    spec = QuerySpec(
+        fields=tuple(fields or ["pressure"]),
+        ts_from=ts_from,
+        ts_to=ts_to,
+        require_flags=require_flags,
+        reject_flags=reject_flags,
+        bucket_ms=bucket_ms,
+    )
+    try:
+        result, stats = run_query(inputs, spec, workers=workers)
+    except ValueError as exc:
+        raise typer.BadParameter(str(exc)) from exc
+    if fmt == "csv":
+        result.to_csv(sys.stdout, index=False)
+    else:
+        result.to_json(sys.stdout, orient="records", lines=True)
+        sys.stdout.write("\n")
+    typer.echo(
+        f"files={stats.files} chunks={stats.chunks_scanned}/{stats.chunks_total} "
+        f"rows={stats.rows_matched}/{stats.rows_scanned} bytes={stats.bytes_scanned}",
+        err=True,
+    )
+
+
+HIST_QUANTILES = (0.5, 0.9, 0.99, 0.999)
+
+
+def _echo_histogram(hist: LogLinearHistogram, label: str) -> None:
+    typer.echo(
+        f"{label}: n={hist.count} min={hist.min:.6g} max={hist.max:.6g} "
+        f"(bucket error <= {hist.relative_error * 100:.2f}%)"
+    )
+    for q, value in hist.quantiles(HIST_QUANTILES).items():
+        typer.echo(f"  p{q * 100:g}: {value:.6g}")
+
+
+@log_app.command("hist")
+def log_hist(
+    inputs: List[Path] = typer.Argument(..., help="Sample log CSV files", exists=True, readable=True),
+    field_name: str = typer.Option("pressure", "--field", "-f", help="Column to histogram"),
+    unit: float = typer.Option(1e-3, "--unit", help="Value resolution (bucket width at small magnitudes)"),
+    precision: int = typer.Option(6, "--precision", help="Bits per power-of-two range (error 2^-P)"),
+    diff: bool = typer.Option(False, "--diff", help="Histogram frame-to-frame deltas (noise)"),
+    merge: Optional[List[Path]] = typer.Option(None, "--merge", help="Saved histogram JSON to merge in"),
+    save: Optional[Path] = typer.Option(None, "--save", help="Write the merged histogram as JSON"),
+):
+    """Quantiles with bounded relative error in constant memory."""
+    hist = LogLinearHistogram(precision, unit)
+    try:
+        rows = histogram_csv_column(inputs, field_name, hist, diff=diff)
+        for path in merge or []:
+            hist.merge(LogLinearHistogram.load(path))
+    except ValueError as exc:
+        raise typer.BadParameter(str(exc)) from exc
+    label = f"{field_name} deltas" if diff else field_name
+    _echo_histogram(hist, f"{label} ({rows} rows)")
+    if save is not None:
+        hist.save(save)
+        typer.echo(f"Saved histogram to {save}")
+
+
+@log_app.command("devhist")
+def log_devhist(
+    port: str = typer.Option("/dev/ttyACM0", "--port", "-p", help="Serial device"),
+    baudrate: int = typer.Option(921600, "--baud", help="Serial baudrate"),
+    timeout: float = typer.Option(2.0, "--timeout", help="Serial timeout (seconds)"),
+    reset: bool = typer.Option(False, "--reset", help="Clear the on-device histograms after reading"),
+    save: Optional[Path] = typer.Option(None, "--save", help="Write the frequency histogram as JSON"),
+):
+    """Read the on-device frame-to-frame noise histograms (`HIST.READB`)."""
+    settings = SerialSettings(port=port, baudrate=baudrate, timeout=timeout)
+    client = SerialCommandClient(settings)
+    try:
+        freq, _ = read_firmware_hist(client.execute_binary, "F", timeout, unit=1e-4)
+        diode, _ = read_firmware_hist(client.execute_binary, "V", timeout, unit=1.0)
+        if reset:
+            client.execute("HIST.RESET", timeout=timeout)
+    except ValueError as exc:
+        raise typer.BadParameter(str(exc)) from exc
+    finally:
+        client.close()
+    _echo_histogram(freq, "frequency delta (Hz)")
+    _echo_histogram(diode, "diode delta (uV)")
+    if save is not None:
+        freq.save(save)
+        typer.echo(f"Saved histogram to {save}")
+
+
 app = typer.Typer(add_completion=False, help="TERPS RPS host utilities.")
 app.add_typer(coeff_app, name="coeff")
+app.add_typer(capture_app, name="capture")
+app.add_typer(log_app, name="log")
+app.add_typer(out_app, name="out")
+
+
+@app.command("subscribe")
+def subscribe_cmd(
+    socket_path: Path = typer.Option(Path("/run/terps/samples.sock"), "--socket", help="Stream server socket"),
+    fields: Optional[List[str]] = typer.Option(None, "--field", "-f", help="Field to include (repeatable)"),
+    require_flags: int = typer.Option(0, "--require-flags", help="Only samples with all of these flag bits"),
+    reject_flags: int = typer.Option(0, "--reject-flags", help="Skip samples with any of these flag bits"),
+    decimate: int = typer.Option(1, "--decimate", help="Forward every Nth sample / aggregate blocks of N"),
+    aggregate: Optional[str] = typer.Option(None, "--aggregate", help="mean|min|max over each block"),
+):
+    """Print rows from a running host's sample stream (host.stream_socket)."""
+    if aggregate is not None and aggregate not in AGGREGATES:
+        raise typer.BadParameter(f"--aggregate must be one of {list(AGGREGATES)}")
+    try:
+        spec = SubscriptionSpec.from_mapping(
+            {
+                "fields": fields,
+                "require_flags": require_flags,
+                "reject_flags": reject_flags,
+                "decimate": decimate,
+                "aggregate": aggregate,
+            }
+        )
+    except ValueError as exc:
+        raise typer.BadParameter(str(exc)) from exc
+    typer.echo(",".join(spec.fields))
+    try:
+        for row in subscribe(socket_path, spec):
+            typer.echo(row)
+    except KeyboardInterrupt:
+        pass
+
+
+def _join_sockets(
+    sockets: Sequence[Path], joiner: StreamJoiner, field_name: str, writer: JoinedCsvWriter
+) -> None:
+    rows: "queue.Queue[Tuple[int, str, float]]" = queue.Queue(maxsize=65536)
+    spec = SubscriptionSpec(fields=("ts_ms", "tau_ms", field_name, "flags"))
+
+    def pump(idx: int, path: Path) -> None:
+        try:
+            for row in subscribe(path, spec):
+                rows.put((idx, row, time.time() * 1000.0))
+        except (OSError, ValueError) as exc:
+            logger.warning("Join input %s closed: %s", path, exc)
+        rows.put((idx, "", 0.0))
+
+    for idx, path in enumerate(sockets):
+        threading.Thread(target=pump, args=(idx, path), name=f"terps-join-{idx}", daemon=True).start()
+    open_inputs = len(sockets)
+    while open_inputs:
+        try:
+            idx, row, arrival = rows.get(timeout=1.0)
+        except queue.Empty:
+            continue
+        if not row:
+            open_inputs -= 1
+            continue
+        ts, tau, value, flags = row.split(",")
+        records = joiner.push(idx, [float(ts)], [float(value)], [int(flags)], [float(tau)], arrival)
+        if records:
+            writer.write(records)
+            sys.stdout.flush()
+
+
+@app.command("join")
+def join_cmd(
+    logs: Optional[List[Path]] = typer.Argument(None, help="Archived logs to join offline on ts_ms"),
+    sockets: Optional[List[Path]] = typer.Option(None, "--socket", help="Live host stream socket (repeatable)"),
+    names: Optional[List[str]] = typer.Option(None, "--name", help="Column suffix per input (repeatable)"),
+    field_name: str = typer.Option("pressure", "--field", "-f", help="Sample field to join"),
+    period_ms: float = typer.Option(100.0, "--period-ms", help="Output grid spacing"),
+    mode: str = typer.Option("interpolate", "--mode", help="interpolate|window"),
+    max_gap_ms: Optional[float] = typer.Option(None, "--max-gap-ms", help="Largest gap to interpolate across"),
+    max_lateness_ms: float = typer.Option(1000.0, "--max-lateness-ms", help="Emit without a stalled input after this"),
+    out: Optional[Path] = typer.Option(None, "--out", help="Joined CSV (default: stdout)"),
+):
+    """Align several sensors onto one time grid for differential analysis."""
+    if bool(logs) == bool(sockets):
+        raise typer.BadParameter("Give either log files or --socket inputs")
+    inputs = list(logs or sockets or [])
+    if names and len(names) != len(inputs):
+        raise typer.BadParameter("--name must be given once per input")
+    if mode not in JOIN_MODES:
+        raise typer.BadParameter(f"--mode must be one of {list(JOIN_MODES)}")
+    live = bool(sockets)
+    joiner = StreamJoiner(
+        names or [path.stem for path in inputs],
+        period_ms,
+        mode=mode,
+        max_gap_ms=max_gap_ms,
+        # Offline inputs are read slowest-first, so nothing is ever late there.
+        max_lateness_ms=max_lateness_ms if live else float("inf"),
+        map_clock=live,
+    )
+    handle = out.open("w", encoding="utf-8", newline="") if out else sys.stdout
+    writer = JoinedCsvWriter(handle, joiner.devices, field_name)
+    try:
+        if live:
+            _join_sockets(inputs, joiner, field_name, writer)
+        else:
+            for records in join_logs(inputs, joiner, field_name):
+                writer.write(records)
+    except KeyboardInterrupt:
+        pass
+    except ValueError as exc:
+        raise typer.BadParameter(str(exc)) from exc
+    finally:
+        if live:
+            writer.write(joiner.flush())
+        if out:
+            handle.close()
+    typer.echo(f"join {joiner.stats()}", err=True)
+
+
+@app.command("plan")
+def plan_cmd(
+    config_path: Path = typer.Option(
+        Path("host_pi/config.json"), "--config", "-c", help="Config providing sensor_poly and ADC settings."
+    ),
+    carrier_hz: Optional[float] = typer.Option(None, "--freq", help="Carrier frequency (default: sensor_poly.X)"),
+    ts_resolution_us: float = typer.Option(1.0, "--ts-res-us", help="Edge timestamp resolution (µs)"),
+    jitter_ns: float = typer.Option(20.0, "--jitter-ns", help="Measured RMS edge jitter (ns)"),
+    pps: bool = typer.Option(False, "--pps/--no-pps", help="PPS discipline locked"),
+    crystal_ppm: float = typer.Option(20.0, "--crystal-ppm", help="Timebase tolerance without PPS"),
+    adc_rate: Optional[float] = typer.Option(None, "--adc-rate", help="ADC data rate in SPS (default: config)"),
+    adc_noise_uV: float = typer.Option(1.0, "--adc-noise-uV", help="RMS diode noise per conversion (µV)"),
+    dp_df: Optional[float] = typer.Option(None, "--dp-df", help="Pressure per Hz (default: from sensor_poly)"),
+    dp_dv: Optional[float] = typer.Option(None, "--dp-dv", help="Pressure per µV (default: from sensor_poly)"),
+    tau: Optional[List[float]] = typer.Option(None, "--tau", help="Candidate window lengths in ms (repeatable)"),
+    target: Optional[List[float]] = typer.Option(None, "--target", help="Pressure noise targets (repeatable)"),
+    max_latency_ms: float = typer.Option(1000.0, "--max-latency-ms", help="Latency ceiling for recommendations"),
+    validate: bool = typer.Option(False, "--validate", help="Check each prediction against the edge simulator"),
+    out: Optional[Path] = typer.Option(None, "--out", help="Write recommended presets (JSON, use with run --preset-file)"),
+):
+    """Predict resolution, noise and latency per mode/tau and recommend presets."""
+    cfg = load_config(config_path)
+    poly_df, poly_dv = sensitivities(cfg.sensor_poly)
+    dp_df = poly_df if dp_df is None else dp_df
+    dp_dv = poly_dv if dp_dv is None else dp_dv
+    if dp_df == 0.0 and dp_dv == 0.0:
+        typer.echo("sensor_poly has no slope at (X, Y); pressure noise is reported in Hz (dP/df=1)")
+        dp_df = 1.0
+    spec = AcquisitionSpec(
+        carrier_hz=carrier_hz if carrier_hz is not None else cfg.sensor_poly.X,
+        ts_resolution_s=ts_resolution_us * 1e-6,
+        jitter_s=jitter_ns * 1e-9,
+        pps_locked=pps,
+        crystal_ppm=crystal_ppm,
+        adc_rate_sps=adc_rate if adc_rate is not None else float(cfg.adc.rate_sps),
+        adc_noise_uV=adc_noise_uV,
+        adc_gain=cfg.adc.gain,
+        mains_reject=cfg.adc.mains_reject,
+        dp_df=dp_df,
+        dp_dv=dp_dv,
+    )
+    predictions = predict_all(spec, tau or DEFAULT_TAUS_MS, MODES)
+    typer.echo(f"dP/df={dp_df:.6g}/Hz dP/dV={dp_dv:.6g}/uV timebase bias={predictions[0].timebase_bias:.4g}")
+    typer.echo("mode   tau_ms  f_noise_Hz  f_res_Hz    V_noise_uV  conv  P_noise     latency_ms" + ("  sim_f_Hz" if validate else ""))
+    for prediction in predictions:
+        line = (
+            f"{prediction.mode:<6} {prediction.tau_ms:>6g}  {prediction.freq_noise_hz:<10.4g}  "
+            f"{prediction.freq_resolution_hz:<10.4g}  {prediction.diode_noise_uV:<10.4g}  {prediction.conversions:>4}  "
+            f"{prediction.pressure_noise:<10.4g}  {prediction.latency_ms:<10.4g}"
+        )
+        if validate:
+            line += f"  {validate_candidate(spec, prediction):.4g}"
+        typer.echo(line.rstrip())
+    chosen = choose_presets(predictions, target or (), max_latency_ms)
+    for value in target or ():
+        if f"plan_{value:g}" not in chosen:
+            typer.echo(f"Target {value:g} is not reachable within {max_latency_ms:g} ms")
+    if not chosen:
+        typer.echo("No candidate meets the targets within the latency ceiling")
+        raise typer.Exit(code=1)
+    presets = {name: to_preset(spec, prediction) for name, prediction in chosen.items()}
+    for name, prediction in chosen.items():
+        typer.echo(
+            f"{name}: mode={prediction.mode} tau_ms={prediction.tau_ms:g} "
+            f"P_noise={prediction.pressure_noise:.4g} latency_ms={prediction.latency_ms:.4g}"
+        )
+    if out is not None:
+        out.write_text(json.dumps(presets, indent=2), encoding="utf-8")
+        typer.echo(f"Wrote {len(presets)} presets to {out}")
 
 
 @app.command()
@@ -573,6 +1277,9 @@ def run(
         "-P",
         help="Apply preset (0p02|0p01|0p003) before other overrides.",
     ),
+    preset_file: Optional[Path] = typer.Option(
+        None, "--preset-file", help="Extra presets JSON (e.g. from `plan --out`) for --preset."
+    ),
     plot: bool = typer.Option(False, "--plot", help="Show realtime 2x2 Matplotlib dashboard."),
     plot_snapshot_every: float = typer.Option(0.0, "--plot-snapshot-every", help="Save PNG every N seconds (0=off)."),
     temp_mode: str = typer.Option("off", "--temp-mode", help="Temperature proxy mode: off|linear|poly."),
@@ -602,11 +1309,14 @@ def run(
     """Run the host pipeline: read frames, compute pressure, persist CSV."""
 
     preset_overrides_list: list[str] = []
+    presets = dict(PRESETS)
+    if preset_file is not None:
+        presets.update(json.loads(preset_file.read_text(encoding="utf-8")))
     if preset:
         key = preset.lower()
-        if key not in PRESETS:
-            raise typer.BadParameter(f"Unknown preset '{preset}'. Expected one of {list(PRESETS)}")
-        preset_overrides_list = preset_overrides(key)
+        if key not in presets:
+            raise typer.BadParameter(f"Unknown preset '{preset}'. Expected one of {list(presets)}")
+        preset_overrides_list = preset_overrides(key, presets)
     combined_overrides = preset_overrides_list + (override or [])
     cfg = load_config(config_path, combined_overrides or None)
     plotter = None
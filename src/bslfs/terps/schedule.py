@@ -0,0 +1,224 @@
+"""
+Time-triggered acquisition: put every device's gate windows on one host grid.
+
+The firmware opens window k at ``start_us + k * period_us`` on its own 64-bit
+microsecond timer (`SCHED.START`) and tags each frame with the slot index k.
+`SlotScheduler` chooses ``start_us`` so that slot k begins at host wall-clock
+time ``k * period_ms``: it estimates the device-minus-host offset from the
+`TIME.NOW` probe with the shortest round trip (the midpoint of a fast probe is
+the tightest bound on when the device read its timer), and converts the host
+grid point into device time. Because the slot is a pure function of host time,
+several units scheduled from hosts sharing an NTP/PPS clock agree on it and
+their frames can be joined by slot rather than by interpolated timestamps.
+
+Crystal skew slowly walks the device grid away from the host grid.
+`maybe_resync` re-probes periodically, fits the skew from the offset history,
+and re-issues `SCHED.START` with a skew-corrected period once the predicted
+grid error exceeds ``tolerance_us``. The firmware keeps the open window across
+a re-schedule and closes it on the new grid, so no data is lost; the slot
+numbers inside the re-anchoring lead time are skipped.
+"""
+
+from __future__ import annotations
+
+import math
+import time
+from dataclasses import dataclass
+from typing import Callable, Dict, List, Optional, Sequence
+
+from .coeff import _parse_header_tokens
+
+CommandExecutor = Callable[[str, float], Sequence[str]]
+
+_SLOT_MOD = 1 << 32
+_SLOT_HALF = 1 << 31
+
+
+@dataclass
+class ClockProbe:
+    """One `TIME.NOW` exchange; ``offset_us`` is device minus host at the midpoint."""
+
+    host_us: float
+    device_us: int
+    rtt_us: float
+
+    @property
+    def offset_us(self) -> float:
+        return self.device_us - self.host_us
+
+
+def _command(executor: CommandExecutor, command: str, timeout: float) -> Dict[str, str]:
+    lines = executor(command, timeout)
+    if not lines or not lines[0].startswith("OK"):
+        raise RuntimeError(f"{command.split()[0]} failed: {lines[0].strip() if lines else 'no reply'}")
+    return _parse_header_tokens(lines[0])
+
+
+def probe_device_clock(
+    executor: CommandExecutor,
+    timeout: float = 1.0,
+    probes: int = 8,
+    clock: Callable[[], float] = time.time,
+) -> ClockProbe:
+    """Return the minimum-RTT probe out of ``probes`` `TIME.NOW` round trips."""
+
+    best: Optional[ClockProbe] = None
+    for _ in range(max(probes, 1)):
+        sent = clock()
+        reply = _command(executor, "TIME.NOW", timeout)
+        received = clock()
+        probe = ClockProbe(
+            host_us=(sent + received) * 0.5e6,
+            device_us=int(reply["T_US"]),
+            rtt_us=(received - sent) * 1e6,
+        )
+        if best is None or probe.rtt_us < best.rtt_us:
+            best = probe
+    assert best is not None
+    return best
+
+
+class SlotScheduler:
+    """Keep one device's `SCHED` grid aligned to ``k * period_ms`` of host time."""
+
+    def __init__(
+        self,
+        executor: CommandExecutor,
+        period_ms: float,
+        lead_ms: float = 250.0,
+        timeout: float = 1.0,
+        probes: int = 8,
+        resync_sec: float = 60.0,
+        tolerance_us: float = 200.0,
+        history: int = 16,
+        reset_jump_us: float = 10000.0,
+        clock: Callable[[], float] = time.time,
+    ):
+        if period_ms * 1000.0 < 1000.0:
+            raise ValueError("period_ms must be at least 1 ms")
+        self._executor = executor
+        self.period_us = period_ms * 1000.0
+        self._lead_us = max(lead_ms, 0.0) * 1000.0
+        self._timeout = timeout
+        self._probes = probes
+        self._resync_sec = resync_sec
+        self._tolerance_us = tolerance_us
+        self._history_len = max(history, 2)
+        self._reset_jump_us = reset_jump_us
+        self._clock = clock
+        self._history: List[ClockProbe] = []
+        self._rate = 1.0  # device µs per host µs
+        self._anchor_host_us = 0.0
+        self._anchor_offset_us = 0.0
+        self._next_resync = math.inf
+        self._stats: Dict[str, float] = {
+            "starts": 0,
+            "resyncs": 0,
+            "probes": 0,
+            "last_error_us": 0.0,
+            "max_error_us": 0.0,
+            "rtt_us": 0.0,
+        }
+
+    @property
+    def skew_ppm(self) -> float:
+        return (self._rate - 1.0) * 1e6
+
+    def stats(self) -> Dict[str, float]:
+        return dict(self._stats, skew_ppm=self.skew_ppm)
+
+    def device_time(self, host_us: float) -> float:
+        """Predict the device timer reading at host time ``host_us``."""
+
+        return host_us + self._anchor_offset_us + (host_us - self._anchor_host_us) * (self._rate - 1.0)
+
+    def start(self) -> int:
+        """Probe the clock and start the device on the next host grid slot; returns that slot."""
+
+        self._probe()
+        slot = self._first_slot(self._clock() * 1e6)
+        self._schedule(slot)
+        self._stats["starts"] += 1
+        # Check back early: the skew is unknown until a second probe is in.
+        self._next_resync = self._clock() + min(self._resync_sec, 10.0)
+        return slot
+
+    def stop(self) -> None:
+        _command(self._executor, "SCHED.STOP", self._timeout)
+        self._next_resync = math.inf
+
+    def maybe_resync(self, now: Optional[float] = None) -> bool:
+        """Re-probe when due; returns True if the device grid was re-issued."""
+
+        now = self._clock() if now is None else now
+        if now < self._next_resync:
+            return False
+        self._next_resync = now + self._resync_sec
+        self._probe()
+        status = _command(self._executor, "SCHED.STATUS", self._timeout)
+        if status.get("ACTIVE") != "1":
+            self._schedule(self._first_slot(self._clock() * 1e6))
+            self._stats["starts"] += 1
+            return True
+        slot = self._unwrap_slot(int(status["SLOT"]))
+        error = int(status["NEXT_US"]) - self.device_time(slot * self.period_us)
+        self._stats["last_error_us"] = error
+        self._stats["max_error_us"] = max(self._stats["max_error_us"], abs(error))
+        period_q16 = (int(status["PERIOD_US"]) << 16) + int(status.get("PERIOD_FRAC", "0"))
+        # Grid error expected by the next check if the device keeps its current period.
+        drift_us = abs(period_q16 - self._device_period_q16()) / 65536.0 * self._resync_sec * 1e6 / self.period_us
+        if abs(error) + drift_us <= self._tolerance_us:
+            return False
+        # Re-anchor on the first slot that is still safely in the future.
+        self._schedule(max(slot, self._first_slot(self._clock() * 1e6)))
+        self._stats["resyncs"] += 1
+        return True
+
+    def _unwrap_slot(self, wrapped: int) -> int:
+        """Frames and `SCHED.STATUS` carry the slot modulo 2**32; recover it near the host slot."""
+
+        expected = int(self._clock() * 1e6 // self.period_us)
+        return expected + ((wrapped - expected + _SLOT_HALF) % _SLOT_MOD) - _SLOT_HALF
+
+    def _first_slot(self, host_now_us: float) -> int:
+        return int(math.ceil((host_now_us + self._lead_us) / self.period_us))
+
+    def _device_period_q16(self) -> int:
+        """Skew-corrected period in 1/65536 µs, the firmware's `PERIOD_US`/`PERIOD_FRAC` pair."""
+
+        return int(round(self.period_us * self._rate * 65536.0))
+
+    def _schedule(self, slot: int) -> None:
+        start_us = int(round(self.device_time(slot * self.period_us)))
+        period_q16 = self._device_period_q16()
+        _command(
+            self._executor,
+            f"SCHED.START {start_us} {period_q16 >> 16} {slot % _SLOT_MOD} {period_q16 & 0xFFFF}",
+            self._timeout,
+        )
+
+    def _probe(self) -> None:
+        probe = probe_device_clock(self._executor, self._timeout, self._probes, self._clock)
+        if self._history and abs(self.device_time(probe.host_us) - probe.device_us) > self._reset_jump_us:
+            # The device rebooted or the host clock stepped: the old fit no longer applies.
+            self._history.clear()
+            self._rate = 1.0
+        self._history.append(probe)
+        del self._history[: -self._history_len]
+        self._stats["probes"] += 1
+        self._stats["rtt_us"] = probe.rtt_us
+        self._fit()
+
+    def _fit(self) -> None:
+        """Least-squares line through the offset history; the anchor is its centroid."""
+
+        host = [p.host_us for p in self._history]
+        offsets = [p.offset_us for p in self._history]
+        mean_h = sum(host) / len(host)
+        mean_o = sum(offsets) / len(offsets)
+        den = sum((h - mean_h) ** 2 for h in host)
+        if len(self._history) >= 2 and den > 0:
+            num = sum((h - mean_h) * (o - mean_o) for h, o in zip(host, offsets))
+            self._rate = 1.0 + num / den
+        self._anchor_host_us = mean_h
+        self._anchor_offset_us = mean_o
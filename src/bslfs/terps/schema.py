@@ -0,0 +1,345 @@
+"""
+Self-describing binary records (firmware `frame_schema.h`).
+
+The device announces each record layout in a ``0x55 0xA6`` packet:
+
+    version(u8=1) | packet_type(u8) | payload_len(u8) | nfields(u8) |
+    nfields × { id(u8) type(u8) offset(u8) scale_exp(i8) attr(u8) name_len(u8) name }
+
+`SchemaRegistry` keeps the latest schema per packet type and compiles one
+decoder per (type, payload length): a single precompiled `struct` unpack
+(unknown field IDs become ``x`` padding) followed by generated straight-line
+conversion code, so decoding costs the same as the hand-written parser it
+replaces. ``0xAA`` frames decode to `Frame` by field ID; other record types
+decode to ``{name: value}`` dicts.
+
+Before any schema arrives the registry uses `BUILTIN_FRAME_SCHEMA`, which
+mirrors the firmware table and also accepts the 19-, 23- and 24-byte payloads
+of firmware that predates the slot / ``adc_fresh`` / ``seq`` fields.
+"""
+
+from __future__ import annotations
+
+import math
+import struct
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple
+
+SCHEMA_VERSION = 1
+PACKET_SCHEMA = 0xA6
+PACKET_TX_STATE = 0xA7
+
+ATTR_ALL_ONES_NONE = 0x01
+
+# wire type code -> (struct code, size)
+FIELD_TYPES: Dict[int, Tuple[str, int]] = {
+    1: ("B", 1),
+    2: ("b", 1),
+    3: ("H", 2),
+    4: ("h", 2),
+    5: ("I", 4),
+    6: ("i", 4),
+    7: ("f", 4),
+}
+TYPE_NAMES = {1: "u8", 2: "i8", 3: "u16", 4: "i16", 5: "u32", 6: "i32", 7: "f32"}
+
+FIELD_TS_MS = 1
+FIELD_F_HZ = 2
+FIELD_TAU_MS = 3
+FIELD_DIODE_UV = 4
+FIELD_ADC_GAIN = 5
+FIELD_FLAGS = 6
+FIELD_PPM_CORR = 7
+FIELD_MODE = 8
+FIELD_SLOT = 9
+FIELD_ADC_FRESH = 10
+FIELD_SEQ = 11
+
+MODE_NAMES = {0: "GATED", 1: "RECIP", 2: "DUAL", 3: "REF"}
+
+# Frame member, conversion kind and value used when the field is absent.
+_FRAME_TARGETS: Dict[int, Tuple[str, str, Any]] = {
+    FIELD_TS_MS: ("ts_ms", "float", math.nan),
+    FIELD_F_HZ: ("f_hz", "float", math.nan),
+    FIELD_TAU_MS: ("tau_ms", "float", math.nan),
+    FIELD_DIODE_UV: ("v_uV", "float", math.nan),
+    FIELD_ADC_GAIN: ("adc_gain", "int", 0),
+    FIELD_FLAGS: ("flags", "int", 0),
+    FIELD_PPM_CORR: ("ppm_corr", "float", 0.0),
+    FIELD_MODE: ("mode", "mode", "UNKNOWN"),
+    FIELD_SLOT: ("slot", "int", -1),
+    FIELD_ADC_FRESH: ("adc_fresh", "int", -1),
+    FIELD_SEQ: ("seq", "int", -1),
+}
+
+
+@dataclass(frozen=True)
+class FieldDesc:
+    field_id: int
+    type_code: int
+    offset: int
+    scale_exp: int = 0
+    attr: int = 0
+    name: str = ""
+
+    @property
+    def size(self) -> int:
+        return FIELD_TYPES[self.type_code][1]
+
+
+@dataclass(frozen=True)
+class FrameSchema:
+    packet_type: int
+    payload_len: int
+    fields: Tuple[FieldDesc, ...]
+    # Shorter payloads that decode the fields they fully contain (legacy firmware).
+    accept_lens: Tuple[int, ...] = ()
+    version: int = SCHEMA_VERSION
+
+    def allowed_lens(self) -> Tuple[int, ...]:
+        return tuple(sorted(set(self.accept_lens) | {self.payload_len}))
+
+
+class SchemaError(ValueError):
+    pass
+
+
+def parse_schema_packet(payload: bytes) -> FrameSchema:
+    if len(payload) < 4:
+        raise SchemaError("schema packet too short")
+    version, packet_type, payload_len, nfields = payload[0], payload[1], payload[2], payload[3]
+    if version != SCHEMA_VERSION:
+        raise SchemaError(f"unsupported schema version {version}")
+    fields: List[FieldDesc] = []
+    pos = 4
+    for _ in range(nfields):
+        if pos + 6 > len(payload):
+            raise SchemaError("truncated field descriptor")
+        field_id, type_code, offset, scale_exp, attr, name_len = struct.unpack_from("<BBBbBB", payload, pos)
+        pos += 6
+        name = payload[pos : pos + name_len].decode("ascii", errors="replace")
+        if len(name) != name_len:
+            raise SchemaError("truncated field name")
+        pos += name_len
+        if type_code not in FIELD_TYPES:
+            raise SchemaError(f"unknown field type {type_code} for field {field_id}")
+        fields.append(FieldDesc(field_id, type_code, offset, scale_exp, attr, name))
+    schema = FrameSchema(packet_type, payload_len, tuple(fields))
+    _check_layout(schema)
+    return schema
+
+
+def encode_schema_packet(schema: FrameSchema) -> bytes:
+    out = bytearray([schema.version, schema.packet_type, schema.payload_len, len(schema.fields)])
+    for desc in schema.fields:
+        name = desc.name.encode("ascii")
+        out += struct.pack("<BBBbBB", desc.field_id, desc.type_code, desc.offset, desc.scale_exp, desc.attr, len(name))
+        out += name
+    return bytes(out)
+
+
+def encode_record(schema: FrameSchema, raw: Dict[int, Any]) -> bytes:
+    """Pack raw wire values by field ID like `frame_schema_encode()`; missing fields are zero."""
+
+    out = bytearray(schema.payload_len)
+    for desc in schema.fields:
+        struct.pack_into("<" + FIELD_TYPES[desc.type_code][0], out, desc.offset, raw.get(desc.field_id, 0))
+    return bytes(out)
+
+
+def _check_layout(schema: FrameSchema) -> None:
+    end = 0
+    for desc in sorted(schema.fields, key=lambda d: d.offset):
+        if desc.offset < end:
+            raise SchemaError(f"field {desc.field_id} overlaps the previous field")
+        end = desc.offset + desc.size
+    if end > schema.payload_len:
+        raise SchemaError("fields extend past payload_len")
+
+
+def _frame_fields(*rows: Tuple[int, int, int, int, str]) -> Tuple[FieldDesc, ...]:
+    fields = []
+    offset = 0
+    for field_id, type_code, scale_exp, attr, name in rows:
+        fields.append(FieldDesc(field_id, type_code, offset, scale_exp, attr, name))
+        offset += FIELD_TYPES[type_code][1]
+    return tuple(fields)
+
+
+BUILTIN_FRAME_SCHEMA = FrameSchema(
+    packet_type=0xAA,
+    payload_len=26,
+    fields=_frame_fields(
+        (FIELD_TS_MS, 5, 0, 0, "ts_ms"),
+        (FIELD_F_HZ, 6, -4, 0, "f_hz"),
+        (FIELD_TAU_MS, 3, 0, 0, "tau_ms"),
+        (FIELD_DIODE_UV, 6, 0, 0, "diode_uV"),
+        (FIELD_ADC_GAIN, 1, 0, 0, "adc_gain"),
+        (FIELD_FLAGS, 1, 0, 0, "flags"),
+        (FIELD_PPM_CORR, 4, -2, 0, "ppm_corr"),
+        (FIELD_MODE, 1, 0, 0, "mode"),
+        (FIELD_SLOT, 5, 0, ATTR_ALL_ONES_NONE, "slot"),
+        (FIELD_ADC_FRESH, 1, 0, 0, "adc_fresh"),
+        (FIELD_SEQ, 3, 0, 0, "seq"),
+    ),
+    accept_lens=(19, 23, 24),
+)
+
+
+# TX pacer step change (firmware usb_cdc.cpp tx_state_record_t).
+BUILTIN_TX_STATE_SCHEMA = FrameSchema(
+    packet_type=PACKET_TX_STATE,
+    payload_len=30,
+    fields=_frame_fields(
+        (1, 5, 0, 0, "ts_ms"),
+        (2, 1, 0, 0, "step"),
+        (3, 1, 0, 0, "level"),
+        (4, 3, 0, 0, "batch"),
+        (5, 3, 0, 0, "merge"),
+        (6, 5, 0, 0, "drain_Bps"),
+        (7, 5, 0, 0, "capacity_Bps"),
+        (8, 5, 0, 0, "demand_Bps"),
+        (9, 5, 0, 0, "stalls"),
+        (10, 5, 0, 0, "dropped"),
+    ),
+)
+
+
+def _mode_name(raw: int) -> str:
+    return MODE_NAMES.get(raw, f"UNKNOWN({raw})")
+
+
+def _scaled_expr(var: str, desc: FieldDesc, kind: str) -> str:
+    expr = var
+    if desc.scale_exp < 0:
+        # Division by an exact power of ten keeps values identical to the legacy decoder.
+        expr = f"{var} / 1e{-desc.scale_exp}"
+    elif desc.scale_exp > 0:
+        expr = f"{var} * 1e{desc.scale_exp}"
+    elif kind == "float":
+        expr = f"{var} / 1.0"
+    if kind == "int" and desc.scale_exp:
+        expr = f"int(round({expr}))"
+    if desc.attr & ATTR_ALL_ONES_NONE and desc.type_code != 7:
+        mask = (1 << (8 * desc.size)) - 1
+        if FIELD_TYPES[desc.type_code][0].islower():
+            mask = -1
+        none = {"int": "-1", "raw": "None"}.get(kind, "_nan")
+        expr = f"({none} if {var} == {mask} else {expr})"
+    return expr
+
+
+def compile_decoder(schema: FrameSchema, length: int, frame_cls: Optional[type] = None) -> Callable[[bytes], Any]:
+    """
+    Build a decoder for payloads of exactly ``length`` bytes. With ``frame_cls``
+    the result is a `Frame` keyed by field ID; otherwise a ``{name: value}`` dict.
+    Fields that do not fit in ``length`` are left at their defaults.
+    """
+
+    present = sorted((d for d in schema.fields if d.offset + d.size <= length), key=lambda d: d.offset)
+    fmt = ["<"]
+    names: List[str] = []
+    used: List[Tuple[str, FieldDesc, str, str]] = []  # (var, desc, target, kind)
+    pos = 0
+    for desc in present:
+        if desc.offset > pos:
+            fmt.append(f"{desc.offset - pos}x")
+        if frame_cls is not None:
+            target = _FRAME_TARGETS.get(desc.field_id)
+            if target is None:
+                # Unknown to this host: skip the bytes instead of unpacking them.
+                fmt.append(f"{desc.size}x")
+                pos = desc.offset + desc.size
+                continue
+            attr, kind, _default = target
+        else:
+            attr, kind = desc.name or f"field_{desc.field_id}", "float" if desc.scale_exp else "raw"
+        var = f"v{len(names)}"
+        names.append(var)
+        fmt.append(FIELD_TYPES[desc.type_code][0])
+        used.append((var, desc, attr, kind))
+        pos = desc.offset + desc.size
+    if length > pos:
+        fmt.append(f"{length - pos}x")
+    unpacker = struct.Struct("".join(fmt))
+    if unpacker.size != length:
+        raise SchemaError(f"layout is {unpacker.size} bytes, expected {length}")
+
+    lines = ["def decode(body):"]
+    if names:
+        lines.append(f"    ({', '.join(names)},) = _unpack(body)")
+    else:
+        lines.append("    _unpack(body)")
+    if frame_cls is not None:
+        args = {}
+        for var, desc, attr, kind in used:
+            args[attr] = f"_mode_name({var})" if kind == "mode" else _scaled_expr(var, desc, kind)
+        for attr, kind, default in _FRAME_TARGETS.values():
+            if attr not in args:
+                args[attr] = repr(default) if not (isinstance(default, float) and math.isnan(default)) else "_nan"
+        lines.append("    return _cls(" + ", ".join(f"{k}={v}" for k, v in args.items()) + ")")
+    else:
+        items = ", ".join(f"{attr!r}: {_scaled_expr(var, desc, kind)}" for var, desc, attr, kind in used)
+        lines.append("    return {" + items + "}")
+    namespace: Dict[str, Any] = {
+        "_unpack": unpacker.unpack,
+        "_cls": frame_cls,
+        "_mode_name": _mode_name,
+        "_nan": math.nan,
+    }
+    exec(compile("\n".join(lines), f"<schema 0x{schema.packet_type:02X}/{length}>", "exec"), namespace)
+    decoder = namespace["decode"]
+    decoder.__doc__ = "\n".join(lines)
+    return decoder
+
+
+@dataclass
+class SchemaRegistry:
+    """Latest schema per packet type plus compiled decoders keyed by (type, length)."""
+
+    frame_type: int = 0xAA
+    frame_cls: Optional[type] = None
+    schemas: Dict[int, FrameSchema] = field(default_factory=dict)
+    _decoders: Dict[Tuple[int, int], Callable[[bytes], Any]] = field(default_factory=dict, repr=False)
+
+    def __post_init__(self) -> None:
+        if self.frame_type not in self.schemas:
+            self.schemas[self.frame_type] = BUILTIN_FRAME_SCHEMA
+        self.schemas.setdefault(PACKET_TX_STATE, BUILTIN_TX_STATE_SCHEMA)
+
+    def register(self, schema: FrameSchema) -> bool:
+        """Install ``schema``; returns True when it changed the layout for its type."""
+
+        if self.schemas.get(schema.packet_type) == schema:
+            return False
+        self.schemas[schema.packet_type] = schema
+        for key in [key for key in self._decoders if key[0] == schema.packet_type]:
+            del self._decoders[key]
+        return True
+
+    def register_packet(self, payload: bytes) -> FrameSchema:
+        schema = parse_schema_packet(payload)
+        self.register(schema)
+        return schema
+
+    def packet_types(self) -> Sequence[int]:
+        return tuple(self.schemas)
+
+    def accepts(self, packet_type: int, length: int) -> bool:
+        schema = self.schemas.get(packet_type)
+        return schema is not None and length in schema.allowed_lens()
+
+    def decoder(self, packet_type: int, length: int) -> Optional[Callable[[bytes], Any]]:
+        key = (packet_type, length)
+        decoder = self._decoders.get(key)
+        if decoder is None:
+            if not self.accepts(packet_type, length):
+                return None
+            frame_cls = self.frame_cls if packet_type == self.frame_type else None
+            decoder = compile_decoder(self.schemas[packet_type], length, frame_cls)
+            self._decoders[key] = decoder
+        return decoder
+
+    def decode(self, packet_type: int, body: bytes) -> Any:
+        decoder = self.decoder(packet_type, len(body))
+        return None if decoder is None else decoder(body)
@@ -0,0 +1,400 @@
+"""
+Synthetic TERPS edge traces for exercising firmware algorithms on the host.
+
+The generator models the comparator output as an ideal carrier with white
+timing jitter, slow frequency drift and occasional ringing glitches, then
+quantises timestamps the way `time_us_64()` does on the Pico.
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+from typing import Callable, List, Optional, Tuple
+
+import numpy as np
+
+
+@dataclass
+class EdgeTraceSpec:
+    freq_hz: float = 30000.0
+    jitter_s: float = 20e-9
+    drift_ppm_per_s: float = 0.0
+    glitch_rate: float = 0.0
+    glitch_delay_frac: float = 0.05
+    duty: float = 0.5
+    fall_delay_s: float = 0.0
+    seed: Optional[int] = None
+
+
+def _nominal_edges(spec: EdgeTraceSpec, n_edges: int, start_s: float) -> np.ndarray:
+    nominal = start_s + np.arange(n_edges, dtype=float) / spec.freq_hz
+    if spec.drift_ppm_per_s:
+        # Integrate a linear frequency ramp: f(t) = f0 * (1 + k t)
+        k = spec.drift_ppm_per_s * 1e-6
+        nominal = start_s + (np.sqrt(1.0 + 2.0 * k * (nominal - start_s)) - 1.0) / k
+    return nominal
+
+
+def synthetic_edge_times(spec: EdgeTraceSpec, n_edges: int, start_s: float = 0.0) -> np.ndarray:
+    """Return rising-edge times in seconds, including injected glitch edges."""
+
+    if n_edges <= 0:
+        return np.empty(0, dtype=float)
+    rng = np.random.default_rng(spec.seed)
+    period = 1.0 / spec.freq_hz
+    nominal = _nominal_edges(spec, n_edges, start_s)
+    times = nominal + rng.normal(scale=spec.jitter_s, size=n_edges)
+    if spec.glitch_rate > 0.0:
+        mask = rng.random(n_edges) < spec.glitch_rate
+        glitches = times[mask] + spec.glitch_delay_frac * period
+        times = np.sort(np.concatenate([times, glitches]))
+    return times
+
+
+def synthetic_square_wave(
+    spec: EdgeTraceSpec, n_periods: int, start_s: float = 0.0
+) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Return (rise, fall) edge times in seconds. Each falling edge sits `duty`
+    of the local period after its rise plus `fall_delay_s`, which models a
+    comparator whose thresholds or propagation delays differ per direction.
+    """
+
+    if n_periods <= 0:
+        return np.empty(0, dtype=float), np.empty(0, dtype=float)
+    rng = np.random.default_rng(spec.seed)
+    nominal = _nominal_edges(spec, n_periods + 1, start_s)
+    periods = np.diff(nominal)
+    nominal = nominal[:-1]
+    rise = nominal + rng.normal(scale=spec.jitter_s, size=n_periods)
+    fall = nominal + spec.duty * periods + spec.fall_delay_s + rng.normal(scale=spec.jitter_s, size=n_periods)
+    return rise, fall
+
+
+def interleave_edges(rise_us: np.ndarray, fall_us: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """Merge per-polarity timestamps into one time-ordered (ts, rising) edge stream."""
+
+    ts = np.concatenate([rise_us, fall_us])
+    rising = np.concatenate([np.ones(len(rise_us), dtype=bool), np.zeros(len(fall_us), dtype=bool)])
+    order = np.argsort(ts, kind="stable")
+    return ts[order], rising[order]
+
+
+def quantize_us(times_s: np.ndarray, offset_us: int = 0) -> np.ndarray:
+    """Quantise edge times to the 1 µs resolution of the Pico system timer."""
+
+    return np.floor(times_s * 1e6).astype(np.int64) + int(offset_us)
+
+
+class EdgeCounterModel:
+    """
+    Per-edge mirror of the RECIP and DUAL window logic in `edge_counter.cpp`.
+
+    `on_edge()` returns `(freq_hz, duty)` when a window completes. RECIP only
+    uses rising edges; DUAL counts rise->rise and fall->fall spans separately
+    and pools them, so a fixed rise/fall asymmetry cancels and each window
+    gets twice the edges. Windows restart on the next edge, as on the device.
+    """
+
+    def __init__(self, dual: bool, target_periods: int, min_interval_frac: float = 0.25, freq_hint_hz: float = 30000.0):
+        self.dual = dual
+        self.target = max(int(target_periods), 1) * (2 if dual else 1)
+        self.min_interval_frac = min_interval_frac
+        self.freq_estimate_hz = freq_hint_hz
+        self.glitches = 0
+        self._min_interval_us = 1
+        self._update_min_interval()
+        self._reset()
+
+    def on_edge(self, ts_us: int, rising: bool) -> Optional[Tuple[float, float]]:
+        if not self.dual:
+            if not rising:
+                return None
+            if self._last_rise and ts_us - self._last_rise < self._min_interval_us:
+                self.glitches += 1
+                return None
+            self._last_rise = ts_us
+            if self._pulses == 0:
+                self._start = ts_us
+            self._end = ts_us
+            self._pulses += 1
+            if self._pulses >= self.target:
+                freq = self._pulses * 1e6 / max(self._end - self._start, 1)
+                return self._finish(freq, 0.0)
+            return None
+
+        last = self._last_rise if rising else self._last_fall
+        if last and ts_us - last < self._min_interval_us:
+            self.glitches += 1
+            return None
+        if rising:
+            if self._rises == 0:
+                self._first_rise = ts_us
+            self._rises += 1
+            self._last_rise = ts_us
+        else:
+            if self._falls == 0:
+                self._first_fall = ts_us
+            self._falls += 1
+            high = ts_us - self._last_rise
+            if self._last_rise and high * self.freq_estimate_hz < 1e6:
+                self._high_sum += high
+                self._high_count += 1
+            self._last_fall = ts_us
+        self._pulses += 1
+        if self._pulses < self.target:
+            return None
+        rise_periods = max(self._rises - 1, 0)
+        fall_periods = max(self._falls - 1, 0)
+        span = (self._last_rise - self._first_rise if rise_periods else 0) + (
+            self._last_fall - self._first_fall if fall_periods else 0
+        )
+        if span <= 0:
+            self._reset()
+            return None
+        freq = (rise_periods + fall_periods) * 1e6 / span
+        duty = min(self._high_sum / self._high_count * freq * 1e-6, 1.0) if self._high_count else 0.0
+        return self._finish(freq, duty)
+
+    def _finish(self, freq: float, duty: float) -> Tuple[float, float]:
+        self.freq_estimate_hz = freq
+        self._update_min_interval()
+        self._reset()
+        return freq, duty
+
+    def _update_min_interval(self) -> None:
+        self._min_interval_us = max(int(1e6 / self.freq_estimate_hz * self.min_interval_frac), 1)
+
+    def _reset(self) -> None:
+        self._pulses = 0
+        self._start = self._end = 0
+        self._rises = self._falls = 0
+        self._first_rise = self._last_rise = 0
+        self._first_fall = self._last_fall = 0
+        self._high_sum = 0
+        self._high_count = 0
+
+
+def run_counter(model: EdgeCounterModel, ts_us: np.ndarray, rising: np.ndarray) -> np.ndarray:
+    """Feed an edge stream through `model`; returns an (n, 2) array of (freq_hz, duty) per window."""
+
+    out = []
+    on_edge = model.on_edge
+    for ts, rise in zip(ts_us.tolist(), rising.tolist()):
+        result = on_edge(ts, rise)
+        if result is not None:
+            out.append(result)
+    return np.asarray(out, dtype=float).reshape(-1, 2)
+
+
+@dataclass
+class ClockSpec:
+    """A free-running clock: nominal rate, fixed error and a linear drift of that error."""
+
+    hz: float = 10e6
+    ppm: float = 0.0
+    drift_ppm_per_s: float = 0.0
+    phase: float = 0.0  # fraction of a cycle already elapsed at t = 0
+
+    def cycles(self, t_s: np.ndarray) -> np.ndarray:
+        t = np.asarray(t_s, dtype=float)
+        return self.phase + self.hz * (t + (self.ppm * t + 0.5 * self.drift_ppm_per_s * t * t) * 1e-6)
+
+    def count(self, t_s: np.ndarray) -> np.ndarray:
+        """Whole cycles (rising edges) counted since t = 0."""
+
+        return np.floor(self.cycles(t_s)).astype(np.int64)
+
+
+class RefCounterExtender:
+    """Mirror of `ref_clock_extend()`: signed 16-bit steps onto a 64-bit count."""
+
+    def __init__(self, raw0: int = 0):
+        self.count = 0
+        self.last_raw = raw0 & 0xFFFF
+
+    def extend(self, raw: int) -> int:
+        delta = ((raw - self.last_raw + 0x8000) & 0xFFFF) - 0x8000
+        if delta < 0:
+            # Latched before the previous sample; report it, keep the state.
+            return self.count + delta
+        self.count += delta
+        self.last_raw = raw & 0xFFFF
+        return self.count
+
+
+def ref_ratio_x1e4(periods: int, cycles: int, ref_hz: int) -> int:
+    """`ref_clock_ratio_x1e4()`: periods * ref_hz / cycles in 1e-4 Hz, rounded to nearest."""
+
+    if cycles <= 0:
+        return 0
+    whole, rem = divmod(periods * ref_hz, cycles)
+    return min(whole * 10000 + (rem * 10000 + cycles // 2) // cycles, 2**31 - 1)
+
+
+class RefRatioCounterModel:
+    """
+    Per-edge mirror of TERPS_MODE_REF in `edge_counter.cpp`: RECIP windows
+    (deglitched on the Pico timer) whose frequency is the whole periods between
+    the first and last edge over the reference cycles latched at those edges.
+    `on_edge()` returns `(freq_hz, f_hz_x1e4)` when a window completes.
+    """
+
+    def __init__(self, target_edges: int, ref_hz: int = 10_000_000, min_interval_frac: float = 0.25, freq_hint_hz: float = 30000.0):
+        self.target = max(int(target_edges), 2)
+        self.ref_hz = int(ref_hz)
+        self.min_interval_frac = min_interval_frac
+        self.freq_estimate_hz = freq_hint_hz
+        self.extender = RefCounterExtender()
+        self.glitches = 0
+        self._min_interval_us = max(int(1e6 / freq_hint_hz * min_interval_frac), 1)
+        self._last_us = 0
+        self._reset()
+
+    def keepalive(self, ref_raw: int) -> None:
+        self.extender.extend(ref_raw)
+
+    def on_edge(self, ts_us: int, ref_raw: int) -> Optional[Tuple[float, int]]:
+        if self._last_us and ts_us - self._last_us < self._min_interval_us:
+            self.glitches += 1
+            return None
+        self._last_us = ts_us
+        count = self.extender.extend(ref_raw)
+        if self._pulses == 0:
+            self._first = count
+        self._last = count
+        self._pulses += 1
+        if self._pulses < self.target:
+            return None
+        x1e4 = ref_ratio_x1e4(self._pulses - 1, self._last - self._first, self.ref_hz)
+        self._reset()
+        if x1e4 == 0:
+            return None
+        self.freq_estimate_hz = x1e4 * 1e-4
+        self._min_interval_us = max(int(1e6 / self.freq_estimate_hz * self.min_interval_frac), 1)
+        return self.freq_estimate_hz, x1e4
+
+    def _reset(self) -> None:
+        self._pulses = 0
+        self._first = self._last = 0
+
+
+@dataclass
+class RefCountingTrace:
+    true_hz: np.ndarray   # periods / true span of each REF window
+    ref_hz: np.ndarray    # TERPS_MODE_REF result
+    recip_hz: np.ndarray  # TERPS_MODE_RECIP on the same edges, Pico timebase
+    t_s: np.ndarray       # window end, true time
+
+
+def run_ref_counter(
+    edges: EdgeTraceSpec,
+    n_edges: int,
+    target_edges: int,
+    ref: ClockSpec,
+    xtal: ClockSpec,
+    latch_jitter_s: float = 100e-9,
+    keepalive_us: Optional[float] = None,
+    seed: Optional[int] = None,
+) -> RefCountingTrace:
+    """
+    Count one synthetic edge stream both ways. ``xtal`` is the Pico timer
+    (``hz`` = 1e6 for `time_us_64()`), ``ref`` the external reference, both with
+    their own error and drift. Each edge IRQ reads the timer and the PWM
+    counter after a random latency of up to ``latch_jitter_s``; a keepalive
+    alarm samples the counter every quarter wrap, as `ref_clock.cpp` does.
+    """
+
+    rng = np.random.default_rng(seed)
+    times = synthetic_edge_times(edges, n_edges)
+    latched = times + rng.uniform(0.0, latch_jitter_s, size=times.size)
+    ts_us = xtal.count(latched)
+    raw = ref.count(latched) & 0xFFFF
+    if keepalive_us is None:
+        keepalive_us = 16384e6 / ref.hz
+    keep_t = np.arange(keepalive_us * 1e-6, latched[-1], keepalive_us * 1e-6) if times.size else np.empty(0)
+    keep_raw = ref.count(keep_t) & 0xFFFF
+    # Edges first on a tie; process every event in true-time order.
+    order = np.argsort(np.concatenate([latched, keep_t]), kind="stable")
+
+    model = RefRatioCounterModel(target_edges, ref_hz=int(round(ref.hz)), freq_hint_hz=edges.freq_hz)
+    model.extender = RefCounterExtender(int(ref.count(np.zeros(1))[0]))
+    recip = EdgeCounterModel(False, target_edges, freq_hint_hz=edges.freq_hz)
+    true_hz: List[float] = []
+    ref_out: List[float] = []
+    recip_out: List[float] = []
+    t_out: List[float] = []
+    first_t = None
+    pulses = 0
+    n = times.size
+    for idx in order.tolist():
+        if idx >= n:
+            model.keepalive(int(keep_raw[idx - n]))
+            continue
+        ts = int(ts_us[idx])
+        r = recip.on_edge(ts, True)
+        if r is not None:
+            # Same window; undo the pulses-over-span convention of the RECIP path.
+            recip_out.append(r[0] * (target_edges - 1) / target_edges)
+        if pulses == 0:
+            first_t = times[idx]
+        pulses += 1
+        result = model.on_edge(ts, int(raw[idx]))
+        if result is not None:
+            true_hz.append((pulses - 1) / (times[idx] - first_t))
+            ref_out.append(result[0])
+            t_out.append(times[idx])
+            pulses = 0
+    k = min(len(ref_out), len(recip_out))
+    return RefCountingTrace(
+        true_hz=np.asarray(true_hz[:k]),
+        ref_hz=np.asarray(ref_out[:k]),
+        recip_hz=np.asarray(recip_out[:k]),
+        t_s=np.asarray(t_out[:k]),
+    )
+
+
+@dataclass
+class DeviceStreamSpec:
+    """One simulated sensor as seen by the host: clock error, transport and sensor offset."""
+
+    rate_hz: float = 100.0
+    clock_offset_ms: float = 0.0
+    skew_ppm: float = 0.0
+    delay_ms: float = 1.0
+    delay_jitter_ms: float = 2.0
+    batch: int = 8
+    pressure_offset: float = 0.0
+    noise: float = 0.0
+    seed: Optional[int] = None
+
+
+def synthetic_device_stream(
+    spec: DeviceStreamSpec,
+    duration_s: float,
+    signal: Callable[[np.ndarray], np.ndarray],
+    start_s: float = 0.0,
+) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    Return (device ts_ms, host arrival ms, pressure) for one device sampling
+    the shared ``signal(host_time_s)``. Samples leave the device in batches of
+    ``spec.batch`` and each batch arrives after a fixed plus exponential delay,
+    so arrival times are non-decreasing like a USB CDC stream.
+    """
+
+    rng = np.random.default_rng(spec.seed)
+    n = int(duration_s * spec.rate_hz)
+    true_s = start_s + (np.arange(n, dtype=float) + rng.random()) / spec.rate_hz
+    device_ms = spec.clock_offset_ms + (true_s - start_s) * 1e3 * (1.0 + spec.skew_ppm * 1e-6)
+    pressure = signal(true_s) + spec.pressure_offset
+    if spec.noise:
+        pressure = pressure + rng.normal(scale=spec.noise, size=n)
+    batch = max(spec.batch, 1)
+    last_in_batch = np.minimum((np.arange(n) // batch + 1) * batch - 1, n - 1)
+    n_batches = -(-n // batch)
+    delays = spec.delay_ms + rng.exponential(spec.delay_jitter_ms, size=n_batches) if spec.delay_jitter_ms else (
+        np.full(n_batches, spec.delay_ms)
+    )
+    arrival = true_s[last_in_batch] * 1e3 + delays[np.arange(n) // batch]
+    arrival = np.maximum.accumulate(arrival)
+    return device_ms, arrival, pressure
@@ -0,0 +1,369 @@
+from __future__ import annotations
+
+import json
+import logging
+import os
+import selectors
+import socket
+import threading
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, Dict, Iterator, List, Optional, Sequence, Tuple
+
+from .processing import SampleRecord
+
+logger = logging.getLogger(__name__)
+
+SAMPLE_FIELDS: Tuple[str, ...] = (
+    "ts_ms",
+    "frequency_hz",
+    "tau_ms",
+    "diode_uV",
+    "pressure",
+    "adc_gain",
+    "flags",
+    "ppm_corr",
+    "mode",
+    "slot",
+    "adc_fresh",
+)
+AGGREGATES = ("mean", "min", "max")
+_MAX_SPEC_BYTES = 4096
+
+
+@dataclass(frozen=True)
+class SubscriptionSpec:
+    """
+    What a socket client wants from the sample stream. Specs are hashable so
+    identical subscriptions share one channel and are computed once.
+
+    `require_flags`/`reject_flags` select samples by flag bits, `decimate`
+    forwards every Nth selected sample (or aggregates each block of N when
+    `aggregate` is set). In aggregated rows `ts_ms`, `mode` and `slot` come from the
+    last sample of the block, `flags` is the OR and `adc_fresh` the sum over the block.
+    """
+
+    fields: Tuple[str, ...] = SAMPLE_FIELDS
+    require_flags: int = 0
+    reject_flags: int = 0
+    decimate: int = 1
+    aggregate: Optional[str] = None
+
+    @staticmethod
+    def from_mapping(data: Dict[str, Any]) -> "SubscriptionSpec":
+        fields = tuple(data.get("fields") or SAMPLE_FIELDS)
+        unknown = [name for name in fields if name not in SAMPLE_FIELDS]
+        if unknown:
+            raise ValueError(f"unknown fields {unknown}")
+        decimate = int(data.get("decimate", 1))
+        if decimate < 1:
+            raise ValueError("decimate must be >= 1")
+        aggregate = data.get("aggregate")
+        if aggregate is not None and aggregate not in AGGREGATES:
+            raise ValueError(f"aggregate must be one of {AGGREGATES}")
+        return SubscriptionSpec(
+            fields=fields,
+            require_flags=int(data.get("require_flags", 0)),
+            reject_flags=int(data.get("reject_flags", 0)),
+            decimate=decimate,
+            aggregate=aggregate,
+        )
+
+
+class _Channel:
+    """Incremental state for one distinct spec, shared by all its clients."""
+
+    def __init__(self, spec: SubscriptionSpec):
+        self.spec = spec
+        self.clients: List["_Client"] = []
+        self._index = [SAMPLE_FIELDS.index(name) for name in spec.fields]
+        self._count = 0
+        self._acc: Optional[List[Any]] = None
+
+    def feed(self, rows: Sequence[Tuple[Any, ...]]) -> bytes:
+        spec = self.spec
+        out: List[str] = []
+        for row in rows:
+            flags = row[6]
+            if (flags & spec.require_flags) != spec.require_flags or flags & spec.reject_flags:
+                continue
+            if spec.aggregate is None:
+                if self._count % spec.decimate == 0:
+                    out.append(",".join(str(row[idx]) for idx in self._index))
+                self._count += 1
+                continue
+            self._accumulate(row)
+            self._count += 1
+            if self._count == spec.decimate:
+                out.append(self._emit())
+        return ("\n".join(out) + "\n").encode("utf-8") if out else b""
+
+    def _accumulate(self, row: Tuple[Any, ...]) -> None:
+        acc = self._acc
+        if acc is None:
+            self._acc = list(row)
+            return
+        agg = self.spec.aggregate
+        for idx in (1, 2, 3, 4, 5, 7):
+            if agg == "mean":
+                acc[idx] += row[idx]
+            elif agg == "min":
+                acc[idx] = min(acc[idx], row[idx])
+            else:
+                acc[idx] = max(acc[idx], row[idx])
+        acc[0] = row[0]
+        acc[6] |= row[6]
+        acc[8] = row[8]
+        acc[9] = row[9]
+        acc[10] = acc[10] + row[10] if acc[10] >= 0 and row[10] >= 0 else -1
+
+    def _emit(self) -> str:
+        acc = self._acc
+        assert acc is not None
+        if self.spec.aggregate == "mean":
+            for idx in (1, 2, 3, 4, 5, 7):
+                acc[idx] = acc[idx] / self._count
+        self._acc = None
+        self._count = 0
+        return ",".join(str(acc[idx]) for idx in self._index)
+
+
+class _Client:
+    def __init__(self, sock: socket.socket):
+        self.sock = sock
+        self.inbox = bytearray()
+        self.outbox = bytearray()
+        self.channel: Optional[_Channel] = None
+
+
+class SampleStreamServer:
+    """
+    Fan processed samples out to local consumers over a Unix domain socket.
+
+    A client connects, sends one JSON line with its `SubscriptionSpec`, and
+    receives `OK fields=a,b,...` followed by CSV rows, or `ERR <reason>`.
+    Publishing never blocks the pipeline: rows are queued per client and a
+    client whose backlog exceeds `max_backlog` bytes is disconnected.
+    """
+
+    def __init__(self, path: Path | str, max_backlog: int = 1 << 20):
+        self.path = Path(path)
+        self.max_backlog = max_backlog
+        self._selector = selectors.DefaultSelector()
+        self._lock = threading.Lock()
+        self._channels: Dict[SubscriptionSpec, _Channel] = {}
+        self._clients: Dict[int, _Client] = {}
+        self._stats = {"clients": 0, "published": 0, "dropped_clients": 0}
+        self._wake_r, self._wake_w = socket.socketpair()
+        self._wake_r.setblocking(False)
+        self._wake_w.setblocking(False)
+        self._listener: Optional[socket.socket] = None
+        self._thread: Optional[threading.Thread] = None
+        self._stop = threading.Event()
+
+    def start(self) -> None:
+        if self.path.exists():
+            self.path.unlink()
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        listener.bind(str(self.path))
+        listener.listen(64)
+        listener.setblocking(False)
+        self._listener = listener
+        self._selector.register(listener, selectors.EVENT_READ, "accept")
+        self._selector.register(self._wake_r, selectors.EVENT_READ, "wake")
+        self._thread = threading.Thread(target=self._serve, name="terps-stream", daemon=True)
+        self._thread.start()
+        logger.info("Streaming samples on %s", self.path)
+
+    def publish(self, samples: Sequence[SampleRecord]) -> None:
+        if not samples:
+            return
+        rows = [
+            (s.ts_ms, s.frequency_hz, s.tau_ms, s.diode_uV, s.pressure, s.adc_gain, s.flags, s.ppm_corr, s.mode, s.slot, s.adc_fresh)
+            for s in samples
+        ]
+        wake = False
+        with self._lock:
+            self._stats["published"] += len(rows)
+            for channel in self._channels.values():
+                payload = channel.feed(rows)
+                if not payload:
+                    continue
+                for client in channel.clients:
+                    client.outbox += payload
+                    wake = True
+        if wake:
+            self._wake()
+
+    def stats(self) -> Dict[str, int]:
+        with self._lock:
+            data = dict(self._stats)
+            data["channels"] = len(self._channels)
+            data["connected"] = len(self._clients)
+        return data
+
+    def close(self) -> None:
+        self._stop.set()
+        self._wake()
+        if self._thread is not None:
+            self._thread.join(timeout=2.0)
+            self._thread = None
+        with self._lock:
+            for client in list(self._clients.values()):
+                client.sock.close()
+            self._clients.clear()
+            self._channels.clear()
+        if self._listener is not None:
+            self._listener.close()
+            self._listener = None
+            try:
+                os.unlink(self.path)
+            except OSError:
+                pass
+        self._selector.close()
+        self._wake_r.close()
+        self._wake_w.close()
+
+    def _wake(self) -> None:
+        try:
+            self._wake_w.send(b"\0")
+        except (BlockingIOError, OSError):
+            pass
+
+    def _serve(self) -> None:
+        while not self._stop.is_set():
+            for key, events in self._selector.select(timeout=0.5):
+                if key.data == "accept":
+                    self._accept()
+                elif key.data == "wake":
+                    try:
+                        while self._wake_r.recv(4096):
+                            pass
+                    except BlockingIOError:
+                        pass
+                else:
+                    client: _Client = key.data
+                    if events & selectors.EVENT_READ:
+                        self._read(client)
+            self._flush_all()
+
+    def _accept(self) -> None:
+        assert self._listener is not None
+        try:
+            sock, _ = self._listener.accept()
+        except BlockingIOError:
+            return
+        sock.setblocking(False)
+        client = _Client(sock)
+        with self._lock:
+            self._clients[sock.fileno()] = client
+            self._stats["clients"] += 1
+        self._selector.register(sock, selectors.EVENT_READ, client)
+
+    def _read(self, client: _Client) -> None:
+        try:
+            data = client.sock.recv(4096)
+        except BlockingIOError:
+            return
+        except OSError:
+            data = b""
+        if not data:
+            self._drop(client)
+            return
+        if client.channel is not None:
+            return  # subscribed clients only listen
+        client.inbox += data
+        if b"\n" not in client.inbox:
+            if len(client.inbox) > _MAX_SPEC_BYTES:
+                self._reject(client, "spec too long")
+            return
+        line = bytes(client.inbox).split(b"\n", 1)[0]
+        try:
+            spec = SubscriptionSpec.from_mapping(json.loads(line or b"{}"))
+        except (ValueError, TypeError) as exc:
+            self._reject(client, str(exc))
+            return
+        with self._lock:
+            channel = self._channels.get(spec)
+            if channel is None:
+                channel = _Channel(spec)
+                self._channels[spec] = channel
+            channel.clients.append(client)
+            client.channel = channel
+            client.outbox += f"OK fields={','.join(spec.fields)}\n".encode("ascii")
+
+    def _reject(self, client: _Client, reason: str) -> None:
+        with self._lock:
+            client.outbox += f"ERR {reason}\n".encode("utf-8")
+        self._flush(client)
+        self._drop(client)
+
+    def _flush_all(self) -> None:
+        with self._lock:
+            pending = [client for client in self._clients.values() if client.outbox]
+        for client in pending:
+            self._flush(client)
+
+    def _flush(self, client: _Client) -> None:
+        with self._lock:
+            if not client.outbox:
+                return
+            try:
+                sent = client.sock.send(client.outbox)
+            except BlockingIOError:
+                sent = 0
+            except OSError:
+                sent = -1
+            if sent > 0:
+                del client.outbox[:sent]
+            overflow = len(client.outbox) > self.max_backlog
+        if sent < 0 or overflow:
+            if overflow:
+                logger.warning("Dropping slow stream client (backlog %d bytes)", len(client.outbox))
+                with self._lock:
+                    self._stats["dropped_clients"] += 1
+            self._drop(client)
+        elif client.outbox:
+            self._selector.modify(client.sock, selectors.EVENT_READ | selectors.EVENT_WRITE, client)
+        else:
+            self._selector.modify(client.sock, selectors.EVENT_READ, client)
+
+    def _drop(self, client: _Client) -> None:
+        with self._lock:
+            self._clients.pop(client.sock.fileno(), None)
+            channel = client.channel
+            if channel is not None and client in channel.clients:
+                channel.clients.remove(client)
+                if not channel.clients:
+                    self._channels.pop(channel.spec, None)
+        try:
+            self._selector.unregister(client.sock)
+        except (KeyError, ValueError):
+            pass
+        client.sock.close()
+
+
+def subscribe(path: Path | str, spec: SubscriptionSpec, timeout: Optional[float] = None) -> Iterator[str]:
+    """Connect to a `SampleStreamServer` and yield CSV rows for `spec`."""
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.settimeout(timeout)
+    sock.connect(str(path))
+    request = {
+        "fields": list(spec.fields),
+        "require_flags": spec.require_flags,
+        "reject_flags": spec.reject_flags,
+        "decimate": spec.decimate,
+        "aggregate": spec.aggregate,
+    }
+    sock.sendall((json.dumps(request) + "\n").encode("utf-8"))
+    try:
+        with sock.makefile("r", encoding="utf-8", newline="\n") as reader:
+            status = reader.readline().rstrip("\n")
+            if not status.startswith("OK"):
+                raise ValueError(f"Subscription rejected: {status or 'connection closed'}")
+            for line in reader:
+                yield line.rstrip("\n")
+    finally:
+        sock.close()
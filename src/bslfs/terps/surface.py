@@ -0,0 +1,248 @@
+"""
+Fit the TERPS pressure surface ``P = Σ K[i][j] · (f - X)^i · (V - Y)^j``.
+
+The design is the (nx+1)·(ny+1) tensor product of frequency and diode-voltage
+offsets around the reference point (X, Y), the same layout `PressureCalculator`
+evaluates. Raw powers of a ~10³ Hz offset span many decades, so each axis is
+first divided by its largest absolute offset and every column is then
+normalised to unit 2-norm before a Householder QR solve; coefficients are
+mapped back to the unscaled basis afterwards. The column scaling is what keeps
+orders up to 5×5 well conditioned without resorting to orthogonal polynomials.
+
+`fit_surface` solves weighted least squares, or the (weighted) minimax problem
+with Lawson's iteratively reweighted least squares on an exchange set: the
+points with the largest least-squares residuals are refined first and
+violators from the full data set are added until none remain, which keeps a
+10⁵-point fit to a few hundred small QR solves.
+"""
+
+from __future__ import annotations
+
+import json
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple
+
+import numpy as np
+
+from .config import SensorPoly
+
+FIT_METHODS = ("lsq", "minimax")
+
+
+@dataclass
+class SurfaceFit:
+    """Fitted surface plus residual diagnostics in the pressure unit of the data."""
+
+    sensor_poly: SensorPoly
+    method: str
+    residuals: np.ndarray
+    rms: float
+    max_abs: float
+    condition: float
+    iterations: int = 0
+    metadata: Dict[str, float] = field(default_factory=dict)
+
+    def summary(self) -> Dict[str, float]:
+        return {
+            "points": float(self.residuals.size),
+            "rms": self.rms,
+            "max_abs": self.max_abs,
+            "condition": self.condition,
+            "iterations": float(self.iterations),
+            **self.metadata,
+        }
+
+    def to_config(self, base: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        """Config JSON (as in `coeffs_example.json`) with this surface as `sensor_poly`."""
+
+        data = dict(base or {})
+        data["sensor_poly"] = {
+            "X": self.sensor_poly.X,
+            "Y": self.sensor_poly.Y,
+            "K": self.sensor_poly.K,
+        }
+        return data
+
+    def save(self, path: Path | str, base: Optional[Dict[str, Any]] = None) -> None:
+        Path(path).write_text(json.dumps(self.to_config(base), indent=2), encoding="utf-8")
+
+
+def scaled_design(
+    x: np.ndarray, y: np.ndarray, nx: int, ny: int, x_scale: float, y_scale: float
+) -> np.ndarray:
+    """Tensor-product columns (x/sx)^i (y/sy)^j in `K` row-major order."""
+
+    xp = np.power.outer(x / x_scale, np.arange(nx + 1, dtype=float))
+    yp = np.power.outer(y / y_scale, np.arange(ny + 1, dtype=float))
+    return (xp[:, :, None] * yp[:, None, :]).reshape(x.size, -1)
+
+
+def _qr_solve(a: np.ndarray, b: np.ndarray) -> Tuple[np.ndarray, float]:
+    q, r = np.linalg.qr(a, mode="reduced")
+    diag = np.abs(np.diag(r))
+    if diag.size == 0 or diag.min() <= diag.max() * 1e-13:
+        raise ValueError("Design matrix is rank deficient; lower nx/ny or add calibration points")
+    return np.linalg.solve(r, q.T @ b), float(diag.max() / diag.min())
+
+
+def _weighted_lsq(a: np.ndarray, b: np.ndarray, w: np.ndarray) -> Tuple[np.ndarray, float]:
+    root = np.sqrt(w)
+    return _qr_solve(a * root[:, None], b * root)
+
+
+def _lawson(
+    a: np.ndarray, b: np.ndarray, w: np.ndarray, tol: float, max_iter: int
+) -> Tuple[np.ndarray, np.ndarray, float, int]:
+    """
+    Discrete minimax of ``a c ≈ b`` by Lawson reweighting from start weights ``w``;
+    returns (c, final weights, lower bound, iterations).
+    """
+
+    w = w / w.sum()
+    coef, _ = _weighted_lsq(a, b, w)
+    lower = 0.0
+    for iteration in range(1, max_iter + 1):
+        r = b - a @ coef
+        abs_r = np.abs(r)
+        upper = float(abs_r.max())
+        # sqrt(Σ w r²) of the weighted LSQ solution bounds the minimax error from below.
+        lower = max(lower, float(np.sqrt(np.dot(w, r * r))))
+        if upper == 0.0 or upper - lower <= tol * upper:
+            return coef, w, lower, iteration
+        # Floor rather than drop small weights: a point pruned early may belong
+        # to the final extremal set and could never re-enter.
+        w = w * abs_r
+        w = np.maximum(w / w.sum(), 1e-30)
+        coef, _ = _weighted_lsq(a, b, w)
+    return coef, w, lower, max_iter
+
+
+def fit_surface(
+    frequency_hz: np.ndarray,
+    diode_uV: np.ndarray,
+    pressure: np.ndarray,
+    nx: int,
+    ny: int,
+    x_ref: Optional[float] = None,
+    y_ref: Optional[float] = None,
+    weights: Optional[np.ndarray] = None,
+    method: str = "lsq",
+    tol: float = 1e-3,
+    max_iter: int = 1000,
+) -> SurfaceFit:
+    """
+    Fit `K` of shape (nx+1, ny+1). `x_ref`/`y_ref` default to the data midrange.
+    For ``lsq`` weights multiply squared residuals; for ``minimax`` they scale the
+    residuals whose maximum is minimised (e.g. 1/tolerance per calibration point).
+    """
+
+    if method not in FIT_METHODS:
+        raise ValueError(f"method must be one of {FIT_METHODS}")
+    f = np.asarray(frequency_hz, dtype=float)
+    v = np.asarray(diode_uV, dtype=float)
+    p = np.asarray(pressure, dtype=float)
+    if not (f.shape == v.shape == p.shape) or f.ndim != 1:
+        raise ValueError("frequency, voltage and pressure must be equally sized 1-D arrays")
+    w = np.ones_like(p) if weights is None else np.asarray(weights, dtype=float)
+    finite = np.isfinite(f) & np.isfinite(v) & np.isfinite(p) & np.isfinite(w) & (w > 0)
+    f, v, p, w = f[finite], v[finite], p[finite], w[finite]
+    columns = (nx + 1) * (ny + 1)
+    if nx < 0 or ny < 0:
+        raise ValueError("nx and ny must be non-negative")
+    if f.size < columns:
+        raise ValueError(f"need at least {columns} valid points for nx={nx}, ny={ny}")
+
+    X = float(x_ref) if x_ref is not None else 0.5 * float(f.min() + f.max())
+    Y = float(y_ref) if y_ref is not None else 0.5 * float(v.min() + v.max())
+    x = f - X
+    y = v - Y
+    x_scale = float(np.abs(x).max()) or 1.0
+    y_scale = float(np.abs(y).max()) or 1.0
+    a = scaled_design(x, y, nx, ny, x_scale, y_scale)
+    col_norm = np.linalg.norm(a, axis=0)
+    col_norm[col_norm == 0.0] = 1.0
+    a /= col_norm
+
+    iterations = 0
+    metadata: Dict[str, float] = {}
+    coef, condition = _weighted_lsq(a, p, w)
+    if method == "minimax":
+        coef, iterations, lower = _minimax_exchange(a, p, w, coef, tol, max_iter)
+        metadata["minimax_lower_bound"] = lower
+
+    # Undo column normalisation and axis scaling: K_ij = c_ij / (sx^i sy^j).
+    scale = np.outer(x_scale ** np.arange(nx + 1.0), y_scale ** np.arange(ny + 1.0)).ravel()
+    k = (coef / col_norm / scale).reshape(nx + 1, ny + 1)
+    residuals = p - a @ coef
+    return SurfaceFit(
+        sensor_poly=SensorPoly(X=X, Y=Y, K=k.tolist()),
+        method=method,
+        residuals=residuals,
+        rms=float(np.sqrt(np.mean(residuals * residuals))),
+        max_abs=float(np.abs(residuals).max()),
+        condition=condition,
+        iterations=iterations,
+        metadata=metadata,
+    )
+
+
+def _minimax_exchange(
+    a: np.ndarray,
+    p: np.ndarray,
+    w: np.ndarray,
+    coef: np.ndarray,
+    tol: float,
+    max_iter: int,
+) -> Tuple[np.ndarray, int, float]:
+    """Lawson on a growing subset seeded with the largest LSQ residuals."""
+
+    aw = a * w[:, None]
+    pw = p * w
+    columns = a.shape[1]
+    seed = min(pw.size, max(8 * columns, 128))
+    active = np.argpartition(-np.abs(pw - aw @ coef), seed - 1)[:seed]
+    weights = np.ones(active.size)
+    iterations = 0
+    lower = 0.0
+    best, best_err = coef, float(np.abs(pw - aw @ coef).max())
+    while True:
+        coef, weights, bound_lo, used = _lawson(aw[active], pw[active], weights, tol, max_iter - iterations)
+        iterations += used
+        lower = max(lower, bound_lo)
+        err = np.abs(pw - aw @ coef)
+        if err.max() < best_err:
+            best, best_err = coef, float(err.max())
+        bound = float(err[active].max())
+        violators = np.flatnonzero(err > bound * (1.0 + tol))
+        if violators.size == 0 or iterations >= max_iter:
+            return best, iterations, lower
+        # Keep the current support with its weights, drop points Lawson has
+        # already discarded, and add the worst violators at the mean weight.
+        keep = weights > weights.max() * 1e-6
+        worst = violators[np.argsort(-err[violators])[: 4 * columns]]
+        active = np.concatenate((active[keep], worst))
+        weights = np.concatenate((weights[keep], np.full(worst.size, weights[keep].mean())))
+
+
+def load_calibration(
+    paths: List[Path],
+    f_col: str,
+    v_col: str,
+    p_col: str,
+    w_col: Optional[str] = None,
+) -> Tuple[np.ndarray, np.ndarray, np.ndarray, Optional[np.ndarray]]:
+    """Concatenate calibration CSVs (`#` metadata lines are skipped)."""
+
+    import pandas as pd
+
+    cols = [f_col, v_col, p_col] + ([w_col] if w_col else [])
+    frames = [pd.read_csv(path, comment="#", usecols=cols) for path in paths]
+    data = pd.concat(frames, ignore_index=True) if len(frames) > 1 else frames[0]
+    weights = data[w_col].to_numpy(dtype=float) if w_col else None
+    return (
+        data[f_col].to_numpy(dtype=float),
+        data[v_col].to_numpy(dtype=float),
+        data[p_col].to_numpy(dtype=float),
+        weights,
+    )
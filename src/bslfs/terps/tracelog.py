@@ -0,0 +1,117 @@
+from __future__ import annotations
+
+import json
+import re
+import struct
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Dict, Optional, Tuple
+
+_TRACE_HEADER = struct.Struct("<IHBB")
+_DEF_ENTRY = re.compile(r'^TRACE_FMT\((\w+),\s*"(.*)"\)\s*$')
+_C_CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z)?([diuxXcs%])")
+
+
+@dataclass
+class TraceRecord:
+    """One deferred log entry emitted by the firmware trace rings."""
+
+    ts_us: int
+    trace_id: int
+    core: int
+    args: Tuple[int, ...]
+
+
+def decode_trace_payload(payload: bytes) -> Optional[TraceRecord]:
+    if len(payload) < _TRACE_HEADER.size:
+        return None
+    ts_us, trace_id, core, nargs = _TRACE_HEADER.unpack_from(payload)
+    if len(payload) != _TRACE_HEADER.size + 4 * nargs:
+        return None
+    args = struct.unpack_from(f"<{nargs}I", payload, _TRACE_HEADER.size)
+    return TraceRecord(ts_us=ts_us, trace_id=trace_id, core=core, args=tuple(args))
+
+
+def parse_trace_line(line: str) -> Optional[TraceRecord]:
+    """Decode the `#L id core ts args...` text form used in CSV streaming mode."""
+
+    parts = line.strip().split()
+    if len(parts) < 4 or parts[0] != "#L":
+        return None
+    try:
+        values = [int(token) for token in parts[1:]]
+    except ValueError:
+        return None
+    trace_id, core, ts_us, *args = values
+    return TraceRecord(ts_us=ts_us, trace_id=trace_id, core=core, args=tuple(args))
+
+
+class TraceStringTable:
+    """
+    Maps trace IDs to printf-style format strings. The firmware build writes
+    `trace_log_strings.json` next to the UF2; the `.def` source can be read
+    directly when decoding against a source checkout.
+    """
+
+    def __init__(self, formats: Dict[int, Tuple[str, str]]):
+        self._formats = formats
+
+    @staticmethod
+    def load(path: Path | str) -> "TraceStringTable":
+        path = Path(path)
+        if path.suffix == ".def":
+            return TraceStringTable.from_def(path.read_text(encoding="utf-8"))
+        data = json.loads(path.read_text(encoding="utf-8"))
+        formats = {
+            int(item["id"]): (str(item["name"]), str(item["fmt"]))
+            for item in data.get("formats", [])
+        }
+        return TraceStringTable(formats)
+
+    @staticmethod
+    def from_def(text: str) -> "TraceStringTable":
+        formats: Dict[int, Tuple[str, str]] = {}
+        for line in text.splitlines():
+            match = _DEF_ENTRY.match(line.strip())
+            if match:
+                formats[len(formats)] = (match.group(1), match.group(2))
+        return TraceStringTable(formats)
+
+    def name(self, trace_id: int) -> str:
+        entry = self._formats.get(trace_id)
+        return entry[0] if entry else f"TRACE_{trace_id}"
+
+    def format(self, record: TraceRecord) -> str:
+        entry = self._formats.get(record.trace_id)
+        if entry is None:
+            args = " ".join(str(value) for value in record.args)
+            return f"trace id={record.trace_id} args=[{args}]"
+        return _apply_c_format(entry[1], record.args)
+
+
+def _apply_c_format(fmt: str, args: Tuple[int, ...]) -> str:
+    values = iter(args)
+
+    def substitute(match: re.Match[str]) -> str:
+        flags, conv = match.group(1), match.group(2)
+        if conv == "%":
+            return "%"
+        value = next(values, 0)
+        if conv in "di" and value & 0x80000000:
+            value -= 1 << 32
+        if conv == "u":
+            conv = "d"
+        elif conv == "c":
+            return chr(value & 0xFF)
+        elif conv == "s":
+            return f"<0x{value:08X}>"
+        return ("%" + flags + conv) % value
+
+    return _C_CONVERSION.sub(substitute, fmt)
+
+
+def format_record(record: TraceRecord, table: Optional[TraceStringTable]) -> str:
+    text = table.format(record) if table else (
+        f"trace id={record.trace_id} args={list(record.args)}"
+    )
+    return f"[core{record.core} t={record.ts_us}us] {text}"
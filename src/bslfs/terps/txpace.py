@@ -0,0 +1,381 @@
+"""
+Host-side model of the firmware's adaptive USB TX path (`tx_pacer.cpp`).
+
+`TxPacerModel` mirrors the pacer step logic. `simulate_link` models the whole
+path on a 1 ms tick: frame production, batching/merging, the CDC TX FIFO and
+a `ThrottledHost` that drains it under a byte-rate and a USB-packet budget.
+The bytes the host receives can be fed straight into `FrameParser`, so
+overload tests cover the in-band signalling as well as the pacing.
+
+In-band signals: binary streams carry ``0x55 0xA7`` records (decoded by
+`SchemaRegistry` into dicts), CSV streams carry ``#TX KEY=VALUE ...`` lines
+(`parse_tx_line`).
+"""
+
+from __future__ import annotations
+
+import math
+import struct
+from collections import deque
+from dataclasses import dataclass, field
+from typing import Deque, Dict, List, Optional, Tuple
+
+from .frames import FLAG_PPS_LOCKED, FLAG_SETTLED, FLAG_SUMMARY, PACKET_FRAME, PACKET_MAGIC, crc16_ccitt
+from .schema import BUILTIN_TX_STATE_SCHEMA, PACKET_TX_STATE
+
+LEVELS = ("NORMAL", "BATCH", "SUMMARY")
+USB_PACKET_BYTES = 64
+_FRAME = struct.Struct("<IiHiBBhBIB")
+_RELEASE_MARGIN = 0.7
+_PROBE_HOLDS_MIN = 4
+_PROBE_HOLDS_MAX = 64
+_ALPHA = 0.5
+
+
+@dataclass
+class TxPacerLimits:
+    fifo_size: int = 256
+    batch_max: int = 8
+    batch_ms: int = 20
+    merge_max: int = 64
+    sample_ms: int = 50
+    hold_ms: int = 1000
+    high_fill: float = 0.75
+    low_fill: float = 0.25
+
+
+@dataclass
+class TxPacerModel:
+    """Step logic of `tx_pacer_sample()`; times in µs, rates in bytes/s."""
+
+    limits: TxPacerLimits = field(default_factory=TxPacerLimits)
+    step: int = 0
+    started: bool = False
+    stall_pending: bool = False
+    last_us: int = 0
+    calm_since_us: int = 0
+    capacity_at_us: int = 0
+    down_at_us: int = 0
+    probe_holds: int = _PROBE_HOLDS_MIN
+    written: int = 0
+    drained_prev: int = 0
+    offered: int = 0
+    drain_Bps: float = 0.0
+    capacity_Bps: float = 0.0
+    demand_Bps: float = 0.0
+    changes: int = 0
+    stalls: int = 0
+    dropped: int = 0
+
+    @property
+    def max_step(self) -> int:
+        return 1 + int(math.log2(max(self.limits.merge_max, 1)))
+
+    @property
+    def level(self) -> str:
+        return LEVELS[min(self.step, 2)]
+
+    @property
+    def batch(self) -> int:
+        return self.limits.batch_max if self.step >= 1 else 1
+
+    @property
+    def merge(self) -> int:
+        return merge_for(self.step)
+
+    def offer(self, normal_bytes: int) -> None:
+        self.offered += normal_bytes
+
+    def wrote(self, n: int) -> None:
+        self.written += n
+
+    def stall(self, frames_lost: int) -> None:
+        self.stall_pending = True
+        self.stalls += 1
+        self.dropped += frames_lost
+
+    def sample(self, now_us: int, fifo_free: int) -> bool:
+        lim = self.limits
+        occupancy = max(lim.fifo_size - fifo_free, 0)
+        drained = self.written - occupancy
+        if not self.started:
+            self.started = True
+            self.last_us = self.calm_since_us = now_us
+            self.drained_prev = drained
+            self.offered = 0
+            return False
+        dt_us = now_us - self.last_us
+        if (dt_us < lim.sample_ms * 1000 and not self.stall_pending) or dt_us <= 0:
+            return False
+        dt_s = dt_us * 1e-6
+        drain = (drained - self.drained_prev) / dt_s
+        demand = self.offered / dt_s
+        self.drain_Bps += _ALPHA * (drain - self.drain_Bps)
+        self.demand_Bps += _ALPHA * (demand - self.demand_Bps)
+        self.drained_prev = drained
+        self.offered = 0
+        self.last_us = now_us
+
+        fill = occupancy / lim.fifo_size
+        if fill > lim.low_fill:
+            self.capacity_Bps = self.drain_Bps if self.capacity_at_us else drain
+            self.capacity_at_us = now_us
+
+        hold_us = lim.hold_ms * 1000
+        target = self.step
+        if self.stall_pending or fill >= lim.high_fill:
+            target = min(target + 1, self.max_step)
+            if self.down_at_us and now_us - self.down_at_us < 2 * hold_us:
+                self.probe_holds = min(self.probe_holds * 2, _PROBE_HOLDS_MAX)
+            self.down_at_us = 0
+            self.calm_since_us = now_us
+        elif fill <= lim.low_fill:
+            if target > 0 and now_us - self.calm_since_us >= hold_us:
+                need = self.demand_Bps / merge_for(target - 1)
+                stale = self.capacity_at_us == 0 or now_us - self.capacity_at_us >= hold_us * self.probe_holds
+                if stale or need < _RELEASE_MARGIN * self.capacity_Bps:
+                    target -= 1
+                    self.down_at_us = now_us
+                    if target == 0:
+                        self.probe_holds = _PROBE_HOLDS_MIN
+                self.calm_since_us = now_us
+        else:
+            self.calm_since_us = now_us
+        self.stall_pending = False
+        if target == self.step:
+            return False
+        self.step = target
+        self.changes += 1
+        return True
+
+
+def merge_for(step: int) -> int:
+    return 1 << (step - 1) if step >= 2 else 1
+
+
+@dataclass
+class ThrottledHost:
+    """
+    A host that drains at most ``bytes_per_s`` and ``packets_per_s`` USB
+    packets. Every flush is split into 64-byte packets, so many small flushes
+    cost more packets than one batched flush. ``schedule`` switches the rates
+    at given times: ``[(t_s, bytes_per_s, packets_per_s), ...]``.
+    """
+
+    bytes_per_s: float = 1e6
+    packets_per_s: float = 1000.0
+    schedule: List[Tuple[float, float, float]] = field(default_factory=list)
+    _byte_credit: float = 0.0
+    _packet_credit: float = 0.0
+
+    def rates(self, t_s: float) -> Tuple[float, float]:
+        bps, pps = self.bytes_per_s, self.packets_per_s
+        for start, sched_bps, sched_pps in self.schedule:
+            if t_s >= start:
+                bps, pps = sched_bps, sched_pps
+        return bps, pps
+
+    def drain(self, fifo: Deque[bytearray], t_s: float, dt_s: float) -> bytes:
+        bps, pps = self.rates(t_s)
+        self._byte_credit = min(self._byte_credit + bps * dt_s, bps * 0.01 + USB_PACKET_BYTES)
+        self._packet_credit = min(self._packet_credit + pps * dt_s, pps * 0.01 + 1.0)
+        out = bytearray()
+        while fifo and self._packet_credit >= 1.0:
+            packet = fifo[0]
+            take = min(len(packet), USB_PACKET_BYTES)
+            if self._byte_credit < take:
+                break
+            out += packet[:take]
+            self._byte_credit -= take
+            self._packet_credit -= 1.0
+            if take == len(packet):
+                fifo.popleft()
+            else:
+                del packet[:take]
+        return bytes(out)
+
+
+@dataclass
+class LinkResult:
+    received: bytes
+    frames_produced: int
+    frames_sent: int  # frames (summaries count once) handed to the FIFO
+    windows_sent: int  # source windows represented by the sent frames
+    dropped: int
+    steps: List[Tuple[float, int]]  # (t_s, step) at every change
+    pacer: TxPacerModel
+
+
+def encode_frame_packet(frame: Dict[str, float]) -> bytes:
+    body = _FRAME.pack(
+        int(frame["ts_ms"]),
+        int(round(frame["f_hz"] * 1e4)),
+        min(int(frame["tau_ms"]), 0xFFFF),
+        int(frame["v_uV"]),
+        16,
+        int(frame["flags"]),
+        0,
+        1,
+        0xFFFFFFFF,
+        min(int(frame["adc_fresh"]), 0xFF),
+    )
+    return bytes([PACKET_MAGIC, PACKET_FRAME, len(body)]) + body + crc16_ccitt(body).to_bytes(2, "little")
+
+
+def encode_tx_state(pacer: TxPacerModel, ts_ms: int) -> bytes:
+    values = (
+        ts_ms,
+        pacer.step,
+        min(pacer.step, 2),
+        pacer.batch,
+        pacer.merge,
+        int(pacer.drain_Bps),
+        int(pacer.capacity_Bps),
+        int(pacer.demand_Bps),
+        pacer.stalls,
+        pacer.dropped,
+    )
+    body = struct.pack("<IBBHHIIIII", *values)
+    assert len(body) == BUILTIN_TX_STATE_SCHEMA.payload_len
+    return bytes([PACKET_MAGIC, PACKET_TX_STATE, len(body)]) + body + crc16_ccitt(body).to_bytes(2, "little")
+
+
+def merge_frames(frames: List[Dict[str, float]]) -> Dict[str, float]:
+    """Same folding as the firmware's merge_take()."""
+
+    status = FLAG_PPS_LOCKED | FLAG_SETTLED
+    flags_or = 0
+    flags_and = 0xFF
+    for frame in frames:
+        flags_or |= int(frame["flags"])
+        flags_and &= int(frame["flags"])
+    return {
+        "ts_ms": frames[-1]["ts_ms"],
+        "f_hz": sum(f["f_hz"] for f in frames) / len(frames),
+        "tau_ms": sum(f["tau_ms"] for f in frames),
+        "v_uV": int(sum(f["v_uV"] for f in frames) / len(frames)),
+        "flags": (flags_or & ~status) | (flags_and & status) | FLAG_SUMMARY,
+        "adc_fresh": sum(f["adc_fresh"] for f in frames),
+    }
+
+
+def simulate_link(
+    host: ThrottledHost,
+    duration_s: float,
+    frame_period_ms: float = 10.0,
+    limits: Optional[TxPacerLimits] = None,
+    adaptive: bool = True,
+) -> LinkResult:
+    """Run the binary TX path against ``host`` for ``duration_s`` seconds."""
+
+    limits = limits or TxPacerLimits()
+    pacer = TxPacerModel(limits=limits)
+    fifo: Deque[bytearray] = deque()
+    fifo_bytes = 0
+    received = bytearray()
+    stage = bytearray()
+    stage_frames = 0
+    stage_windows = 0
+    stage_since_ms = 0.0
+    merge_buf: List[Dict[str, float]] = []
+    produced = sent = windows = 0
+    steps: List[Tuple[float, int]] = []
+    next_frame_ms = frame_period_ms
+
+    def write(data: bytes) -> None:
+        nonlocal fifo_bytes
+        fifo.append(bytearray(data))
+        fifo_bytes += len(data)
+        pacer.wrote(len(data))
+
+    def flush() -> None:
+        nonlocal stage, stage_frames, stage_windows, sent, windows
+        if not stage:
+            return
+        if limits.fifo_size - fifo_bytes < len(stage):
+            pacer.stall(stage_frames)
+        else:
+            write(bytes(stage))
+            sent += stage_frames
+            windows += stage_windows
+        stage = bytearray()
+        stage_frames = stage_windows = 0
+
+    announce_pending = False
+
+    def tick(now_ms: float) -> None:
+        nonlocal announce_pending
+        before = pacer.step
+        pacer.sample(int(now_ms * 1000), limits.fifo_size - fifo_bytes)
+        if not adaptive:
+            pacer.step = before
+        elif pacer.step != before:
+            if pacer.merge == 1:
+                merge_buf.clear()
+            steps.append((now_ms / 1000.0, pacer.step))
+            announce_pending = True
+        if announce_pending:
+            # Like announce_tx_state(): retried until it fits, with the current state.
+            flush()
+            packet = encode_tx_state(pacer, int(now_ms))
+            if limits.fifo_size - fifo_bytes >= len(packet):
+                write(packet)
+                announce_pending = False
+
+    total_ms = int(duration_s * 1000)
+    for now in range(1, total_ms + 1):
+        now_ms = float(now)
+        drained = host.drain(fifo, now_ms / 1000.0, 1e-3)
+        received += drained
+        fifo_bytes -= len(drained)
+        if stage_frames and now_ms - stage_since_ms >= limits.batch_ms:
+            flush()
+        tick(now_ms)
+        while next_frame_ms <= now_ms:
+            produced += 1
+            frame = {
+                "ts_ms": next_frame_ms,
+                "f_hz": 30000.0 + 0.001 * produced,
+                "tau_ms": frame_period_ms,
+                "v_uV": 600000 + produced,
+                "flags": FLAG_SETTLED,
+                "adc_fresh": 2,
+            }
+            next_frame_ms += frame_period_ms
+            tick(now_ms)
+            packet = encode_frame_packet(frame)
+            pacer.offer(len(packet))
+            merged_windows = 1
+            if pacer.merge > 1:
+                merge_buf.append(frame)
+                if len(merge_buf) < pacer.merge:
+                    continue
+                merged_windows = len(merge_buf)
+                packet = encode_frame_packet(merge_frames(merge_buf))
+                merge_buf.clear()
+            if len(stage) + len(packet) > 1024:
+                flush()
+            if not stage_frames:
+                stage_since_ms = now_ms
+            stage += packet
+            stage_frames += 1
+            stage_windows += merged_windows
+            if stage_frames >= pacer.batch:
+                flush()
+    return LinkResult(bytes(received), produced, sent, windows, pacer.dropped, steps, pacer)
+
+
+def parse_tx_line(line: str) -> Optional[Dict[str, object]]:
+    """Parse a CSV-mode ``#TX KEY=VALUE ...`` announcement."""
+
+    parts = line.strip().split()
+    if not parts or parts[0] != "#TX":
+        return None
+    record: Dict[str, object] = {}
+    for token in parts[1:]:
+        key, sep, value = token.partition("=")
+        if not sep:
+            continue
+        key = key.lower().replace("_bps", "_Bps")
+        record[key] = value if key == "level" else int(value)
+    return record
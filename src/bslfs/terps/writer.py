@@ -0,0 +1,207 @@
+from __future__ import annotations
+
+import csv
+import io
+import logging
+import os
+import queue
+import threading
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import TYPE_CHECKING, Dict, List, Optional, Sequence
+
+if TYPE_CHECKING:
+    from .processing import SampleRecord
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class _Metadata:
+    line: str
+
+
+@dataclass
+class _Flush:
+    done: threading.Event
+
+
+_STOP = object()
+
+
+class GroupCommitLogger:
+    """
+    Drop-in replacement for `CsvLogger` that moves serialisation and I/O off
+    the acquisition path. `append()` only enqueues; a background thread turns
+    queued samples into CSV text and commits them with a single `write()` once
+    `commit_rows` rows or `commit_interval_s` seconds have accumulated.
+
+    Durability is governed by `fsync_interval_s`: 0 syncs every commit, a
+    positive value syncs at most that often, and a negative value leaves
+    write-back to the kernel. Commits always end on a row boundary, so a crash
+    loses at most the uncommitted tail and never leaves a torn row behind.
+    """
+
+    def __init__(
+        self,
+        path: Path | str,
+        commit_rows: int = 256,
+        commit_interval_s: float = 1.0,
+        fsync_interval_s: float = 5.0,
+    ):
+        self.path = Path(path)
+        self.commit_rows = max(1, int(commit_rows))
+        self.commit_interval_s = max(0.0, float(commit_interval_s))
+        self.fsync_interval_s = float(fsync_interval_s)
+        self._queue: "queue.SimpleQueue[object]" = queue.SimpleQueue()
+        self._thread: Optional[threading.Thread] = None
+        self._start_lock = threading.Lock()
+        self._error: Optional[BaseException] = None
+        self._stats: Dict[str, int] = {
+            "rows": 0,
+            "commits": 0,
+            "bytes": 0,
+            "fsyncs": 0,
+        }
+
+    def append(self, sample: "SampleRecord") -> None:
+        self._ensure_thread()
+        self._queue.put(sample)
+
+    def append_batch(self, samples: Sequence["SampleRecord"]) -> None:
+        if not samples:
+            return
+        self._ensure_thread()
+        self._queue.put(list(samples))
+
+    def set_metadata(self, metadata: Dict[str, str]) -> None:
+        if not metadata:
+            return
+        line = "# " + " ".join(f"{key}={value}" for key, value in metadata.items())
+        self._ensure_thread()
+        self._queue.put(_Metadata(line))
+
+    def flush(self, timeout: Optional[float] = None) -> bool:
+        """Commit and fsync everything queued so far; returns False on timeout."""
+        if self._thread is None:
+            return True
+        done = threading.Event()
+        self._queue.put(_Flush(done))
+        return done.wait(timeout)
+
+    def close(self) -> None:
+        thread = self._thread
+        if thread is not None:
+            self._queue.put(_STOP)
+            thread.join()
+            self._thread = None
+        if self._error is not None:
+            error, self._error = self._error, None
+            raise OSError(f"Sample log writer failed for {self.path}") from error
+
+    def stats(self) -> Dict[str, int]:
+        return dict(self._stats)
+
+    def _ensure_thread(self) -> None:
+        if self._thread is not None:
+            return
+        with self._start_lock:
+            if self._thread is None:
+                self._thread = threading.Thread(
+                    target=self._run, name="terps-log-writer", daemon=True
+                )
+                self._thread.start()
+
+    def _run(self) -> None:
+        buffer = io.StringIO()
+        writer = csv.writer(buffer)
+        pending_metadata: List[str] = []
+        fd: Optional[int] = None
+        rows_pending = 0
+        deadline = 0.0
+        last_sync = time.monotonic()
+
+        def commit(force_sync: bool = False) -> None:
+            nonlocal rows_pending, last_sync
+            data = buffer.getvalue().encode("utf-8")
+            buffer.seek(0)
+            buffer.truncate()
+            rows = rows_pending
+            rows_pending = 0
+            if fd is None or self._error is not None:
+                return
+            try:
+                if data:
+                    view = memoryview(data)
+                    while view:
+                        written = os.write(fd, view)
+                        view = view[written:]
+                    self._stats["rows"] += rows
+                    self._stats["commits"] += 1
+                    self._stats["bytes"] += len(data)
+                now = time.monotonic()
+                interval = self.fsync_interval_s
+                if force_sync or (
+                    data and interval >= 0.0 and now - last_sync >= interval
+                ):
+                    _fdatasync(fd)
+                    self._stats["fsyncs"] += 1
+                    last_sync = now
+            except OSError as exc:
+                logger.error("Sample log write failed: %s", exc)
+                self._error = exc
+
+        while True:
+            timeout = None if rows_pending == 0 else max(0.0, deadline - time.monotonic())
+            try:
+                item = self._queue.get(timeout=timeout)
+            except queue.Empty:
+                commit()
+                continue
+
+            if isinstance(item, _Metadata):
+                if fd is None:
+                    pending_metadata.append(item.line)
+                else:
+                    buffer.write(item.line + "\n")
+                    commit()
+            elif isinstance(item, _Flush):
+                commit(force_sync=True)
+                item.done.set()
+            elif item is _STOP:
+                commit(force_sync=True)
+                if fd is not None:
+                    os.close(fd)
+                return
+            elif self._error is not None:
+                continue
+            else:
+                batch = item if isinstance(item, list) else [item]
+                if fd is None:
+                    try:
+                        fd = _open_log(self.path)
+                    except OSError as exc:
+                        logger.error("Cannot open sample log %s: %s", self.path, exc)
+                        self._error = exc
+                        continue
+                    for line in pending_metadata:
+                        buffer.write(line + "\n")
+                    pending_metadata.clear()
+                    writer.writerow(batch[0].__dict__.keys())
+                if rows_pending == 0:
+                    deadline = time.monotonic() + self.commit_interval_s
+                writer.writerows(sample.__dict__.values() for sample in batch)
+                rows_pending += len(batch)
+                if rows_pending >= self.commit_rows:
+                    commit()
+
+
+def _open_log(path: Path) -> int:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    return os.open(path, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o644)
+
+
+def _fdatasync(fd: int) -> None:
+    sync = getattr(os, "fdatasync", os.fsync)
+    sync(fd)
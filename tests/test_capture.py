@@ -0,0 +1,60 @@
+from __future__ import annotations
+
+import struct
+
+import numpy as np
+
+from bslfs.terps.capture import decode_edges, encode_edges, read_capture, residual_stats
+from bslfs.terps.frames import crc16_ccitt
+from bslfs.terps.sim import EdgeTraceSpec, quantize_us, synthetic_edge_times
+
+
+def _trace(**kwargs) -> np.ndarray:
+    spec = EdgeTraceSpec(seed=7, **kwargs)
+    return quantize_us(synthetic_edge_times(spec, 20000), offset_us=5_000_000)
+
+
+def test_capture_roundtrip_on_clean_carrier():
+    ts = _trace()
+    data, stats = encode_edges(ts)
+    assert stats.edges == len(ts)
+    assert stats.tokens8 == 1  # first period has no predictor
+    decoded = decode_edges(data, int(ts[0]), stats.edges)
+    assert np.array_equal(decoded, ts)
+    assert stats.bits_per_edge < 4.2
+    assert stats.ratio(8) > 14.0
+
+
+def test_capture_escapes_glitches_and_drift():
+    ts = _trace(freq_hz=1000.0, glitch_rate=0.01, drift_ppm_per_s=500.0)
+    data, stats = encode_edges(ts)
+    assert stats.tokens16 > 0  # glitch splits one period into a short and a long one
+    assert np.array_equal(decode_edges(data, int(ts[0]), stats.edges), ts)
+    summary = residual_stats(ts)
+    assert summary.token_share["4"] > 0.9
+    assert summary.max > 127
+
+
+def test_read_capture_pulls_crc_checked_chunks():
+    ts = _trace()
+    data, stats = encode_edges(ts)
+    status = (
+        f"OK ARMED=0 EDGES={stats.edges} MAX=0 BYTES={len(data)} FIRST_US={int(ts[0])} "
+        f"T4={stats.tokens4} T8={stats.tokens8} T16={stats.tokens16} T32={stats.tokens32} OVERFLOW=0"
+    )
+    commands = []
+
+    def executor(cmd: str, _timeout: float):
+        commands.append(cmd)
+        return ["OK", "END"] if cmd.startswith("CAPTURE.START") else [status, "END"]
+
+    def binary_executor(cmd: str, _timeout: float):
+        _, offset, length = cmd.split()
+        chunk = data[int(offset) : int(offset) + int(length)]
+        block = chunk + struct.pack("<H", crc16_ccitt(chunk))
+        return [f"OK OFFSET={offset} LEN={len(chunk)} BIN={len(block)}", "END"], block
+
+    decoded, header = read_capture(executor, binary_executor, 1.0, max_edges=stats.edges)
+    assert commands[0] == f"CAPTURE.START {stats.edges}"
+    assert header["EDGES"] == str(stats.edges)
+    assert np.array_equal(decoded, ts)
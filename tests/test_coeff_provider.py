@@ -13,9 +13,12 @@ from bslfs.terps.coeff import (
     EepromOverCdc,
     ManualOverride,
     RPS_EEPROM_SIZE,
+    parse_eeprom_block,
     parse_rps_eeprom,
+    read_eeprom_image,
 )
 from bslfs.terps.config import load_config
+from bslfs.terps.frames import crc16_ccitt
 
 
 def _make_eeprom_blob() -> bytes:
@@ -43,6 +46,11 @@ def _hex_lines_from_blob(blob: bytes) -> List[str]:
     return [hex_str[i : i + 64] for i in range(0, len(hex_str), 64)]
 
 
+def _binary_block_from_blob(blob: bytes, device: int = 0xA2) -> bytes:
+    body = struct.pack("<BBHHI", 1, device, 0, len(blob), 40000) + blob
+    return b"\x55\xEE" + body + crc16_ccitt(body).to_bytes(2, "little")
+
+
 def test_parse_rps_eeprom_big_endian() -> None:
     blob = _make_eeprom_blob()
     coeff = parse_rps_eeprom(blob, source="test", device_address=0xA0)
@@ -143,3 +151,38 @@ def test_coeff_manager_refresh_interval(monkeypatch) -> None:
     refreshed = manager.refresh(12.0)
     assert refreshed is None  # no change because data identical
     assert fetches == 2
+
+
+def test_parse_eeprom_block_roundtrip() -> None:
+    blob = bytes(range(256)) * 2
+    block = _binary_block_from_blob(blob)
+    data, header = parse_eeprom_block([f"OK DEV=0xA2 START=0x0000 LEN=512 BIN={len(block)}"], block)
+    assert data == blob
+    assert header["DEV"] == "0xA2"
+    assert header["BITRATE"] == "40000"
+
+    corrupted = bytearray(block)
+    corrupted[100] ^= 0x01
+    try:
+        parse_eeprom_block(["OK"], bytes(corrupted))
+    except ValueError as exc:
+        assert "CRC" in str(exc)
+    else:  # pragma: no cover - defensive
+        raise AssertionError("corrupted block accepted")
+
+
+def test_read_eeprom_image_falls_back_to_hex_dump() -> None:
+    blob = bytes(range(256)) * 2
+    commands: List[str] = []
+
+    def binary_executor(command: str, _timeout: float):
+        commands.append(command)
+        return ["ERR UNKNOWN_CMD", "END"], b""
+
+    def executor(command: str, _timeout: float) -> List[str]:
+        commands.append(command)
+        return ["OK DEV=0xA0 LEN=512", *_hex_lines_from_blob(blob), "END"]
+
+    data, header = read_eeprom_image(executor, binary_executor, 1.0)
+    assert data == blob
+    assert commands == ["EEPROM.READB 0 512", "EEPROM.DUMP 0 512"]
@@ -0,0 +1,85 @@
+from __future__ import annotations
+
+import numpy as np
+import pytest
+
+from bslfs.terps.config import SensorPoly
+from bslfs.terps.ctrl_out import (
+    ControlOutputModel,
+    OutputLatencySpec,
+    OutputScale,
+    output_latency_us,
+    poly_commands,
+    run_output_pipeline,
+    usb_round_trip_us,
+)
+from bslfs.terps.processing import PressureCalculator
+from bslfs.terps.sim import EdgeCounterModel, EdgeTraceSpec
+
+POLY = SensorPoly(X=30000.0, Y=500000.0, K=[[100.0, 1e-4, 0.0], [0.25, 0.0, 1e-9], [1e-5, 0.0, 0.0]])
+
+
+def test_scaling_limits_and_codes():
+    out = ControlOutputModel(OutputScale("FREQ", 29000.0, 31000.0, 0.1, 0.9), dac="MCP4921")
+    assert out.update(30000.0) == pytest.approx(0.5)
+    assert (out.pwm_code, out.dac_code) == (2048, 2048)
+    assert out.update(29500.0) == pytest.approx(0.3)
+    assert out.update(40000.0) == 0.9
+    assert out.update(0.0) == 0.1
+    assert (out.updates, out.clamped) == (4, 2)
+
+
+def test_invalid_windows_hold_or_go_to_fault_level():
+    hold = ControlOutputModel(OutputScale("FREQ", 0.0, 1.0, 0.2, 1.0))
+    # Nothing valid yet: the output sits at out_min.
+    assert hold.update(0.5, f_valid=False) == 0.2
+    assert hold.update(0.5) == pytest.approx(0.6)
+    assert hold.update(0.9, f_valid=False) is None
+    assert hold.level == pytest.approx(0.6)
+
+    safe = ControlOutputModel(OutputScale("PRESSURE", 0.0, 200.0, fault_level=0.0), poly=POLY)
+    assert safe.update(30000.0, 500000.0) == pytest.approx(0.5)
+    assert safe.update(30000.0, 500000.0, v_valid=False) == 0.0
+    assert safe.faults == 1
+    assert ControlOutputModel(OutputScale("OFF")).update(30000.0) is None
+
+
+def test_pressure_matches_host_calculator_and_upload_round_trips():
+    out = ControlOutputModel(OutputScale("PRESSURE", 0.0, 1000.0), poly=POLY)
+    calc = PressureCalculator(POLY)
+    for f, v in [(30000.0, 500000.0), (30123.5, 498765.0), (29876.0, 501234.0)]:
+        out.update(f, v)
+        assert out.level * 1000.0 == pytest.approx(calc.evaluate(f, v), rel=1e-6)
+
+    lines = poly_commands(POLY)
+    assert lines[0] == "OUT.POLY 3 3 30000.0 500000.0" and lines[-1] == "OUT.POLY.COMMIT"
+    assert all(len(line) < 128 for line in lines)
+    k = {(int(i), int(j)): float(val) for _, i, j, val in (line.split() for line in lines[1:-1])}
+    assert k == {(i, j): POLY.K[i][j] for i in range(3) for j in range(3)}
+    with pytest.raises(ValueError):
+        poly_commands(SensorPoly(X=0.0, Y=0.0, K=[[0.0]] * 9))
+
+
+def test_pipeline_tracks_windows_within_budget():
+    edges = EdgeTraceSpec(freq_hz=30000.0, jitter_s=20e-9, drift_ppm_per_s=20.0, seed=4)
+    # The counter reports pulses / span, so 300-pulse windows read ~0.3 % high.
+    out = ControlOutputModel(OutputScale("FREQ", 30090.0, 30130.0))
+    latency = OutputLatencySpec(adc_rate_sps=1000.0)
+    trace = run_output_pipeline(edges, 600_000, EdgeCounterModel(False, 300), out, latency, seed=5)
+    assert len(trace.end_us) > 1500
+    np.testing.assert_allclose(trace.level, np.clip((trace.freq_hz - 30090.0) / 40.0, 0.0, 1.0))
+    assert trace.level[-1] > trace.level[0]
+    assert trace.percentile(99) < latency.budget_us
+    assert trace.percentile(99, effective=False) < trace.percentile(99)
+
+    rng = np.random.default_rng(6)
+    assert np.percentile(usb_round_trip_us(5000, rng), 50) > 20 * trace.percentile(99)
+
+
+def test_dac_and_surface_costs_stay_in_budget():
+    rng = np.random.default_rng(7)
+    spec = OutputLatencySpec(pwm_bits=None, dac="DAC8551", poly_terms=64)
+    measured, effective = output_latency_us(spec, 20000, rng)
+    np.testing.assert_array_equal(measured, effective)
+    assert measured.min() > spec.dac_write_us
+    assert np.percentile(effective, 99) < spec.budget_us
@@ -0,0 +1,53 @@
+from __future__ import annotations
+
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+from bslfs.data import load_calibration_csv
+from bslfs.fastcsv import read_csv_columns
+from bslfs.terps.processing import CsvLogger, SampleRecord
+
+
+def _write_log(path: Path, rows: int, switch_at: int) -> None:
+    logger = CsvLogger(path)
+    logger.set_metadata({"coeff_source": "config", "unit": "Pa"})
+    for idx in range(rows):
+        if idx == switch_at:
+            logger.set_metadata({"coeff_source": "eeprom"})
+        logger.append(
+            SampleRecord(idx * 100.0, 30000.0 + idx * 1e-4, 100.0, 600000.0 + idx, 101325.5, 16, idx % 16, 0.25, "RECIP")
+        )
+    logger.close()
+
+
+def test_chunked_reader_matches_pandas_and_keeps_metadata(tmp_path: Path) -> None:
+    path = tmp_path / "log.csv"
+    _write_log(path, rows=6000, switch_at=3333)
+    table = read_csv_columns(path, chunk_bytes=64 * 1024, workers=3)
+    reference = pd.read_csv(path, comment="#")
+    assert len(table) == len(reference) == 6000
+    for name in reference.columns:
+        assert np.array_equal(table.columns[name], reference[name].to_numpy()), name
+    assert table.columns["flags"].dtype.kind == "i"
+    assert table.metadata == [
+        (0, {"coeff_source": "config", "unit": "Pa"}),
+        (3333, {"coeff_source": "eeprom"}),
+    ]
+
+
+def test_reader_column_subset_and_calibration_loader(tmp_path: Path) -> None:
+    path = tmp_path / "log.csv"
+    _write_log(path, rows=10, switch_at=5)
+    table = read_csv_columns(path, usecols=["ts_ms", "pressure"])
+    assert list(table.columns) == ["ts_ms", "pressure"]
+
+    calib = tmp_path / "calib.csv"
+    calib.write_text(
+        "# rig=bench1\npressure_ref,output,cycle_id\n0,1.0,1\n50,2.0,1\n100,3.0,1\n",
+        encoding="utf-8",
+    )
+    data = load_calibration_csv(calib)
+    assert data.fs_pressure == 100.0
+    assert list(data.cycle_id) == ["1", "1", "1"]
@@ -69,3 +69,70 @@ def test_binary_frame_length_error():
     assert len(frames) == 1
     stats = parser.stats()
     assert stats["frames"] == 1
+
+
+def seq_stream(count: int, first_seq: int = 0) -> list:
+    packets = []
+    for i in range(count):
+        body = build_body(ts=i) + (0xFFFFFFFF).to_bytes(4, "little") + bytes([1])
+        packets.append(build_packet(body + ((first_seq + i) & 0xFFFF).to_bytes(2, "little")))
+    return packets
+
+
+def test_corrupted_length_costs_only_its_packet():
+    packets = seq_stream(10)
+    bad = bytearray(packets[3])
+    bad[2] = 0xFF  # 0xAA frames are never 255 bytes: rejected without waiting for the tail
+    stream = b"".join(packets[:3]) + bytes(bad) + b"".join(packets[4:])
+    parser = FrameParser(FrameFormat.BINARY)
+    frames = feed(parser, stream)
+    assert [f.seq for f in frames] == [0, 1, 2, 4, 5, 6, 7, 8, 9]
+    stats = parser.stats()
+    assert (stats["length_errors"], stats["resyncs"], stats["lost_frames"]) == (1, 1, 1)
+    assert stats["lost_bytes"] == len(packets[3])
+
+
+def test_crc_failure_rescans_inside_the_packet():
+    packets = seq_stream(6)
+    bad = bytearray(packets[2])
+    bad[10] ^= 0x04
+    # A stray magic+type inside the damaged frame must not swallow the next packet either.
+    bad[12:14] = b"\x55\xAA"
+    parser = FrameParser(FrameFormat.BINARY)
+    frames = feed(parser, b"".join(packets[:2]) + bytes(bad) + b"".join(packets[3:]))
+    assert [f.seq for f in frames] == [0, 1, 3, 4, 5]
+    stats = parser.stats()
+    assert stats["crc_errors"] >= 1
+    assert (stats["lost_bytes"], stats["lost_frames"]) == (len(packets[2]), 1)
+
+
+def test_seq_gaps_wrap_and_restart():
+    packets = seq_stream(3, first_seq=0xFFFE)  # 0xFFFE, 0xFFFF, 0
+    packets += seq_stream(2, first_seq=3)  # skips 1, 2
+    packets += seq_stream(1, first_seq=0)  # device restarted
+    parser = FrameParser(FrameFormat.BINARY)
+    assert len(feed(parser, b"".join(packets))) == 6
+    stats = parser.stats()
+    assert (stats["lost_frames"], stats["seq_resets"], stats["lost_bytes"]) == (2, 1, 0)
+
+
+def test_random_bit_errors_recover_every_intact_frame():
+    import random
+
+    rng = random.Random(7)
+    packets = seq_stream(3000)
+    size = len(packets[0])
+    stream = bytearray(b"".join(packets))
+    damaged = set()
+    for _ in range(60):
+        # Keep the first and last frame intact so every loss sits between two seq values.
+        bit = rng.randrange(size * 8, (len(stream) - size) * 8)
+        stream[bit // 8] ^= 1 << (bit % 8)
+        damaged.add(bit // 8 // size)
+    parser = FrameParser(FrameFormat.BINARY)
+    chunks = [bytes(stream[i : i + 64]) for i in range(0, len(stream), 64)]
+    frames = list(parser.parse_binary(chunks))
+    assert [f.seq for f in frames] == [i for i in range(len(packets)) if i not in damaged]
+    stats = parser.stats()
+    assert stats["lost_frames"] == len(damaged)
+    assert stats["lost_bytes"] == len(damaged) * size
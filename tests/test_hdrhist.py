@@ -0,0 +1,112 @@
+import struct
+
+import numpy as np
+import pytest
+
+from bslfs.terps.frames import crc16_ccitt
+from bslfs.terps.hdrhist import (
+    LogLinearHistogram,
+    bucket_count,
+    bucket_index,
+    bucket_lower,
+    bucket_width,
+    histogram_csv_column,
+    parse_firmware_export,
+    read_firmware_hist,
+)
+
+
+def _reference_bucket(mag: int, precision: int) -> int:
+    length = mag.bit_length()
+    if length <= precision:
+        return mag
+    shift = length - precision
+    return shift * (1 << (precision - 1)) + (mag >> shift)
+
+
+def test_bucket_layout_matches_firmware_rule_and_covers_u32():
+    precision = 6
+    mags = np.array([0, 1, 63, 64, 65, 127, 128, 1000, 123456, 2**31, 2**32 - 1], dtype=np.int64)
+    idx = bucket_index(mags, precision)
+    assert list(idx) == [_reference_bucket(int(m), precision) for m in mags]
+    assert int(idx.max()) == bucket_count(precision) - 1
+    lower = bucket_lower(idx, precision)
+    width = bucket_width(idx, precision)
+    assert np.all(lower <= mags)
+    assert np.all(mags < lower + width)
+    wide = width > 1
+    assert np.all(width[wide] <= lower[wide] * 2.0**-(precision - 1))
+
+
+@pytest.mark.parametrize("precision", [4, 6, 8])
+def test_quantiles_within_relative_error(precision):
+    rng = np.random.default_rng(5)
+    values = np.concatenate([rng.lognormal(8.0, 2.0, 20000), -rng.lognormal(5.0, 1.0, 5000)])
+    hist = LogLinearHistogram(precision, unit=1.0)
+    hist.record(values)
+    ints = np.sort(np.rint(values))
+    for q in (0.01, 0.1, 0.5, 0.9, 0.99, 0.999):
+        rank = max(int(q * ints.size + 0.5), 1)
+        exact = ints[rank - 1]
+        assert abs(hist.quantile(q) - exact) <= abs(exact) * hist.relative_error + 0.5
+    assert hist.min == ints[0]
+    assert hist.max == ints[-1]
+
+
+def test_merge_equals_single_pass_and_json_roundtrip(tmp_path):
+    rng = np.random.default_rng(9)
+    a = rng.normal(0.0, 50.0, 3000)
+    b = rng.normal(10.0, 500.0, 4000)
+    whole = LogLinearHistogram(6, unit=0.01)
+    whole.record(np.concatenate([a, b]))
+    left = LogLinearHistogram(6, unit=0.01)
+    left.record(a)
+    right = LogLinearHistogram(6, unit=0.01)
+    right.record(b)
+    path = tmp_path / "right.json"
+    right.save(path)
+    left.merge(LogLinearHistogram.load(path))
+    assert left.count == whole.count
+    assert np.array_equal(left.pos, whole.pos)
+    assert np.array_equal(left.neg, whole.neg)
+    assert left.quantiles([0.5, 0.99]) == whole.quantiles([0.5, 0.99])
+    with pytest.raises(ValueError):
+        left.merge(LogLinearHistogram(5, unit=0.01))
+
+
+def test_parse_firmware_export_and_crc():
+    values = [-300, -3, 0, 0, 5, 70, 70, 4000]
+    host = LogLinearHistogram(6)
+    host.record(values)
+    block = bytearray()
+    for index in range(host.pos.size):
+        if host.neg[index]:
+            block += struct.pack("<HI", index | 0x8000, int(host.neg[index]))
+        if host.pos[index]:
+            block += struct.pack("<HI", index, int(host.pos[index]))
+    header = f"OK SERIES=F P=6 N={len(values)} MIN=-300 MAX=4000 ENTRIES={len(block) // 6} BIN={len(block) + 2}"
+    reply = bytes(block) + struct.pack("<H", crc16_ccitt(bytes(block)))
+
+    hist, status = read_firmware_hist(lambda cmd, tmo: ([header], reply), "F", 1.0, unit=1e-4)
+    assert status["SERIES"] == "F"
+    assert np.array_equal(hist.pos, host.pos)
+    assert np.array_equal(hist.neg, host.neg)
+    assert hist.quantile(0.5) == pytest.approx(host.quantile(0.5) * 1e-4)
+
+    with pytest.raises(ValueError):
+        read_firmware_hist(lambda cmd, tmo: ([header], reply[:-1] + b"\x00"), "F", 1.0)
+    with pytest.raises(ValueError):
+        parse_firmware_export({"P": "6", "N": "99"}, bytes(block))
+
+
+def test_histogram_csv_column_streams_deltas(tmp_path):
+    path = tmp_path / "log.csv"
+    pressure = np.cumsum(np.full(5000, 0.25)) + 100.0
+    path.write_text("ts_ms,pressure\n" + "".join(f"{i},{p}\n" for i, p in enumerate(pressure)))
+    hist = LogLinearHistogram(6, unit=0.01)
+    rows = histogram_csv_column([path], "pressure", hist, diff=True)
+    assert rows == pressure.size
+    assert hist.count == pressure.size - 1
+    assert hist.quantile(0.5) == pytest.approx(0.25)
+    with pytest.raises(ValueError):
+        histogram_csv_column([path], "missing", LogLinearHistogram())
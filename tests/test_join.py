@@ -0,0 +1,113 @@
+from __future__ import annotations
+
+import io
+import math
+
+import numpy as np
+import pytest
+
+from bslfs.terps.join import ClockMapper, JoinedCsvWriter, StreamJoiner, join_logs
+from bslfs.terps.sim import DeviceStreamSpec, synthetic_device_stream
+
+
+def _signal(t: np.ndarray) -> np.ndarray:
+    return 101325.0 + 40.0 * np.sin(2.0 * np.pi * 0.2 * t)
+
+
+def _interleave(streams):
+    """Yield (device, batch slice) in host arrival order, one USB batch at a time."""
+    events = []
+    for dev, (ts, arrival, pressure) in enumerate(streams):
+        for end in np.flatnonzero(np.diff(np.append(arrival, np.inf)) != 0):
+            events.append((arrival[end], dev, end))
+    events.sort()
+    starts = [0] * len(streams)
+    for when, dev, end in events:
+        ts, _, pressure = streams[dev]
+        yield dev, ts[starts[dev] : end + 1], pressure[starts[dev] : end + 1], float(when)
+        starts[dev] = end + 1
+
+
+def test_clock_mapper_recovers_offset_and_skew():
+    spec = DeviceStreamSpec(clock_offset_ms=123456.0, skew_ppm=80.0, delay_ms=1.0, delay_jitter_ms=2.0, seed=1)
+    ts, arrival, _ = synthetic_device_stream(spec, 60.0, _signal)
+    mapper = ClockMapper()
+    for end in range(7, ts.size, 8):
+        mapper.observe(ts[end], arrival[end])
+    assert mapper.skew_ppm == pytest.approx(80.0, abs=10.0)
+    true_ms = (ts[-1] - 123456.0) / (1 + 80e-6)
+    assert mapper.to_host(np.array([ts[-1]]))[0] == pytest.approx(true_ms, abs=2.0)
+
+
+@pytest.mark.parametrize("mode", ["interpolate", "window"])
+def test_joined_differential_pressure_is_coherent(mode):
+    specs = [
+        DeviceStreamSpec(clock_offset_ms=5000.0 * dev, skew_ppm=(-40.0, 0.0, 60.0)[dev], pressure_offset=10.0 * dev, seed=dev)
+        for dev in range(3)
+    ]
+    streams = [synthetic_device_stream(spec, 30.0, _signal) for spec in specs]
+    joiner = StreamJoiner(["a", "b", "c"], period_ms=20.0, mode=mode, max_lateness_ms=500.0)
+    records = []
+    for dev, ts, pressure, when in _interleave(streams):
+        records.extend(joiner.push(dev, ts, pressure, arrival_ms=when))
+    records.extend(joiner.flush())
+    stats = joiner.stats()
+    assert stats["late"] == 0
+    assert stats["overflow"] == 0
+    complete = [r for r in records if r.complete][50:]  # skip clock warm-up
+    assert len(complete) > 1000
+    diff_ab = np.array([r.values[1] - r.values[0] for r in complete])
+    diff_ac = np.array([r.values[2] - r.values[0] for r in complete])
+    # Peak slope is ~50 Pa/s, so a few ms of residual misalignment stays well under 1 Pa.
+    assert np.median(diff_ab) == pytest.approx(10.0, abs=0.5)
+    assert np.median(diff_ac) == pytest.approx(20.0, abs=0.5)
+    assert np.percentile(np.abs(diff_ac - 20.0), 99) < 1.5
+    assert stats["latency_ms_max"] < 500.0
+
+
+def test_stalled_device_is_bounded_by_lateness_and_late_samples_are_dropped():
+    joiner = StreamJoiner(["a", "b"], period_ms=10.0, max_lateness_ms=100.0, max_buffer=64, map_clock=False)
+    t = np.arange(0.0, 1000.0, 10.0)
+    joiner.push(1, t[:5], np.ones(5))
+    emitted = joiner.push(0, t, np.zeros(t.size))
+    assert emitted, "ticks beyond the lateness bound must be forced out"
+    assert emitted[-1].ts_ms >= t[-1] - 100.0 - 10.0
+    assert any(not r.complete and math.isnan(r.values[1]) for r in emitted)
+    assert joiner.stats()["max_buffered"] <= 2 * 64
+    joiner.push(1, t[5:20], np.ones(15))
+    assert joiner.stats()["late"] == 15
+    assert joiner.stats()["overflow"] > 0
+
+
+def test_window_mode_weights_by_overlap():
+    joiner = StreamJoiner(["a"], period_ms=10.0, mode="window", map_clock=False)
+    # Two 7.5 ms gates: [2.5,10) at 1.0 and [12.5,20) at 3.0, plus one to close tick 20.
+    records = joiner.push(0, [10.0, 20.0, 30.0], [1.0, 3.0, 5.0], tau_ms=[7.5, 7.5, 7.5])
+    assert [r.ts_ms for r in records] == [10.0, 20.0, 30.0]
+    assert records[1].values[0] == pytest.approx(3.0)
+    joiner = StreamJoiner(["a"], period_ms=10.0, mode="window", map_clock=False)
+    records = joiner.push(0, [5.0, 15.0, 25.0], [1.0, 3.0, 5.0])
+    # Contiguous coverage [5,15) at 3.0 overlaps tick 20's window [10,20) by 5 ms, [15,25) by 5 ms.
+    assert records[-1].ts_ms == 20.0
+    assert records[-1].values[0] == pytest.approx(4.0)
+
+
+def test_join_logs_writes_joined_csv(tmp_path):
+    paths = []
+    for dev in range(2):
+        path = tmp_path / f"dev{dev}.csv"
+        ts = np.arange(0.0, 5000.0, 10.0) + 3.0 * dev
+        rows = "".join(f"{t},{100.0 + dev + t / 1000.0},0\n" for t in ts)
+        path.write_text("ts_ms,pressure,flags\n" + rows)
+        paths.append(path)
+    joiner = StreamJoiner(["a", "b"], period_ms=50.0, map_clock=False, max_lateness_ms=math.inf)
+    out = io.StringIO()
+    writer = JoinedCsvWriter(out, joiner.devices)
+    for records in join_logs(paths, joiner):
+        writer.write(records)
+    lines = out.getvalue().splitlines()
+    assert lines[0] == "ts_ms,pressure.a,pressure.b,flags.a,flags.b,present"
+    assert len(lines) > 90
+    ts, a, b = (float(v) for v in lines[10].split(",")[:3])
+    assert b - a == pytest.approx(1.0)
+    assert a == pytest.approx(100.0 + ts / 1000.0)
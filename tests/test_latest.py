@@ -0,0 +1,98 @@
+from typing import Iterator, List, Sequence
+
+import numpy as np
+
+WORDS = 6
+
+
+class SeqLatch:
+    """Model of `latest.cpp`: publish() and read() yield after every shared word access."""
+
+    def __init__(self, words: int):
+        self.seq = 0
+        self.copies: List[List[int]] = [[0] * words, [0] * words]
+        self.retries = 0
+
+    def publish(self, record: Sequence[int]) -> Iterator[None]:
+        seq = self.seq
+        self.seq = seq + 1
+        yield
+        for i, word in enumerate(record):
+            self.copies[0][i] = word
+            yield
+        self.seq = seq + 2
+        yield
+        for i, word in enumerate(record):
+            self.copies[1][i] = word
+            yield
+
+    def read(self, out: List[int]) -> Iterator[None]:
+        seq = self.seq
+        yield
+        while True:
+            copy = self.copies[seq & 1]
+            for i in range(len(out)):
+                out[i] = copy[i]
+                yield
+            again = self.seq
+            yield
+            if again == seq:
+                return
+            seq = again
+            self.retries += 1
+
+
+def _record(k: int):
+    return [k] * WORDS
+
+
+def _interleave(latch: SeqLatch, n_publish: int, n_readers: int, rng: np.random.Generator):
+    """Run a writer and readers under a random schedule; returns every completed read."""
+
+    writer = iter(())
+    published = 0
+    readers = [None] * n_readers
+    buffers = [[0] * WORDS for _ in range(n_readers)]
+    reads = []
+    while published < n_publish or any(r is not None for r in readers):
+        actor = int(rng.integers(0, n_readers + 1))
+        if actor == n_readers:
+            if next(writer, StopIteration) is StopIteration and published < n_publish:
+                published += 1
+                writer = latch.publish(_record(published))
+            continue
+        if readers[actor] is None:
+            if published < n_publish:
+                readers[actor] = latch.read(buffers[actor])
+            continue
+        if next(readers[actor], StopIteration) is StopIteration:
+            reads.append((actor, list(buffers[actor])))
+            readers[actor] = None
+    return reads
+
+
+def test_reads_are_never_torn_and_never_go_back():
+    rng = np.random.default_rng(11)
+    latch = SeqLatch(WORDS)
+    reads = _interleave(latch, 400, 3, rng)
+    assert len(reads) > 100
+    last = {}
+    for actor, record in reads:
+        assert len(set(record)) == 1, record
+        assert record[0] >= last.get(actor, 0)
+        last[actor] = record[0]
+    # The schedule publishes as fast as it reads, so the retry path is exercised.
+    assert latch.retries > 0
+
+
+def test_reader_preempting_the_writer_never_retries():
+    # An IRQ on the writer's core runs a whole read between two writer steps.
+    latch = SeqLatch(WORDS)
+    for k in range(1, 20):
+        writer = latch.publish(_record(k))
+        for _ in writer:
+            out = [0] * WORDS
+            for _ in latch.read(out):
+                pass
+            assert out in (_record(k - 1), _record(k))
+    assert latch.retries == 0
@@ -0,0 +1,71 @@
+from __future__ import annotations
+
+import json
+
+import pytest
+
+from bslfs.terps.config import SensorPoly
+from bslfs.terps.noise_model import (
+    AcquisitionSpec,
+    choose_presets,
+    predict,
+    predict_all,
+    sensitivities,
+    to_preset,
+    validate_candidate,
+)
+from bslfs.terps.runner import preset_overrides
+
+
+@pytest.mark.parametrize(
+    "mode,tau_ms,resolution_s,jitter_s",
+    [
+        ("GATED", 50.0, 1e-6, 20e-9),
+        ("RECIP", 20.0, 1e-6, 20e-9),
+        ("RECIP", 50.0, 1e-7, 20e-9),
+        ("DUAL", 20.0, 1e-6, 300e-9),
+    ],
+)
+def test_prediction_matches_simulator(mode: str, tau_ms: float, resolution_s: float, jitter_s: float) -> None:
+    spec = AcquisitionSpec(ts_resolution_s=resolution_s, jitter_s=jitter_s)
+    prediction = predict(spec, mode, tau_ms)
+    simulated = validate_candidate(spec, prediction, windows=80)
+    assert simulated == pytest.approx(prediction.freq_noise_hz, rel=0.3)
+
+
+def test_recip_beats_gated_and_dual_beats_recip() -> None:
+    spec = AcquisitionSpec()
+    gated, recip, dual = (predict(spec, mode, 100.0) for mode in ("GATED", "RECIP", "DUAL"))
+    assert recip.freq_noise_hz < gated.freq_noise_hz / 10
+    assert dual.freq_noise_hz == pytest.approx(recip.freq_noise_hz / 2**0.5, rel=0.01)
+    assert gated.latency_ms < recip.latency_ms
+
+
+def test_pressure_noise_combines_both_channels() -> None:
+    poly = SensorPoly(X=30000.0, Y=600000.0, K=[[0.0, 0.002], [3.0, 0.0]])
+    dp_df, dp_dv = sensitivities(poly)
+    assert (dp_df, dp_dv) == pytest.approx((3.0, 0.002))
+    spec = AcquisitionSpec(dp_df=dp_df, dp_dv=dp_dv, adc_rate_sps=20.0, adc_noise_uV=4.0)
+    prediction = predict(spec, "RECIP", 200.0)
+    assert prediction.conversions == 4
+    assert prediction.diode_noise_uV == pytest.approx(2.0)
+    expected = ((3.0 * prediction.freq_noise_hz) ** 2 + (0.002 * 2.0) ** 2) ** 0.5
+    assert prediction.pressure_noise == pytest.approx(expected)
+    locked = predict(AcquisitionSpec(dp_df=3.0, pps_locked=True), "RECIP", 200.0)
+    assert locked.timebase_bias < prediction.timebase_bias / 100
+
+
+def test_presets_pick_lowest_latency_meeting_target() -> None:
+    spec = AcquisitionSpec(dp_df=1.0)
+    predictions = predict_all(spec)
+    chosen = choose_presets(predictions, targets=[0.05, 1e-6], max_latency_ms=1000.0)
+    assert set(chosen) == {"plan_0.05"}
+    best = chosen["plan_0.05"]
+    assert best.pressure_noise <= 0.05
+    assert all(p.latency_ms >= best.latency_ms for p in predictions if p.pressure_noise <= 0.05)
+
+    presets = {name: to_preset(spec, prediction) for name, prediction in chosen.items()}
+    presets = json.loads(json.dumps(presets))
+    overrides = preset_overrides("plan_0.05", presets)
+    assert f"mode={best.mode}" in overrides
+    assert f"tau_ms={best.tau_ms}" in overrides
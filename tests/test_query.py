@@ -0,0 +1,57 @@
+from __future__ import annotations
+
+import os
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+from bslfs.terps.processing import CsvLogger, SampleRecord
+from bslfs.terps.query import LogIndex, QuerySpec, build_index, load_index, run_query
+
+
+def _write_log(path: Path, ts_start: float, rows: int) -> None:
+    logger = CsvLogger(path)
+    logger.set_metadata({"coeff_source": "config"})
+    for idx in range(rows):
+        ts = ts_start + 100.0 * idx
+        flags = 4 if (ts // 200_000) % 2 == 0 else 0  # PPS lock toggles every 200 s
+        logger.append(SampleRecord(ts, 30000.0, 100.0, 600000.0, 1000.0 + idx % 7, 16, flags, 0.0, "RECIP"))
+    logger.close()
+
+
+def test_query_matches_pandas_and_skips_chunks(tmp_path: Path) -> None:
+    paths = [tmp_path / "a.csv", tmp_path / "b.csv"]
+    _write_log(paths[0], 0.0, 4000)
+    _write_log(paths[1], 400_000.0, 4000)
+    for path in paths:
+        build_index(path, chunk_bytes=64 * 1024)
+        assert LogIndex.sidecar(path).exists()
+
+    spec = QuerySpec(fields=("pressure",), ts_from=100_000.0, ts_to=700_000.0, require_flags=4, bucket_ms=100_000.0)
+    result, stats = run_query(paths, spec, workers=2)
+
+    frame = pd.concat(pd.read_csv(path, comment="#") for path in paths)
+    mask = (frame["ts_ms"] >= 100_000) & (frame["ts_ms"] < 700_000) & ((frame["flags"] & 4) == 4)
+    expected = frame[mask].groupby((frame["ts_ms"][mask] // 100_000) * 100_000)["pressure"].agg(
+        ["count", "mean", "min", "max"]
+    )
+    assert result["bucket"].tolist() == expected.index.tolist()
+    assert result["count"].tolist() == expected["count"].tolist()
+    assert np.allclose(result["pressure_mean"], expected["mean"])
+    assert result["pressure_min"].tolist() == expected["min"].tolist()
+    assert result["pressure_max"].tolist() == expected["max"].tolist()
+    assert stats.chunks_scanned < stats.chunks_total
+    assert stats.rows_matched == int(mask.sum())
+
+
+def test_stale_index_is_rebuilt(tmp_path: Path) -> None:
+    path = tmp_path / "log.csv"
+    _write_log(path, 0.0, 100)
+    first = load_index(path)
+    _write_log(path, 0.0, 200)
+    os.utime(path, ns=(first.mtime_ns + 1_000_000, first.mtime_ns + 1_000_000))
+    second = load_index(path)
+    assert sum(chunk.rows for chunk in second.chunks) == 200
+    result, _ = run_query([path], QuerySpec(fields=("pressure", "diode_uV")))
+    assert result["count"].tolist() == [200]
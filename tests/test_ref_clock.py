@@ -0,0 +1,80 @@
+from fractions import Fraction
+
+import numpy as np
+import pytest
+
+from bslfs.terps.sim import (
+    ClockSpec,
+    EdgeTraceSpec,
+    RefCounterExtender,
+    ref_ratio_x1e4,
+    run_ref_counter,
+)
+
+
+def test_ratio_is_exact_integer_rounding():
+    rng = np.random.default_rng(3)
+    for _ in range(2000):
+        periods = int(rng.integers(1, 2_000_000))
+        cycles = int(rng.integers(1, 2**40))
+        ref_hz = int(rng.integers(1_000_000, 50_000_000))
+        exact = Fraction(periods * ref_hz * 10000, cycles)
+        got = ref_ratio_x1e4(periods, cycles, ref_hz)
+        if exact < 2**31 - 1:
+            assert abs(Fraction(got) - exact) <= Fraction(1, 2)
+    # 3000 periods of 30 kHz over 10 MHz: 1 000 000 cycles -> 30000.0000 Hz.
+    assert ref_ratio_x1e4(3000, 1_000_000, 10_000_000) == 300_000_000
+    assert ref_ratio_x1e4(2, 3, 10) == 66667
+    assert ref_ratio_x1e4(1, 20000, 1) == 1  # halves round up
+
+
+def test_extender_survives_wraps_and_stale_samples():
+    rng = np.random.default_rng(5)
+    true = np.cumsum(rng.integers(0, 30000, size=5000))
+    ext = RefCounterExtender()
+    for i, count in enumerate(true.tolist()):
+        assert ext.extend(count & 0xFFFF) == count
+        if i:
+            # An edge IRQ latched just before the previous sample but served after it.
+            stale = max(count - int(rng.integers(1, 2000)), int(true[i - 1]))
+            assert ext.extend(stale & 0xFFFF) == stale
+
+
+def _trace(**xtal):
+    return run_ref_counter(
+        EdgeTraceSpec(freq_hz=30000.123, jitter_s=20e-9, seed=1),
+        3000 * 30,
+        3000,
+        ref=ClockSpec(hz=10e6, ppm=0.002, phase=0.3),
+        xtal=ClockSpec(hz=1e6, **xtal),
+        seed=2,
+    )
+
+
+def test_ref_mode_ignores_a_drifting_pico_crystal():
+    trace = _trace(ppm=30.0, drift_ppm_per_s=2.0)
+    assert trace.ref_hz.size == 30
+    ref_err = (trace.ref_hz / trace.true_hz - 1.0) * 1e6
+    recip_err = (trace.recip_hz / trace.true_hz - 1.0) * 1e6
+    # 100 ms of 10 MHz resolves 1 ppm per window; the mean sits on the reference error.
+    assert abs(ref_err.mean()) < 0.3
+    assert ref_err.std() < 1.0
+    # The Pico timebase carries the crystal error and its drift straight into RECIP.
+    assert recip_err.mean() == pytest.approx(-33.0, abs=2.0)
+    assert np.polyfit(trace.t_s, recip_err, 1)[0] == pytest.approx(-2.0, abs=0.6)
+    assert abs(np.polyfit(trace.t_s, ref_err, 1)[0]) < 0.5
+
+
+def test_ref_mode_follows_the_reference_error():
+    # A reference that is itself 5 ppm fast makes every window read 5 ppm low,
+    # whatever the Pico crystal does.
+    trace = run_ref_counter(
+        EdgeTraceSpec(freq_hz=30000.123, jitter_s=20e-9, seed=1),
+        3000 * 20,
+        3000,
+        ref=ClockSpec(hz=10e6, ppm=5.0),
+        xtal=ClockSpec(hz=1e6, ppm=-50.0, drift_ppm_per_s=-3.0),
+        seed=4,
+    )
+    ref_err = (trace.ref_hz / trace.true_hz - 1.0) * 1e6
+    assert ref_err.mean() == pytest.approx(-5.0, abs=0.3)
@@ -0,0 +1,162 @@
+from __future__ import annotations
+
+import math
+import struct
+
+import numpy as np
+import pytest
+
+from bslfs.terps.frames import FrameFormat, FrameParser, crc16_ccitt
+from bslfs.terps.schedule import SlotScheduler, probe_device_clock
+
+
+class FakeClock:
+    def __init__(self, start: float):
+        self.now = start
+
+    def __call__(self) -> float:
+        return self.now
+
+
+class FakeDevice:
+    """Device timer = boot offset + (1 + skew) * host time, reached over a jittery link."""
+
+    def __init__(self, clock: FakeClock, offset_us: float, skew_ppm: float, seed: int = 1):
+        self.clock = clock
+        self.offset_us = offset_us
+        self.rate = 1.0 + skew_ppm * 1e-6
+        self.rng = np.random.default_rng(seed)
+        self.start_us = 0
+        self.period_q16 = 0
+        self.first_slot = 0
+        self.active = False
+        self.commands: list = []
+
+    def device_us(self, host_s: float) -> int:
+        return int(self.offset_us + host_s * 1e6 * self.rate)
+
+    def host_s(self, device_us: float) -> float:
+        return (device_us - self.offset_us) / self.rate / 1e6
+
+    def slot_start(self, slot: int) -> int:
+        # The firmware slot counter is a wrapping u32.
+        return self._start_of((slot - self.first_slot) % (1 << 32))
+
+    def _start_of(self, n: int) -> int:
+        # Fractional period: whole µs plus the accumulated carry of period_frac/65536.
+        return self.start_us + (n * self.period_q16 >> 16)
+
+    def execute(self, command: str, timeout: float):
+        self.commands.append(command)
+        # Request and reply legs each take 100-900 µs, asymmetrically.
+        self.clock.now += self.rng.uniform(100e-6, 900e-6)
+        now = self.device_us(self.clock.now)
+        self.clock.now += self.rng.uniform(100e-6, 900e-6)
+        name, *args = command.split()
+        if name == "TIME.NOW":
+            return [f"OK T_US={now}"]
+        if name == "SCHED.START":
+            start, period, slot, frac = (int(value) for value in args)
+            if start <= now:
+                return ["ERR PAST"]
+            self.start_us, self.period_q16, self.first_slot = start, (period << 16) + frac, slot
+            self.active = True
+        elif name == "SCHED.STOP":
+            self.active = False
+        n = 0
+        if self.active and now >= self.start_us:
+            n = ((now - self.start_us) << 16) // self.period_q16 + 1
+        return [
+            f"OK ACTIVE={int(self.active)} NEXT_US={self._start_of(n)} PERIOD_US={self.period_q16 >> 16} "
+            f"PERIOD_FRAC={self.period_q16 & 0xFFFF} SLOT={(self.first_slot + n) % (1 << 32)} NOW_US={now}"
+        ]
+
+
+def test_probe_picks_minimum_rtt_midpoint() -> None:
+    clock = FakeClock(1_700_000_000.0)
+    device = FakeDevice(clock, offset_us=-1.7e15 + 5e6, skew_ppm=0.0)
+    probe = probe_device_clock(device.execute, probes=16, clock=clock)
+    assert probe.rtt_us < 600.0
+    # The offset error is bounded by half the round trip.
+    assert abs(probe.offset_us - device.offset_us) <= probe.rtt_us / 2 + 1
+
+
+def test_start_aligns_first_slot_to_host_grid() -> None:
+    clock = FakeClock(1_700_000_000.123)
+    device = FakeDevice(clock, offset_us=-1.7e15 + 42e6, skew_ppm=30.0)
+    scheduler = SlotScheduler(device.execute, period_ms=100.0, clock=clock)
+    slot = scheduler.start()
+    assert device.active
+    assert device.first_slot == slot % (1 << 32)
+    host_start = device.host_s(device.start_us)
+    assert host_start > clock.now
+    assert abs(host_start - slot * 0.1) < 1e-3
+
+
+def test_resync_tracks_skew_over_a_day() -> None:
+    clock = FakeClock(1_700_000_000.0)
+    devices = [
+        FakeDevice(clock, offset_us=-1.7e15 + 3e6, skew_ppm=45.0, seed=2),
+        FakeDevice(clock, offset_us=-1.7e15 + 900e6, skew_ppm=-20.0, seed=3),
+    ]
+    schedulers = [
+        SlotScheduler(dev.execute, period_ms=100.0, resync_sec=60.0, tolerance_us=200.0, clock=clock)
+        for dev in devices
+    ]
+    for scheduler in schedulers:
+        scheduler.start()
+    worst = 0.0
+    for _ in range(24 * 60):
+        clock.now += 60.0
+        for dev, scheduler in zip(devices, schedulers):
+            scheduler.maybe_resync()
+            # Where does the device open a slot one second ahead of the host?
+            slot = int(clock.now // 0.1) + 10
+            worst = max(worst, abs(dev.host_s(dev.slot_start(slot)) - slot * 0.1))
+    assert worst < 1e-3
+    for dev, scheduler in zip(devices, schedulers):
+        assert scheduler.skew_ppm == pytest.approx((dev.rate - 1.0) * 1e6, abs=2.0)
+        # Skew is absorbed into the period, so the grid is rarely re-anchored.
+        assert scheduler.stats()["resyncs"] < 24 * 60 / 4
+
+
+def test_resync_restarts_after_device_reboot() -> None:
+    clock = FakeClock(1_700_000_000.0)
+    device = FakeDevice(clock, offset_us=-1.7e15, skew_ppm=10.0)
+    scheduler = SlotScheduler(device.execute, period_ms=50.0, resync_sec=30.0, clock=clock)
+    scheduler.start()
+    clock.now += 31.0
+    device.active = False
+    device.offset_us -= 1.7e9  # timer restarted
+    assert scheduler.maybe_resync()
+    assert device.active
+    slot = int(clock.now // 0.05) + 10
+    assert abs(device.host_s(device.slot_start(slot)) - slot * 0.05) < 1e-3
+
+
+def _binary_packet(body: bytes) -> bytes:
+    return b"\x55\xAA" + bytes([len(body)]) + body + crc16_ccitt(body).to_bytes(2, "little")
+
+
+def test_binary_frames_carry_slot() -> None:
+    legacy = struct.pack("<IiHiBBhB", 1000, 300000000, 100, 600000, 16, 0, 0, 0)
+    parser = FrameParser(FrameFormat.BINARY)
+    packets = (
+        _binary_packet(legacy)
+        + _binary_packet(legacy + struct.pack("<I", 123456))
+        + _binary_packet(legacy + struct.pack("<I", 0xFFFFFFFF))
+    )
+    frames = list(parser.parse_binary([packets]))
+    assert [frame.slot for frame in frames] == [-1, 123456, -1]
+    assert parser.stats()["length_errors"] == 0
+
+
+def test_csv_frames_carry_slot() -> None:
+    parser = FrameParser(FrameFormat.CSV)
+    lines = [
+        "ts_ms,f_hz,tau_ms,v_uV,adc_gain,flags,ppm_corr,mode,slot",
+        "1000,30000.0,100,600000.0,16,0,0.00,GATED,77",
+        "1100,30000.0,100,600000.0,16,0,0.00,GATED,-1",
+    ]
+    assert [frame.slot for frame in parser.parse_csv(lines)] == [77, -1]
+    assert not math.isnan(next(FrameParser(FrameFormat.CSV).parse_csv(lines[:2])).f_hz)
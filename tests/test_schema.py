@@ -0,0 +1,88 @@
+from __future__ import annotations
+
+import math
+import struct
+
+import pytest
+
+from bslfs.terps.frames import FrameFormat, FrameParser, crc16_ccitt
+from bslfs.terps.schema import (
+    BUILTIN_FRAME_SCHEMA,
+    FieldDesc,
+    FrameSchema,
+    SchemaError,
+    encode_schema_packet,
+    parse_schema_packet,
+)
+
+
+def packet(packet_type: int, body: bytes) -> bytes:
+    return b"\x55" + bytes([packet_type, len(body)]) + body + crc16_ccitt(body).to_bytes(2, "little")
+
+
+def test_schema_packet_round_trip() -> None:
+    payload = encode_schema_packet(BUILTIN_FRAME_SCHEMA)
+    # Same bytes the firmware table produces (see frame_schema_describe).
+    assert payload[:4] == bytes([1, 0xAA, 26, 11])
+    assert len(payload) == 134
+    parsed = parse_schema_packet(payload)
+    assert parsed.fields == BUILTIN_FRAME_SCHEMA.fields
+    assert parsed.payload_len == 26
+    with pytest.raises(SchemaError):
+        parse_schema_packet(payload[:-3])
+
+
+@pytest.mark.parametrize("length", [19, 23, 24])
+def test_generated_decoder_matches_legacy_layouts(length: int) -> None:
+    full = struct.pack("<IiHiBBhBIB", 5000, -300001234, 10, 600100, 16, 0x15, -731, 2, 0xFFFFFFFF, 3)
+    parser = FrameParser(FrameFormat.BINARY)
+    (frame,) = parser.parse_binary([packet(0xAA, full[:length])])
+    assert (frame.ts_ms, frame.f_hz, frame.tau_ms, frame.v_uV) == (5000.0, -30000.1234, 10.0, 600100.0)
+    assert (frame.adc_gain, frame.flags, frame.ppm_corr, frame.mode) == (16, 0x15, -7.31, "DUAL")
+    assert frame.slot == -1
+    assert frame.adc_fresh == (3 if length == 24 else -1)
+
+
+def test_announced_schema_adds_fields_and_record_types() -> None:
+    # A newer device: frame grows an unknown field 42 in the middle, plus a 0xB0 record type.
+    fields = list(BUILTIN_FRAME_SCHEMA.fields[:4])
+    fields.append(FieldDesc(42, 7, 14, 0, 0, "future"))
+    fields += [
+        FieldDesc(d.field_id, d.type_code, d.offset + 4, d.scale_exp, d.attr, d.name)
+        for d in BUILTIN_FRAME_SCHEMA.fields[4:10]
+    ]
+    frame_schema = FrameSchema(0xAA, 28, tuple(fields))
+    temp_schema = FrameSchema(
+        0xB0, 6, (FieldDesc(1, 5, 0, 0, 0, "ts_ms"), FieldDesc(2, 4, 4, -2, 0, "temp_c"))
+    )
+    records = []
+    parser = FrameParser(FrameFormat.BINARY, on_record=lambda t, r: records.append((t, r)))
+    body = struct.pack("<IiHif", 7, 300000000, 20, 1234, 1.5) + struct.pack("<BBhBIB", 8, 1, 0, 1, 17, 2)
+    stream = (
+        packet(0xA6, encode_schema_packet(frame_schema))
+        + packet(0xA6, encode_schema_packet(temp_schema))
+        + packet(0xAA, body)
+        + packet(0xB0, struct.pack("<Ih", 9, 2512))
+    )
+    frames = list(parser.parse_binary([stream[i : i + 5] for i in range(0, len(stream), 5)]))
+    assert len(frames) == 1
+    assert (frames[0].f_hz, frames[0].adc_gain, frames[0].slot, frames[0].adc_fresh) == (30000.0, 8, 17, 2)
+    assert records == [(0xB0, {"ts_ms": 9, "temp_c": 25.12})]
+    stats = parser.stats()
+    assert (stats["schema_packets"], stats["records"], stats["length_errors"]) == (2, 1, 0)
+    # The old 24-byte layout is no longer what this device sends.
+    assert list(parser.parse_binary([packet(0xAA, body[:24])])) == []
+    assert parser.stats()["length_errors"] == 1
+
+
+def test_missing_fields_take_defaults_and_bad_schema_is_ignored() -> None:
+    schema = FrameSchema(0xAA, 8, (FieldDesc(1, 5, 0, 0, 0, "ts_ms"), FieldDesc(2, 6, 4, -4, 0, "f_hz")))
+    parser = FrameParser(FrameFormat.BINARY)
+    overlapping = bytearray(encode_schema_packet(schema))
+    overlapping[4 + 6 + 5 + 2] = 2  # second field offset 4 -> 2
+    stream = packet(0xA6, bytes(overlapping)) + packet(0xA6, encode_schema_packet(schema))
+    stream += packet(0xAA, struct.pack("<Ii", 11, 12345))
+    (frame,) = parser.parse_binary([stream])
+    assert parser.stats()["schema_errors"] == 1
+    assert (frame.ts_ms, frame.f_hz, frame.mode, frame.slot) == (11.0, 1.2345, "UNKNOWN", -1)
+    assert math.isnan(frame.v_uV)
@@ -0,0 +1,84 @@
+from __future__ import annotations
+
+import socket
+import threading
+import time
+from pathlib import Path
+from typing import List
+
+import pytest
+
+from bslfs.terps.processing import SampleRecord
+from bslfs.terps.stream import SampleStreamServer, SubscriptionSpec, subscribe
+
+pytestmark = pytest.mark.skipif(not hasattr(socket, "AF_UNIX"), reason="needs Unix sockets")
+
+
+def _samples(start: int, count: int) -> List[SampleRecord]:
+    return [
+        SampleRecord(float(i), 30000.0 + i, 100.0, 600000.0, float(i), 16, 4 if i % 2 else 0, 0.0, "RECIP")
+        for i in range(start, start + count)
+    ]
+
+
+def _collect(path: Path, spec: SubscriptionSpec, expected: int, out: List[List[str]]) -> None:
+    rows: List[str] = []
+    for row in subscribe(path, spec, timeout=10.0):
+        rows.append(row)
+        if len(rows) == expected:
+            break
+    out.append(rows)
+
+
+def _wait_connected(server: SampleStreamServer, channels: int, clients: int) -> None:
+    deadline = time.monotonic() + 5.0
+    while time.monotonic() < deadline:
+        stats = server.stats()
+        if stats["channels"] == channels and stats["connected"] == clients:
+            return
+        time.sleep(0.01)
+    raise AssertionError(f"subscribers did not register: {server.stats()}")
+
+
+def test_fan_out_shares_identical_subscriptions(tmp_path: Path) -> None:
+    path = tmp_path / "samples.sock"
+    server = SampleStreamServer(path)
+    server.start()
+    raw = SubscriptionSpec(fields=("ts_ms", "pressure"))
+    locked = SubscriptionSpec(fields=("ts_ms",), require_flags=4, decimate=5)
+    mean = SubscriptionSpec(fields=("ts_ms", "pressure", "flags"), decimate=10, aggregate="mean")
+    specs = [raw] * 8 + [locked] * 8 + [mean] * 8
+    expected = {raw: 1000, locked: 100, mean: 100}
+    results: List[List[str]] = []
+    threads = [
+        threading.Thread(target=_collect, args=(path, spec, expected[spec], results)) for spec in specs
+    ]
+    try:
+        for thread in threads:
+            thread.start()
+        _wait_connected(server, channels=3, clients=len(specs))
+        for start in range(0, 1000, 50):
+            server.publish(_samples(start, 50))
+        for thread in threads:
+            thread.join(timeout=10.0)
+    finally:
+        server.close()
+
+    assert len(results) == len(specs)
+    raw_rows = [rows for rows in results if len(rows) == 1000]
+    assert len(raw_rows) == 8 and raw_rows[0][3] == "3.0,3.0"
+    locked_rows = [rows for rows in results if len(rows) == 100 and "," not in rows[0]]
+    assert len(locked_rows) == 8 and locked_rows[0][:3] == ["1.0", "11.0", "21.0"]
+    mean_rows = [rows for rows in results if len(rows) == 100 and rows[0].count(",") == 2]
+    assert len(mean_rows) == 8 and mean_rows[0][0] == "9.0,4.5,4"
+
+
+def test_bad_spec_is_rejected(tmp_path: Path) -> None:
+    path = tmp_path / "samples.sock"
+    server = SampleStreamServer(path)
+    server.start()
+    try:
+        with pytest.raises(ValueError, match="ERR unknown fields"):
+            next(subscribe(path, SubscriptionSpec(fields=("bogus",)), timeout=5.0))
+    finally:
+        server.close()
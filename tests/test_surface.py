@@ -0,0 +1,91 @@
+from __future__ import annotations
+
+import json
+import time
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+from bslfs.terps.config import SensorPoly
+from bslfs.terps.processing import PressureCalculator
+from bslfs.terps.surface import fit_surface, load_calibration
+
+TRUE_POLY = SensorPoly(
+    X=30000.0,
+    Y=600000.0,
+    K=[
+        [101325.0, -0.012, 2.0e-9],
+        [8.1, 3.0e-7, -1.0e-12],
+        [-2.3e-4, 1.5e-11, 0.0],
+        [4.0e-9, 0.0, 0.0],
+    ],
+)
+
+
+def _calibration(n: int, noise: float, seed: int = 4):
+    rng = np.random.default_rng(seed)
+    f = rng.uniform(28500.0, 31500.0, n)
+    v = rng.uniform(520000.0, 680000.0, n)
+    p = PressureCalculator(TRUE_POLY).evaluate_batch(f, v) + rng.normal(0.0, noise, n)
+    return f, v, p
+
+
+def test_lsq_recovers_known_surface() -> None:
+    f, v, p = _calibration(2000, noise=0.0)
+    fit = fit_surface(f, v, p, nx=3, ny=2, x_ref=TRUE_POLY.X, y_ref=TRUE_POLY.Y)
+    np.testing.assert_allclose(np.array(fit.sensor_poly.K), np.array(TRUE_POLY.K), rtol=1e-6, atol=1e-13)
+    assert fit.max_abs < 1e-6
+
+
+def test_fit_evaluates_like_pressure_calculator() -> None:
+    f, v, p = _calibration(5000, noise=0.5)
+    fit = fit_surface(f, v, p, nx=3, ny=2)
+    predicted = PressureCalculator(fit.sensor_poly).evaluate_batch(f, v)
+    np.testing.assert_allclose(p - predicted, fit.residuals, atol=1e-6)
+    assert fit.rms == pytest.approx(0.5, rel=0.1)
+    assert fit.condition < 1e3
+
+
+def test_minimax_lowers_worst_case_error() -> None:
+    rng = np.random.default_rng(9)
+    f, v, p = _calibration(20000, noise=0.0)
+    # Bounded, non-Gaussian error: least squares spreads it, minimax equalises it.
+    p = p + rng.uniform(-1.0, 1.0, p.size) ** 3 * 2.0
+    lsq = fit_surface(f, v, p, nx=2, ny=1)
+    minimax = fit_surface(f, v, p, nx=2, ny=1, method="minimax")
+    assert minimax.max_abs < lsq.max_abs
+    assert minimax.metadata["minimax_lower_bound"] <= minimax.max_abs
+
+
+def test_fit_handles_1e5_points_quickly() -> None:
+    f, v, p = _calibration(100_000, noise=0.2)
+    started = time.perf_counter()
+    fit_surface(f, v, p, nx=3, ny=2)
+    fit_surface(f, v, p, nx=3, ny=2, method="minimax")
+    assert time.perf_counter() - started < 1.0
+
+
+def test_rank_deficient_data_is_rejected() -> None:
+    f = np.full(100, 30000.0)
+    v = np.linspace(5e5, 6e5, 100)
+    with pytest.raises(ValueError):
+        fit_surface(f, v, v * 0.1, nx=2, ny=1)
+
+
+def test_config_round_trip(tmp_path: Path) -> None:
+    f, v, p = _calibration(500, noise=0.0)
+    csv = tmp_path / "cal.csv"
+    csv.write_text(
+        "# chamber run\nfrequency_hz,diode_uV,pressure_ref\n"
+        + "".join(f"{a:.17g},{b:.17g},{c:.17g}\n" for a, b, c in zip(f, v, p)),
+        encoding="utf-8",
+    )
+    loaded = load_calibration([csv], "frequency_hz", "diode_uV", "pressure_ref")
+    fit = fit_surface(*loaded[:3], nx=3, ny=2)
+    out = tmp_path / "fit.json"
+    fit.save(out, {"mode": "RECIP", "sensor_poly": {"X": 0, "Y": 0, "K": [[0]]}})
+    data = json.loads(out.read_text(encoding="utf-8"))
+    assert data["mode"] == "RECIP"
+    poly = SensorPoly.from_mapping(data["sensor_poly"])
+    np.testing.assert_allclose(PressureCalculator(poly).evaluate_batch(f, v), p, atol=1e-6)
@@ -1,12 +1,13 @@
 from __future__ import annotations
 
+import struct
 from pathlib import Path
 
 import numpy as np
 
 from bslfs.terps.coeff import coeff_from_sensor_poly
 from bslfs.terps.config import SensorPoly, TerpsConfig, load_config
-from bslfs.terps.frames import Frame, FrameFormat, FrameParser, crc16_ccitt
+from bslfs.terps.frames import FLAG_PPS_LOCKED, FLAG_SETTLED, Frame, FrameFormat, FrameParser, crc16_ccitt
 from bslfs.terps.processing import PressureCalculator, SamplePipeline
 
 
@@ -78,6 +79,31 @@ def test_parse_binary_frame() -> None:
     assert frame.mode == "RECIP"
 
 
+def test_parse_binary_frame_with_slot_and_adc_count() -> None:
+    parser = FrameParser(FrameFormat.BINARY)
+    body = struct.pack("<IiHiBBhBIB", 5000, 300001234, 10, 600100, 16, 0, 0, 0, 42, 3)
+    packet = b"\x55\xAA" + bytes([len(body)]) + body + crc16_ccitt(body).to_bytes(2, "little")
+    (frame,) = list(parser.parse_binary([packet]))
+    assert frame.slot == 42
+    assert frame.adc_fresh == 3
+    assert frame.mode == "GATED"
+
+
+def test_pipeline_counts_reused_adc_values(tmp_path: Path) -> None:
+    cfg = load_config(Path("host_pi/config.json"))
+    cfg.output_csv = tmp_path / "fresh.csv"
+    pipeline = SamplePipeline(cfg, coeff_from_sensor_poly("test", cfg.sensor_poly))
+    frames = [
+        Frame(float(i), 30000.0, 10.0, 600000.0, 16, 0, 0.0, "RECIP", adc_fresh=i % 2) for i in range(6)
+    ]
+    samples = pipeline.process(frames)
+    pipeline.close()
+    assert [s.adc_fresh for s in samples] == [0, 1, 0, 1, 0, 1]
+    assert pipeline.stats()["adc_reused"] == 3
+    header = cfg.output_csv.read_text().splitlines()[1]
+    assert header.endswith(",slot,adc_fresh")
+
+
 def test_pressure_calculator_linear() -> None:
     sensor_poly = SensorPoly(
         X=30000.0,
@@ -152,3 +178,54 @@ def test_sample_pipeline_microvolt_frame(tmp_path: Path) -> None:
     pipeline.close()
     assert len(samples) == 1
     assert np.isclose(samples[0].pressure, 123.0)
+
+
+def test_batch_pipeline_matches_scalar_and_swaps_at_boundary(tmp_path: Path) -> None:
+    cfg = load_config(Path("host_pi/config.json"), overrides=["host.batch_max_frames=4"])
+    cfg.output_csv = None
+    rng = np.random.default_rng(3)
+    poly = SensorPoly(X=30000.0, Y=600000.0, K=rng.normal(size=(3, 2)).tolist())
+    cfg.sensor_poly = poly
+    pipeline = SamplePipeline(cfg, coeff_from_sensor_poly("first", poly))
+    seen = []
+    pipeline.register_callback(seen.append)
+    frames = [
+        Frame(float(i), 30000.0 + i, 100.0, 600000.0 + 10.0 * i, 16, 0, 0.0, "RECIP")
+        for i in range(10)
+    ]
+    samples = pipeline.process(frames)
+    scalar = PressureCalculator(poly)
+    assert np.allclose(
+        [s.pressure for s in samples], [scalar.evaluate(f.f_hz, f.v_uV) for f in frames]
+    )
+    assert len(seen) == 10
+    stats = pipeline.stats()
+    assert stats["batches"] == 3 and stats["frames"] == 10
+
+    doubled = SensorPoly(X=poly.X, Y=poly.Y, K=[[2.0 * k for k in row] for row in poly.K])
+    pipeline.update_coeff(coeff_from_sensor_poly("second", doubled))
+    assert pipeline.coeff_version == 0  # staged until the next batch
+    second = pipeline.process_batch(frames[:2])
+    assert pipeline.coeff_version == 1
+    assert np.allclose([s.pressure for s in second], [2.0 * s.pressure for s in samples[:2]])
+
+
+def test_batch_pipeline_drops_flagged_frames() -> None:
+    cfg = load_config(Path("host_pi/config.json"), overrides=["host.drop_flags=2"])
+    cfg.output_csv = None
+    pipeline = SamplePipeline(cfg, coeff_from_sensor_poly("test", cfg.sensor_poly))
+    frames = [Frame(float(i), 30000.0, 100.0, 600000.0, 16, 2 if i % 3 == 0 else 0, 0.0, "RECIP") for i in range(6)]
+    samples = pipeline.process_batch(frames)
+    assert [s.ts_ms for s in samples] == [1.0, 2.0, 4.0, 5.0]
+    assert pipeline.stats()["filtered"] == 2
+
+
+def test_batch_pipeline_requires_settled_flag() -> None:
+    cfg = load_config(Path("host_pi/config.json"), overrides=[f"host.require_flags={FLAG_SETTLED}", "host.drop_flags=2"])
+    cfg.output_csv = None
+    pipeline = SamplePipeline(cfg, coeff_from_sensor_poly("test", cfg.sensor_poly))
+    flags = [0, FLAG_SETTLED, FLAG_SETTLED | 2, FLAG_SETTLED | FLAG_PPS_LOCKED, 0]
+    frames = [Frame(float(i), 30000.0, 100.0, 600000.0, 16, f, 0.0, "RECIP") for i, f in enumerate(flags)]
+    samples = pipeline.process_batch(frames)
+    assert [s.ts_ms for s in samples] == [1.0, 3.0]
+    assert pipeline.stats()["filtered"] == 3
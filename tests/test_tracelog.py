@@ -0,0 +1,38 @@
+from __future__ import annotations
+
+import struct
+from pathlib import Path
+
+from bslfs.terps.frames import FrameFormat, FrameParser, crc16_ccitt
+from bslfs.terps.tracelog import TraceStringTable, parse_trace_line
+
+from test_frames_binary import build_body, build_packet
+
+FMT_DEF = Path("firmware_pico2/include/trace_log_fmt.def")
+
+
+def build_trace_packet(trace_id: int, args: list[int], *, ts_us: int = 1000, core: int = 1) -> bytes:
+    payload = struct.pack("<IHBB", ts_us, trace_id, core, len(args))
+    payload += struct.pack(f"<{len(args)}I", *args)
+    crc = crc16_ccitt(payload)
+    return b"\x55\xA5" + bytes([len(payload)]) + payload + crc.to_bytes(2, "little")
+
+
+def test_trace_packets_are_demuxed_from_frames():
+    records = []
+    parser = FrameParser(FrameFormat.BINARY, on_trace=records.append)
+    stream = build_packet(build_body(ts=1)) + build_trace_packet(2, [120, 118, 2, 8])
+    stream += build_packet(build_body(ts=2))
+    frames = list(parser.parse_binary([stream[:7], stream[7:30], stream[30:]]))
+    assert [frame.ts_ms for frame in frames] == [1.0, 2.0]
+    assert len(records) == 1
+    assert records[0].args == (120, 118, 2, 8)
+    assert parser.stats()["trace_records"] == 1
+
+
+def test_string_table_formats_def_entries():
+    table = TraceStringTable.load(FMT_DEF)
+    record = parse_trace_line("#L 2 1 5000 120 118 2 8")
+    assert record is not None
+    assert table.name(2) == "TRACE_FREQ_DEGLITCH"
+    assert table.format(record) == "[freq] raw=120 kept=118 dropped=2 min_interval_us=8"
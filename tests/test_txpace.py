@@ -0,0 +1,93 @@
+from __future__ import annotations
+
+from typing import Dict, List
+
+from bslfs.terps.frames import FLAG_SETTLED, FLAG_SUMMARY, FrameFormat, FrameParser
+from bslfs.terps.schema import PACKET_TX_STATE
+from bslfs.terps.txpace import ThrottledHost, TxPacerLimits, TxPacerModel, parse_tx_line, simulate_link
+
+
+def decode(received: bytes):
+    records: List[Dict[str, object]] = []
+    parser = FrameParser(FrameFormat.BINARY, on_record=lambda ptype, rec: records.append(rec))
+    frames = list(parser.parse_binary([received]))
+    assert parser.stats()["crc_errors"] == 0
+    return frames, records
+
+
+def test_fast_host_stays_normal() -> None:
+    result = simulate_link(ThrottledHost(), 5.0)
+    assert result.steps == []
+    assert result.dropped == 0
+    assert result.frames_sent == result.frames_produced
+    frames, records = decode(result.received)
+    assert records == []
+    assert len(frames) >= result.frames_produced - 1
+    assert not any(f.flags & FLAG_SUMMARY for f in frames)
+
+
+def test_byte_limited_host_escalates_to_summary() -> None:
+    # 100 fps × 29 B ≈ 2.9 kB/s offered, host takes 1.5 kB/s.
+    result = simulate_link(ThrottledHost(bytes_per_s=1500), 10.0)
+    assert max(step for _, step in result.steps) >= 2
+    frames, records = decode(result.received)
+    assert len(records) >= 2
+    # A record delayed by a full FIFO still lands, carrying the step current at send time.
+    assert {r["step"] for r in records} <= {step for _, step in result.steps}
+    assert records[-1]["step"] == result.pacer.step
+    summaries = [f for f in frames if f.flags & FLAG_SUMMARY]
+    assert summaries and all(f.flags & FLAG_SETTLED for f in summaries)
+    # Dropping is the exception: nearly every window reaches the host.
+    assert result.windows_sent >= 0.98 * result.frames_produced
+    assert result.dropped <= 10
+
+
+def test_packet_limited_host_batches() -> None:
+    # Plenty of bandwidth but only 40 USB packets/s: one frame per packet fails.
+    result = simulate_link(ThrottledHost(bytes_per_s=1e6, packets_per_s=40), 10.0)
+    assert result.steps and result.steps[0][1] == 1
+    assert result.windows_sent >= 0.98 * result.frames_produced
+
+
+def test_fixed_step_overflows_without_pacing() -> None:
+    paced = simulate_link(ThrottledHost(bytes_per_s=1500), 10.0)
+    fixed = simulate_link(ThrottledHost(bytes_per_s=1500), 10.0, adaptive=False)
+    assert fixed.steps == []
+    assert fixed.dropped > 10 * paced.dropped
+
+
+def test_recovered_host_returns_to_normal() -> None:
+    host = ThrottledHost(schedule=[(0.0, 1200.0, 1000.0), (6.0, 1e6, 1000.0)])
+    result = simulate_link(host, 20.0)
+    assert max(step for _, step in result.steps) >= 2
+    assert result.steps[-1][1] == 0
+    _, records = decode(result.received)
+    assert records[-1]["step"] == 0 and records[-1]["merge"] == 1
+
+
+def test_failed_probe_backs_off() -> None:
+    model = TxPacerModel(limits=TxPacerLimits(fifo_size=256))
+    model.sample(0, 256)
+    model.step = 3
+    model.down_at_us = 100_000
+    model.sample(200_000, 10)  # FIFO nearly full right after a step-down
+    assert model.step == 4
+    assert model.probe_holds == 8
+
+
+def test_parse_tx_line() -> None:
+    line = "#TX STEP=3 LEVEL=SUMMARY BATCH=8 MERGE=4 DRAIN_BPS=1490 CAPACITY_BPS=1502 DEMAND_BPS=2900 STALLS=2 DROPPED=9"
+    record = parse_tx_line(line)
+    assert record == {
+        "step": 3,
+        "level": "SUMMARY",
+        "batch": 8,
+        "merge": 4,
+        "drain_Bps": 1490,
+        "capacity_Bps": 1502,
+        "demand_Bps": 2900,
+        "stalls": 2,
+        "dropped": 9,
+    }
+    assert parse_tx_line("#TRACE 1 2") is None
+    assert PACKET_TX_STATE == 0xA7
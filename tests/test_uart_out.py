@@ -0,0 +1,241 @@
+"""
+Host model of the firmware UART frame output (`uart_out.cpp`).
+
+Each window's ``0x55 0xAA`` packet is encoded once into one of `slots` ring
+slots; the DMA moves it into the 32-byte UART FIFO and its completion IRQ
+starts the next slot, so packets leave back to back at line rate. A slot is
+free again once its last byte is in the FIFO, i.e. a FIFO's worth of
+characters before its last stop bit. A full ring drops the window but still
+consumes a ``seq``, so `FrameParser` on the receiving end counts the gap.
+
+With a driver-enable pin, DE rises ``de_lead_us`` before the first start bit,
+stays up while packets follow each other and falls ``de_tail_us`` after the
+last stop bit. `UartOutModel.stream()` returns the exact wire bytes and
+`.packets` the timing of each one, so encoding, DMA hand-off, DE timing and
+edge-to-wire latency can all be checked without hardware.
+"""
+
+from __future__ import annotations
+
+import struct
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Tuple
+
+import numpy as np
+import pytest
+
+from bslfs.terps.frames import Frame, FrameFormat, FrameParser, crc16_ccitt
+from bslfs.terps.schema import (
+    BUILTIN_FRAME_SCHEMA,
+    FIELD_ADC_FRESH,
+    FIELD_ADC_GAIN,
+    FIELD_DIODE_UV,
+    FIELD_F_HZ,
+    FIELD_FLAGS,
+    FIELD_MODE,
+    FIELD_PPM_CORR,
+    FIELD_SEQ,
+    FIELD_SLOT,
+    FIELD_TAU_MS,
+    FIELD_TS_MS,
+    MODE_NAMES,
+    encode_record,
+)
+
+
+UART_FIFO_BYTES = 32
+BITS_PER_CHAR = 10  # 8N1
+_MODE_CODES = {name: code for code, name in MODE_NAMES.items()}
+
+
+def frame_to_raw(frame: Frame, seq: int) -> Dict[int, int]:
+    """Wire values of a `Frame`, as the firmware's terps_frame_t would carry them."""
+
+    return {
+        FIELD_TS_MS: int(frame.ts_ms) & 0xFFFFFFFF,
+        FIELD_F_HZ: int(round(frame.f_hz * 1e4)),
+        FIELD_TAU_MS: int(frame.tau_ms),
+        FIELD_DIODE_UV: int(round(frame.v_uV)),
+        FIELD_ADC_GAIN: frame.adc_gain,
+        FIELD_FLAGS: frame.flags,
+        FIELD_PPM_CORR: int(round(frame.ppm_corr * 100)),
+        FIELD_MODE: _MODE_CODES.get(frame.mode, 1),
+        FIELD_SLOT: frame.slot & 0xFFFFFFFF,
+        FIELD_ADC_FRESH: max(frame.adc_fresh, 0),
+        FIELD_SEQ: seq & 0xFFFF,
+    }
+
+
+def encode_frame_packet(frame: Frame, seq: int) -> bytes:
+    """The packet `usb_cdc_encode_binary()` builds for ``frame``."""
+
+    body = encode_record(BUILTIN_FRAME_SCHEMA, frame_to_raw(frame, seq))
+    return b"\x55\xAA" + bytes([len(body)]) + body + struct.pack("<H", crc16_ccitt(body))
+
+
+@dataclass
+class UartPacket:
+    seq: int
+    end_us: float         # closing edge of the window
+    queued_us: float      # encoded into a slot
+    wire_start_us: float  # first start bit
+    wire_end_us: float    # last stop bit
+    data: bytes
+
+    @property
+    def wire_latency_us(self) -> float:
+        return self.wire_end_us - self.end_us
+
+
+@dataclass
+class UartOutModel:
+    baud: int = 921600
+    slots: int = 8
+    de: bool = False
+    de_lead_us: float = 5.0
+    de_tail_us: float = 5.0
+    core1_us: float = 15.0    # closing edge -> uart_out_send_frame() (wake, ADC read, ctrl_out, settle)
+    encode_us: float = 3.0
+    irq_us: float = 1.0       # DMA-complete IRQ entry to the next transfer
+    packets: List[UartPacket] = field(default_factory=list)
+    de_intervals: List[Tuple[float, float]] = field(default_factory=list)
+    dropped: int = 0
+    depth_max: int = 0
+    _seq: int = 0
+    _wire_free: float = 0.0
+    _slot_free: List[float] = field(default_factory=list)  # DMA-complete times of queued packets
+
+    @property
+    def char_us(self) -> float:
+        return BITS_PER_CHAR * 1e6 / self.baud
+
+    def send(self, frame: Frame, end_us: float) -> bool:
+        """One window, closed at ``end_us``; returns False when the ring was full."""
+
+        seq = self._seq
+        self._seq = (self._seq + 1) & 0xFFFF
+        now = end_us + self.core1_us
+        self._slot_free = [t for t in self._slot_free if t > now]
+        if len(self._slot_free) >= self.slots:
+            self.dropped += 1
+            return False
+        now += self.encode_us
+        data = encode_frame_packet(frame, seq)
+        if self._slot_free:
+            # Started by the previous slot's DMA-complete IRQ.
+            start = max(self._slot_free[-1] + self.irq_us, now)
+        else:
+            start = now
+        begin = max(start, self._wire_free)
+        if self.de and (not self.de_intervals or self.de_intervals[-1][1] < start):
+            # DE was released: raise it and wait the lead time. Otherwise the
+            # pending release is cancelled and the packet follows directly.
+            self.de_intervals.append((start, start))
+            begin = max(begin, start + self.de_lead_us)
+        wire_end = begin + len(data) * self.char_us
+        self._wire_free = wire_end
+        if self.de:
+            self.de_intervals[-1] = (self.de_intervals[-1][0], wire_end + self.de_tail_us)
+        # The DMA finishes once the last byte fits in the FIFO behind the others.
+        dma_done = max(start, wire_end - UART_FIFO_BYTES * self.char_us)
+        self._slot_free.append(dma_done)
+        self.depth_max = max(self.depth_max, len(self._slot_free))
+        self.packets.append(UartPacket(seq, end_us, now, begin, wire_end, data))
+        return True
+
+    def stream(self) -> bytes:
+        return b"".join(p.data for p in self.packets)
+
+    def stats(self) -> Dict[str, float]:
+        wire = np.array([p.wire_latency_us for p in self.packets]) if self.packets else np.zeros(1)
+        return {
+            "queued": len(self.packets),
+            "dropped": self.dropped,
+            "bytes": sum(len(p.data) for p in self.packets),
+            "depth_max": self.depth_max,
+            "de_cycles": len(self.de_intervals),
+            "wire_min_us": float(wire.min()),
+            "wire_mean_us": float(wire.mean()),
+            "wire_max_us": float(wire.max()),
+        }
+
+
+def packet_wire_us(baud: int, payload_len: Optional[int] = None) -> float:
+    """Line time of one frame packet at ``baud`` (8N1)."""
+
+    length = (payload_len if payload_len is not None else BUILTIN_FRAME_SCHEMA.payload_len) + 5
+    return length * BITS_PER_CHAR * 1e6 / baud
+
+
+def frame(i: int) -> Frame:
+    return Frame(
+        ts_ms=1000 + i * 10,
+        f_hz=30000.1234 + i * 0.01,
+        tau_ms=10,
+        v_uV=612345 - i,
+        adc_gain=16,
+        flags=0x10,
+        ppm_corr=-0.25,
+        mode="RECIP",
+        slot=-1 if i % 2 else i,
+        adc_fresh=2,
+    )
+
+
+def parse(stream: bytes, chunk: int = 64):
+    parser = FrameParser(FrameFormat.BINARY)
+    frames = list(parser.parse_binary(stream[i : i + chunk] for i in range(0, len(stream), chunk)))
+    return frames, parser.stats()
+
+
+def test_packet_matches_the_usb_encoding():
+    packet = encode_frame_packet(frame(3), seq=7)
+    assert packet[:3] == b"\x55\xAA\x1a" and len(packet) == 31
+    (decoded,), _ = parse(packet)
+    assert decoded.seq == 7 and decoded.slot == -1
+    assert decoded.f_hz == pytest.approx(30000.1534)
+    assert (decoded.v_uV, decoded.flags, decoded.mode, decoded.ppm_corr) == (612342, 0x10, "RECIP", -0.25)
+
+
+def test_steady_stream_has_deterministic_wire_latency():
+    model = UartOutModel(baud=921600)
+    for i in range(500):
+        assert model.send(frame(i), end_us=i * 10_000.0)
+    frames, stats = parse(model.stream())
+    assert [f.seq for f in frames] == list(range(500))
+    assert stats["lost_frames"] == 0
+    expected = model.core1_us + model.encode_us + packet_wire_us(921600)
+    st = model.stats()
+    assert st["wire_min_us"] == pytest.approx(expected) and st["wire_max_us"] == pytest.approx(expected)
+    assert st["depth_max"] == 1 and st["dropped"] == 0
+
+
+def test_ring_overflow_drops_show_up_as_seq_gaps():
+    # 1 kHz windows into a 9600 baud line: each packet needs ~32 ms on the wire.
+    model = UartOutModel(baud=9600, slots=8)
+    sent = [model.send(frame(i), end_us=i * 1000.0) for i in range(400)]
+    st = model.stats()
+    assert st["dropped"] == sent.count(False) > 300
+    assert st["queued"] + st["dropped"] == 400
+    frames, stats = parse(model.stream())
+    assert len(frames) == st["queued"]
+    assert stats["lost_frames"] == st["dropped"] - (399 - frames[-1].seq)
+    # Packets leave back to back once the ring is full.
+    gaps = [b.wire_start_us - a.wire_end_us for a, b in zip(model.packets, model.packets[1:])]
+    assert max(gaps[10:]) == pytest.approx(0.0, abs=1e-6)
+
+
+def test_rs485_driver_enable_covers_every_packet():
+    model = UartOutModel(baud=115200, de=True, de_lead_us=8.0, de_tail_us=12.0)
+    # Bursts of three back-to-back windows, then a pause.
+    ends = [burst * 20_000.0 + k * 50.0 for burst in range(5) for k in range(3)]
+    for i, end in enumerate(ends):
+        model.send(frame(i), end_us=end)
+    assert model.stats()["de_cycles"] == 5
+    for packet in model.packets:
+        rise, fall = next(iv for iv in model.de_intervals if iv[0] <= packet.wire_start_us <= iv[1])
+        assert packet.wire_end_us + model.de_tail_us <= fall + 1e-9
+    for (rise, fall), first in zip(model.de_intervals, model.packets[::3]):
+        assert first.wire_start_us - rise == pytest.approx(8.0)
+        last = model.packets[model.packets.index(first) + 2]
+        assert fall - last.wire_end_us == pytest.approx(12.0)
@@ -0,0 +1,358 @@
+"""
+Host model of the firmware's lock-step UNI/O reader (`uni_o.cpp`).
+
+`UnioEepromModel` is an 11LC040 as the firmware sees it, stepped one bit slot
+at a time; `LockstepUnioMaster` mirrors `unio_read_buses()` over any number of
+such buses (``None`` = nothing on the line). Each slot resolves the wired-AND
+line per half bit with the same pull-up/decoding rules as the firmware, so a
+fault on one bus (missing device, other address, corrupted bit, stuck line)
+shows up exactly as it would on the Pico while the other buses carry on.
+"""
+
+from __future__ import annotations
+
+import random
+from dataclasses import dataclass, field
+from typing import List, Optional, Sequence, Tuple
+
+from bslfs.terps.coeff import parse_eeprom_scan
+
+
+UNIO_T_STANDBY_US = 600
+UNIO_T_HDR_US = 10
+UNIO_START_HEADER = 0x55
+UNIO_CMD_READ = 0x03
+DEVICE_ADDRS = tuple(range(0xA0, 0xAF, 2))
+EEPROM_SIZE = 512
+
+STATUS_OK = "OK"
+STATUS_NO_DEVICE = "NO_DEVICE"
+STATUS_IO_ERROR = "IO_ERROR"
+
+# Half-bit drive levels; None = released (pull-up wins unless the other side drives low).
+Halves = Tuple[Optional[int], Optional[int]]
+_RELEASED: Halves = (None, None)
+
+
+def half_period_us(bitrate_bps: int) -> int:
+    """Same clamping as `compute_half_period()`."""
+
+    bitrate_bps = bitrate_bps or 20000
+    half = ((1_000_000 + bitrate_bps // 2) // bitrate_bps) // 2
+    return min(max(half, 5), 200)
+
+
+def _symbol(bit: int) -> Halves:
+    # Firmware convention: 1 = high then low, 0 = low then high.
+    return (1, 0) if bit else (0, 1)
+
+
+@dataclass
+class UnioEepromModel:
+    """
+    Slave state machine. ``corrupt_rx_slot`` turns the n-th slot it answers
+    (0-based, counted per transaction) into a low/low symbol; ``stuck_low``
+    holds the line low for good.
+    """
+
+    device_addr: int = 0xA0
+    image: bytes = bytes(EEPROM_SIZE)
+    corrupt_rx_slot: Optional[int] = None
+    stuck_low: bool = False
+    _state: str = "standby"
+    _shift: int = 0
+    _bits: int = 0
+    _pointer: int = 0
+    _answered: int = 0
+    _pending: Optional[Halves] = field(default=None, repr=False)
+    _after: str = ""
+    reads: int = 0
+
+    def standby(self) -> None:
+        self._state = "armed"
+
+    def header_low(self) -> None:
+        self._state = "header" if self._state == "armed" else "silent"
+        self._shift = self._bits = 0
+        self._answered = 0
+
+    def master_slot(self, bit: int) -> None:
+        """The master drove `bit` for one slot."""
+
+        if self._state in ("standby", "armed", "silent", "done"):
+            return
+        if self._state == "mak_in":
+            # Master ack after a data byte: 1 = more, 0 = stop. The SAK follows.
+            self._pending = (0, None)
+            self._after = "data" if bit else "done"
+            return
+        if self._state == "sak_in":
+            self._state = self._after
+            return
+        self._shift = ((self._shift << 1) | bit) & 0xFF
+        self._bits += 1
+        if self._bits < 8:
+            return
+        value, self._bits = self._shift, 0
+        if self._state == "header":
+            self._state = "addr" if value == UNIO_START_HEADER else "silent"
+        elif self._state == "addr":
+            self._accept(value == self.device_addr, "cmd")
+        elif self._state == "cmd":
+            self._accept(value == UNIO_CMD_READ, "addr_hi")
+        elif self._state == "addr_hi":
+            self._pointer = value << 8
+            self._accept(True, "addr_lo")
+        elif self._state == "addr_lo":
+            self._pointer = (self._pointer | value) % EEPROM_SIZE
+            self._accept(True, "data")
+
+    def _accept(self, ok: bool, next_state: str) -> None:
+        if not ok:
+            self._state = "silent"
+            return
+        # The firmware reads a 1 from the slave, then sends a 0 it ignores.
+        self._pending = (None, 0)
+        self._after = next_state
+        self._state = "ack_out"
+
+    def slave_slot(self) -> Halves:
+        """The master released the line for one slot; returns what we drive."""
+
+        if self.stuck_low:
+            return (0, 0)
+        if self._pending is not None:
+            halves, self._pending = self._pending, None
+            if self._state == "ack_out":
+                self._state = "sak_in"
+            elif self._state == "mak_in":
+                self._state = self._after
+                if self._state == "data":
+                    self._pointer = (self._pointer + 1) % EEPROM_SIZE
+                else:
+                    self.reads += 1
+            return self._corrupt(halves)
+        if self._state != "data":
+            return _RELEASED
+        bit = (self.image[self._pointer] >> (7 - self._bits)) & 1
+        self._bits += 1
+        if self._bits == 8:
+            self._bits = 0
+            self._state = "mak_in"
+        return self._corrupt(_symbol(bit))
+
+    def _corrupt(self, halves: Halves) -> Halves:
+        index = self._answered
+        self._answered += 1
+        return (0, 0) if index == self.corrupt_rx_slot else halves
+
+
+@dataclass
+class BusResult:
+    status: str = STATUS_NO_DEVICE
+    device_addr: int = 0
+    data: bytes = b""
+
+
+@dataclass
+class LockstepUnioMaster:
+    """Mirror of `unio_read_buses()`; ``elapsed_us`` accumulates bus time."""
+
+    buses: Sequence[Optional[UnioEepromModel]]
+    bitrate_bps: int = 40000
+    elapsed_us: int = 0
+    contention: int = 0
+
+    def __post_init__(self) -> None:
+        self.half_us = half_period_us(self.bitrate_bps)
+
+    # -- line primitives (every call acts on all buses in `lines`) ------------
+
+    def _standby(self, lines: Sequence[int]) -> None:
+        if not lines:
+            return
+        for bus in lines:
+            if self.buses[bus] is not None:
+                self.buses[bus].standby()
+        self.elapsed_us += UNIO_T_STANDBY_US
+
+    def _tx_slot(self, lines: Sequence[int], bits: Sequence[int]) -> None:
+        for bus, bit in zip(lines, bits):
+            slave = self.buses[bus]
+            if slave is None:
+                continue
+            if slave.stuck_low:
+                self.contention += 1
+            slave.master_slot(bit)
+        self.elapsed_us += 2 * self.half_us
+
+    def _rx_slot(self, lines: Sequence[int]) -> List[str]:
+        out = []
+        for bus in lines:
+            slave = self.buses[bus]
+            first, second = slave.slave_slot() if slave is not None else _RELEASED
+            a = 0 if first == 0 else 1
+            b = 0 if second == 0 else 1
+            out.append({(0, 1): "zero", (1, 0): "one", (1, 1): "idle"}.get((a, b), "error"))
+        self.elapsed_us += 2 * self.half_us
+        return out
+
+    def _tx_byte(self, lines: Sequence[int], value: int) -> None:
+        for bit in range(7, -1, -1):
+            self._tx_slot(lines, [(value >> bit) & 1] * len(lines))
+
+    # -- transaction -----------------------------------------------------------
+
+    def _round(self, lines: List[int], device_addr: int, addr: int, length: int) -> Tuple[List[int], dict, dict]:
+        status: dict = {}
+        data = {bus: bytearray() for bus in lines}
+
+        def drop(bus: int, result: str) -> None:
+            lines.remove(bus)
+            status[bus] = result
+
+        self._standby(lines)
+        for bus in lines:
+            if self.buses[bus] is not None:
+                self.buses[bus].header_low()
+        self.elapsed_us += UNIO_T_HDR_US
+        self._tx_byte(lines, UNIO_START_HEADER)
+
+        for byte in (device_addr, UNIO_CMD_READ, (addr >> 8) & 0xFF, addr & 0xFF):
+            if not lines:
+                return lines, status, data
+            self._tx_byte(lines, byte)
+            for bus, res in zip(list(lines), self._rx_slot(lines)):
+                if res == "idle":
+                    drop(bus, STATUS_NO_DEVICE)
+                elif res != "one":
+                    drop(bus, STATUS_IO_ERROR)
+            if lines:
+                self._tx_slot(lines, [0] * len(lines))  # SAK = 0
+
+        for index in range(length):
+            if not lines:
+                break
+            values = {bus: 0 for bus in lines}
+            for bit in range(7, -1, -1):
+                for bus, res in zip(list(lines), self._rx_slot(lines)):
+                    if res == "idle":
+                        drop(bus, STATUS_NO_DEVICE)
+                    elif res == "error":
+                        drop(bus, STATUS_IO_ERROR)
+                    elif res == "one":
+                        values[bus] |= 1 << bit
+            for bus in lines:
+                data[bus].append(values[bus])
+            if not lines:
+                break
+            more = 1 if index + 1 < length else 0
+            self._tx_slot(lines, [more] * len(lines))
+            for bus, res in zip(list(lines), self._rx_slot(lines)):
+                if res == "idle":
+                    drop(bus, STATUS_NO_DEVICE)
+                elif res != "zero":
+                    drop(bus, STATUS_IO_ERROR)
+        return lines, status, data
+
+    def read(self, addr: int, length: int, bus_mask: Optional[int] = None) -> List[BusResult]:
+        wanted = [bus for bus in range(len(self.buses)) if bus_mask is None or bus_mask >> bus & 1]
+        results = [BusResult() for _ in self.buses]
+        length = min(length, EEPROM_SIZE)
+        pending = list(wanted)
+        for device_addr in DEVICE_ADDRS:
+            if not pending:
+                break
+            ok, status, data = self._round(list(pending), device_addr, addr, length)
+            self._standby(pending)
+            for bus in list(pending):
+                if bus in ok:
+                    results[bus] = BusResult(STATUS_OK, device_addr, bytes(data[bus]))
+                    pending.remove(bus)
+                elif status.get(bus) == STATUS_IO_ERROR:
+                    results[bus] = BusResult(STATUS_IO_ERROR)
+                    pending.remove(bus)
+        return results
+
+
+def format_scan_reply(
+    results: Sequence[BusResult], gpios: Sequence[int], start: int, length: int, elapsed_us: int
+) -> List[str]:
+    """The `EEPROM.SCAN` reply lines `report_eeprom_buses()` prints for ``results``."""
+
+    ok = sum(1 for r in results if r.status == STATUS_OK)
+    lines = [f"OK BUSES={len(results)} OK={ok} START=0x{start:04X} LEN={length} US={elapsed_us}"]
+    for bus, (result, gpio) in enumerate(zip(results, gpios)):
+        lines.append(f"B {bus} GPIO={gpio} STATUS={result.status} DEV=0x{result.device_addr:02X}")
+        for offset in range(0, len(result.data), 32):
+            lines.append(result.data[offset : offset + 32].hex().upper())
+    lines.append("END")
+    return lines
+
+
+def images(count: int, seed: int = 3) -> list:
+    rng = random.Random(seed)
+    return [bytes(rng.randrange(256) for _ in range(512)) for _ in range(count)]
+
+
+def test_single_bus_reads_image_and_offset():
+    image = images(1)[0]
+    slave = UnioEepromModel(image=image)
+    master = LockstepUnioMaster([slave])
+    (result,) = master.read(0, 512)
+    assert (result.status, result.device_addr, result.data) == (STATUS_OK, 0xA0, image)
+    (result,) = master.read(0x1F0, 32)
+    # The 11LC040 address counter wraps at the end of the array.
+    assert result.data == image[0x1F0:] + image[:16]
+    assert slave.reads == 2
+
+
+def test_eight_buses_load_in_the_time_of_one():
+    imgs = images(8)
+    lockstep = LockstepUnioMaster([UnioEepromModel(image=img) for img in imgs])
+    results = lockstep.read(0, 512)
+    assert [r.data for r in results] == imgs
+    single = LockstepUnioMaster([UnioEepromModel(image=imgs[0])])
+    single.read(0, 512)
+    assert lockstep.elapsed_us == single.elapsed_us
+    # 512 bytes at 40 kbit/s: ~125 ms per bus instead of ~1 s for eight in a row.
+    assert 100_000 < single.elapsed_us < 150_000
+
+
+def test_faults_stay_on_their_bus():
+    imgs = images(6, seed=9)
+    buses = [UnioEepromModel(image=img) for img in imgs]
+    buses[1] = None  # nothing fitted
+    buses[2].device_addr = 0xA6  # found in the fourth address round
+    buses[3].corrupt_rx_slot = 200  # bit error mid-image
+    buses[4].stuck_low = True
+    results = LockstepUnioMaster(buses).read(0, 512)
+    assert [r.status for r in results] == [
+        STATUS_OK,
+        STATUS_NO_DEVICE,
+        STATUS_OK,
+        STATUS_IO_ERROR,
+        STATUS_IO_ERROR,
+        STATUS_OK,
+    ]
+    assert results[2].device_addr == 0xA6
+    for bus in (0, 2, 5):
+        assert results[bus].data == imgs[bus]
+
+
+def test_scan_reply_round_trip():
+    imgs = images(3, seed=5)
+    buses = [UnioEepromModel(image=imgs[0]), None, UnioEepromModel(image=imgs[2], device_addr=0xA2)]
+    master = LockstepUnioMaster(buses)
+    results = master.read(0x10, 64)
+    lines = format_scan_reply(results, [6, 7, 8], 0x10, 64, master.elapsed_us)
+    parsed, header = parse_eeprom_scan(lines)
+    assert (header["BUSES"], header["OK"], header["LEN"]) == ("3", "2", "64")
+    assert [(p.bus, p.gpio, p.status, p.device_address) for p in parsed] == [
+        (0, 6, "OK", 0xA0),
+        (1, 7, "NO_DEVICE", 0x00),
+        (2, 8, "OK", 0xA2),
+    ]
+    assert parsed[0].data == imgs[0][0x10:0x50]
+    assert parsed[2].data == imgs[2][0x10:0x50]
+    assert parsed[1].data == b""
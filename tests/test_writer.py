@@ -0,0 +1,89 @@
+from __future__ import annotations
+
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+from bslfs.terps.processing import CsvLogger, SampleRecord
+from bslfs.terps.writer import GroupCommitLogger
+
+
+def _sample(idx: int) -> SampleRecord:
+    return SampleRecord(
+        ts_ms=float(idx),
+        frequency_hz=30000.0 + idx * 0.001,
+        tau_ms=100.0,
+        diode_uV=600000.0,
+        pressure=101325.0 + idx,
+        adc_gain=16,
+        flags=0,
+        ppm_corr=0.0,
+        mode="RECIP",
+    )
+
+
+def _wait_for(predicate, timeout: float = 2.0) -> None:
+    deadline = time.monotonic() + timeout
+    while not predicate():
+        assert time.monotonic() < deadline, "condition not reached"
+        time.sleep(0.005)
+
+
+def test_group_commit_output_matches_sync_logger(tmp_path: Path):
+    sync_path = tmp_path / "sync.csv"
+    group_path = tmp_path / "group.csv"
+    sync_logger = CsvLogger(sync_path)
+    group_logger = GroupCommitLogger(group_path, commit_rows=7)
+    for logger in (sync_logger, group_logger):
+        logger.set_metadata({"coeff_source": "config"})
+        for idx in range(20):
+            logger.append(_sample(idx))
+        logger.set_metadata({"coeff_source": "eeprom"})
+        logger.append(_sample(20))
+        logger.close()
+    assert group_path.read_bytes() == sync_path.read_bytes()
+
+
+def test_commits_by_size_and_by_time(tmp_path: Path):
+    path = tmp_path / "log.csv"
+    logger = GroupCommitLogger(path, commit_rows=10, commit_interval_s=60.0, fsync_interval_s=0.0)
+    for idx in range(25):
+        logger.append(_sample(idx))
+    _wait_for(lambda: logger.stats()["commits"] == 2)
+    assert len(path.read_text().splitlines()) == 1 + 20
+    assert logger.stats()["fsyncs"] == 2
+    logger.close()
+    assert len(path.read_text().splitlines()) == 1 + 25
+
+    timed = GroupCommitLogger(tmp_path / "timed.csv", commit_rows=1000, commit_interval_s=0.05)
+    timed.append(_sample(0))
+    _wait_for(lambda: timed.stats()["rows"] == 1)
+    timed.close()
+
+
+def test_crash_keeps_only_whole_committed_rows(tmp_path: Path):
+    path = tmp_path / "crash.csv"
+    script = f"""
+import os, time
+from bslfs.terps.processing import SampleRecord
+from bslfs.terps.writer import GroupCommitLogger
+log = GroupCommitLogger({str(path)!r}, commit_rows=8, commit_interval_s=60.0, fsync_interval_s=-1)
+log.set_metadata({{"coeff_source": "config"}})
+for i in range(30):
+    log.append(SampleRecord(float(i), 30000.0, 100.0, 6e5, 1.0, 16, 0, 0.0, "RECIP"))
+deadline = time.monotonic() + 5
+while log.stats()["commits"] < 3 and time.monotonic() < deadline:
+    time.sleep(0.005)
+os._exit(0)
+"""
+    subprocess.run([sys.executable, "-c", script], check=True, timeout=30)
+    text = path.read_text()
+    assert text.endswith("\n")
+    lines = text.splitlines()
+    assert lines[0] == "# coeff_source=config"
+    assert lines[1].startswith("ts_ms,")
+    rows = lines[2:]
+    assert len(rows) == 24  # three commits of eight, the pending tail is lost
+    assert all(len(row.split(",")) == 11 for row in rows)
+    assert [float(row.split(",")[0]) for row in rows] == [float(i) for i in range(24)]